@@ -198,8 +198,8 @@ bool ATTR_ROW::SetAttrToEnd(const UINT iStart, const TextAttribute attr)
 // - wToBeReplacedAttr - the legacy attribute to replace in this row.
 // - wReplaceWith - the new value for the matching runs' attributes.
 // Return Value:
-// <none>
-void ATTR_ROW::ReplaceLegacyAttrs(_In_ WORD wToBeReplacedAttr, _In_ WORD wReplaceWith) noexcept
+// - True if any run in the row changed.
+bool ATTR_ROW::ReplaceLegacyAttrs(_In_ WORD wToBeReplacedAttr, _In_ WORD wReplaceWith) noexcept
 {
     TextAttribute ToBeReplaced;
     ToBeReplaced.SetFromLegacy(wToBeReplacedAttr);
@@ -207,7 +207,7 @@ void ATTR_ROW::ReplaceLegacyAttrs(_In_ WORD wToBeReplacedAttr, _In_ WORD wReplac
     TextAttribute ReplaceWith;
     ReplaceWith.SetFromLegacy(wReplaceWith);
 
-    ReplaceAttrs(ToBeReplaced, ReplaceWith);
+    return ReplaceAttrs(ToBeReplaced, ReplaceWith);
 }
 
 
@@ -218,16 +218,59 @@ void ATTR_ROW::ReplaceLegacyAttrs(_In_ WORD wToBeReplacedAttr, _In_ WORD wReplac
 // - toBeReplacedAttr - the attribute to replace in this row.
 // - replaceWith - the new value for the matching runs' attributes.
 // Return Value:
-// - <none>
-void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept
+// - True if any run in the row changed.
+bool ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept
 {
+    const std::pair<TextAttribute, TextAttribute> replacement{ toBeReplacedAttr, replaceWith };
+    return ReplaceAttrs({ &replacement, 1 });
+}
+
+// Method Description:
+// - Replaces the attributes of all runs in the row that match the first half
+//      of one of the given pairs with its second half. All pairs are applied
+//      at once, so they can swap attributes with each other.
+// - Neighboring runs that end up with the same attributes are merged.
+// Arguments:
+// - replacements - pairs of the attribute to replace and its new value.
+// Return Value:
+// - True if any run in the row changed.
+bool ATTR_ROW::ReplaceAttrs(const gsl::span<const std::pair<TextAttribute, TextAttribute>> replacements) noexcept
+{
+    bool changed = false;
     for (auto& run : _list)
     {
-        if (run.GetAttributes() == toBeReplacedAttr)
+        for (const auto& replacement : replacements)
+        {
+            if (run.GetAttributes() == replacement.first)
+            {
+                if (replacement.first != replacement.second)
+                {
+                    run.SetAttributes(replacement.second);
+                    changed = true;
+                }
+                break;
+            }
+        }
+    }
+
+    if (changed)
+    {
+        auto merged = _list.begin();
+        for (auto it = std::next(merged); it != _list.end(); ++it)
         {
-            run.SetAttributes(replaceWith);
+            if (it->GetAttributes() == merged->GetAttributes())
+            {
+                merged->SetLength(merged->GetLength() + it->GetLength());
+            }
+            else
+            {
+                *++merged = *it;
+            }
         }
+        _list.erase(std::next(merged), _list.end());
     }
+
+    return changed;
 }
 
 
@@ -527,6 +570,59 @@ HRESULT ATTR_ROW::InsertAttrRuns(const std::basic_string_view<TextAttributeRun>
     return S_OK;
 }
 
+// Routine Description:
+// - Copies the attributes of a span of columns from a row (which may be this
+//   one) into this row. The runs covering the source span are trimmed to fit
+//   it and spliced in as a whole, instead of one column at a time.
+// Arguments:
+// - source - The row to copy the attributes from.
+// - sourceIndex - The first column to copy from the source.
+// - targetIndex - The column in this row to copy the first attribute to.
+// - count - The number of columns to copy.
+// Return Value:
+// - S_OK, E_INVALIDARG if either span is out of bounds, or another error if
+//   there wasn't enough memory to splice the runs.
+[[nodiscard]]
+HRESULT ATTR_ROW::CopyAttrRuns(const ATTR_ROW& source,
+                               const size_t sourceIndex,
+                               const size_t targetIndex,
+                               const size_t count)
+{
+    RETURN_HR_IF(E_INVALIDARG, sourceIndex + count > source._cchRowWidth);
+    RETURN_HR_IF(E_INVALIDARG, targetIndex + count > _cchRowWidth);
+
+    if (count == 0)
+    {
+        return S_OK;
+    }
+
+    try
+    {
+        // Copy the runs out first, since the source might be this row.
+        std::vector<TextAttributeRun> runs;
+
+        size_t applies = 0;
+        auto runIndex = source.FindAttrIndex(sourceIndex, &applies);
+        size_t remaining = count;
+        while (remaining > 0)
+        {
+            const auto& run = source._list.at(runIndex);
+            const size_t length = std::min(applies, remaining);
+            runs.emplace_back(length, run.GetAttributes());
+            remaining -= length;
+
+            // Every run after the first one applies from its start.
+            if (++runIndex < source._list.size())
+            {
+                applies = source._list.at(runIndex).GetLength();
+            }
+        }
+
+        return InsertAttrRuns({ runs.data(), runs.size() }, targetIndex, targetIndex + count - 1, _cchRowWidth);
+    }
+    CATCH_RETURN();
+}
+
 // Routine Description:
 // - packs a vector of TextAttribute into a vector of TextAttrbuteRun
 // Arguments:
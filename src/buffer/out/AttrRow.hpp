@@ -42,8 +42,9 @@ public:
                          size_t* const pApplies) const;
 
     bool SetAttrToEnd(const UINT iStart, const TextAttribute attr);
-    void ReplaceLegacyAttrs(const WORD wToBeReplacedAttr, const WORD wReplaceWith) noexcept;
-    void ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept;
+    bool ReplaceLegacyAttrs(const WORD wToBeReplacedAttr, const WORD wReplaceWith) noexcept;
+    bool ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept;
+    bool ReplaceAttrs(const gsl::span<const std::pair<TextAttribute, TextAttribute>> replacements) noexcept;
 
     void Resize(const size_t newWidth);
 
@@ -53,6 +54,12 @@ public:
                            const size_t iEnd,
                            const size_t cBufferWidth);
 
+    [[nodiscard]]
+    HRESULT CopyAttrRuns(const ATTR_ROW& source,
+                         const size_t sourceIndex,
+                         const size_t targetIndex,
+                         const size_t count);
+
     static std::vector<TextAttributeRun> PackAttrs(const std::vector<TextAttribute>& attrs);
 
     const_iterator begin() const noexcept;
@@ -293,6 +293,78 @@ std::wstring CharRow::GetText() const
     return wstr;
 }
 
+// Routine Description:
+// - Copies a span of cells from a row (which may be this one) into this row,
+//   as one block. Overlapping spans within the same row are handled.
+// - Glyphs that are kept in UnicodeStorage are carried over to their new keys.
+// - Like writing cells one by one would, a trailing half of a double-byte
+//   character landing in the first column, or a leading half landing in the
+//   last column, is cleared.
+// Arguments:
+// - source - the row to copy from
+// - sourceIndex - the first column to copy from the source
+// - targetIndex - the column in this row to copy the first cell to
+// - count - the number of cells to copy
+// Return Value:
+// - <none>
+// Note: will throw exception if either span is out of bounds, or if there's
+//       not enough memory to carry over stored glyphs.
+void CharRow::CopyCells(const CharRow& source, const size_t sourceIndex, const size_t targetIndex, const size_t count)
+{
+    THROW_HR_IF(E_INVALIDARG, sourceIndex + count > source._data.size());
+    THROW_HR_IF(E_INVALIDARG, targetIndex + count > _data.size());
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto sourceBegin = source._data.cbegin() + sourceIndex;
+    const auto sourceEnd = sourceBegin + count;
+
+    // Stored glyphs are keyed by position, so read them all out before the
+    //      cells (and potentially their keys) are overwritten. Most rows have
+    //      none, so this doesn't allocate.
+    std::vector<std::pair<size_t, UnicodeStorage::mapped_type>> glyphs;
+    for (auto it = sourceBegin; it != sourceEnd; ++it)
+    {
+        if (it->DbcsAttr().IsGlyphStored())
+        {
+            const size_t offset = it - sourceBegin;
+            glyphs.emplace_back(offset, source.GetUnicodeStorage().GetText(source.GetStorageKey(sourceIndex + offset)));
+        }
+    }
+
+    const auto targetBegin = _data.begin() + targetIndex;
+    if (this == &source && targetIndex > sourceIndex)
+    {
+        // Moving right within the row, so copy from the end to not overwrite
+        //      cells before they're read.
+        std::copy_backward(sourceBegin, sourceEnd, targetBegin + count);
+    }
+    else
+    {
+        std::copy(sourceBegin, sourceEnd, targetBegin);
+    }
+
+    auto& storage = GetUnicodeStorage();
+    for (const auto& glyph : glyphs)
+    {
+        storage.StoreGlyph(GetStorageKey(targetIndex + glyph.first), glyph.second);
+    }
+
+    if (targetIndex == 0 && _data.front().DbcsAttr().IsTrailing())
+    {
+        ClearCell(0);
+    }
+
+    if (targetIndex + count == _data.size() && _data.back().DbcsAttr().IsLeading())
+    {
+        ClearCell(_data.size() - 1);
+        SetDoubleBytePadded(true);
+    }
+}
+
 UnicodeStorage& CharRow::GetUnicodeStorage()
 {
     return _pParent->GetUnicodeStorage();
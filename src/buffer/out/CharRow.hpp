@@ -63,6 +63,7 @@ public:
     const DbcsAttribute& DbcsAttrAt(const size_t column) const;
     DbcsAttribute& DbcsAttrAt(const size_t column);
     void ClearGlyph(const size_t column);
+    void CopyCells(const CharRow& source, const size_t sourceIndex, const size_t targetIndex, const size_t count);
     std::wstring GetText() const;
 
     // other functions implemented at the template class level
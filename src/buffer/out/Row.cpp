@@ -220,3 +220,105 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
 
     return it;
 }
+
+// Routine Description:
+// - writes a span of legacy CHAR_INFO cells into this row as one block. The
+//   characters are stored directly, and the colors are packed into runs and
+//   inserted with a single splice, instead of one cell at a time.
+// - This doesn't apply the padding rules WriteCells uses for a trailing byte
+//   in the first column or a leading byte in the last column. If the span
+//   would need them, nothing is written, and the caller should fall back to
+//   WriteCells.
+// Arguments:
+// - charInfos - the cells to write
+// - index - the column to write the first cell to
+// - setWrap - set the wrap flag on the row if the write fills the last column
+// Return Value:
+// - true if the cells were written, false if the caller needs to use WriteCells.
+// Note: will throw exception on error.
+bool ROW::WriteCharInfos(const std::basic_string_view<CHAR_INFO> charInfos, const size_t index, const bool setWrap)
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+    THROW_HR_IF(E_INVALIDARG, charInfos.size() > _charRow.size() - index);
+
+    if (charInfos.empty())
+    {
+        return true;
+    }
+
+    // A cell that claims to be both is treated as leading, like OutputCellIterator does.
+    const auto isLeading = [](const CHAR_INFO& ci) noexcept { return WI_IsFlagSet(ci.Attributes, COMMON_LVB_LEADING_BYTE); };
+    const auto isTrailing = [&](const CHAR_INFO& ci) noexcept { return !isLeading(ci) && WI_IsFlagSet(ci.Attributes, COMMON_LVB_TRAILING_BYTE); };
+
+    const size_t lastIndex = index + charInfos.size() - 1;
+    const bool fillsLastColumn = lastIndex == _charRow.size() - 1;
+    if ((index == 0 && isTrailing(charInfos.front())) ||
+        (fillsLastColumn && isLeading(charInfos.back())))
+    {
+        return false;
+    }
+
+    // Pack the colors into runs as we store the text. The lead/trail flags
+    // aren't part of the color, so they don't split a run.
+    std::vector<TextAttributeRun> runs;
+    WORD runLegacy = 0;
+
+    auto cellIter = _charRow.begin() + index;
+    for (const auto& charInfo : charInfos)
+    {
+        DbcsAttribute dbcsAttr;
+        if (isLeading(charInfo))
+        {
+            dbcsAttr.SetLeading();
+        }
+        else if (isTrailing(charInfo))
+        {
+            dbcsAttr.SetTrailing();
+        }
+        cellIter->DbcsAttr() = dbcsAttr;
+        cellIter->Char() = charInfo.Char.UnicodeChar;
+        ++cellIter;
+
+        const WORD legacy = charInfo.Attributes & ~COMMON_LVB_SBCSDBCS;
+        if (!runs.empty() && legacy == runLegacy)
+        {
+            runs.back().SetLength(runs.back().GetLength() + 1);
+        }
+        else
+        {
+            TextAttribute attr;
+            attr.SetFromLegacy(legacy);
+            runs.emplace_back(1, attr);
+            runLegacy = legacy;
+        }
+    }
+
+    THROW_IF_FAILED(_attrRow.InsertAttrRuns({ runs.data(), runs.size() },
+                                            index,
+                                            lastIndex,
+                                            _charRow.size()));
+
+    if (setWrap && fillsLastColumn)
+    {
+        _charRow.SetWrapForced(true);
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - copies a span of cells, text and attributes, from a row (which may be this
+//   one) into this row as one block.
+// Arguments:
+// - source - the row to copy from
+// - sourceIndex - the first column to copy from the source
+// - targetIndex - the column in this row to copy the first cell to
+// - count - the number of cells to copy
+// Return Value:
+// - <none>
+// Note: will throw exception on error.
+void ROW::CopyCells(const ROW& source, const size_t sourceIndex, const size_t targetIndex, const size_t count)
+{
+    _charRow.CopyCells(source._charRow, sourceIndex, targetIndex, count);
+    THROW_IF_FAILED(_attrRow.CopyAttrRuns(source._attrRow, sourceIndex, targetIndex, count));
+}
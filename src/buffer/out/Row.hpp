@@ -59,6 +59,8 @@ public:
     const UnicodeStorage& GetUnicodeStorage() const;
 
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const bool setWrap, std::optional<size_t> limitRight = std::nullopt);
+    bool WriteCharInfos(const std::basic_string_view<CHAR_INFO> charInfos, const size_t index, const bool setWrap);
+    void CopyCells(const ROW& source, const size_t sourceIndex, const size_t targetIndex, const size_t count);
 
     friend bool operator==(const ROW& a, const ROW& b) noexcept;
 
@@ -372,6 +372,34 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Writes one line of legacy CHAR_INFO cells to the output buffer, storing
+//   the whole span into the row at once where possible.
+// Arguments:
+// - charInfos - The cells to write. They must fit on the line from the target onward.
+// - target - Coordinate targeted within output buffer
+// Return Value:
+// - <none>
+// Note: will throw exception on error.
+void TextBuffer::WriteCharInfos(const std::basic_string_view<CHAR_INFO> charInfos,
+                                const COORD target)
+{
+    THROW_HR_IF(E_INVALIDARG, !GetSize().IsInBounds(target));
+
+    ROW& row = GetRowByOffset(target.Y);
+    if (row.WriteCharInfos(charInfos, target.X, true))
+    {
+        const Viewport paint = Viewport::FromDimensions(target, { gsl::narrow<SHORT>(charInfos.size()), 1 });
+        _NotifyPaint(paint);
+    }
+    else
+    {
+        // A double byte character is split by an edge of the buffer, so let
+        // the cell by cell path apply its padding rules.
+        Write(OutputCellIterator(charInfos), target);
+    }
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -738,6 +766,41 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
     _RefreshRowIDs(std::nullopt);
 }
 
+// Routine Description:
+// - Copies a rectangle of cells to another position in the buffer, one row
+//   span at a time, instead of one cell at a time. The source and the target
+//   may overlap; the rows are walked in the direction that reads every source
+//   row before it's overwritten.
+// Arguments:
+// - source - The rectangle to copy.
+// - targetOrigin - The upper left corner of where the copy should go.
+// Return Value:
+// - <none>
+// Note: will throw exception if either rectangle isn't within the buffer.
+void TextBuffer::CopyRectangle(const Viewport source, const COORD targetOrigin)
+{
+    const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
+    const auto size = GetSize();
+    THROW_HR_IF(E_INVALIDARG, !size.IsInBounds(source) || !size.IsInBounds(target));
+
+    const auto height = source.Height();
+    const auto width = gsl::narrow<size_t>(source.Width());
+
+    // When moving down, start at the bottom so no source row is overwritten
+    //      before it's copied. Rows that stay put copy within themselves.
+    const bool bottomUp = targetOrigin.Y > source.Top();
+    for (SHORT i = 0; i < height; i++)
+    {
+        const SHORT offset = bottomUp ? height - 1 - i : i;
+        const ROW& sourceRow = GetRowByOffset(source.Top() + offset);
+        ROW& targetRow = GetRowByOffset(targetOrigin.Y + offset);
+
+        targetRow.CopyCells(sourceRow, source.Left(), targetOrigin.X, width);
+    }
+
+    _NotifyPaint(target);
+}
+
 Cursor& TextBuffer::GetCursor()
 {
     return _cursor;
@@ -758,6 +821,79 @@ void TextBuffer::SetCurrentAttributes(const TextAttribute currentAttributes) noe
 {
     _currentAttributes = currentAttributes;
 }
+
+// Routine Description:
+// - Replaces the attributes of every run in the buffer that matches the first
+//   half of one of the given pairs with its second half, like when the default
+//   colors of the buffer change.
+// - Big buffers are split into chunks of rows that are rewritten on separate
+//   threads. Every row belongs to exactly one chunk, so they don't contend.
+// - Only the rows that actually changed are invalidated.
+// Arguments:
+// - replacements - pairs of the attribute to replace and its new value.
+// Return Value:
+// - <none>
+void TextBuffer::ReplaceAttributes(const gsl::span<const std::pair<TextAttribute, TextAttribute>> replacements)
+{
+    // Below this many rows per thread, starting the thread costs more than it saves.
+    constexpr size_t minimumRowsPerChunk = 1024;
+
+    const size_t rowCount = TotalRowCount();
+    std::vector<BYTE> changed(rowCount, FALSE);
+
+    const auto replaceRows = [&](const size_t begin, const size_t end) noexcept {
+        for (size_t i = begin; i < end; i++)
+        {
+            changed[i] = _storage[(_firstRow + i) % rowCount].GetAttrRow().ReplaceAttrs(replacements);
+        }
+    };
+
+    const size_t threadLimit = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunkCount = std::clamp<size_t>(rowCount / minimumRowsPerChunk, 1, threadLimit);
+    const size_t chunkSize = (rowCount + chunkCount - 1) / chunkCount;
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunkCount - 1);
+    auto joinThreads = wil::scope_exit([&]() noexcept {
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    });
+
+    for (size_t begin = chunkSize; begin < rowCount; begin += chunkSize)
+    {
+        const size_t end = std::min(begin + chunkSize, rowCount);
+        try
+        {
+            threads.emplace_back(replaceRows, begin, end);
+        }
+        catch (...)
+        {
+            // If we can't get another thread, this chunk is just done here instead.
+            LOG_CAUGHT_EXCEPTION();
+            replaceRows(begin, end);
+        }
+    }
+    replaceRows(0, std::min(chunkSize, rowCount));
+    joinThreads.reset();
+
+    // Invalidate each run of consecutive changed rows at once.
+    const SHORT right = GetSize().RightInclusive();
+    for (size_t top = 0; top < rowCount; top++)
+    {
+        if (changed[top])
+        {
+            size_t bottom = top;
+            while (bottom + 1 < rowCount && changed[bottom + 1])
+            {
+                bottom++;
+            }
+            _NotifyPaint(Viewport::FromInclusive({ 0, gsl::narrow<SHORT>(top), right, gsl::narrow<SHORT>(bottom) }));
+            top = bottom;
+        }
+    }
+}
 
 // Routine Description:
 // - Resets the text contents of this buffer with the default character
@@ -924,110 +1060,161 @@ Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget()
 }
 
 // Routine Description:
-// - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
+// - Walks the selected region a row at a time, handing it to the callbacks in
+//   runs of text that share their attributes. Only one row is held at a time,
+//   so any amount of the buffer can be exported with bounded memory, and text
+//   and formatting can be produced from it in a single pass.
 // Arguments:
 // - lineSelection - true if entire line is being selected. False otherwise (box selection)
 // - trimTrailingWhitespace - setting flag removes trailing whitespace at the end of each row in selection
 // - selectionRects - the selection regions from which the data will be extracted from the buffer
-// - GetForegroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
-// - GetBackgroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
+// - appendRun - called with each run of text in the row and the attributes of its cells
+// - endRow - called after the last run of each row, with whether a CR/LF
+//   belongs between it and the next row
 // Return Value:
-// - The text, background color, and foreground color data of the selected region of the text buffer.
-const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSelection,
-                                                               const bool trimTrailingWhitespace,
-                                                               const std::vector<SMALL_RECT>& selectionRects,
-                                                               std::function<COLORREF(TextAttribute&)> GetForegroundColor,
-                                                               std::function<COLORREF(TextAttribute&)> GetBackgroundColor) const
+// - <none>
+void TextBuffer::ExportSelection(const bool lineSelection,
+                                 const bool trimTrailingWhitespace,
+                                 const std::vector<SMALL_RECT>& selectionRects,
+                                 const std::function<void(const std::wstring_view text, const TextAttribute& attributes)>& appendRun,
+                                 const std::function<void(const bool lineBreak)>& endRow) const
 {
-    TextAndColor data;
-
-    // preallocate our vectors to reduce reallocs
-    size_t const rows = selectionRects.size();
-    data.text.reserve(rows);
-    data.FgAttr.reserve(rows);
-    data.BkAttr.reserve(rows);
+    // The text of the current row, and the attributes of each run of it.
+    std::wstring rowText;
+    std::vector<TextAttributeRun> rowRuns;
 
-    // for each row in the selection
-    for (UINT i = 0; i < rows; i++)
+    for (size_t i = 0; i < selectionRects.size(); i++)
     {
-        const UINT iRow = selectionRects.at(i).Top;
-
-        const Viewport highlight = Viewport::FromInclusive(selectionRects.at(i));
-
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
-
-        // allocate a string buffer
-        std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
-
-        // preallocate to avoid reallocs
-        selectionText.reserve(highlight.Width() + 2); // + 2 for \r\n if we munged it
-        selectionFgAttr.reserve(highlight.Width() + 2);
-        selectionBkAttr.reserve(highlight.Width() + 2);
-
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+        const SMALL_RECT& rect = selectionRects.at(i);
+        const ROW& row = GetRowByOffset(rect.Top);
+        const CharRow& charRow = row.GetCharRow();
+        const ATTR_ROW& attrRow = row.GetAttrRow();
+
+        rowText.clear();
+        rowRuns.clear();
+
+        // copy char data a run of attributes at a time, skipping trailing bytes
+        const size_t right = std::min(gsl::narrow_cast<size_t>(rect.Right) + 1, charRow.size());
+        size_t column = rect.Left;
+        while (column < right)
         {
-            const auto& cell = *it;
-            auto cellData = cell.TextAttr();
-            COLORREF const CellFgAttr = GetForegroundColor(cellData);
-            COLORREF const CellBkAttr = GetBackgroundColor(cellData);
-
-            if (!cell.DbcsAttr().IsTrailing())
+            size_t applies;
+            const TextAttribute attributes = attrRow.GetAttrByColumn(column, &applies);
+            const size_t runEnd = std::min(right, column + applies);
+            const size_t runStart = rowText.size();
+            for (; column < runEnd; column++)
             {
-                selectionText.append(cell.Chars());
-                for (const wchar_t wch : cell.Chars())
+                if (!charRow.DbcsAttrAt(column).IsTrailing())
                 {
-                    selectionFgAttr.push_back(CellFgAttr);
-                    selectionBkAttr.push_back(CellBkAttr);
+                    const std::wstring_view glyph = charRow.GlyphAt(column);
+                    rowText.append(glyph);
                 }
             }
-            it++;
+
+            if (rowText.size() > runStart)
+            {
+                rowRuns.emplace_back(rowText.size() - runStart, attributes);
+            }
         }
 
+        bool lineBreak = false;
+
         // trim trailing spaces if SHIFT key not held
         if (trimTrailingWhitespace)
         {
-            const ROW& Row = GetRowByOffset(iRow);
-
             // FOR LINE SELECTION ONLY: if the row was wrapped, don't remove the spaces at the end.
-            if (!lineSelection || !Row.GetCharRow().WasWrapForced())
+            if (!lineSelection || !charRow.WasWrapForced())
             {
-                while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
+                while (!rowText.empty() && rowText.back() == UNICODE_SPACE)
                 {
-                    selectionText.pop_back();
-                    selectionFgAttr.pop_back();
-                    selectionBkAttr.pop_back();
+                    rowText.pop_back();
+                    rowRuns.back().DecrementLength();
+                    if (rowRuns.back().GetLength() == 0)
+                    {
+                        rowRuns.pop_back();
+                    }
                 }
             }
 
             // apply CR/LF to the end of the final string, unless we're the last line.
-            // a.k.a if we're earlier than the bottom, then apply CR/LF.
-            if (i < selectionRects.size() - 1)
-            {
-                // FOR LINE SELECTION ONLY: if the row was wrapped, do not apply CR/LF.
-                // a.k.a. if the row was NOT wrapped, then we can assume a CR/LF is proper
-                // always apply \r\n for box selection
-                if (!lineSelection || !GetRowByOffset(iRow).GetCharRow().WasWrapForced())
-                {
-                    COLORREF const Blackness = RGB(0x00, 0x00, 0x00);      // cant see CR/LF so just use black FG & BK
-
-                    selectionText.push_back(UNICODE_CARRIAGERETURN);
-                    selectionText.push_back(UNICODE_LINEFEED);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                }
-            }
+            // FOR LINE SELECTION ONLY: if the row was wrapped, do not apply CR/LF.
+            // always apply \r\n for box selection
+            lineBreak = i < selectionRects.size() - 1 &&
+                        (!lineSelection || !charRow.WasWrapForced());
         }
 
-        data.text.emplace_back(selectionText);
-        data.FgAttr.emplace_back(selectionFgAttr);
-        data.BkAttr.emplace_back(selectionBkAttr);
+        const std::wstring_view text{ rowText };
+        size_t offset = 0;
+        for (const auto& run : rowRuns)
+        {
+            appendRun(text.substr(offset, run.GetLength()), run.GetAttributes());
+            offset += run.GetLength();
+        }
+        endRow(lineBreak);
     }
+}
+
+// Routine Description:
+// - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
+// - The colors are looked up once for each run of attributes, not for every cell.
+// Arguments:
+// - lineSelection - true if entire line is being selected. False otherwise (box selection)
+// - trimTrailingWhitespace - setting flag removes trailing whitespace at the end of each row in selection
+// - selectionRects - the selection regions from which the data will be extracted from the buffer
+// - GetForegroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
+// - GetBackgroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
+// Return Value:
+// - The text of each row of the selected region, and the runs of colors it's drawn in.
+const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSelection,
+                                                               const bool trimTrailingWhitespace,
+                                                               const std::vector<SMALL_RECT>& selectionRects,
+                                                               std::function<COLORREF(TextAttribute&)> GetForegroundColor,
+                                                               std::function<COLORREF(TextAttribute&)> GetBackgroundColor) const
+{
+    TextAndColor data;
+
+    // preallocate our vectors to reduce reallocs
+    data.text.reserve(selectionRects.size());
+    data.colors.reserve(selectionRects.size());
+
+    std::wstring selectionText;
+    std::vector<ColorRun> selectionColors;
+
+    const auto appendRun = [&](const std::wstring_view text, const TextAttribute& attributes) {
+        TextAttribute attr = attributes;
+        const COLORREF foreground = GetForegroundColor(attr);
+        const COLORREF background = GetBackgroundColor(attr);
+
+        // neighboring runs can differ in attributes that don't change their colors
+        if (!selectionColors.empty() &&
+            selectionColors.back().foreground == foreground &&
+            selectionColors.back().background == background)
+        {
+            selectionColors.back().length += text.size();
+        }
+        else
+        {
+            selectionColors.push_back({ text.size(), foreground, background });
+        }
+        selectionText.append(text);
+    };
+
+    const auto endRow = [&](const bool lineBreak) {
+        if (lineBreak)
+        {
+            COLORREF const Blackness = RGB(0x00, 0x00, 0x00); // cant see CR/LF so just use black FG & BK
+
+            selectionText.push_back(UNICODE_CARRIAGERETURN);
+            selectionText.push_back(UNICODE_LINEFEED);
+            selectionColors.push_back({ 2, Blackness, Blackness });
+        }
+
+        data.text.emplace_back(std::move(selectionText));
+        data.colors.emplace_back(std::move(selectionColors));
+        selectionText.clear();
+        selectionColors.clear();
+    };
 
+    ExportSelection(lineSelection, trimTrailingWhitespace, selectionRects, appendRun, endRow);
     return data;
 }
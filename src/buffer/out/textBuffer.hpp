@@ -96,6 +96,9 @@ public:
                                  const bool setWrap = false,
                                  const std::optional<size_t> limitRight = std::nullopt);
 
+    void WriteCharInfos(const std::basic_string_view<CHAR_INFO> charInfos,
+                        const COORD target);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool IncrementCursor();
@@ -114,6 +117,7 @@ public:
     const Microsoft::Console::Types::Viewport GetSize() const;
 
     void ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta);
+    void CopyRectangle(const Microsoft::Console::Types::Viewport source, const COORD targetOrigin);
 
     UINT TotalRowCount() const;
 
@@ -122,6 +126,8 @@ public:
 
     void SetCurrentAttributes(const TextAttribute currentAttributes) noexcept;
 
+    void ReplaceAttributes(const gsl::span<const std::pair<TextAttribute, TextAttribute>> replacements);
+
     void Reset();
 
     [[nodiscard]]
@@ -132,12 +138,25 @@ public:
 
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget();
 
+    void ExportSelection(const bool lineSelection,
+                         const bool trimTrailingWhitespace,
+                         const std::vector<SMALL_RECT>& selectionRects,
+                         const std::function<void(const std::wstring_view text, const TextAttribute& attributes)>& appendRun,
+                         const std::function<void(const bool lineBreak)>& endRow) const;
+
+    // The colors of a run of selected text, covering length chars of it.
+    struct ColorRun
+    {
+        size_t length;
+        COLORREF foreground;
+        COLORREF background;
+    };
+
     class TextAndColor
     {
     public:
         std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        std::vector<std::vector<ColorRun>> colors; // the runs of each row, in order
     };
 
     const TextAndColor GetTextForClipboard(const bool lineSelection,
@@ -26,7 +26,10 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         _outputThreadId{ 0 },
         _hOutputThread{ INVALID_HANDLE_VALUE },
         _piConhost{ 0 },
-        _closing{ false }
+        _closing{ false },
+        _buffer{ std::make_unique<BYTE[]>(s_cbBuffer) },
+        _cbPartial{ 0 },
+        _outputIsBulk{ false }
     {
         _commandline = commandline;
         _startingDirectory = startingDirectory;
@@ -137,17 +140,94 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         return pInstance->_OutputThread();
     }
 
+    // Function Description:
+    // - Finds how much of a buffer of UTF-8 holds only whole sequences, so that
+    //      a sequence cut off by the end of a read isn't converted in halves.
+    // Arguments:
+    // - pb: The UTF-8 text.
+    // - cb: The length of the text, in bytes.
+    // Return Value:
+    // - The length up to the start of a sequence that's missing its end, or cb
+    //      if every sequence is whole.
+    size_t ConhostConnection::s_CompleteUtf8Length(const BYTE* const pb, const size_t cb) noexcept
+    {
+        // Look back over the continuation bytes at the end for the lead byte
+        //      of the last sequence, and check it has all of them.
+        for (size_t back = 1; back <= 4 && back <= cb; back++)
+        {
+            const BYTE lead = pb[cb - back];
+            if ((lead & 0xC0) != 0x80)
+            {
+                const size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+                return length > back ? cb - back : cb;
+            }
+        }
+
+        // Nothing but continuation bytes. That's not going to get any better
+        //      by waiting, so let the conversion replace them.
+        return cb;
+    }
+
+    // Function Description:
+    // - Reads whatever else is already waiting in the pipe into the rest of our
+    //      buffer, so it can be handed to the terminal in one piece.
+    // - If the last batch was large, the client is writing in bulk, so we give
+    //      it a short window to write more. Interactive output never waits.
+    //      The window is a sleep rather than polling the pipe, so the thread
+    //      doesn't keep a core busy between batches.
+    // Arguments:
+    // - cbRead: How much of the buffer has been filled already.
+    // Return Value:
+    // - How much of the buffer is filled now.
+    size_t ConhostConnection::_ReadAvailable(size_t cbRead)
+    {
+        bool waited = false;
+        while (cbRead < s_cbBuffer)
+        {
+            DWORD cbAvailable = 0;
+            if (!PeekNamedPipe(_outPipe, nullptr, 0, nullptr, &cbAvailable, nullptr))
+            {
+                // The pipe broke. Send what we have, and let the next read report it.
+                break;
+            }
+
+            if (cbAvailable == 0)
+            {
+                if (!_outputIsBulk || waited)
+                {
+                    break;
+                }
+
+                Sleep(s_coalesceMilliseconds);
+                waited = true;
+                continue;
+            }
+
+            DWORD dwRead = 0;
+            const DWORD cbWanted = static_cast<DWORD>(std::min<size_t>(cbAvailable, s_cbBuffer - cbRead));
+            if (!ReadFile(_outPipe, _buffer.get() + cbRead, cbWanted, &dwRead, nullptr))
+            {
+                break;
+            }
+            cbRead += dwRead;
+        }
+
+        return cbRead;
+    }
+
     DWORD ConhostConnection::_OutputThread()
     {
-        const size_t bufferSize = 4096;
-        BYTE buffer[bufferSize];
         DWORD dwRead;
         while (true)
         {
             dwRead = 0;
             bool fSuccess = false;
 
-            fSuccess = !!ReadFile(_outPipe, buffer, bufferSize, &dwRead, nullptr);
+            fSuccess = !!ReadFile(_outPipe,
+                                  _buffer.get() + _cbPartial,
+                                  static_cast<DWORD>(s_cbBuffer - _cbPartial),
+                                  &dwRead,
+                                  nullptr);
             if (!fSuccess)
             {
                 if (_closing)
@@ -163,11 +243,19 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
             }
             if (dwRead == 0) continue;
-            // Convert buffer to hstring
-            char* pchStr = (char*)(buffer);
-            std::string str{pchStr, dwRead};
+
+            const size_t cbBatch = _ReadAvailable(_cbPartial + dwRead);
+            _outputIsBulk = cbBatch - _cbPartial >= s_cbBulkOutput;
+
+            // Convert buffer to hstring, holding back a sequence that isn't
+            //      complete yet until the next read.
+            const size_t cbComplete = s_CompleteUtf8Length(_buffer.get(), cbBatch);
+            const std::string_view str{ reinterpret_cast<const char*>(_buffer.get()), cbComplete };
             auto hstr = winrt::to_hstring(str);
 
+            _cbPartial = cbBatch - cbComplete;
+            memmove(_buffer.get(), _buffer.get() + cbComplete, _cbPartial);
+
             // Pass the output to our registered event handlers
             _outputHandlers(hstr);
         }
@@ -39,7 +39,20 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         PROCESS_INFORMATION _piConhost;
         bool _closing;
 
+        // Output is read into one large buffer. Everything that's already in
+        //      the pipe goes out to the handlers at once, and while output is
+        //      coming in bulk, a read waits briefly for more to show up.
+        static constexpr size_t s_cbBuffer = 64 * 1024;
+        static constexpr size_t s_cbBulkOutput = 4 * 1024;
+        static constexpr DWORD s_coalesceMilliseconds = 1;
+
+        std::unique_ptr<BYTE[]> _buffer;
+        size_t _cbPartial; // The start of a UTF-8 sequence the last read cut off.
+        bool _outputIsBulk;
+
         static DWORD StaticOutputThreadProc(LPVOID lpParameter);
+        static size_t s_CompleteUtf8Length(const BYTE* const pb, const size_t cb) noexcept;
+        size_t _ReadAvailable(size_t cbRead);
         DWORD _OutputThread();
     };
 }
@@ -230,6 +230,11 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     TermControl::~TermControl()
     {
         _closing = true;
+
+        // The parse thread takes the lock to finish up, so it has to be
+        //      stopped before we take it ourselves.
+        _terminal->StopParseThread();
+
         // Don't let anyone else do something to the buffer.
         auto lock = _terminal->LockForWriting();
 
@@ -329,8 +334,10 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         THROW_IF_FAILED(dxEngine->Enable());
         _renderEngine = std::move(dxEngine);
 
+        // Output is parsed on a thread of its own, so the connection can go
+        //      right back to reading while the renderer holds the terminal.
         auto onRecieveOutputFn = [this](const hstring str) {
-            _terminal->Write(str.c_str());
+            _terminal->QueueWrite(str);
         };
         _connectionOutputEventToken = _connection.TerminalOutput(onRecieveOutputFn);
 
@@ -416,6 +423,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         //      becomes a no-op.
         _controlRoot.Focus(FocusState::Programmatic);
 
+        THROW_IF_FAILED(_terminal->StartParseThread());
         _connection.Start();
         _initializedTerminal = true;
     }
@@ -849,7 +857,8 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         const auto dpi = (int)(scale * USER_DEFAULT_SCREEN_DPI);
 
         // TODO: MSFT: 21169071 - Shouldn't this all happen through _renderer and trigger the invalidate automatically on DPI change?
-        THROW_IF_FAILED(_renderEngine->UpdateDpi(dpi));
+        // The engine paints outside the terminal lock, so it's only changed between frames.
+        THROW_IF_FAILED(_renderer->CallEngine([&]() { return _renderEngine->UpdateDpi(dpi); }));
         _renderer->TriggerRedrawAll();
     }
 
@@ -864,8 +873,10 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         size.cx = static_cast<long>(newWidth);
         size.cy = static_cast<long>(newHeight);
 
-        // Tell the dx engine that our window is now the new size.
-        THROW_IF_FAILED(_renderEngine->SetWindowSize(size));
+        // Tell the dx engine that our window is now the new size. The engine
+        //      paints outside the terminal lock, so it's only changed or asked
+        //      about its size between frames.
+        THROW_IF_FAILED(_renderer->CallEngine([&]() { return _renderEngine->SetWindowSize(size); }));
 
         // Invalidate everything
         _renderer->TriggerRedrawAll();
@@ -873,7 +884,11 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         // Convert our new dimensions to characters
         const auto viewInPixels = Viewport::FromDimensions({ 0, 0 },
                                                            { static_cast<short>(size.cx), static_cast<short>(size.cy) });
-        const auto vp = _renderEngine->GetViewportInCharacters(viewInPixels);
+        auto vp = Viewport::Empty();
+        THROW_IF_FAILED(_renderer->CallEngine([&]() {
+            vp = _renderEngine->GetViewportInCharacters(viewInPixels);
+            return S_OK;
+        }));
 
         // If this function succeeds with S_FALSE, then the terminal didn't
         //      actually change size. No need to notify the connection of this
@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "OutputRing.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+// Method Description:
+// - Makes an empty ring.
+// Arguments:
+// - capacity: How many characters the ring holds. Must be a power of two, and
+//   at least 2 so that a surrogate pair always fits.
+OutputRing::OutputRing(const size_t capacity) :
+    _capacity{ capacity },
+    _mask{ capacity - 1 },
+    _ring{},
+    _writeIndex{ 0 },
+    _readIndex{ 0 },
+    _closed{ false },
+    _readerWaiting{ false },
+    _writerWaiting{ false },
+    _dataAvailable{ wil::EventOptions::None },
+    _spaceAvailable{ wil::EventOptions::None }
+{
+    THROW_HR_IF(E_INVALIDARG, capacity < 2 || (capacity & _mask) != 0);
+    _ring = std::make_unique<wchar_t[]>(capacity);
+}
+
+// Method Description:
+// - Copies text into the ring. Only waits if the ring fills up, until the
+//   reader makes room.
+// - Waiting is done by saying so first and then looking again, and the reader
+//   makes room first and then looks whether anyone is waiting. Either the
+//   writer sees the room or the reader sees the writer, so a wakeup is never
+//   missed.
+// - A surrogate pair is never split between two writes to the ring, so the
+//   reader never sees text that ends on half of a character.
+// Arguments:
+// - text: The text to hand to the reader.
+// Return Value:
+// - false if the ring was closed, in which case the rest of the text is dropped.
+bool OutputRing::Write(std::wstring_view text)
+{
+    while (!text.empty())
+    {
+        if (_closed.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        const size_t cchNeeded = (text.size() > 1 && IS_HIGH_SURROGATE(text.front())) ? 2 : 1;
+        const size_t writeIndex = _writeIndex.load(std::memory_order_relaxed);
+        size_t space = _capacity - (writeIndex - _readIndex.load(std::memory_order_acquire));
+        if (space < cchNeeded)
+        {
+            _writerWaiting.store(true);
+            space = _capacity - (writeIndex - _readIndex.load());
+            if (space < cchNeeded && !_closed.load())
+            {
+                _spaceAvailable.wait();
+            }
+            _writerWaiting.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        size_t cch = std::min(space, text.size());
+        if (cch < text.size() && IS_HIGH_SURROGATE(text[cch - 1]))
+        {
+            // The other half goes with the next write.
+            cch--;
+        }
+
+        const size_t offset = writeIndex & _mask;
+        const size_t cchFirst = std::min(cch, _capacity - offset);
+        std::copy_n(text.data(), cchFirst, &_ring[offset]);
+        std::copy_n(text.data() + cchFirst, cch - cchFirst, &_ring[0]);
+
+        _writeIndex.store(writeIndex + cch);
+        if (_readerWaiting.load())
+        {
+            _dataAvailable.SetEvent();
+        }
+
+        text = text.substr(cch);
+    }
+
+    return true;
+}
+
+// Method Description:
+// - Waits until there's text to read.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if there's text to read. false once the ring is closed and everything
+//   written before that has been read.
+bool OutputRing::WaitForData() noexcept
+{
+    const size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+    while (true)
+    {
+        if (_writeIndex.load(std::memory_order_acquire) != readIndex)
+        {
+            return true;
+        }
+
+        if (_closed.load(std::memory_order_acquire))
+        {
+            // The writer may have written just before the ring was closed.
+            return _writeIndex.load(std::memory_order_acquire) != readIndex;
+        }
+
+        _readerWaiting.store(true);
+        if (_writeIndex.load() == readIndex && !_closed.load())
+        {
+            _dataAvailable.wait();
+        }
+        _readerWaiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+// Method Description:
+// - Gets all the text that's waiting to be read. It stays in the ring until
+//   it's consumed.
+// - The ring may wrap around in the middle of the text, so it comes in two
+//   parts. The second one is empty if it doesn't.
+// Arguments:
+// - <none>
+// Return Value:
+// - The waiting text, in order.
+std::pair<std::wstring_view, std::wstring_view> OutputRing::GetAvailable() const noexcept
+{
+    const size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+    const size_t cch = _writeIndex.load(std::memory_order_acquire) - readIndex;
+    const size_t offset = readIndex & _mask;
+    const size_t cchFirst = std::min(cch, _capacity - offset);
+    return { { &_ring[offset], cchFirst }, { &_ring[0], cch - cchFirst } };
+}
+
+// Method Description:
+// - Gives the room taken by text that has been read back to the writer.
+// Arguments:
+// - cch: How many characters were read. No more than GetAvailable returned.
+// Return Value:
+// - <none>
+void OutputRing::Consume(const size_t cch) noexcept
+{
+    _readIndex.store(_readIndex.load(std::memory_order_relaxed) + cch);
+    if (_writerWaiting.load())
+    {
+        _spaceAvailable.SetEvent();
+    }
+}
+
+// Method Description:
+// - Closes the ring. Writes from now on are dropped, a writer waiting for room
+//   gives up, and the reader stops waiting once it has read what's left.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void OutputRing::Close() noexcept
+{
+    _closed.store(true);
+    _dataAvailable.SetEvent();
+    _spaceAvailable.SetEvent();
+}
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+//
+// An OutputRing hands text from the thread reading the connection to the
+// thread parsing it. There is exactly one writer and one reader, so the two
+// indexes are all they need to agree on and neither side takes a lock. A side
+// only sleeps when there's nothing it can do: the reader when the ring is
+// empty, the writer when it's full.
+
+#pragma once
+
+namespace Microsoft::Terminal::Core
+{
+    class OutputRing;
+}
+
+// The indexes are kept apart so that the two threads don't bounce one cache
+//      line between them on every write and read.
+#pragma warning(push)
+#pragma warning(disable : 4324) // structure was padded due to alignment specifier
+
+class Microsoft::Terminal::Core::OutputRing final
+{
+public:
+    OutputRing(const size_t capacity);
+
+    OutputRing(const OutputRing&) = delete;
+    OutputRing& operator=(const OutputRing&) = delete;
+
+    // Writer side
+    bool Write(std::wstring_view text);
+
+    // Reader side
+    bool WaitForData() noexcept;
+    std::pair<std::wstring_view, std::wstring_view> GetAvailable() const noexcept;
+    void Consume(const size_t cch) noexcept;
+
+    void Close() noexcept;
+
+private:
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<wchar_t[]> _ring;
+
+    // Both only ever go up. Their difference is how much text is waiting.
+    alignas(64) std::atomic<size_t> _writeIndex;
+    alignas(64) std::atomic<size_t> _readIndex;
+
+    alignas(64) std::atomic<bool> _closed;
+    std::atomic<bool> _readerWaiting;
+    std::atomic<bool> _writerWaiting;
+    wil::unique_event _dataAvailable;
+    wil::unique_event _spaceAvailable;
+};
+
+#pragma warning(pop)
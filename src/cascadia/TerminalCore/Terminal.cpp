@@ -182,6 +182,126 @@ void Terminal::Write(std::wstring_view stringView)
     _stateMachine->ProcessString(stringView.data(), stringView.size());
 }
 
+// Method Description:
+// - Hands output to the parse thread and returns without waiting for it to be
+//   parsed, or for the renderer to let go of the terminal. Only waits if the
+//   parse thread is a whole ring of output behind.
+// - Parses the output right away, like Write, if the parse thread was never
+//   started. Drops it once the parse thread has been stopped.
+// - Must only be called from one thread at a time.
+// Arguments:
+// - stringView: the output to parse.
+void Terminal::QueueWrite(std::wstring_view stringView)
+{
+    if (_outputRing)
+    {
+        _outputRing->Write(stringView);
+    }
+    else
+    {
+        Write(stringView);
+    }
+}
+
+// Method Description:
+// - Starts the thread that parses output handed over by QueueWrite.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if the thread started, or it was already running.
+[[nodiscard]]
+HRESULT Terminal::StartParseThread() noexcept
+{
+    if (_hParseThread)
+    {
+        return S_OK;
+    }
+
+    try
+    {
+        _outputRing = std::make_unique<OutputRing>(s_cchOutputRing);
+    }
+    CATCH_RETURN();
+
+    _hParseThread.reset(CreateThread(nullptr, 0, Terminal::s_ParseThreadProc, this, 0, nullptr));
+    if (!_hParseThread)
+    {
+        _outputRing.reset();
+        RETURN_LAST_ERROR();
+    }
+
+    return S_OK;
+}
+
+// Method Description:
+// - Stops the parse thread, once it has parsed the output already queued.
+//   Output queued after this is dropped.
+// - Must not be called while holding the terminal lock, since the parse thread
+//   takes it to finish up.
+// Arguments:
+// - <none>
+void Terminal::StopParseThread() noexcept
+{
+    if (_hParseThread)
+    {
+        _outputRing->Close();
+        WaitForSingleObject(_hParseThread.get(), INFINITE);
+        _hParseThread.reset();
+    }
+}
+
+DWORD WINAPI Terminal::s_ParseThreadProc(_In_ LPVOID lpParameter)
+{
+    static_cast<Terminal*>(lpParameter)->_ParseThreadProc();
+    return 0;
+}
+
+// Method Description:
+// - Parses output as the connection hands it over. Everything waiting in the
+//   ring is parsed under a single acquisition of the lock, so a burst of
+//   output takes the lock once rather than once per read from the connection.
+//   What arrives while that's going on waits for the next round, which gives
+//   the renderer a chance to take the lock in between.
+// Arguments:
+// - <none>
+void Terminal::_ParseThreadProc()
+{
+    while (_outputRing->WaitForData())
+    {
+        const auto available = _outputRing->GetAvailable();
+        try
+        {
+            auto lock = LockForWriting();
+            _ParseOutput(available.first, available.second);
+        }
+        CATCH_LOG();
+        _outputRing->Consume(available.first.size() + available.second.size());
+    }
+}
+
+// Method Description:
+// - Parses output that came out of the ring in two parts, keeping a surrogate
+//   pair split where the ring wraps around in one piece.
+// - The caller must hold the write lock.
+// Arguments:
+// - first: the output up to the end of the ring.
+// - second: the output from the start of the ring.
+void Terminal::_ParseOutput(const std::wstring_view first, const std::wstring_view second)
+{
+    if (!first.empty() && !second.empty() && IS_HIGH_SURROGATE(first.back()))
+    {
+        _stateMachine->ProcessString(first.data(), first.size() - 1);
+        const wchar_t pair[] = { first.back(), second.front() };
+        _stateMachine->ProcessString(pair, ARRAYSIZE(pair));
+        _stateMachine->ProcessString(second.data() + 1, second.size() - 1);
+    }
+    else
+    {
+        _stateMachine->ProcessString(first.data(), first.size());
+        _stateMachine->ProcessString(second.data(), second.size());
+    }
+}
+
 // Method Description:
 // - Send this particular key event to the terminal. The terminal will translate
 //   the key and the modifiers pressed into the appropriate VT sequence for that
@@ -573,20 +693,19 @@ void Terminal::ClearSelection() noexcept
 // - wstring text from buffer. If extended to multiple lines, each line is separated by \r\n
 const std::wstring Terminal::RetrieveSelectedTextFromBuffer(bool trimTrailingWhitespace) const
 {
-    std::function<COLORREF(TextAttribute&)> GetForegroundColor = std::bind(&Terminal::GetForegroundColor, this, std::placeholders::_1);
-    std::function<COLORREF(TextAttribute&)> GetBackgroundColor = std::bind(&Terminal::GetBackgroundColor, this, std::placeholders::_1);
-
-    auto data = _buffer->GetTextForClipboard(!_boxSelection,
-                                             trimTrailingWhitespace,
-                                             _GetSelectionRects(),
-                                             GetForegroundColor,
-                                             GetBackgroundColor);
-
+    // Only the text is needed, so it's appended straight from the buffer,
+    // without looking up any colors.
     std::wstring result;
-    for (const auto& text : data.text)
-    {
-        result += text;
-    }
+    _buffer->ExportSelection(!_boxSelection,
+                             trimTrailingWhitespace,
+                             _GetSelectionRects(),
+                             [&](const std::wstring_view text, const TextAttribute&) { result.append(text); },
+                             [&](const bool lineBreak) {
+                                 if (lineBreak)
+                                 {
+                                     result.append(L"\r\n");
+                                 }
+                             });
 
     return result;
 }
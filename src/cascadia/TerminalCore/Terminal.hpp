@@ -13,6 +13,7 @@
 #include "../../types/inc/Viewport.hpp"
 #include "../../cascadia/terminalcore/ITerminalApi.hpp"
 #include "../../cascadia/terminalcore/ITerminalInput.hpp"
+#include "../../cascadia/terminalcore/OutputRing.hpp"
 
 // You have to forward decl the ICoreSettings here, instead of including the header.
 // If you include the header, there will be compilation errors with other
@@ -34,7 +35,7 @@ class Microsoft::Terminal::Core::Terminal final :
 {
 public:
     Terminal();
-    virtual ~Terminal() {};
+    virtual ~Terminal() { StopParseThread(); };
 
     void Create(COORD viewportSize,
                 SHORT scrollbackLines,
@@ -48,6 +49,12 @@ public:
     // Write goes through the parser
     void Write(std::wstring_view stringView);
 
+    // QueueWrite hands the text to the parse thread, if it's running
+    void QueueWrite(std::wstring_view stringView);
+    [[nodiscard]]
+    HRESULT StartParseThread() noexcept;
+    void StopParseThread() noexcept;
+
     [[nodiscard]]
     std::shared_lock<std::shared_mutex> LockForReading();
     [[nodiscard]]
@@ -149,6 +156,15 @@ public:
 
     std::shared_mutex _readWriteLock;
 
+    // Output from the connection waits here for the parse thread
+    std::unique_ptr<OutputRing> _outputRing;
+    wil::unique_handle _hParseThread;
+    static constexpr size_t s_cchOutputRing = 256 * 1024;
+
+    static DWORD WINAPI s_ParseThreadProc(_In_ LPVOID lpParameter);
+    void _ParseThreadProc();
+    void _ParseOutput(const std::wstring_view first, const std::wstring_view second);
+
     // TODO: These members are not shared by an alt-buffer. They should be
     //      encapsulated, such that a Terminal can have both a main and alt buffer.
     std::unique_ptr<TextBuffer> _buffer;
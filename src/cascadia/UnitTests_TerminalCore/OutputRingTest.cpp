@@ -0,0 +1,285 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "../cascadia/TerminalCore/OutputRing.hpp"
+#include "../renderer/inc/DummyRenderTarget.hpp"
+#include "consoletaeftemplates.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+
+namespace TerminalCoreUnitTests
+{
+    class OutputRingTest
+    {
+        TEST_CLASS(OutputRingTest);
+
+        TEST_METHOD(TextComesOutInOrder)
+        {
+            // A ring much smaller than the text, so it wraps around and fills
+            //      up over and over.
+            OutputRing ring(16);
+
+            std::wstring text;
+            for (size_t i = 0; i < 100000; i++)
+            {
+                text.push_back(static_cast<wchar_t>(L'!' + i % 90));
+            }
+
+            std::thread writer([&]() {
+                size_t offset = 0;
+                for (size_t cch = 1; offset < text.size(); cch = cch % 37 + 1)
+                {
+                    const auto piece = std::wstring_view(text).substr(offset, cch);
+                    ring.Write(piece);
+                    offset += piece.size();
+                }
+                ring.Close();
+            });
+
+            std::wstring read;
+            while (ring.WaitForData())
+            {
+                const auto available = ring.GetAvailable();
+                VERIFY_IS_LESS_THAN_OR_EQUAL(available.first.size() + available.second.size(), size_t{ 16 });
+                read.append(available.first);
+                read.append(available.second);
+                ring.Consume(available.first.size() + available.second.size());
+            }
+            writer.join();
+
+            VERIFY_ARE_EQUAL(text.size(), read.size());
+            VERIFY_IS_TRUE(text == read);
+        }
+
+        TEST_METHOD(SurrogatePairsAreNotSplit)
+        {
+            // An odd number of characters up front, so the pairs don't line up
+            //      with the ring filling up.
+            OutputRing ring(4);
+
+            std::wstring text(L"a");
+            for (size_t i = 0; i < 1000; i++)
+            {
+                text.append(L"\xD83D\xDE00");
+            }
+
+            std::thread writer([&]() {
+                ring.Write(text);
+                ring.Close();
+            });
+
+            std::wstring read;
+            while (ring.WaitForData())
+            {
+                const auto available = ring.GetAvailable();
+                const auto last = available.second.empty() ? available.first.back() : available.second.back();
+                VERIFY_IS_FALSE(IS_HIGH_SURROGATE(last));
+                read.append(available.first);
+                read.append(available.second);
+                ring.Consume(available.first.size() + available.second.size());
+            }
+            writer.join();
+
+            VERIFY_IS_TRUE(text == read);
+        }
+
+        TEST_METHOD(ClosingTheRing)
+        {
+            OutputRing ring(4);
+            VERIFY_IS_TRUE(ring.Write(L"abc"));
+            ring.Close();
+            VERIFY_IS_FALSE(ring.Write(L"d"), L"Writes after closing are dropped.");
+
+            Log::Comment(L"What was written before closing can still be read.");
+            VERIFY_IS_TRUE(ring.WaitForData());
+            const auto available = ring.GetAvailable();
+            VERIFY_ARE_EQUAL(std::wstring(L"abc"), std::wstring(available.first));
+            VERIFY_IS_TRUE(available.second.empty());
+            ring.Consume(available.first.size());
+            VERIFY_IS_FALSE(ring.WaitForData());
+
+            Log::Comment(L"A writer waiting for room gives up when the ring is closed.");
+            OutputRing fullRing(4);
+            std::thread writer([&]() {
+                VERIFY_IS_FALSE(fullRing.Write(L"abcdefgh"));
+            });
+            Sleep(50);
+            fullRing.Close();
+            writer.join();
+        }
+
+        TEST_METHOD(ParseThreadParsesQueuedOutput)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 100, 30 }, 0, emptyRT);
+
+            VERIFY_SUCCEEDED(term.StartParseThread());
+            term.QueueWrite(L"Hello");
+            term.QueueWrite(L"\r\nWorld!");
+            term.StopParseThread();
+
+            Log::Comment(L"Stopping the thread parses everything queued before it.");
+            VERIFY_ARE_EQUAL(COORD({ 6, 1 }), term.GetCursorPosition());
+            VERIFY_ARE_EQUAL(std::wstring(L"W"), std::wstring(*term.GetTextBuffer().GetTextDataAt({ 0, 1 })));
+
+            term.QueueWrite(L"more");
+            VERIFY_ARE_EQUAL(COORD({ 6, 1 }), term.GetCursorPosition(), L"Output after that is dropped.");
+        }
+
+        TEST_METHOD(ParseThreadKeepsUpWithRendering)
+        {
+            // Another thread takes the terminal lock as fast as it can, like
+            //      the renderer painting frame after frame, while output comes
+            //      in small pieces. Parsing it on the parse thread has to end
+            //      up where parsing it on the thread it came in on does.
+            const size_t cchPiece = 256;
+            const size_t pieces = 64;
+
+            std::wstring piece;
+            while (piece.size() < cchPiece)
+            {
+                piece.append(L"\x1b[32mThe quick brown fox\x1b[m jumps over the lazy dog\r\n");
+            }
+            piece.resize(cchPiece);
+
+            std::vector<COORD> cursorPositions;
+            for (const bool queued : { false, true })
+            {
+                Terminal term;
+                DummyRenderTarget emptyRT;
+                term.Create({ 120, 30 }, 1000, emptyRT);
+
+                std::atomic<bool> stop{ false };
+                std::thread renderer([&]() {
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        term.LockConsole();
+                        term.GetCursorPosition();
+                        term.UnlockConsole();
+                    }
+                });
+
+                if (queued)
+                {
+                    VERIFY_SUCCEEDED(term.StartParseThread());
+                }
+
+                for (size_t i = 0; i < pieces; i++)
+                {
+                    if (queued)
+                    {
+                        term.QueueWrite(piece);
+                    }
+                    else
+                    {
+                        term.Write(piece);
+                    }
+                }
+
+                // Stopping the thread waits for everything queued to be parsed.
+                term.StopParseThread();
+
+                stop = true;
+                renderer.join();
+
+                cursorPositions.push_back(term.GetCursorPosition());
+            }
+
+            VERIFY_ARE_EQUAL(cursorPositions[0], cursorPositions[1]);
+        }
+
+        // Not a pass/fail test, and too slow for the unit test run. Run it with
+        //      /p:PerfTest=true for the numbers.
+        BEGIN_TEST_METHOD(ParseThroughputWhileRendering)
+            TEST_METHOD_PROPERTY(L"Ignore[@PerfTest=true]", L"false")
+            TEST_METHOD_PROPERTY(L"Ignore[default]", L"true")
+        END_TEST_METHOD()
+    };
+
+    void OutputRingTest::ParseThroughputWhileRendering()
+    {
+        // Another thread takes the terminal lock as fast as it can, like the
+        //      renderer painting frame after frame, while a lot of output comes
+        //      in small pieces. The output is parsed either on the thread it
+        //      came in on, or handed to the parse thread.
+        const size_t cchPiece = 256;
+        const size_t pieces = 16 * 1024;
+
+        std::wstring piece;
+        while (piece.size() < cchPiece)
+        {
+            piece.append(L"\x1b[32mThe quick brown fox\x1b[m jumps over the lazy dog\r\n");
+        }
+        piece.resize(cchPiece);
+
+        for (const bool queued : { false, true })
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 120, 30 }, 1000, emptyRT);
+
+            std::atomic<bool> stop{ false };
+            size_t frames = 0;
+            std::thread renderer([&]() {
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    term.LockConsole();
+                    term.GetCursorPosition();
+                    term.UnlockConsole();
+                    frames++;
+                }
+            });
+
+            if (queued)
+            {
+                VERIFY_SUCCEEDED(term.StartParseThread());
+            }
+
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            LARGE_INTEGER start;
+            LARGE_INTEGER handedOver;
+            LARGE_INTEGER end;
+
+            QueryPerformanceCounter(&start);
+            for (size_t i = 0; i < pieces; i++)
+            {
+                if (queued)
+                {
+                    term.QueueWrite(piece);
+                }
+                else
+                {
+                    term.Write(piece);
+                }
+            }
+            QueryPerformanceCounter(&handedOver);
+
+            // Stopping the thread waits for everything queued to be parsed.
+            term.StopParseThread();
+            QueryPerformanceCounter(&end);
+
+            stop = true;
+            renderer.join();
+
+            const double seconds = static_cast<double>(end.QuadPart - start.QuadPart) / frequency.QuadPart;
+            const double megabytes = static_cast<double>(cchPiece * pieces * sizeof(wchar_t)) / (1024 * 1024);
+            Log::Comment(NoThrowString().Format(L"%s: %.1f MB/s parsed, producer done after %.1f ms of %.1f ms, %zu frames",
+                                                queued ? L"Parse thread" : L"Connection thread",
+                                                megabytes / seconds,
+                                                (handedOver.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart,
+                                                seconds * 1000.0,
+                                                frames));
+        }
+    }
+}
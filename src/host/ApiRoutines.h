@@ -54,29 +54,29 @@ public:
 
     [[nodiscard]]
     HRESULT PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> buffer,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]]
     HRESULT PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> buffer,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]]
     HRESULT ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> buffer,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]]
     HRESULT ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> buffer,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
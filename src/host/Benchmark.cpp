@@ -0,0 +1,2063 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "Benchmark.hpp"
+
+#include "cmdline.h"
+#include "handle.h"
+#include "srvinit.h"
+#include "renderFontDefaults.hpp"
+#include "inputReadHandleData.h"
+#include "search.h"
+#include "VtInputThread.hpp"
+#include "outputStream.hpp" // For ConhostInternalGetSet
+
+#include "..\server\ApiSorter.h"
+#include "..\server\ApiStatistics.h"
+#include "..\server\DeviceComm.h"
+#include "..\server\IoWorkerPool.h"
+#include "..\server\MessageBufferPool.h"
+#include "..\server\WaitQueue.h"
+
+#include "..\interactivity\inc\ServiceLocator.hpp"
+
+#include "../renderer/base/renderer.hpp"
+#include "../renderer/inc/RecordingRenderEngine.hpp"
+#include "../renderer/vt/Xterm256Engine.hpp"
+#include "../renderer/vt/VtSequenceBuilder.hpp"
+#include "../terminal/adapter/InteractDispatch.hpp"
+#include "../terminal/parser/InputStateMachineEngine.hpp"
+#include "../terminal/parser/stateMachine.hpp"
+#include "../types/inc/convert.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+using namespace Microsoft::Console::VirtualTerminal;
+
+// How much each workload does. Fixed, so that runs can be compared.
+static constexpr size_t s_writeCalls = 2048;
+static constexpr size_t s_cchWrite = 4096;
+static constexpr size_t s_narrowShortWrites = 20000;
+static constexpr size_t s_narrowLargeBytes = 1024 * 1024;
+static constexpr size_t s_narrowLargeChunk = 64 * 1024;
+static constexpr size_t s_smallWrites = 1000000;
+static constexpr size_t s_readOutputCalls = 2000;
+static constexpr size_t s_readModifyWriteCycles = 1000;
+static constexpr size_t s_scrollCalls = 2000;
+static constexpr size_t s_inputRounds = 2000;
+static constexpr size_t s_keysPerRound = 32;
+static constexpr size_t s_pasteRounds = 20;
+static constexpr size_t s_pasteEvents = 64 * 1024;
+static constexpr size_t s_pasteReadChunk = 512;
+static constexpr size_t s_vtPasteChars = 1024 * 1024;
+static constexpr size_t s_vtPasteChunk = 4096;
+static constexpr size_t s_conptyInputBytes = 512 * 1024;
+static constexpr size_t s_editLineLength = 2000;
+static constexpr size_t s_editKeystrokes = 200;
+static constexpr size_t s_waitingProcesses = 10;
+static constexpr size_t s_waitingHandles = 100;
+static constexpr size_t s_pendingWaits = 500;
+static constexpr size_t s_waitNotifications = 1000;
+static constexpr size_t s_formatFrames = 20000;
+static constexpr size_t s_paintFrames = 100;
+static constexpr size_t s_scrollFrames = 500;
+static constexpr size_t s_paintChunkChars = 4096;
+static constexpr size_t s_convertChars = 1024 * 1024;
+static constexpr size_t s_convertPasses = 20;
+static constexpr size_t s_copyPasses = 5;
+static constexpr COORD s_searchBufferSize{ 120, 9000 };
+static constexpr COORD s_recolorBufferSize{ 120, 9000 };
+static constexpr size_t s_pooledClients = 8;
+static constexpr size_t s_pooledCallsPerClient = 1000;
+
+// Heap allocations the process made while s_countAllocations was set. The
+//      global operator new below counts them, so they're counted in every
+//      build and on every thread, not just through the debug CRT's hook.
+static std::atomic<bool> s_countAllocations{ false };
+static std::atomic<size_t> s_allocations{ 0 };
+
+void* __cdecl operator new(const size_t size)
+{
+    if (s_countAllocations.load(std::memory_order_relaxed))
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Even an empty allocation has to get a pointer of its own.
+    void* const pv = malloc(size == 0 ? 1 : size);
+    if (pv == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+    return pv;
+}
+
+void __cdecl operator delete(void* const pv) noexcept
+{
+    free(pv);
+}
+
+// Counts the heap allocations made while it's alive. Only one can be alive
+//      at a time.
+class AllocationCounter final
+{
+public:
+    AllocationCounter() noexcept :
+        _start{ s_allocations.load(std::memory_order_relaxed) }
+    {
+        s_countAllocations = true;
+    }
+
+    ~AllocationCounter()
+    {
+        s_countAllocations = false;
+    }
+
+    size_t Count() const noexcept
+    {
+        return s_allocations.load(std::memory_order_relaxed) - _start;
+    }
+
+private:
+    const size_t _start;
+};
+
+// The renderer keeps a pointer to its engines until the process exits, so the
+//      VT engine has to live that long too.
+static std::unique_ptr<Xterm256Engine> s_pVtEngine;
+
+enum class Workload : ULONG
+{
+    WriteText,
+    WriteVt,
+    WriteNarrowShortOem,
+    WriteNarrowShortUtf8,
+    WriteNarrowLargeOem,
+    WriteNarrowLargeUtf8,
+    SmallWriteHeap,
+    SmallWritePooled,
+    ReadOutput,
+    ReadModifyWrite,
+    ScrollFullWidth,
+    ScrollLeftPane,
+    ScrollRightPane,
+    WriteInput,
+    ReadInput,
+    WritePaste,
+    ReadPaste,
+    VtInputPaste,
+    ConptyInputTiny,
+    ConptyInputSmall,
+    ConptyInputLarge,
+    EditKeystroke,
+    EditRedraw,
+    QueueWait,
+    KeyWithWaits,
+    NotifyHandleWaits,
+    NotifyAllWaits,
+    PooledWrite,
+    PooledQuery
+};
+
+// Routine Description:
+// - Makes an API call the way the API dispatchers do, with the console lock
+//   held for just that call. With a render engine attached, the render thread
+//   takes the lock between calls to capture its frames, and how long the call
+//   waited for it shows up in the results.
+// Arguments:
+// - call - The call to make.
+// Return Value:
+// - The result of the call.
+template<typename TCall>
+[[nodiscard]]
+static HRESULT s_LockedCall(const TCall& call)
+{
+    LockConsole();
+    auto unlock = wil::scope_exit([&]() { UnlockConsole(); });
+    return call();
+}
+
+static double s_SecondsSince(const LARGE_INTEGER& begin) noexcept
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return static_cast<double>(now.QuadPart - begin.QuadPart) / frequency.QuadPart;
+}
+
+static void s_Record(ApiStatistics& statistics,
+                     const ApiStatistics::CallStart& start,
+                     const Workload workload,
+                     _In_ PCSTR name,
+                     const size_t bytesIn,
+                     const size_t bytesOut) noexcept
+{
+    statistics.RecordCall(start, 0, static_cast<ULONG>(workload), name, bytesIn, bytesOut);
+}
+
+// Routine Description:
+// - Makes text to write, in lines as wide as the buffer, to size.
+// Arguments:
+// - withVt - true to color every word and move the cursor around now and
+//   then, false for plain text.
+// - width - The width of the buffer.
+// Return Value:
+// - The text.
+static std::wstring s_MakeOutput(const bool withVt, const short width)
+{
+    static constexpr std::wstring_view words[] = { L"lorem", L"ipsum", L"dolor", L"sit", L"amet", L"consectetur" };
+
+    std::wstring text;
+    text.reserve(s_cchWrite);
+
+    size_t word = 0;
+    size_t line = 0;
+    while (text.size() < s_cchWrite)
+    {
+        size_t column = 0;
+        if (withVt && line % 8 == 7)
+        {
+            // Go back up and overwrite part of what was written, like a
+            //      progress display does.
+            text.append(L"\x1b[4A\x1b[10G\x1b[K");
+        }
+
+        while (column + words[word].size() + 1 < static_cast<size_t>(width))
+        {
+            if (withVt)
+            {
+                wchar_t sgr[16];
+                swprintf_s(sgr, L"\x1b[38;5;%zum", 16 + word * 37 % 216);
+                text.append(sgr);
+            }
+            text.append(words[word]);
+            text.push_back(L' ');
+            column += words[word].size() + 1;
+            word = (word + 1) % ARRAYSIZE(words);
+        }
+
+        if (withVt)
+        {
+            text.append(L"\x1b[m");
+        }
+        text.append(L"\r\n");
+        line++;
+    }
+
+    text.resize(s_cchWrite);
+    return text;
+}
+
+[[nodiscard]]
+static HRESULT s_WriteOutput(ApiStatistics& statistics,
+                             SCREEN_INFORMATION& screenInfo,
+                             const bool withVt)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    ULONG originalMode = 0;
+    RETURN_IF_FAILED(s_LockedCall([&]() {
+        api.GetConsoleOutputModeImpl(screenInfo, originalMode);
+        return api.SetConsoleOutputModeImpl(screenInfo, withVt ?
+                                                        originalMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING :
+                                                        originalMode & ~ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }));
+    auto restoreMode = wil::scope_exit([&]() {
+        LOG_IF_FAILED(s_LockedCall([&]() { return api.SetConsoleOutputModeImpl(screenInfo, originalMode); }));
+    });
+
+    const std::wstring text = s_MakeOutput(withVt, screenInfo.GetBufferSize().Width());
+    const Workload workload = withVt ? Workload::WriteVt : Workload::WriteText;
+    PCSTR const name = withVt ? "WriteConsoleW (VT)" : "WriteConsoleW (text)";
+
+    for (size_t call = 0; call < s_writeCalls; call++)
+    {
+        size_t read = 0;
+        std::unique_ptr<IWaitRoutine> waiter;
+
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.WriteConsoleWImpl(screenInfo, text, read, waiter); }));
+        s_Record(statistics, start, workload, name, read * sizeof(wchar_t), 0);
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Writes narrow text with WriteConsoleA, the way most ported Unix tools do,
+//   in both an OEM codepage and UTF-8: many short lines one at a time, then a
+//   megabyte in 64KB writes.
+// Arguments:
+// - statistics - Receives a call record for every API call made.
+// - screenInfo - The buffer to write to.
+// Return Value:
+// - S_OK, or the failure of the API call that failed.
+[[nodiscard]]
+static HRESULT s_WriteNarrowOutput(ApiStatistics& statistics, SCREEN_INFORMATION& screenInfo)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    ULONG originalCodepage = 0;
+    api.GetConsoleOutputCodePageImpl(originalCodepage);
+    auto restoreCodepage = wil::scope_exit([&]() {
+        LOG_IF_FAILED(api.SetConsoleOutputCodePageImpl(originalCodepage));
+    });
+
+    const std::string_view shortLine{ "short line of text\r\n" };
+    std::string largeText;
+    largeText.reserve(s_narrowLargeBytes);
+    while (largeText.size() < s_narrowLargeBytes)
+    {
+        largeText.append("the quick brown fox jumps over the lazy dog 0123456789\r\n");
+    }
+    largeText.resize(s_narrowLargeBytes);
+
+    // A write may leave a trailing partial sequence for the next one, so
+    //      every piece is written until it's all been taken.
+    const auto writeAll = [&](const std::string_view text, const Workload workload, _In_ PCSTR name) {
+        for (size_t offset = 0; offset < text.size();)
+        {
+            size_t read = 0;
+            std::unique_ptr<IWaitRoutine> waiter;
+            const auto start = ApiStatistics::s_BeginCall();
+            RETURN_IF_FAILED(s_LockedCall([&]() { return api.WriteConsoleAImpl(screenInfo, text.substr(offset), read, waiter); }));
+            s_Record(statistics, start, workload, name, read, 0);
+
+            RETURN_HR_IF(E_UNEXPECTED, read == 0);
+            offset += read;
+        }
+        return S_OK;
+    };
+
+    static constexpr struct
+    {
+        UINT codepage;
+        Workload shortWorkload;
+        PCSTR shortName;
+        Workload largeWorkload;
+        PCSTR largeName;
+    } codepages[] = {
+        { 437, Workload::WriteNarrowShortOem, "WriteConsoleA (437)", Workload::WriteNarrowLargeOem, "WriteConsoleA 64K (437)" },
+        { CP_UTF8, Workload::WriteNarrowShortUtf8, "WriteConsoleA (UTF-8)", Workload::WriteNarrowLargeUtf8, "WriteConsoleA 64K (UTF-8)" },
+    };
+
+    for (const auto& codepage : codepages)
+    {
+        RETURN_IF_FAILED(api.SetConsoleOutputCodePageImpl(codepage.codepage));
+
+        for (size_t call = 0; call < s_narrowShortWrites; call++)
+        {
+            RETURN_IF_FAILED(writeAll(shortLine, codepage.shortWorkload, codepage.shortName));
+        }
+
+        for (size_t offset = 0; offset < largeText.size(); offset += s_narrowLargeChunk)
+        {
+            RETURN_IF_FAILED(writeAll(std::string_view{ largeText }.substr(offset, s_narrowLargeChunk), codepage.largeWorkload, codepage.largeName));
+        }
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Makes a million tiny WriteConsoleW calls the way the server dispatches
+//   them, payload buffer and all: once with a payload from the heap for every
+//   message, like the server used to, and once with payloads from the
+//   MessageBufferPool.
+// Arguments:
+// - statistics - Receives a call record for every API call made.
+// - screenInfo - The buffer to write to.
+// - notes - Receives the calls per second and payload allocations per call.
+// Return Value:
+// - S_OK, or the failure of the API call that failed.
+[[nodiscard]]
+static HRESULT s_SmallWrites(ApiStatistics& statistics, SCREEN_INFORMATION& screenInfo, std::string& notes)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    const std::wstring_view text{ L"ok\r\n" };
+    const ULONG cbText = gsl::narrow<ULONG>(text.size() * sizeof(wchar_t));
+
+    const auto dispatch = [&](BYTE* const payload, const Workload workload, _In_ PCSTR name) {
+        RETURN_IF_NULL_ALLOC(payload);
+
+        // This stands in for reading the payload from the driver.
+        memcpy(payload, text.data(), cbText);
+
+        const std::wstring_view buffer{ reinterpret_cast<const wchar_t*>(payload), text.size() };
+        size_t read = 0;
+        std::unique_ptr<IWaitRoutine> waiter;
+
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.WriteConsoleWImpl(screenInfo, buffer, read, waiter); }));
+        s_Record(statistics, start, workload, name, read * sizeof(wchar_t), 0);
+        return S_OK;
+    };
+
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+    for (size_t call = 0; call < s_smallWrites; call++)
+    {
+        auto payload = wil::make_unique_nothrow<BYTE[]>(cbText);
+        RETURN_IF_FAILED(dispatch(payload.get(), Workload::SmallWriteHeap, "WriteConsoleW 8B (heap)"));
+    }
+    const double heapSeconds = s_SecondsSince(begin);
+
+    auto& pool = MessageBufferPool::Instance();
+    const auto before = pool.GetStatistics();
+
+    QueryPerformanceCounter(&begin);
+    for (size_t call = 0; call < s_smallWrites; call++)
+    {
+        BYTE* const payload = pool.Acquire(cbText);
+        auto release = wil::scope_exit([&]() { pool.Release(payload, cbText); });
+        RETURN_IF_FAILED(dispatch(payload, Workload::SmallWritePooled, "WriteConsoleW 8B (pooled)"));
+    }
+    const double poolSeconds = s_SecondsSince(begin);
+
+    const auto after = pool.GetStatistics();
+
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "%zu small writes: %.0f calls/s with heap payloads (1 allocation per call), %.0f calls/s pooled (%.6f allocations per call)\r\n",
+              s_smallWrites,
+              s_smallWrites / heapSeconds,
+              s_smallWrites / poolSeconds,
+              static_cast<double>(after.allocated - before.allocated) / (after.acquired - before.acquired));
+    notes.append(line);
+    return S_OK;
+}
+
+[[nodiscard]]
+static HRESULT s_ReadOutput(ApiStatistics& statistics, const SCREEN_INFORMATION& screenInfo)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    const Viewport viewport = screenInfo.GetViewport();
+    std::vector<CHAR_INFO> buffer(static_cast<size_t>(viewport.Width()) * viewport.Height());
+
+    for (size_t call = 0; call < s_readOutputCalls; call++)
+    {
+        Viewport readRectangle = Viewport::Empty();
+
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.ReadConsoleOutputWImpl(screenInfo, buffer, viewport, readRectangle); }));
+        s_Record(statistics, start, Workload::ReadOutput, "ReadConsoleOutputW", 0, readRectangle.Width() * readRectangle.Height() * sizeof(CHAR_INFO));
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Reads the whole window with ReadConsoleOutputW, changes every cell and
+//   writes it back with WriteConsoleOutputW, like a full screen app that
+//   redraws its window with CHAR_INFOs every frame. Each cycle is recorded as
+//   one call.
+// Arguments:
+// - statistics - Receives a call record for every cycle.
+// - screenInfo - The buffer to read and write.
+// - notes - Receives the cycles per second.
+// Return Value:
+// - S_OK, or the failure of the API call that failed.
+[[nodiscard]]
+static HRESULT s_ReadModifyWriteOutput(ApiStatistics& statistics,
+                                       SCREEN_INFORMATION& screenInfo,
+                                       std::string& notes)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    const Viewport viewport = screenInfo.GetViewport();
+    std::vector<CHAR_INFO> cells(static_cast<size_t>(viewport.Width()) * viewport.Height());
+
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+
+    for (size_t cycle = 0; cycle < s_readModifyWriteCycles; cycle++)
+    {
+        Viewport readRectangle = Viewport::Empty();
+        Viewport writtenRectangle = Viewport::Empty();
+
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.ReadConsoleOutputWImpl(screenInfo, cells, viewport, readRectangle); }));
+
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            cells[i].Char.UnicodeChar = static_cast<wchar_t>(L'A' + (i + cycle) % 26);
+            cells[i].Attributes = static_cast<WORD>((i / 8 + cycle) % 16);
+        }
+
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.WriteConsoleOutputWImpl(screenInfo, cells, viewport, writtenRectangle); }));
+        s_Record(statistics,
+                 start,
+                 Workload::ReadModifyWrite,
+                 "Read-modify-write cycle",
+                 writtenRectangle.Width() * writtenRectangle.Height() * sizeof(CHAR_INFO),
+                 readRectangle.Width() * readRectangle.Height() * sizeof(CHAR_INFO));
+    }
+
+    const double seconds = s_SecondsSince(begin);
+
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "Read-modify-write of %dx%d cells: %.0f cycles/s\r\n",
+              viewport.Width(),
+              viewport.Height(),
+              seconds > 0 ? s_readModifyWriteCycles / seconds : 0.0);
+    notes.append(line);
+    return S_OK;
+}
+
+// Routine Description:
+// - Scrolls the window up a line at a time with ScrollConsoleScreenBufferW:
+//   across its whole width, and within the left or the right half of it like
+//   side by side panes do (a split-pane editor, or tmux with a vertical split).
+//   The panes are clipped to themselves, so the other half is left alone.
+// Arguments:
+// - statistics - Receives a call record for every API call made.
+// - screenInfo - The buffer to scroll.
+// - notes - Receives the microseconds per scroll of each shape.
+// Return Value:
+// - S_OK, or the failure of the API call that failed.
+[[nodiscard]]
+static HRESULT s_ScrollPanes(ApiStatistics& statistics, SCREEN_INFORMATION& screenInfo, std::string& notes)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    const SMALL_RECT window = screenInfo.GetViewport().ToInclusive();
+    const SHORT middle = window.Left + (window.Right - window.Left + 1) / 2;
+
+    const struct
+    {
+        SMALL_RECT pane;
+        Workload workload;
+        PCSTR name;
+    } panes[] = {
+        { window, Workload::ScrollFullWidth, "Scroll full width" },
+        { { window.Left, window.Top, gsl::narrow<SHORT>(middle - 1), window.Bottom }, Workload::ScrollLeftPane, "Scroll left pane" },
+        { { gsl::narrow<SHORT>(middle + 1), window.Top, window.Right, window.Bottom }, Workload::ScrollRightPane, "Scroll right pane" },
+    };
+
+    double seconds[ARRAYSIZE(panes)]{};
+    for (size_t i = 0; i < ARRAYSIZE(panes); i++)
+    {
+        const auto& pane = panes[i];
+        SMALL_RECT source = pane.pane;
+        source.Top++;
+        const COORD target{ pane.pane.Left, pane.pane.Top };
+        const size_t cells = static_cast<size_t>(source.Right - source.Left + 1) * (source.Bottom - source.Top + 1);
+
+        LARGE_INTEGER begin;
+        QueryPerformanceCounter(&begin);
+        for (size_t call = 0; call < s_scrollCalls; call++)
+        {
+            const auto start = ApiStatistics::s_BeginCall();
+            RETURN_IF_FAILED(s_LockedCall([&]() {
+                return api.ScrollConsoleScreenBufferWImpl(screenInfo, source, target, pane.pane, L' ', FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+            }));
+            s_Record(statistics, start, pane.workload, pane.name, 0, cells * sizeof(CHAR_INFO));
+        }
+        seconds[i] = s_SecondsSince(begin);
+    }
+
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "Scrolling a %dx%d window a line: %.1f us full width, %.1f us left pane, %.1f us right pane\r\n",
+              window.Right - window.Left + 1,
+              window.Bottom - window.Top + 1,
+              seconds[0] * 1000000 / s_scrollCalls,
+              seconds[1] * 1000000 / s_scrollCalls,
+              seconds[2] * 1000000 / s_scrollCalls);
+    notes.append(line);
+    return S_OK;
+}
+
+[[nodiscard]]
+static HRESULT s_WriteAndReadInput(ApiStatistics& statistics, InputBuffer& inputBuffer)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    // Typing: a key down and a key up for every letter.
+    std::vector<INPUT_RECORD> records;
+    for (size_t key = 0; key < s_keysPerRound; key++)
+    {
+        INPUT_RECORD record{};
+        record.EventType = KEY_EVENT;
+        record.Event.KeyEvent.wRepeatCount = 1;
+        record.Event.KeyEvent.wVirtualKeyCode = static_cast<WORD>('A' + key % 26);
+        record.Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(L'a' + key % 26);
+
+        record.Event.KeyEvent.bKeyDown = TRUE;
+        records.push_back(record);
+        record.Event.KeyEvent.bKeyDown = FALSE;
+        records.push_back(record);
+    }
+
+    INPUT_READ_HANDLE_DATA readHandleState;
+    std::vector<INPUT_RECORD> readRecords(records.size());
+    for (size_t round = 0; round < s_inputRounds; round++)
+    {
+        size_t written = 0;
+        auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.WriteConsoleInputWImpl(inputBuffer, { records.data(), records.size() }, written, true); }));
+        s_Record(statistics, start, Workload::WriteInput, "WriteConsoleInputW", written * sizeof(INPUT_RECORD), 0);
+
+        size_t read = 0;
+        std::unique_ptr<IWaitRoutine> waiter;
+        start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.ReadConsoleInputWImpl(inputBuffer, readRecords, read, readHandleState, waiter); }));
+        s_Record(statistics, start, Workload::ReadInput, "ReadConsoleInputW", 0, read * sizeof(INPUT_RECORD));
+
+        RETURN_HR_IF(E_UNEXPECTED, read != records.size());
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Writes a paste's worth of key events to the input buffer in one call and
+//   reads them back a chunk at a time, like a shell draining a large paste.
+// Arguments:
+// - statistics - Receives a call record for every API call made.
+// - inputBuffer - The input buffer to write to and read from.
+// - notes - Receives the events per second.
+// Return Value:
+// - S_OK, or the failure of the API call that failed.
+[[nodiscard]]
+static HRESULT s_PasteSizedInput(ApiStatistics& statistics, InputBuffer& inputBuffer, std::string& notes)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    static constexpr std::wstring_view pasteLine{ L"    for (size_t i = 0; i < count; ++i) // ====\r\n" };
+
+    std::vector<INPUT_RECORD> records;
+    records.reserve(s_pasteEvents);
+    for (size_t i = 0; records.size() < s_pasteEvents; i++)
+    {
+        const wchar_t wch = pasteLine[i % pasteLine.size()];
+
+        INPUT_RECORD record{};
+        record.EventType = KEY_EVENT;
+        record.Event.KeyEvent.wRepeatCount = 1;
+        record.Event.KeyEvent.wVirtualKeyCode = LOBYTE(VkKeyScanW(wch));
+        record.Event.KeyEvent.uChar.UnicodeChar = wch;
+
+        record.Event.KeyEvent.bKeyDown = TRUE;
+        records.push_back(record);
+        record.Event.KeyEvent.bKeyDown = FALSE;
+        records.push_back(record);
+    }
+
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+
+    INPUT_READ_HANDLE_DATA readHandleState;
+    std::vector<INPUT_RECORD> readRecords(s_pasteReadChunk);
+    for (size_t round = 0; round < s_pasteRounds; round++)
+    {
+        size_t written = 0;
+        auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.WriteConsoleInputWImpl(inputBuffer, { records.data(), records.size() }, written, true); }));
+        s_Record(statistics, start, Workload::WritePaste, "WriteConsoleInputW (64K)", written * sizeof(INPUT_RECORD), 0);
+
+        for (size_t remaining = written; remaining > 0;)
+        {
+            size_t read = 0;
+            std::unique_ptr<IWaitRoutine> waiter;
+            start = ApiStatistics::s_BeginCall();
+            RETURN_IF_FAILED(s_LockedCall([&]() { return api.ReadConsoleInputWImpl(inputBuffer, readRecords, read, readHandleState, waiter); }));
+            s_Record(statistics, start, Workload::ReadPaste, "ReadConsoleInputW (512)", 0, read * sizeof(INPUT_RECORD));
+
+            RETURN_HR_IF(E_UNEXPECTED, read == 0 || read > remaining);
+            remaining -= read;
+        }
+    }
+
+    const double seconds = s_SecondsSince(begin);
+
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "Paste of %zu events, read %zu at a time: %.1f million events/s\r\n",
+              records.size(),
+              s_pasteReadChunk,
+              seconds > 0 ? s_pasteRounds * records.size() / seconds / 1000000 : 0.0);
+    notes.append(line);
+    return S_OK;
+}
+
+// Routine Description:
+// - Types a paste that arrives over conpty input into the input buffer, in the
+//   chunks the VT input thread hands to its state machine, then throws it away
+//   like a shell that was too busy to read it.
+// Arguments:
+// - statistics - Receives a call record for every chunk.
+// - inputBuffer - The input buffer the paste is typed into.
+// - notes - Receives the characters per second.
+// Return Value:
+// - S_OK, or the failure of the call that failed.
+[[nodiscard]]
+static HRESULT s_ChunkedVtInput(ApiStatistics& statistics, InputBuffer& inputBuffer, std::string& notes)
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    // Set up like VtInputThread does.
+    auto pGetSet = std::make_unique<ConhostInternalGetSet>(gci);
+    auto engine = std::make_unique<InputStateMachineEngine>(new InteractDispatch(pGetSet.release()));
+    StateMachine stateMachine{ engine.release() };
+
+    static constexpr std::wstring_view pasteLine{ L"    for (size_t i = 0; i < count; ++i) // ====\r\n" };
+    std::wstring paste;
+    paste.reserve(s_vtPasteChars + pasteLine.size());
+    while (paste.size() < s_vtPasteChars)
+    {
+        paste.append(pasteLine);
+    }
+    paste.resize(s_vtPasteChars);
+
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+
+    for (size_t offset = 0; offset < paste.size(); offset += s_vtPasteChunk)
+    {
+        const std::wstring_view chunk = std::wstring_view{ paste }.substr(offset, s_vtPasteChunk);
+
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() {
+            stateMachine.ProcessString(chunk.data(), chunk.size());
+            return S_OK;
+        }));
+        s_Record(statistics, start, Workload::VtInputPaste, "VT input (4096 chars)", chunk.size() * sizeof(wchar_t), 0);
+    }
+
+    const double seconds = s_SecondsSince(begin);
+
+    const size_t events = inputBuffer.GetNumberOfReadyEvents();
+    RETURN_IF_FAILED(s_LockedCall([&]() {
+        api.FlushConsoleInputBuffer(inputBuffer);
+        return S_OK;
+    }));
+
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "VT input paste of %zu chars in %zu char chunks: %zu events, %.1f million chars/s\r\n",
+              paste.size(),
+              s_vtPasteChunk,
+              events,
+              seconds > 0 ? paste.size() / seconds / 1000000 : 0.0);
+    notes.append(line);
+    return S_OK;
+}
+
+// Routine Description:
+// - Types a 2000 character line into a cooked read, the way cmd.exe reads its
+//   command line, moves to the middle of it and types and deletes there one
+//   key at a time. Each keystroke is written to the input buffer and handed to
+//   the read like the wait queue would, and recorded as one call.
+// - For comparison, the whole line is then erased and redrawn as many times.
+// Arguments:
+// - statistics - Receives a call record for every keystroke and redraw.
+// - inputBuffer - The input buffer to type into.
+// - notes - Receives the microseconds per keystroke and per redraw.
+// Return Value:
+// - S_OK, or the failure of the call that failed.
+[[nodiscard]]
+static HRESULT s_EditLongLine(ApiStatistics& statistics, InputBuffer& inputBuffer, std::string& notes)
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    ULONG originalMode = 0;
+    RETURN_IF_FAILED(s_LockedCall([&]() {
+        api.GetConsoleInputModeImpl(inputBuffer, originalMode);
+        return api.SetConsoleInputModeImpl(inputBuffer, ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT | ENABLE_PROCESSED_INPUT | ENABLE_INSERT_MODE | ENABLE_EXTENDED_FLAGS);
+    }));
+    auto restoreMode = wil::scope_exit([&]() {
+        LOG_IF_FAILED(s_LockedCall([&]() { return api.SetConsoleInputModeImpl(inputBuffer, originalMode); }));
+    });
+
+    const auto type = [&](const WORD virtualKey, const wchar_t wch, const size_t count) {
+        std::vector<INPUT_RECORD> records;
+        for (size_t i = 0; i < count; i++)
+        {
+            INPUT_RECORD record{};
+            record.EventType = KEY_EVENT;
+            record.Event.KeyEvent.wRepeatCount = 1;
+            record.Event.KeyEvent.wVirtualKeyCode = virtualKey;
+            record.Event.KeyEvent.uChar.UnicodeChar = wch;
+
+            record.Event.KeyEvent.bKeyDown = TRUE;
+            records.push_back(record);
+            record.Event.KeyEvent.bKeyDown = FALSE;
+            records.push_back(record);
+        }
+
+        size_t written = 0;
+        return s_LockedCall([&]() { return api.WriteConsoleInputWImpl(inputBuffer, { records.data(), records.size() }, written, true); });
+    };
+
+    // Start the read with the line already typed, so it has to wait for the rest.
+    std::wstring line;
+    for (size_t i = 0; i < s_editLineLength; i++)
+    {
+        line.push_back(static_cast<wchar_t>(L'a' + i % 26));
+    }
+    for (const auto wch : line)
+    {
+        RETURN_IF_FAILED(type(LOBYTE(VkKeyScanW(wch)), wch, 1));
+    }
+
+    std::vector<wchar_t> userBuffer(s_editLineLength * 2);
+    INPUT_READ_HANDLE_DATA readHandleState;
+    std::unique_ptr<IWaitRoutine> waiter;
+    size_t written = 0;
+    DWORD controlKeyState = 0;
+    RETURN_IF_FAILED(api.ReadConsoleWImpl(inputBuffer,
+                                          { reinterpret_cast<char*>(userBuffer.data()), userBuffer.size() * sizeof(wchar_t) },
+                                          written,
+                                          waiter,
+                                          {},
+                                          L"conhost.exe",
+                                          readHandleState,
+                                          nullptr,
+                                          0,
+                                          controlKeyState));
+    RETURN_HR_IF_NULL(E_UNEXPECTED, waiter.get());
+    auto abandonRead = wil::scope_exit([&]() {
+        if (waiter)
+        {
+            gci.SetCookedReadData(nullptr);
+        }
+    });
+
+    const auto notify = [&]() {
+        return s_LockedCall([&]() {
+            NTSTATUS status = STATUS_SUCCESS;
+            size_t numBytes = 0;
+            DWORD keyState = 0;
+            if (waiter->Notify(WaitTerminationReason::NoReason, true, &status, &numBytes, &keyState, nullptr))
+            {
+                waiter.reset();
+            }
+            return HRESULT_FROM_NT(status);
+        });
+    };
+
+    RETURN_IF_FAILED(type(VK_LEFT, UNICODE_NULL, s_editLineLength / 2));
+    RETURN_IF_FAILED(notify());
+
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+    for (size_t keystroke = 0; keystroke < s_editKeystrokes && waiter; keystroke++)
+    {
+        const bool typing = keystroke < s_editKeystrokes / 2;
+
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(typing ? type('3', L'#', 1) : type(VK_BACK, UNICODE_BACKSPACE, 1));
+        RETURN_IF_FAILED(notify());
+        s_Record(statistics, start, Workload::EditKeystroke, "Keystroke (2000 chars)", 2 * sizeof(INPUT_RECORD), 0);
+    }
+    const double keystrokeSeconds = s_SecondsSince(begin);
+    RETURN_HR_IF_NULL(E_UNEXPECTED, waiter.get());
+
+    QueryPerformanceCounter(&begin);
+    for (size_t redraw = 0; redraw < s_editKeystrokes; redraw++)
+    {
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() {
+            DeleteCommandLine(gci.CookedReadData(), false);
+            RedrawCommandLine(gci.CookedReadData());
+            return S_OK;
+        }));
+        s_Record(statistics, start, Workload::EditRedraw, "Line redraw (2000 chars)", 0, 0);
+    }
+    const double redrawSeconds = s_SecondsSince(begin);
+
+    // Finish the line, so the read completes and lets go of the buffers.
+    RETURN_IF_FAILED(type(VK_RETURN, UNICODE_CARRIAGERETURN, 1));
+    RETURN_IF_FAILED(notify());
+    RETURN_HR_IF(E_UNEXPECTED, waiter != nullptr);
+
+    char text[256];
+    sprintf_s(text,
+              ARRAYSIZE(text),
+              "Editing the middle of a %zu char line: %.1f us per keystroke, %.1f us per full line redraw\r\n",
+              s_editLineLength,
+              keystrokeSeconds * 1000000 / s_editKeystrokes,
+              redrawSeconds * 1000000 / s_editKeystrokes);
+    notes.append(text);
+    return S_OK;
+}
+
+// Routine Description:
+// - Another thread writes input into a pipe in small pieces, like a terminal
+//   forwarding a paste over conpty, while a VtInputThread reads it the way it
+//   does in a conpty session, for the throughput and how often the console
+//   lock is taken per megabyte. Each read is recorded as one call.
+// Arguments:
+// - statistics - Receives a call record for every read.
+// - inputBuffer - The input buffer the reads end up in.
+// - notes - Receives the MB/s and lock acquisitions per MB for each write size.
+// Return Value:
+// - S_OK, or the failure of the call that failed.
+[[nodiscard]]
+static HRESULT s_ConptyInput(ApiStatistics& statistics, InputBuffer& inputBuffer, std::string& notes)
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    std::string input;
+    input.reserve(s_conptyInputBytes);
+    for (size_t i = 0; i < s_conptyInputBytes; i++)
+    {
+        input.push_back(static_cast<char>('a' + i % 26));
+    }
+
+    static constexpr struct
+    {
+        size_t cbWrite;
+        Workload workload;
+        PCSTR name;
+    } writeSizes[] = {
+        { 16, Workload::ConptyInputTiny, "Conpty input (16B writes)" },
+        { 256, Workload::ConptyInputSmall, "Conpty input (256B writes)" },
+        { 4096, Workload::ConptyInputLarge, "Conpty input (4K writes)" },
+    };
+
+    for (const auto& writeSize : writeSizes)
+    {
+        wil::unique_hfile readPipe;
+        wil::unique_hfile writePipe;
+        RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&readPipe, &writePipe, nullptr, 64 * 1024));
+
+        VtInputThread thread(std::move(readPipe), false);
+
+        // Every letter is a key down and a key up.
+        const size_t expectedEvents = 2 * input.size();
+        const auto before = gci.GetLockStatistics();
+        size_t reads = 0;
+        std::atomic<bool> writerDone{ false };
+
+        LARGE_INTEGER begin;
+        QueryPerformanceCounter(&begin);
+
+        std::thread writer([&]() {
+            for (size_t offset = 0; offset < input.size(); offset += writeSize.cbWrite)
+            {
+                DWORD cbWritten = 0;
+                const DWORD cb = gsl::narrow<DWORD>(std::min(writeSize.cbWrite, input.size() - offset));
+                if (!WriteFile(writePipe.get(), input.data() + offset, cb, &cbWritten, nullptr))
+                {
+                    LOG_LAST_ERROR();
+                    break;
+                }
+            }
+            writePipe.reset();
+            writerDone = true;
+        });
+
+        // Only returns early once the writer has given up, so this can't wait
+        //      on a writer that's blocked on a full pipe.
+        auto joinWriter = wil::scope_exit([&]() { writer.join(); });
+
+        size_t events = inputBuffer.GetNumberOfReadyEvents();
+        while (events < expectedEvents)
+        {
+            const auto start = ApiStatistics::s_BeginCall();
+            thread.DoReadInput(false);
+            const size_t eventsAfter = inputBuffer.GetNumberOfReadyEvents();
+            s_Record(statistics, start, writeSize.workload, writeSize.name, (eventsAfter - events) / 2, 0);
+
+            RETURN_HR_IF(E_UNEXPECTED, eventsAfter == events && writerDone);
+            events = eventsAfter;
+            reads++;
+        }
+
+        const double seconds = s_SecondsSince(begin);
+        const auto after = gci.GetLockStatistics();
+        joinWriter.reset();
+
+        RETURN_IF_FAILED(s_LockedCall([&]() {
+            api.FlushConsoleInputBuffer(inputBuffer);
+            return S_OK;
+        }));
+
+        const double megabytes = static_cast<double>(input.size()) / (1024 * 1024);
+        char line[256];
+        sprintf_s(line,
+                  ARRAYSIZE(line),
+                  "Conpty input in %zu byte writes: %.1f MB/s, %.0f lock acquisitions per MB, %.0f reads per MB\r\n",
+                  writeSize.cbWrite,
+                  megabytes / seconds,
+                  (after.exclusiveAcquisitions - before.exclusiveAcquisitions) / megabytes,
+                  reads / megabytes);
+        notes.append(line);
+    }
+
+    return S_OK;
+}
+
+// A read that's never satisfied by new data, so it stays queued until its
+//      handle closes or its process goes away.
+class PendingRead final : public IWaitRoutine
+{
+public:
+    PendingRead() :
+        IWaitRoutine(ReplyDataType::Read)
+    {
+    }
+
+    bool Notify(const WaitTerminationReason TerminationReason,
+                const bool /*fIsUnicode*/,
+                _Out_ NTSTATUS* const pReplyStatus,
+                _Out_ size_t* const pNumBytes,
+                _Out_ DWORD* const pControlKeyState,
+                _Out_ void* const /*pOutputData*/) override
+    {
+        *pReplyStatus = STATUS_THREAD_IS_TERMINATING;
+        *pNumBytes = 0;
+        *pControlKeyState = 0;
+        return TerminationReason != WaitTerminationReason::NoReason;
+    }
+};
+
+// Routine Description:
+// - Queues hundreds of reads on the input buffer, through a hundred handles of
+//   ten processes, like a build fanning out to many attached processes that
+//   all wait for input. Then types with all of them pending, and notifies the
+//   waits of one handle at a time, like closing a handle does, next to
+//   notifying every wait, like closing one used to.
+// - The processes and handles are made up, so there's no driver to complete
+//   the waits to. Completions go to NUL instead.
+// Arguments:
+// - statistics - Receives a call record for every wait, key and notification.
+// - inputBuffer - The input buffer to wait on.
+// - notes - Receives the microseconds per key and per notification.
+// Return Value:
+// - S_OK, or the failure of the call that failed.
+[[nodiscard]]
+static HRESULT s_PendingWaits(ApiStatistics& statistics, InputBuffer& inputBuffer, std::string& notes)
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+    ApiRoutines& api = g.api;
+
+    std::unique_ptr<DeviceComm> nullDeviceComm;
+    if (g.pDeviceComm == nullptr)
+    {
+        wil::unique_hfile nullSink{ CreateFileW(L"NUL", GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        RETURN_LAST_ERROR_IF(!nullSink);
+        nullDeviceComm = std::make_unique<DeviceComm>(nullSink.release());
+        g.pDeviceComm = nullDeviceComm.get();
+    }
+    auto restoreDeviceComm = wil::scope_exit([&]() {
+        if (nullDeviceComm)
+        {
+            g.pDeviceComm = nullptr;
+        }
+    });
+
+    std::vector<ConsoleProcessHandle*> processes;
+    std::vector<std::unique_ptr<ConsoleHandleData>> handles(s_waitingHandles);
+
+    // Closing the handles ends their waits, and the processes go after them.
+    auto cleanup = wil::scope_exit([&]() {
+        LOG_IF_FAILED(s_LockedCall([&]() {
+            for (auto& handle : handles)
+            {
+                if (handle)
+                {
+                    inputBuffer.WaitQueue.NotifyHandleWaiters(handle.get(), WaitTerminationReason::HandleClosing);
+                    handle.reset();
+                }
+            }
+            for (const auto pProcess : processes)
+            {
+                gci.ProcessHandleList.FreeProcessData(pProcess);
+            }
+            api.FlushConsoleInputBuffer(inputBuffer);
+            return S_OK;
+        }));
+    });
+
+    RETURN_IF_FAILED(s_LockedCall([&]() {
+        // Process IDs are multiples of four, so these can't clash with a real one.
+        for (DWORD process = 0; process < s_waitingProcesses; process++)
+        {
+            ConsoleProcessHandle* pProcess = nullptr;
+            RETURN_IF_FAILED(gci.ProcessHandleList.AllocProcessData(0xFFFF0001 + process * 4, 0, 0, nullptr, &pProcess));
+            processes.push_back(pProcess);
+        }
+        for (auto& handle : handles)
+        {
+            RETURN_IF_FAILED(inputBuffer.AllocateIoHandle(ConsoleHandleData::HandleType::Input,
+                                                          GENERIC_READ | GENERIC_WRITE,
+                                                          FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                                          handle));
+        }
+        return S_OK;
+    }));
+
+    for (size_t wait = 0; wait < s_pendingWaits; wait++)
+    {
+        CONSOLE_API_MSG message{};
+        message.msgHeader.ApiNumber = API_NUMBER_READCONSOLE;
+        message.Descriptor.Process = reinterpret_cast<ULONG_PTR>(processes[wait % processes.size()]);
+        message.Descriptor.Object = reinterpret_cast<ULONG_PTR>(handles[wait % handles.size()].get());
+
+        auto waiter = std::make_unique<PendingRead>();
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(ConsoleWaitQueue::s_CreateWait(&message, waiter.get()));
+        s_Record(statistics, start, Workload::QueueWait, "Queue a wait", 0, 0);
+        waiter.release();
+    }
+    RETURN_HR_IF(E_UNEXPECTED, inputBuffer.WaitQueue.GetWaitCount() != s_pendingWaits);
+
+    INPUT_RECORD key{};
+    key.EventType = KEY_EVENT;
+    key.Event.KeyEvent.bKeyDown = TRUE;
+    key.Event.KeyEvent.wRepeatCount = 1;
+    key.Event.KeyEvent.wVirtualKeyCode = 'A';
+    key.Event.KeyEvent.uChar.UnicodeChar = L'a';
+
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+    for (size_t call = 0; call < s_waitNotifications; call++)
+    {
+        size_t written = 0;
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() { return api.WriteConsoleInputWImpl(inputBuffer, { &key, 1 }, written, true); }));
+        s_Record(statistics, start, Workload::KeyWithWaits, "Key with 500 waits", sizeof(key), 0);
+    }
+    const double keySeconds = s_SecondsSince(begin);
+
+    QueryPerformanceCounter(&begin);
+    for (size_t call = 0; call < s_waitNotifications; call++)
+    {
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() {
+            inputBuffer.WaitQueue.NotifyHandleWaiters(handles[call % handles.size()].get(), WaitTerminationReason::NoReason);
+            return S_OK;
+        }));
+        s_Record(statistics, start, Workload::NotifyHandleWaits, "Notify a handle's waits", 0, 0);
+    }
+    const double handleSeconds = s_SecondsSince(begin);
+
+    QueryPerformanceCounter(&begin);
+    for (size_t call = 0; call < s_waitNotifications; call++)
+    {
+        const auto start = ApiStatistics::s_BeginCall();
+        RETURN_IF_FAILED(s_LockedCall([&]() {
+            inputBuffer.WaitQueue.NotifyWaiters(true);
+            return S_OK;
+        }));
+        s_Record(statistics, start, Workload::NotifyAllWaits, "Notify all 500 waits", 0, 0);
+    }
+    const double allSeconds = s_SecondsSince(begin);
+
+    RETURN_HR_IF(E_UNEXPECTED, inputBuffer.WaitQueue.GetWaitCount() != s_pendingWaits);
+
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "%zu pending waits: %.2f us per key, %.2f us to notify a handle's %zu, %.2f us to notify all\r\n",
+              s_pendingWaits,
+              keySeconds * 1000000 / s_waitNotifications,
+              handleSeconds * 1000000 / s_waitNotifications,
+              s_pendingWaits / s_waitingHandles,
+              allSeconds * 1000000 / s_waitNotifications);
+    notes.append(line);
+    return S_OK;
+}
+
+// Routine Description:
+// - Several clients call in at once and are serviced on an IoWorkerPool, the
+//   way ConsoleIoThread services them when there's more than one processor.
+//   Half of them write build output, the other half poll the buffer info like
+//   a progress display would.
+// - Every call is recorded on the worker that serviced it. The wall clock time
+//   for all of them gives the aggregate rate.
+// Arguments:
+// - statistics - Receives a call record for every API call made.
+// - screenInfo - The buffer to write to and query.
+// - notes - Receives the aggregate rate.
+// Return Value:
+// - S_OK, or the failure of the first API call that failed.
+[[nodiscard]]
+static HRESULT s_PooledClients(ApiStatistics& statistics,
+                               SCREEN_INFORMATION& screenInfo,
+                               std::string& notes)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    const std::wstring_view buildOutput{ L"[client] Compiling src\\host\\consoleInformation.cpp ... ok\r\n" };
+    const size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4);
+    std::atomic<HRESULT> result{ S_OK };
+
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+
+    {
+        // The pool never looks past the descriptor, so the client is all
+        //      that's filled in.
+        IoWorkerPool pool(workerCount, [&](CONSOLE_API_MSG* const pMsg) {
+            HRESULT hr = S_OK;
+            const auto start = ApiStatistics::s_BeginCall();
+            if (pMsg->Descriptor.Process % 2)
+            {
+                // The query takes the lock shared on its own, like it does
+                //      for a client.
+                CONSOLE_SCREEN_BUFFER_INFOEX info{ sizeof(info) };
+                api.GetConsoleScreenBufferInfoExImpl(screenInfo, info);
+                s_Record(statistics, start, Workload::PooledQuery, "GetBufferInfo (pooled)", 0, sizeof(info));
+            }
+            else
+            {
+                size_t read = 0;
+                std::unique_ptr<IWaitRoutine> waiter;
+                hr = s_LockedCall([&]() { return api.WriteConsoleWImpl(screenInfo, buildOutput, read, waiter); });
+                s_Record(statistics, start, Workload::PooledWrite, "WriteConsoleW (pooled)", read * sizeof(wchar_t), 0);
+            }
+
+            HRESULT noFailureYet = S_OK;
+            if (FAILED(hr))
+            {
+                result.compare_exchange_strong(noFailureYet, hr);
+            }
+        });
+
+        for (size_t call = 0; call < s_pooledCallsPerClient; call++)
+        {
+            for (ULONG_PTR client = 0; client < s_pooledClients; client++)
+            {
+                CONSOLE_API_MSG* const pMsg = pool.AcquireMessage();
+                pMsg->Descriptor.Function = CONSOLE_IO_USER_DEFINED;
+                pMsg->Descriptor.Process = client;
+                pool.Dispatch(pMsg);
+            }
+        }
+        pool.Drain();
+    }
+
+    const double seconds = s_SecondsSince(begin);
+    RETURN_IF_FAILED(result.load());
+
+    const size_t calls = s_pooledClients * s_pooledCallsPerClient;
+
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "%zu clients on %zu workers: %zu calls, %.0f calls/s\r\n",
+              s_pooledClients,
+              workerCount,
+              calls,
+              seconds > 0 ? calls / seconds : 0.0);
+    notes.append(line);
+    return S_OK;
+}
+
+// Routine Description:
+// - Formats the sequences the VT engine sends for a frame full of colored
+//   text, over and over, the same way VtSequences.cpp does, into a buffer
+//   that's reused from frame to frame like the engine's.
+// Arguments:
+// - height - How many rows a frame repaints.
+// Return Value:
+// - The results, as text.
+static std::string s_FormatVtSequences(const short height)
+{
+    std::string frame;
+    size_t sequences = 0;
+    size_t allocations = 0;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER start;
+    QueryPerformanceCounter(&start);
+
+    {
+        AllocationCounter allocationCounter;
+        for (size_t i = 0; i < s_formatFrames; i++)
+        {
+            frame.clear();
+            for (short row = 0; row < height; row++)
+            {
+                // Move to the row, set both colors, write the text, erase the rest.
+                CsiSequence<2> position;
+                position.AppendParameter(row + 1);
+                position.AppendParameter(1);
+                frame.append(position.Finish('H'));
+
+                const int color = static_cast<int>((i + row) % 256);
+                CsiSequence<5> foreground;
+                for (const int param : { 38, 2, color, 255 - color, 128 })
+                {
+                    foreground.AppendParameter(param);
+                }
+                frame.append(foreground.Finish('m'));
+
+                CsiSequence<5> background;
+                for (const int param : { 48, 2, 0, color, 255 - color })
+                {
+                    background.AppendParameter(param);
+                }
+                frame.append(background.Finish('m'));
+
+                frame.append("lorem ipsum dolor sit amet");
+
+                CsiSequence<1> erase;
+                erase.AppendParameter(static_cast<int>(i % 80));
+                frame.append(erase.Finish('X'));
+
+                sequences += 4;
+            }
+        }
+
+        allocations = allocationCounter.Count();
+    }
+
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+
+    const double seconds = static_cast<double>(end.QuadPart - start.QuadPart) / frequency.QuadPart;
+
+    std::string report;
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "\r\nVT sequence formatting\r\n%zu frames, %zu sequences, %.1f million sequences/s\r\n",
+              s_formatFrames,
+              sequences,
+              seconds > 0 ? sequences / seconds / 1000000 : 0.0);
+    report.append(line);
+
+    sprintf_s(line, ARRAYSIZE(line), "%.2f allocations per frame\r\n", static_cast<double>(allocations) / s_formatFrames);
+    report.append(line);
+
+    return report;
+}
+
+// Routine Description:
+// - Converts a megabyte of each kind of text between UTF-8 and UTF-16 over and
+//   over, with the conversions in the types library and with the system's,
+//   into buffers that are reused from pass to pass.
+// Arguments:
+// - <none>
+// Return Value:
+// - The results, as text.
+static std::string s_ConvertUtf8()
+{
+    static constexpr std::pair<PCSTR, std::wstring_view> samples[] = {
+        { "ASCII", L"The quick brown fox jumps over the lazy dog. 0123456789" },
+        { "Latin", L"Gr\x00f6\x00df" L"e, caf\x00e9, na\x00ef" L"ve, fa\x00e7" L"ade, \x00c6r\x00f8sk\x00f8" L"bing" },
+        { "CJK", L"\x65e5\x672c\x8a9e\x306e\x30c6\x30ad\x30b9\x30c8\x3001\x4e2d\x6587\xd55c\xad6d\xc5b4" },
+        { "emoji", L"\xd83d\xde00\xd83d\xde80\xd83c\xdf89\xd83d\xdc4d\xd83e\xdd16" },
+    };
+
+    const auto measure = [](auto&& convert) {
+        LARGE_INTEGER begin;
+        QueryPerformanceCounter(&begin);
+        for (size_t pass = 0; pass < s_convertPasses; pass++)
+        {
+            convert();
+        }
+        return s_SecondsSince(begin);
+    };
+
+    std::string report;
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "\r\nUTF-8 conversion, MB/s of UTF-8\r\n%-8s %12s %12s %12s %12s\r\n",
+              "text",
+              "to UTF-16",
+              "system",
+              "to UTF-8",
+              "system");
+    report.append(line);
+
+    for (const auto& [name, sample] : samples)
+    {
+        std::wstring text;
+        text.reserve(s_convertChars + sample.size());
+        while (text.size() < s_convertChars)
+        {
+            text.append(sample);
+        }
+
+        std::string narrow(text.size() * 3, '\0');
+        size_t consumed = 0;
+        size_t produced = 0;
+        if (FAILED(Utf16ToUtf8(text, { narrow.data(), gsl::narrow<ptrdiff_t>(narrow.size()) }, consumed, produced)))
+        {
+            continue;
+        }
+        narrow.resize(produced);
+        std::wstring wide(narrow.size(), L'\0');
+
+        const double toWide = measure([&]() {
+            (void)Utf8ToUtf16(narrow, { wide.data(), gsl::narrow<ptrdiff_t>(wide.size()) }, consumed, produced);
+        });
+        const double systemToWide = measure([&]() {
+            MultiByteToWideChar(CP_UTF8, 0, narrow.data(), gsl::narrow<int>(narrow.size()), wide.data(), gsl::narrow<int>(wide.size()));
+        });
+
+        std::string narrowed(narrow.size(), '\0');
+        const double toNarrow = measure([&]() {
+            (void)Utf16ToUtf8(text, { narrowed.data(), gsl::narrow<ptrdiff_t>(narrowed.size()) }, consumed, produced);
+        });
+        const double systemToNarrow = measure([&]() {
+            WideCharToMultiByte(CP_UTF8, 0, text.data(), gsl::narrow<int>(text.size()), narrowed.data(), gsl::narrow<int>(narrowed.size()), nullptr, nullptr);
+        });
+
+        const double megabytes = static_cast<double>(s_convertPasses * narrow.size()) / (1024 * 1024);
+        const auto rate = [&](const double seconds) { return seconds > 0 ? megabytes / seconds : 0.0; };
+        sprintf_s(line,
+                  ARRAYSIZE(line),
+                  "%-8s %12.0f %12.0f %12.0f %12.0f\r\n",
+                  name,
+                  rate(toWide),
+                  rate(systemToWide),
+                  rate(toNarrow),
+                  rate(systemToNarrow));
+        report.append(line);
+    }
+
+    return report;
+}
+
+// Routine Description:
+// - Selects every row of the buffer and copies it, the way the console's copy
+//   does with GetTextForClipboard, and then the way the run by run export
+//   lets a formatter do it without building the text and colors first. Both
+//   hold the console lock like a copy does.
+// - Runs after the workloads, so the buffer is full of their colored text.
+// Arguments:
+// - screenInfo - The buffer to copy from.
+// Return Value:
+// - The results, as text.
+static std::string s_CopyScrollback(const SCREEN_INFORMATION& screenInfo)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const TextBuffer& buffer = screenInfo.GetTextBuffer();
+    const COORD bufferSize = screenInfo.GetBufferSize().Dimensions();
+
+    std::vector<SMALL_RECT> selection;
+    selection.reserve(bufferSize.Y);
+    for (SHORT row = 0; row < bufferSize.Y; row++)
+    {
+        selection.push_back({ 0, row, gsl::narrow<SHORT>(bufferSize.X - 1), row });
+    }
+
+    const auto foregroundOf = [&](TextAttribute& attributes) { return gci.LookupForegroundColor(attributes); };
+    const auto backgroundOf = [&](TextAttribute& attributes) { return gci.LookupBackgroundColor(attributes); };
+
+    size_t clipboardRuns = 0;
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+    for (size_t pass = 0; pass < s_copyPasses; pass++)
+    {
+        LOG_IF_FAILED(s_LockedCall([&]() {
+            const auto data = buffer.GetTextForClipboard(true, true, selection, foregroundOf, backgroundOf);
+            clipboardRuns = 0;
+            for (const auto& row : data.colors)
+            {
+                clipboardRuns += row.size();
+            }
+            return S_OK;
+        }));
+    }
+    const double clipboardSeconds = s_SecondsSince(begin);
+
+    size_t chars = 0;
+    size_t exportRuns = 0;
+    QueryPerformanceCounter(&begin);
+    for (size_t pass = 0; pass < s_copyPasses; pass++)
+    {
+        chars = 0;
+        exportRuns = 0;
+        LOG_IF_FAILED(s_LockedCall([&]() {
+            buffer.ExportSelection(true,
+                                   true,
+                                   selection,
+                                   [&](const std::wstring_view text, const TextAttribute&) {
+                                       chars += text.size();
+                                       exportRuns++;
+                                   },
+                                   [&](const bool lineBreak) { chars += lineBreak ? 2 : 0; });
+            return S_OK;
+        }));
+    }
+    const double exportSeconds = s_SecondsSince(begin);
+
+    std::string report;
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "\r\nCopying all %d rows, %zu chars\r\nGetTextForClipboard: %zu color runs, %.1f ms per copy\r\nExportSelection: %zu runs, %.1f ms per copy\r\n",
+              bufferSize.Y,
+              chars,
+              clipboardRuns,
+              clipboardSeconds * 1000 / s_copyPasses,
+              exportRuns,
+              exportSeconds * 1000 / s_copyPasses);
+    report.append(line);
+    return report;
+}
+
+// Routine Description:
+// - Recolors a 120x9000 buffer of mixed attributes, like a palette change from
+//   the properties dialog does, once row by row on this thread and once with
+//   ReplaceAttributes, which splits the rows into chunks for several threads.
+// Arguments:
+// - screenInfo - Where the buffers send their invalidations.
+// Return Value:
+// - The results, as text.
+static std::string s_RecolorScrollback(SCREEN_INFORMATION& screenInfo)
+{
+    const auto makeBuffer = [&]() {
+        auto buffer = std::make_unique<TextBuffer>(s_recolorBufferSize, TextAttribute{ 0x07 }, 12, screenInfo.GetRenderTarget());
+        const std::wstring segment(15, L'x');
+        for (SHORT row = 0; row < s_recolorBufferSize.Y; row++)
+        {
+            for (SHORT segmentIndex = 0; segmentIndex < 8; segmentIndex++)
+            {
+                const TextAttribute attr{ static_cast<WORD>((row + segmentIndex) % 16) };
+                buffer->WriteLine(OutputCellIterator{ segment, attr }, { gsl::narrow<SHORT>(segmentIndex * 15), row });
+            }
+        }
+        return buffer;
+    };
+
+    const std::pair<TextAttribute, TextAttribute> replacements[] = {
+        { TextAttribute{ 0x07 }, TextAttribute{ 0x08 } },
+        { TextAttribute{ 0x01 }, TextAttribute{ 0x02 } },
+    };
+
+    auto serial = makeBuffer();
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+    LOG_IF_FAILED(s_LockedCall([&]() {
+        for (SHORT row = 0; row < s_recolorBufferSize.Y; row++)
+        {
+            serial->GetRowByOffset(row).GetAttrRow().ReplaceAttrs(replacements);
+        }
+        return S_OK;
+    }));
+    const double serialSeconds = s_SecondsSince(begin);
+
+    auto chunked = makeBuffer();
+    QueryPerformanceCounter(&begin);
+    LOG_IF_FAILED(s_LockedCall([&]() {
+        chunked->ReplaceAttributes(replacements);
+        return S_OK;
+    }));
+    const double chunkedSeconds = s_SecondsSince(begin);
+
+    std::string report;
+    char line[256];
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "\r\nRecoloring %dx%d cells of mixed attributes\r\nrow by row: %.2f ms, ReplaceAttributes on %u processors: %.2f ms\r\n",
+              s_recolorBufferSize.X,
+              s_recolorBufferSize.Y,
+              serialSeconds * 1000,
+              std::thread::hardware_concurrency(),
+              chunkedSeconds * 1000);
+    report.append(line);
+    return report;
+}
+
+// The paint benchmarks call PaintFrame themselves, so their renderers don't
+//      need a thread. This one counts how often the renderer would wake its
+//      thread; the real RenderThread makes a SetEvent call for each of these.
+class CountingRenderThread final : public IRenderThread
+{
+public:
+    CountingRenderThread(size_t& notifications) noexcept :
+        _notifications{ notifications }
+    {
+    }
+
+    void NotifyPaint() override { _notifications++; }
+    void EnablePainting() override {}
+    void WaitForPaintCompletionAndDisable(const DWORD /*dwTimeoutMs*/) override {}
+
+private:
+    size_t& _notifications;
+};
+
+// Routine Description:
+// - Paints frames with a RecordingRenderEngine, so that only the Renderer
+//   itself is measured and not GDI, DirectX or a pipe: the whole window full of
+//   plain, colored and wide text, one new line of output per frame, and a
+//   megabyte of output in 4096 character chunks with a frame after each.
+// - The buffer is written through its VT parser, like a client's output, and
+//   invalidates through the renderer under test while this runs.
+// Arguments:
+// - screenInfo - The buffer to paint.
+// Return Value:
+// - The results, as text.
+static std::string s_PaintFrames(SCREEN_INFORMATION& screenInfo)
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+    StateMachine& stateMachine = screenInfo.GetStateMachine();
+    const Viewport viewport = screenInfo.GetViewport();
+
+    std::string report{ "\r\nPainting with a recording render engine\r\n" };
+    char line[256];
+
+    size_t notifications = 0;
+    RecordingRenderEngine engine{ viewport.Dimensions() };
+    IRenderEngine* engines[] = { &engine };
+    Renderer renderer{ &gci.renderData, engines, ARRAYSIZE(engines), std::make_unique<CountingRenderThread>(notifications) };
+
+    auto* const pPreviousRenderer = g.pRender;
+    g.pRender = &renderer;
+    auto restoreRenderer = wil::scope_exit([&]() { g.pRender = pPreviousRenderer; });
+
+    const auto write = [&](const std::wstring_view text) {
+        LOG_IF_FAILED(s_LockedCall([&]() {
+            stateMachine.ProcessString(text.data(), text.size());
+            return S_OK;
+        }));
+    };
+
+    const auto fillViewport = [&](const std::wstring_view pattern) {
+        std::wstring row;
+        while (row.size() < gsl::narrow<size_t>(viewport.Width()))
+        {
+            row.append(pattern);
+        }
+
+        std::wstring screen;
+        for (auto y = 0; y < viewport.Height(); y++)
+        {
+            screen.append(L"\x1b[");
+            screen.append(std::to_wstring(y + 1));
+            screen.append(L";1H");
+            screen.append(row);
+        }
+        screen.append(L"\x1b[m");
+        write(screen);
+    };
+
+    // Only the time spent in PaintFrame counts, not preparing the frames.
+    //      The allocations include preparing them, though.
+    const auto paint = [&](_In_ PCSTR name, const size_t frames, const std::function<void(const size_t)>& prepareFrame) {
+        // Paint one frame first, so the numbers don't include growing the
+        //      engine's log or the renderer's snapshot for the first time.
+        prepareFrame(0);
+        renderer.TriggerRedrawAll();
+        LOG_IF_FAILED(renderer.PaintFrame());
+        engine.ClearLog();
+
+        const auto firstFrame = engine.FrameCount();
+        const auto firstCluster = engine.ClusterCount();
+        LONGLONG paintTicks = 0;
+        size_t allocations = 0;
+        {
+            AllocationCounter allocationCounter;
+            for (size_t frame = 1; frame <= frames; frame++)
+            {
+                prepareFrame(frame);
+
+                LARGE_INTEGER start;
+                LARGE_INTEGER end;
+                QueryPerformanceCounter(&start);
+                LOG_IF_FAILED(renderer.PaintFrame());
+                QueryPerformanceCounter(&end);
+                paintTicks += end.QuadPart - start.QuadPart;
+
+                engine.ClearLog();
+            }
+            allocations = allocationCounter.Count();
+        }
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        const double seconds = static_cast<double>(paintTicks) / frequency.QuadPart;
+        const auto painted = engine.FrameCount() - firstFrame;
+        const auto clusters = engine.ClusterCount() - firstCluster;
+
+        sprintf_s(line,
+                  ARRAYSIZE(line),
+                  "%-24s %zu frames, %.3f ms per frame, %.0f clusters/s, %.1f allocations per frame\r\n",
+                  name,
+                  painted,
+                  painted > 0 ? seconds * 1000 / painted : 0.0,
+                  seconds > 0 ? clusters / seconds : 0.0,
+                  painted > 0 ? static_cast<double>(allocations) / painted : 0.0);
+        report.append(line);
+    };
+
+    static constexpr struct
+    {
+        PCSTR name;
+        std::wstring_view pattern;
+    } screens[] = {
+        { "Full screen plain text", L"The quick brown fox jumps over the lazy dog. " },
+        // Every word gets a different color, so every line is many runs.
+        { "Full screen colored text", L"\x1b[31mred \x1b[1;32mgreen \x1b[0;44mblue\x1b[m \x1b[38;2;255;128;0morange \x1b[7mreverse\x1b[m " },
+        { "Full screen wide text", L"\x3042\x3044\x3046\x3048\x304a\x4e2d\x6587 " },
+    };
+
+    for (const auto& screen : screens)
+    {
+        fillViewport(screen.pattern);
+        paint(screen.name, s_paintFrames, [&](const size_t /*frame*/) { renderer.TriggerRedrawAll(); });
+    }
+
+    // One new line of output per frame, like a build log streaming by. The
+    //      buffer invalidates whatever the output touched.
+    paint("Scrolling output", s_scrollFrames, [&](const size_t frame) {
+        std::wstring output{ L"\r\n[" };
+        output.append(std::to_wstring(frame));
+        output.append(L"] Compiling \x1b[36msrc\\renderer\\base\\renderer.cpp\x1b[m ... \x1b[32mok\x1b[m");
+        write(output);
+    });
+
+    // A build log, handed over in pipe sized chunks, with a frame painted after
+    //      every chunk like the render thread would.
+    std::wstring chunk;
+    for (size_t row = 0; chunk.size() < s_paintChunkChars; row++)
+    {
+        chunk.append(L"[");
+        chunk.append(std::to_wstring(row));
+        chunk.append(L"] Compiling \x1b[36msrc\\renderer\\base\\renderer.cpp\x1b[m ... \x1b[32mok\x1b[m\r\n");
+    }
+
+    static constexpr size_t megabyte = 1024 * 1024;
+    const size_t chunks = (megabyte + chunk.size() - 1) / chunk.size();
+
+    LOG_IF_FAILED(renderer.PaintFrame());
+    notifications = 0;
+    const auto firstInvalidation = engine.InvalidationCount();
+    const auto firstFrame = engine.FrameCount();
+
+    for (size_t i = 0; i < chunks; i++)
+    {
+        write(chunk);
+        LOG_IF_FAILED(renderer.PaintFrame());
+        engine.ClearLog();
+    }
+
+    const double megabytes = static_cast<double>(chunks * chunk.size()) / megabyte;
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "A megabyte of output: %.0f thread notifications, %.0f engine invalidations per MB, over %zu frames\r\n",
+              notifications / megabytes,
+              (engine.InvalidationCount() - firstInvalidation) / megabytes,
+              engine.FrameCount() - firstFrame);
+    report.append(line);
+
+    return report;
+}
+
+// Routine Description:
+// - Fills a 120x9000 buffer with text and finds every match in it, once for a
+//   needle that's on every tenth row and once for one that's nowhere, with
+//   Search and with the cell by cell comparison it replaced.
+// - The buffer keeps that size afterwards, so this runs last.
+// Arguments:
+// - screenInfo - The buffer to resize, fill and search.
+// Return Value:
+// - The results, as text.
+static std::string s_SearchScrollback(SCREEN_INFORMATION& screenInfo)
+{
+    ApiRoutines& api = ServiceLocator::LocateGlobals().api;
+
+    std::string report;
+    char line[256];
+
+    if (FAILED(api.SetConsoleScreenBufferSizeImpl(screenInfo, s_searchBufferSize)))
+    {
+        report.append("\r\nSearch\r\nthe buffer couldn't be resized\r\n");
+        return report;
+    }
+
+    const std::wstring_view text{ L"The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs! 0123456789 Sphinx of black quartz." };
+    for (SHORT y = 0; y < s_searchBufferSize.Y; y++)
+    {
+        size_t used = 0;
+        LOG_IF_FAILED(api.WriteConsoleOutputCharacterWImpl(screenInfo, text.substr(y % 10, s_searchBufferSize.X), { 0, y }, used));
+    }
+
+    sprintf_s(line, ARRAYSIZE(line), "\r\nSearch of %dx%d cells\r\n", s_searchBufferSize.X, s_searchBufferSize.Y);
+    report.append(line);
+
+    const Viewport bufferSize = screenInfo.GetBufferSize();
+    for (const std::wstring needle : { L"lazy DOG", L"not in there" })
+    {
+        size_t found = 0;
+        LARGE_INTEGER begin;
+        QueryPerformanceCounter(&begin);
+        LOG_IF_FAILED(s_LockedCall([&]() {
+            Search search(screenInfo, needle, Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+            while (search.FindNext())
+            {
+                found++;
+            }
+            return S_OK;
+        }));
+        const double searchSeconds = s_SecondsSince(begin);
+
+        size_t foundByCell = 0;
+        QueryPerformanceCounter(&begin);
+        LOG_IF_FAILED(s_LockedCall([&]() {
+            COORD pos{ 0, 0 };
+            do
+            {
+                COORD at = pos;
+                bool match = true;
+                for (const auto wch : needle)
+                {
+                    const std::wstring_view glyph = *screenInfo.GetTextDataAt(at);
+                    if (glyph.size() != 1 || ::towlower(glyph.front()) != ::towlower(wch))
+                    {
+                        match = false;
+                        break;
+                    }
+                    bufferSize.IncrementInBoundsCircular(at);
+                }
+                foundByCell += match ? 1 : 0;
+            } while (bufferSize.IncrementInBoundsCircular(pos));
+            return S_OK;
+        }));
+        const double byCellSeconds = s_SecondsSince(begin);
+
+        sprintf_s(line,
+                  ARRAYSIZE(line),
+                  "\"%ls\": Search %zu matches in %.1f ms, cell by cell %zu matches in %.1f ms\r\n",
+                  needle.c_str(),
+                  found,
+                  searchSeconds * 1000,
+                  foundByCell,
+                  byCellSeconds * 1000);
+        report.append(line);
+    }
+
+    return report;
+}
+
+// Routine Description:
+// - Runs every workload once.
+// Arguments:
+// - statistics - Receives a call record for every API call made.
+// - notes - Receives what the workloads measured that isn't per call.
+// Return Value:
+// - S_OK, or the failure of the API call that failed.
+[[nodiscard]]
+static HRESULT s_RunWorkloads(ApiStatistics& statistics, std::string& notes)
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& screenInfo = gci.GetActiveOutputBuffer();
+
+    RETURN_IF_FAILED(s_WriteOutput(statistics, screenInfo, false));
+    RETURN_IF_FAILED(s_WriteOutput(statistics, screenInfo, true));
+    RETURN_IF_FAILED(s_WriteNarrowOutput(statistics, screenInfo));
+    RETURN_IF_FAILED(s_SmallWrites(statistics, screenInfo, notes));
+    RETURN_IF_FAILED(s_ReadOutput(statistics, screenInfo));
+    RETURN_IF_FAILED(s_ReadModifyWriteOutput(statistics, screenInfo, notes));
+    RETURN_IF_FAILED(s_ScrollPanes(statistics, screenInfo, notes));
+    RETURN_IF_FAILED(s_WriteAndReadInput(statistics, *gci.pInputBuffer));
+    RETURN_IF_FAILED(s_PasteSizedInput(statistics, *gci.pInputBuffer, notes));
+    RETURN_IF_FAILED(s_ChunkedVtInput(statistics, *gci.pInputBuffer, notes));
+    RETURN_IF_FAILED(s_ConptyInput(statistics, *gci.pInputBuffer, notes));
+    RETURN_IF_FAILED(s_EditLongLine(statistics, *gci.pInputBuffer, notes));
+    RETURN_IF_FAILED(s_PendingWaits(statistics, *gci.pInputBuffer, notes));
+    RETURN_IF_FAILED(s_PooledClients(statistics, screenInfo, notes));
+    return S_OK;
+}
+
+// Routine Description:
+// - Lays out what one run of the workloads measured, one line per API.
+// Arguments:
+// - statistics - What the run recorded.
+// - title - What sets this run apart from the others.
+// - notes - What the run measured that isn't per call, to go under the table.
+// Return Value:
+// - The report, as text.
+static std::string s_FormatResults(const ApiStatistics& statistics, _In_ PCSTR title, const std::string& notes)
+{
+    std::string report;
+    char line[256];
+
+    sprintf_s(line, ARRAYSIZE(line), "\r\n%s\r\n", title);
+    report.append(line);
+
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "%-28s %8s %10s %8s %8s %8s %10s\r\n",
+              "API",
+              "calls",
+              "MB/s",
+              "p50 us",
+              "p99 us",
+              "max us",
+              "lock ms");
+    report.append(line);
+
+    for (const auto& summary : statistics.Summarize())
+    {
+        const double megabytes = static_cast<double>(summary.bytesIn + summary.bytesOut) / (1024 * 1024);
+        const double seconds = static_cast<double>(summary.totalMicroseconds) / 1000000;
+        sprintf_s(line,
+                  ARRAYSIZE(line),
+                  "%-28s %8llu %10.1f %8llu %8llu %8llu %10.1f\r\n",
+                  summary.name,
+                  summary.calls,
+                  seconds > 0 ? megabytes / seconds : 0.0,
+                  summary.Percentile(0.5),
+                  summary.Percentile(0.99),
+                  summary.Percentile(1.0),
+                  summary.lockWaitMicroseconds / 1000.0);
+        report.append(line);
+    }
+
+    report.append(notes);
+    return report;
+}
+
+// Routine Description:
+// - Sets up the console like the first client to connect would, but without a
+//   window, and without a client.
+// Arguments:
+// - args - The commandline arguments conhost was started with.
+// Return Value:
+// - S_OK if the console is ready for the workloads.
+[[nodiscard]]
+static HRESULT s_AllocateConsole(const ConsoleArguments& args)
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+
+    g.launchArgs = args;
+    g.uiOEMCP = GetOEMCP();
+    g.uiWindowsCP = GetACP();
+    g.pFontDefaultList = new RenderFontDefaults();
+    FontInfo::s_SetFontDefaultList(g.pFontDefaultList);
+
+    CONSOLE_API_CONNECTINFO connectInfo{};
+    connectInfo.ConsoleApp = TRUE;
+    connectInfo.WindowVisible = FALSE;
+    RETURN_IF_FAILED(StringCchCopyW(connectInfo.Title, ARRAYSIZE(connectInfo.Title), L"conhost benchmark"));
+    connectInfo.TitleLength = gsl::narrow<DWORD>(wcslen(connectInfo.Title) * sizeof(wchar_t));
+    RETURN_IF_FAILED(StringCchCopyW(connectInfo.AppName, ARRAYSIZE(connectInfo.AppName), L"conhost.exe"));
+    connectInfo.AppNameLength = gsl::narrow<DWORD>(wcslen(connectInfo.AppName) * sizeof(wchar_t));
+    connectInfo.CurDirLength = GetCurrentDirectoryW(ARRAYSIZE(connectInfo.CurDir), connectInfo.CurDir) * sizeof(wchar_t);
+
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+    LockConsole();
+    auto unlock = wil::scope_exit([&]() { UnlockConsole(); });
+
+    RETURN_IF_NTSTATUS_FAILED(ConsoleAllocateConsole(&connectInfo));
+    WI_SetFlag(gci.Flags, CONSOLE_INITIALIZED);
+    return S_OK;
+}
+
+// Routine Description:
+// - Attaches a VT render engine that writes to NUL, so the workloads that run
+//   after this pay for rendering like they would in a conpty session.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if the engine was attached.
+[[nodiscard]]
+static HRESULT s_AttachVtRenderer()
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    const CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+
+    wil::unique_hfile nullSink{ CreateFileW(L"NUL", GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    RETURN_LAST_ERROR_IF(!nullSink);
+
+    const Viewport initialViewport = Viewport::FromDimensions({ 0, 0 }, gci.GetWindowSize().X, gci.GetWindowSize().Y);
+    s_pVtEngine = std::make_unique<Xterm256Engine>(std::move(nullSink),
+                                                   gci,
+                                                   initialViewport,
+                                                   gci.GetColorTable(),
+                                                   static_cast<WORD>(gci.GetColorTableSize()));
+    g.pRender->AddRenderEngine(s_pVtEngine.get());
+    return S_OK;
+}
+
+// Routine Description:
+// - Writes the report to standard output, or to the debugger if conhost was
+//   started without one.
+// Arguments:
+// - report - The report, as text.
+// Return Value:
+// - <none>
+static void s_WriteReport(const std::string& report) noexcept
+{
+    const HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD cbWritten = 0;
+    if (hOut == nullptr ||
+        hOut == INVALID_HANDLE_VALUE ||
+        !WriteFile(hOut, report.data(), gsl::narrow_cast<DWORD>(report.size()), &cbWritten, nullptr))
+    {
+        OutputDebugStringA(report.c_str());
+    }
+}
+
+// Routine Description:
+// - Runs the benchmark and writes its report. See Benchmark.hpp.
+// Arguments:
+// - args - The commandline arguments conhost was started with. Settings like
+//   --width and --height apply to the benchmark's console too.
+// Return Value:
+// - S_OK if every workload ran. The process should exit after this either way.
+[[nodiscard]]
+HRESULT RunBenchmark(const ConsoleArguments& args) noexcept
+{
+    try
+    {
+        RETURN_IF_FAILED(s_AllocateConsole(args));
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& screenInfo = gci.GetActiveOutputBuffer();
+
+        std::string report;
+        char line[256];
+        sprintf_s(line,
+                  ARRAYSIZE(line),
+                  "conhost benchmark: buffer %dx%d, window %dx%d\r\n",
+                  screenInfo.GetBufferSize().Width(),
+                  screenInfo.GetBufferSize().Height(),
+                  screenInfo.GetViewport().Width(),
+                  screenInfo.GetViewport().Height());
+        report.append(line);
+
+        ApiStatistics withoutRenderer;
+        std::string withoutRendererNotes;
+        RETURN_IF_FAILED(s_RunWorkloads(withoutRenderer, withoutRendererNotes));
+        report.append(s_FormatResults(withoutRenderer, "Without a render engine", withoutRendererNotes));
+
+        RETURN_IF_FAILED(s_AttachVtRenderer());
+        ApiStatistics withVtRenderer;
+        std::string withVtRendererNotes;
+        RETURN_IF_FAILED(s_RunWorkloads(withVtRenderer, withVtRendererNotes));
+        report.append(s_FormatResults(withVtRenderer, "With a VT render engine writing to NUL", withVtRendererNotes));
+
+        report.append(s_FormatVtSequences(screenInfo.GetViewport().Height()));
+        report.append(s_ConvertUtf8());
+        report.append(s_CopyScrollback(screenInfo));
+        report.append(s_RecolorScrollback(screenInfo));
+        report.append(s_PaintFrames(screenInfo));
+        report.append(s_SearchScrollback(screenInfo));
+
+        s_WriteReport(report);
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
@@ -0,0 +1,66 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- Benchmark.hpp
+
+Abstract:
+- Runs conhost against built-in workloads instead of a client, for throughput
+  and latency figures that can be compared from one build to the next without
+  any other tools. Started with --benchmark.
+- The console is set up the way it is for a client's first connection, but
+  without a window. The workloads then call ApiRoutines directly, the same way
+  the API dispatchers do for a client's messages:
+  - plain and VT-heavy WriteConsoleW
+  - short and 64KB WriteConsoleA, in codepage 437 and in UTF-8
+  - a million 8 byte WriteConsoleW calls, each with a payload buffer like a
+    message's, from the heap and then from the MessageBufferPool
+  - ReadConsoleOutputW over the whole window
+  - full screen read-modify-write cycles of ReadConsoleOutputW and
+    WriteConsoleOutputW
+  - ScrollConsoleScreenBufferW a line at a time, across the whole window and
+    within its left or right half, like side by side panes
+  - key events written to and read back from the input buffer
+  - a 64K event paste written in one call and read back 512 events at a time
+  - a megabyte paste typed in through the VT input state machine in 4096
+    character chunks, like it arrives over conpty input
+  - half a megabyte of input written into a pipe in 16, 256 and 4096 byte
+    pieces and read by a VtInputThread, for MB/s and console lock
+    acquisitions per MB
+  - keystrokes in the middle of a 2000 character line in a cooked read, next
+    to redrawing the whole line
+  - 500 reads pending on the input buffer through 100 handles: typing, and
+    notifying one handle's waits next to notifying all of them
+- Last in each run, eight clients call in at once and are serviced on an
+  IoWorkerPool, like ConsoleIoThread does with more than one processor. Half
+  of them write and half poll the buffer info, for the aggregate calls/s.
+- Everything runs twice: once without any render engine, and once with a VT
+  render engine writing to NUL, like a conpty session with nobody slowing it
+  down on the other end of the pipe. Every call holds the console lock only
+  for itself, like a client's would, so the second run measures throughput
+  while the render thread captures frames between calls.
+- After both runs, the VT sequences of a frame full of colored text are formatted over
+  and over, for sequences per second and heap allocations per frame. Heap
+  allocations are counted with a replaced global operator new, in any build. Then a megabyte each of ASCII, Latin, CJK and emoji text is
+  converted between UTF-8 and UTF-16, next to the system's conversions.
+- With the buffer full of what the workloads wrote, every row of it is
+  selected and copied, with GetTextForClipboard and with ExportSelection.
+- A 120x9000 buffer of mixed attributes is recolored row by row and with the
+  chunked ReplaceAttributes.
+- Frames are painted with a RecordingRenderEngine, which records what the
+  Renderer asks for instead of drawing it, for the frame time, clusters per
+  second and allocations per frame of full screens of text and of scrolling
+  output, and for invalidations per megabyte of output.
+- Last, the buffer is resized to 120x9000 and filled with text, and every
+  match of a needle is found with Search and with a cell by cell comparison.
+- The report goes to standard output, so redirect it to a file to keep it:
+  conhost.exe --benchmark > results.txt
+--*/
+
+#pragma once
+
+#include "ConsoleArguments.hpp"
+
+[[nodiscard]]
+HRESULT RunBenchmark(const ConsoleArguments& args) noexcept;
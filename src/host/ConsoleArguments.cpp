@@ -20,6 +20,7 @@ const std::wstring ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
 const std::wstring ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring ConsoleArguments::FEATURE_PTY_ARG = L"pty";
+const std::wstring ConsoleArguments::BENCHMARK_ARG = L"--benchmark";
 
 ConsoleArguments::ConsoleArguments(const std::wstring& commandline,
                                    const HANDLE hStdIn,
@@ -41,6 +42,7 @@ ConsoleArguments::ConsoleArguments(const std::wstring& commandline,
     _width = 0;
     _height = 0;
     _inheritCursor = false;
+    _benchmark = false;
 }
 
 ConsoleArguments::ConsoleArguments() :
@@ -66,6 +68,7 @@ ConsoleArguments& ConsoleArguments::operator=(const ConsoleArguments & other)
         _width = other._width;
         _height = other._height;
         _inheritCursor = other._inheritCursor;
+        _benchmark = other._benchmark;
         _recievedEarlySizeChange = other._recievedEarlySizeChange;
     }
 
@@ -412,6 +415,12 @@ HRESULT ConsoleArguments::ParseCommandline()
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == BENCHMARK_ARG)
+        {
+            _benchmark = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -490,6 +499,18 @@ bool ConsoleArguments::IsHeadless() const
     return _headless;
 }
 
+// Routine Description:
+// - Returns true if we should run the built-in benchmark instead of hosting a
+//   client. See Benchmark.hpp.
+// Arguments:
+// - <none> - uses internal state
+// Return Value:
+// - True or false (see description)
+bool ConsoleArguments::IsBenchmark() const
+{
+    return _benchmark;
+}
+
 bool ConsoleArguments::ShouldCreateServerHandle() const
 {
     return _createServerHandle;
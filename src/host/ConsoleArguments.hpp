@@ -36,6 +36,7 @@ public:
     bool HasVtHandles() const;
     bool InConptyMode() const noexcept;
     bool IsHeadless() const;
+    bool IsBenchmark() const;
     bool ShouldCreateServerHandle() const;
 
     HANDLE GetServerHandle() const;
@@ -68,6 +69,7 @@ public:
     static const std::wstring INHERIT_CURSOR_ARG;
     static const std::wstring FEATURE_ARG;
     static const std::wstring FEATURE_PTY_ARG;
+    static const std::wstring BENCHMARK_ARG;
 
 private:
 #ifdef UNIT_TESTING
@@ -98,6 +100,7 @@ private:
         _serverHandle(serverHandle),
         _signalHandle(signalHandle),
         _inheritCursor(inheritCursor),
+        _benchmark{ false },
         _recievedEarlySizeChange{ false },
         _originalWidth{ -1 },
         _originalHeight{ -1 }
@@ -126,6 +129,7 @@ private:
     DWORD _serverHandle;
     DWORD _signalHandle;
     bool _inheritCursor;
+    bool _benchmark;
 
     bool _recievedEarlySizeChange;
     short _originalWidth;
@@ -225,7 +229,8 @@ namespace WEX {
                     expected.GetServerHandle() == actual.GetServerHandle() &&
                     expected.HasSignalHandle() == actual.HasSignalHandle() &&
                     expected.GetSignalHandle() == actual.GetSignalHandle() &&
-                    expected.GetInheritCursor() == actual.GetInheritCursor();
+                    expected.GetInheritCursor() == actual.GetInheritCursor() &&
+                    expected.IsBenchmark() == actual.IsBenchmark();
             }
 
             static bool AreSame(const ConsoleArguments& expected, const ConsoleArguments& actual)
@@ -251,7 +256,8 @@ namespace WEX {
                     !object.ShouldCreateServerHandle() &&
                     object.GetServerHandle() == 0 &&
                     (object.GetSignalHandle() == 0 || object.GetSignalHandle() == INVALID_HANDLE_VALUE) &&
-                    !object.GetInheritCursor();
+                    !object.GetInheritCursor() &&
+                    !object.IsBenchmark();
             }
         };
     }
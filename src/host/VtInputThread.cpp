@@ -30,7 +30,9 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
     _utf8Parser{ CP_UTF8 },
     _dwThreadId{ 0 },
     _exitRequested{ false },
-    _exitResult{ S_OK }
+    _exitResult{ S_OK },
+    _buffer{ std::make_unique<byte[]>(s_cbBuffer) },
+    _inputIsBulk{ false }
 {
     THROW_HR_IF(E_HANDLE, _hFile.get() == INVALID_HANDLE_VALUE);
 
@@ -97,8 +99,56 @@ DWORD VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 }
 
 // Method Description:
-// - Do a single ReadFile from our pipe, and try and handle it. If handling
-//      failed, throw or log, depending on what the caller wants.
+// - Reads whatever else is already waiting in the pipe into the rest of our
+//      buffer, so that it can all be handled at once.
+// - If the last batch was large, input is coming in bulk (a paste, or another
+//      program writing to us), so we give it a short window to send more.
+//      Typing never waits. The window is a sleep rather than polling the
+//      pipe, so the thread doesn't keep a core busy between batches.
+// Arguments:
+// - cbRead - How much of the buffer has been filled already.
+// Return Value:
+// - How much of the buffer is filled now.
+size_t VtInputThread::_ReadAvailable(size_t cbRead) noexcept
+{
+    bool waited = false;
+    while (cbRead < s_cbBuffer)
+    {
+        DWORD cbAvailable = 0;
+        if (!PeekNamedPipe(_hFile.get(), nullptr, 0, nullptr, &cbAvailable, nullptr))
+        {
+            // The pipe broke. Handle what we have, and let the next read report it.
+            break;
+        }
+
+        if (cbAvailable == 0)
+        {
+            if (!_inputIsBulk || waited)
+            {
+                break;
+            }
+
+            Sleep(s_coalesceMilliseconds);
+            waited = true;
+            continue;
+        }
+
+        DWORD dwRead = 0;
+        const DWORD cbWanted = gsl::narrow_cast<DWORD>(std::min<size_t>(cbAvailable, s_cbBuffer - cbRead));
+        if (!ReadFile(_hFile.get(), _buffer.get() + cbRead, cbWanted, &dwRead, nullptr))
+        {
+            break;
+        }
+        cbRead += dwRead;
+    }
+
+    return cbRead;
+}
+
+// Method Description:
+// - Read from our pipe until it's drained (see _ReadAvailable), and try and
+//      handle it all in one go. If handling failed, throw or log, depending on
+//      what the caller wants.
 // Arguments:
 // - throwOnFail: If true, throw an exception if there was an error processing
 //      the input recieved. Otherwise, log the error.
@@ -106,9 +156,8 @@ DWORD VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    byte buffer[256];
     DWORD dwRead = 0;
-    bool fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
+    bool fSuccess = !!ReadFile(_hFile.get(), _buffer.get(), gsl::narrow_cast<DWORD>(s_cbBuffer), &dwRead, nullptr);
 
     // If we failed to read because the terminal broke our pipe (usually due
     //      to dying itself), close gracefully with ERROR_BROKEN_PIPE.
@@ -121,7 +170,10 @@ void VtInputThread::DoReadInput(const bool throwOnFail)
         return;
     }
 
-    HRESULT hr = _HandleRunInput(buffer, dwRead);
+    const size_t cbBatch = _ReadAvailable(dwRead);
+    _inputIsBulk = cbBatch >= s_cbBulkInput;
+
+    HRESULT hr = _HandleRunInput(_buffer.get(), gsl::narrow_cast<int>(cbBatch));
     if (FAILED(hr))
     {
         if (throwOnFail)
@@ -8,6 +8,9 @@ Module Name:
 Abstract:
 - Defines methods that wrap the thread that reads VT input from a pipe and
   feeds it into the console's input buffer.
+- Everything already waiting in the pipe is read into one large buffer and
+  handled under a single acquisition of the console lock. While input is
+  arriving in bulk, a read also waits briefly for more to show up.
 
 Author(s):
 - Mike Griese (migrie) 15 Aug 2017
@@ -21,6 +24,10 @@ namespace Microsoft::Console
 {
     class VtInputThread
     {
+#ifdef UNIT_TESTING
+        friend class VtInputThreadTests;
+#endif
+
     public:
         VtInputThread(_In_ wil::unique_hfile hPipe, const bool inheritCursor);
 
@@ -33,6 +40,11 @@ namespace Microsoft::Console
         [[nodiscard]]
         HRESULT _HandleRunInput(_In_reads_(cch) const byte* const charBuffer, const int cch);
         DWORD _InputThread();
+        size_t _ReadAvailable(size_t cbRead) noexcept;
+
+        static constexpr size_t s_cbBuffer = 64 * 1024;
+        static constexpr size_t s_cbBulkInput = 4 * 1024;
+        static constexpr DWORD s_coalesceMilliseconds = 1;
 
         wil::unique_hfile _hFile;
         wil::unique_handle _hThread;
@@ -43,5 +55,8 @@ namespace Microsoft::Console
 
         std::unique_ptr<StateMachine> _pInputStateMachine;
         Utf8ToWideCharParser _utf8Parser;
+
+        std::unique_ptr<byte[]> _buffer;
+        bool _inputIsBulk;
     };
 }
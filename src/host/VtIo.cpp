@@ -13,6 +13,7 @@
 #include "../types/inc/utils.hpp"
 #include "input.h" // ProcessCtrlEvents
 #include "output.h" // CloseConsoleProcessState
+#include "handle.h" // LockConsole
 
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::VirtualTerminal;
@@ -230,6 +231,11 @@ HRESULT VtIo::StartIfNeeded()
         try
         {
             g.pRender->AddRenderEngine(_pVtRenderEngine.get());
+            // When the terminal falls behind, the engine skips frames. Once
+            //      it's caught up, it needs a frame to paint what it skipped.
+            _pVtRenderEngine->SetFrameReadyCallback([]() {
+                ServiceLocator::LocateGlobals().pRender->TriggerPaint();
+            });
             g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(_pVtRenderEngine.get());
         }
         CATCH_RETURN();
@@ -247,7 +253,7 @@ HRESULT VtIo::StartIfNeeded()
     //      (so they can't get the DSR) or they can't write the response to us.
     if (_lookingForCursorPosition && _pVtRenderEngine && _pVtInputThread)
     {
-        LOG_IF_FAILED(_pVtRenderEngine->RequestCursor());
+        LOG_IF_FAILED(_CallRenderEngine([&]() { return _pVtRenderEngine->RequestCursor(); }));
         while(_lookingForCursorPosition)
         {
             _pVtInputThread->DoReadInput(false);
@@ -319,7 +325,7 @@ HRESULT VtIo::SuppressResizeRepaint()
     HRESULT hr = S_OK;
     if (_pVtRenderEngine)
     {
-        hr = _pVtRenderEngine->SuppressResizeRepaint();
+        hr = _CallRenderEngine([&]() { return _pVtRenderEngine->SuppressResizeRepaint(); });
     }
     return hr;
 }
@@ -340,7 +346,7 @@ HRESULT VtIo::SetCursorPosition(const COORD coordCursor)
     {
         if (_pVtRenderEngine)
         {
-            hr = _pVtRenderEngine->InheritCursor(coordCursor);
+            hr = _CallRenderEngine([&]() { return _pVtRenderEngine->InheritCursor(coordCursor); });
         }
 
         _lookingForCursorPosition = false;
@@ -358,24 +364,49 @@ void VtIo::CloseInput()
 
 void VtIo::CloseOutput()
 {
+    Globals& g = ServiceLocator::LocateGlobals();
+
+    // This is called from the VT engine's pipe writer thread, which doesn't
+    //      hold the console lock. The screen buffer may only be changed with
+    //      the lock held exclusively. It's taken before the shutdown lock, and
+    //      let go of again before it, since shutting down takes the console
+    //      lock too.
+    {
+        LockConsole();
+        auto unlock = wil::scope_exit([&]() { UnlockConsole(); });
+        g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(nullptr);
+    }
+
     // This will release the lock when it goes out of scope
     std::lock_guard<std::mutex> lk(_shutdownLock);
 
-    Globals& g = ServiceLocator::LocateGlobals();
-    // DON'T RemoveRenderEngine, as that requires the engine list lock, and this
-    // is usually being triggered on a paint operation, when the lock is already
-    // owned by the paint.
+    // DON'T RemoveRenderEngine, as that requires the engine list lock, and the
+    // render thread may be in the middle of a paint that owns it.
     // Instead we're releasing the Engine here. A pointer to it has already been
     // given to the Renderer, so we don't want the unique_ptr to delete it. The
     // Renderer will own it's lifetime now.
     _pVtRenderEngine.release();
 
-    g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(nullptr);
-
     _ShutdownIfNeeded();
 }
 
 
+// Method Description:
+// - Makes a call on our render engine between frames. The renderer paints
+//      outside the console lock, so the engine's state can't be touched while
+//      a frame is in flight. Before the renderer exists, there's nothing to
+//      race with.
+// Arguments:
+// - call: The call to make on the engine.
+// Return Value:
+// - The result of the call.
+[[nodiscard]]
+HRESULT VtIo::_CallRenderEngine(const std::function<HRESULT()>& call)
+{
+    Microsoft::Console::Render::IRenderer* const pRender = ServiceLocator::LocateGlobals().pRender;
+    return pRender ? pRender->CallEngine(call) : call();
+}
+
 void VtIo::_ShutdownIfNeeded()
 {
     // The callers should have both accquired the _shutdownLock at this point -
@@ -69,6 +69,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         void _ShutdownIfNeeded();
 
+        [[nodiscard]]
+        HRESULT _CallRenderEngine(const std::function<HRESULT()>& call);
+
     #ifdef UNIT_TESTING
         friend class VtIoTests;
     #endif
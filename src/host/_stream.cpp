@@ -916,10 +916,104 @@ NTSTATUS WriteCharsLegacy(SCREEN_INFORMATION& screenInfo,
     return STATUS_SUCCESS;
 }
 
+// Routine Description:
+// - Determines if a string can be written without going through the VT state
+//   machine. That's the case when the machine isn't in the middle of a
+//   sequence, no character set translation is active, and the string holds
+//   only printable characters, carriage returns, line feeds, backspaces and tabs.
+// Arguments:
+// - machine - The output state machine of the screen buffer.
+// - pwch - The string to check.
+// - cch - The length of the string, in characters.
+// Return Value:
+// - True if the string is plain text. False if it needs the state machine.
+static bool _IsPlainVtText(const StateMachine& machine,
+                           _In_reads_(cch) const wchar_t* const pwch,
+                           const size_t cch)
+{
+    if (!machine.IsInGroundState())
+    {
+        return false;
+    }
+
+    const auto& engine = static_cast<const OutputStateMachineEngine&>(machine.Engine());
+    const auto& dispatch = static_cast<const AdaptDispatch&>(engine.Dispatch());
+    if (dispatch.IsTranslatingCharacters())
+    {
+        return false;
+    }
+
+    return std::all_of(pwch, pwch + cch, [](const wchar_t wch) {
+        switch (wch)
+        {
+        case UNICODE_CARRIAGERETURN:
+        case UNICODE_LINEFEED:
+        case UNICODE_BACKSPACE:
+        case UNICODE_TAB:
+            return true;
+        default:
+            // DEL and the single character CSI are acted on by the state machine too.
+            return wch >= UNICODE_SPACE && wch != UNICODE_DEL && wch != L'\x9b';
+        }
+    });
+}
+
+// Routine Description:
+// - Writes plain text (see _IsPlainVtText) into the active buffer with the same
+//   flags the state machine's default handlers use, but a whole row's worth at
+//   a time instead of one call for every run of printable characters and
+//   another for every control character between them.
+// - Each backspace starts a new write. WriteCharsLegacy backs up over text
+//   written earlier in the same call, while the state machine hands every
+//   backspace over on its own.
+// Arguments:
+// - screenInfo - The screen buffer the text was written to.
+// - pwch - The text to write.
+// - cch - The length of the text, in characters.
+// Return Value:
+// - STATUS_SUCCESS or a suitable error code from WriteCharsLegacy.
+[[nodiscard]]
+static NTSTATUS _WritePlainVtText(SCREEN_INFORMATION& screenInfo,
+                                  _In_reads_(cch) const wchar_t* const pwch,
+                                  const size_t cch)
+{
+    SCREEN_INFORMATION& activeBuffer = screenInfo.GetActiveBuffer();
+    Cursor& cursor = activeBuffer.GetTextBuffer().GetCursor();
+    cursor.SetIsOn(true);
+
+    NTSTATUS Status = STATUS_SUCCESS;
+    const wchar_t* const pwchEnd = pwch + cch;
+    const wchar_t* pwchSegment = pwch;
+    while (pwchSegment < pwchEnd && NT_SUCCESS(Status))
+    {
+        const wchar_t* const pwchNext = std::find(pwchSegment + 1, pwchEnd, UNICODE_BACKSPACE);
+        size_t cbSegment = (pwchNext - pwchSegment) * sizeof(wchar_t);
+        Status = WriteCharsLegacy(activeBuffer,
+                                  pwchSegment,
+                                  pwchSegment,
+                                  pwchSegment,
+                                  &cbSegment,
+                                  nullptr,
+                                  cursor.GetPosition().X,
+                                  WC_LIMIT_BACKSPACE | WC_NONDESTRUCTIVE_TAB | WC_DELAY_EOL_WRAP,
+                                  nullptr);
+        pwchSegment = pwchNext;
+    }
+
+    if (cch > 0)
+    {
+        auto& engine = static_cast<OutputStateMachineEngine&>(screenInfo.GetStateMachine().Engine());
+        engine.NotePlainTextWritten(pwch[cch - 1]);
+    }
+
+    return Status;
+}
+
 // Routine Description:
 // - This routine writes a string to the screen, processing any embedded
 //   unicode characters.  The string is also copied to the input buffer, if
 //   the output mode is line mode.
+// - In VT mode, plain text skips the state machine (see _IsPlainVtText).
 // Arguments:
 // - screenInfo - reference to screen buffer information structure.
 // - pwchBufferBackupLimit - Pointer to beginning of buffer.
@@ -981,8 +1075,19 @@ NTSTATUS WriteChars(SCREEN_INFORMATION& screenInfo,
                 StateMachine& machine = screenInfo.GetStateMachine();
                 size_t const cch = BufferSize / sizeof(WCHAR);
 
-                machine.ProcessString(pwchRealUnicode, cch);
-                *pcb += BufferSize;
+                if (_IsPlainVtText(machine, pwchRealUnicode, cch))
+                {
+                    Status = _WritePlainVtText(screenInfo, pwchRealUnicode, cch);
+                }
+                else
+                {
+                    machine.ProcessString(pwchRealUnicode, cch);
+                }
+
+                if (NT_SUCCESS(Status))
+                {
+                    *pcb += BufferSize;
+                }
             }
         }
 
@@ -1114,7 +1219,7 @@ HRESULT ApiRoutines::WriteConsoleAImpl(IConsoleOutputObject& context,
 {
     try
     {
-        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         // Ensure output variables are initialized.
         read = 0;
         waiter.reset();
@@ -1146,36 +1251,53 @@ HRESULT ApiRoutines::WriteConsoleAImpl(IConsoleOutputObject& context,
         size_t cchBuffer;
         if (codepage == CP_UTF8)
         {
-            wideCharBuffer.release();
-            unsigned int charCount;
-            unsigned int charsConsumed;
-            unsigned int charsGenerated;
-            RETURN_IF_FAILED(SizeTToUInt(buffer.size(), &charCount));
-            RETURN_IF_FAILED(parser.Parse(reinterpret_cast<const byte*>(buffer.data()),
-                                          charCount,
-                                          charsConsumed,
-                                          wideCharBuffer,
-                                          charsGenerated));
-
-            pwchBuffer = reinterpret_cast<wchar_t*>(wideCharBuffer.get());
-            cchBuffer = charsGenerated;
-            read = charsConsumed;
+            // Text that neither continues a sequence from a previous call nor
+            // ends in the middle of one converts straight into the scratch
+            // buffer. Anything else is left to the parser, which pieces
+            // sequences together across calls.
+            const auto scratch = gci.transcoder.GetWideScratch(buffer.size());
+            size_t cchConverted = 0;
+            if (!parser.HasPartialSequence() &&
+                SUCCEEDED(gci.transcoder.ToWide(CP_UTF8, MB_ERR_INVALID_CHARS, buffer, scratch, cchConverted)))
+            {
+                pwchBuffer = scratch.data();
+                cchBuffer = cchConverted;
+                read = buffer.size();
+            }
+            else
+            {
+                unsigned int charCount;
+                unsigned int charsConsumed;
+                unsigned int charsGenerated;
+                RETURN_IF_FAILED(SizeTToUInt(buffer.size(), &charCount));
+                RETURN_IF_FAILED(parser.Parse(reinterpret_cast<const byte*>(buffer.data()),
+                                              charCount,
+                                              charsConsumed,
+                                              wideCharBuffer,
+                                              charsGenerated));
+
+                pwchBuffer = reinterpret_cast<wchar_t*>(wideCharBuffer.get());
+                cchBuffer = charsGenerated;
+                read = charsConsumed;
+            }
         }
         else
         {
             NTSTATUS Status = STATUS_SUCCESS;
             PWCHAR TransBuffer;
             PWCHAR TransBufferOriginalLocation;
-            DWORD Length;
             ULONG dbcsNumBytes = 0;
             ULONG BufPtrNumBytes = 0;
             const char* BufPtr = buffer.data();
 
             // (cchTextBufferLength + 2) I think because we might be shoving another unicode char
             // from ScreenInfo->WriteConsoleDbcsLeadByte in front
-            TransBuffer = new WCHAR[buffer.size() + 2];
-            RETURN_IF_NULL_ALLOC(TransBuffer);
-            ZeroMemory(TransBuffer, sizeof(WCHAR) * (buffer.size() + 2));
+            const auto scratch = gci.transcoder.GetWideScratch(buffer.size() + 2);
+            TransBuffer = scratch.data();
+
+            // The first char is left alone when the stored lead byte can't be
+            // converted below, and has always been written out as a null then.
+            TransBuffer[0] = UNICODE_NULL;
 
             TransBufferOriginalLocation = TransBuffer;
 
@@ -1248,18 +1370,16 @@ HRESULT ApiRoutines::WriteConsoleAImpl(IConsoleOutputObject& context,
             if (BufPtrNumBytes != 0)
             {
                 // convert the remaining bytes in BufPtr to wide chars
-                Length = sizeof(WCHAR) * MultiByteToWideChar(gci.OutputCP,
-                                                             0,
-                                                             (LPCCH)BufPtr,
-                                                             BufPtrNumBytes,
-                                                             TransBuffer,
-                                                             BufPtrNumBytes);
-
-                if (Length == 0)
+                size_t cchConverted = 0;
+                if (FAILED(gci.transcoder.ToWide(gci.OutputCP,
+                                                 0,
+                                                 { BufPtr, BufPtrNumBytes },
+                                                 { TransBuffer, gsl::narrow<ptrdiff_t>(BufPtrNumBytes) },
+                                                 cchConverted)))
                 {
                     Status = STATUS_UNSUCCESSFUL;
                 }
-                BufPtrNumBytes = Length;
+                BufPtrNumBytes = gsl::narrow<ULONG>(sizeof(WCHAR) * cchConverted);
             }
 
             pwchBuffer = TransBufferOriginalLocation;
@@ -1326,12 +1446,6 @@ HRESULT ApiRoutines::WriteConsoleAImpl(IConsoleOutputObject& context,
             }
         }
 
-        // Free remaining data
-        if (codepage != CP_UTF8)
-        {
-            delete[] pwchBuffer;
-        }
-
         // Give back the waiter now that we're done with tinkering with it.
         waiter.reset(writeDataWaiter.release());
 
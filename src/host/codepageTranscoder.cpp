@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "codepageTranscoder.hpp"
+
+#include "../inc/unicode.hpp"
+#include "../types/inc/convert.hpp"
+
+// Routine Description:
+// - Creates a transcoder. No scratch storage is allocated until it's needed.
+CodepageTranscoder::CodepageTranscoder() noexcept :
+    _wide{},
+    _wideCapacity{ 0 },
+    _narrow{},
+    _narrowCapacity{ 0 },
+    _compatibilityCache{},
+    _nextCompatibilityEntry{ 0 }
+{
+}
+
+// Routine Description:
+// - Gets scratch storage for UTF-16 text, growing it if necessary. The
+//   contents are undefined, and only valid until the next call.
+// Arguments:
+// - count - the number of wchar_ts needed
+// Return Value:
+// - the scratch storage, exactly count long
+// Note:
+// - will throw if the storage has to grow and can't.
+gsl::span<wchar_t> CodepageTranscoder::GetWideScratch(const size_t count)
+{
+    if (count > _wideCapacity)
+    {
+        _wide = std::make_unique<wchar_t[]>(count);
+        _wideCapacity = count;
+    }
+    return { _wide.get(), gsl::narrow<ptrdiff_t>(count) };
+}
+
+// Routine Description:
+// - Gets scratch storage for codepage text, growing it if necessary. The
+//   contents are undefined, and only valid until the next call.
+// Arguments:
+// - count - the number of chars needed
+// Return Value:
+// - the scratch storage, exactly count long
+// Note:
+// - will throw if the storage has to grow and can't.
+gsl::span<char> CodepageTranscoder::GetNarrowScratch(const size_t count)
+{
+    if (count > _narrowCapacity)
+    {
+        _narrow = std::make_unique<char[]>(count);
+        _narrowCapacity = count;
+    }
+    return { _narrow.get(), gsl::narrow<ptrdiff_t>(count) };
+}
+
+// Routine Description:
+// - Checks whether the codepage maps the 128 ASCII characters to themselves,
+//   in both directions, so that ASCII text can be copied across without asking
+//   the codepage. This is true for UTF-8 and nearly every OEM and ANSI
+//   codepage, but not for EBCDIC or the 7-bit national codepages.
+// Arguments:
+// - codepage - the codepage to check
+// Return Value:
+// - true if ASCII can be copied across in the codepage.
+bool CodepageTranscoder::IsAsciiCompatible(const UINT codepage) noexcept
+{
+    // Unused entries are codepage 0 (CP_ACP), which is never looked up by
+    // that number, so they can't match.
+    for (const auto& entry : _compatibilityCache)
+    {
+        if (entry.codepage == codepage && codepage != 0)
+        {
+            return entry.compatible;
+        }
+    }
+
+    const bool compatible = s_CheckAsciiCompatible(codepage);
+    _compatibilityCache[_nextCompatibilityEntry] = { codepage, compatible };
+    _nextCompatibilityEntry = (_nextCompatibilityEntry + 1) % s_compatibilityCacheSize;
+    return compatible;
+}
+
+bool CodepageTranscoder::s_CheckAsciiCompatible(const UINT codepage) noexcept
+{
+    if (codepage == CP_UTF8)
+    {
+        return true;
+    }
+
+    char ascii[0x80];
+    wchar_t wide[0x80];
+    for (int i = 0; i < 0x80; i++)
+    {
+        ascii[i] = static_cast<char>(i);
+        wide[i] = static_cast<wchar_t>(i);
+    }
+
+    wchar_t toWide[0x80];
+    char toNarrow[0x80];
+    if (MultiByteToWideChar(codepage, 0, ascii, ARRAYSIZE(ascii), toWide, ARRAYSIZE(toWide)) != ARRAYSIZE(toWide) ||
+        WideCharToMultiByte(codepage, 0, wide, ARRAYSIZE(wide), toNarrow, ARRAYSIZE(toNarrow), nullptr, nullptr) != ARRAYSIZE(toNarrow))
+    {
+        return false;
+    }
+
+    return std::equal(std::begin(wide), std::end(wide), std::begin(toWide)) &&
+           std::equal(std::begin(ascii), std::end(ascii), std::begin(toNarrow));
+}
+
+// Routine Description:
+// - Converts codepage text to UTF-16. UTF-8 is converted by Utf8ToUtf16. For
+//   other codepages, leading ASCII is copied across directly when the
+//   codepage allows it, and the rest goes through MultiByteToWideChar.
+// Arguments:
+// - codepage - the codepage of the source text
+// - flags - the MultiByteToWideChar flags to convert the rest with
+// - source - the text to convert
+// - target - where to put the converted text
+// - written - on output, the number of wchar_ts written to target
+// Return Value:
+// - S_OK, or the error MultiByteToWideChar failed with. That includes
+//   ERROR_NO_UNICODE_TRANSLATION for an invalid or incomplete sequence when
+//   flags has MB_ERR_INVALID_CHARS. Failures aren't logged, so callers can
+//   use them to fall back to a slower path.
+[[nodiscard]]
+HRESULT CodepageTranscoder::ToWide(const UINT codepage,
+                                   const DWORD flags,
+                                   const std::string_view source,
+                                   const gsl::span<wchar_t> target,
+                                   _Out_ size_t& written) noexcept
+{
+    written = 0;
+
+    if (codepage == CP_UTF8)
+    {
+        return s_Utf8ToWide(flags, source, target, written);
+    }
+
+    size_t converted = 0;
+    if (IsAsciiCompatible(codepage))
+    {
+        converted = WidenAscii(source, target);
+    }
+
+    if (converted < source.size())
+    {
+        // MultiByteToWideChar would measure the text instead of converting it
+        // if it was given no room.
+        const size_t room = gsl::narrow_cast<size_t>(target.size()) - converted;
+        if (room == 0)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER);
+        }
+
+        int cchSource;
+        int cchTarget;
+        RETURN_IF_FAILED(SizeTToInt(source.size() - converted, &cchSource));
+        RETURN_IF_FAILED(SizeTToInt(room, &cchTarget));
+
+        const int cchConverted = MultiByteToWideChar(codepage,
+                                                     flags,
+                                                     source.data() + converted,
+                                                     cchSource,
+                                                     target.data() + converted,
+                                                     cchTarget);
+        if (cchConverted == 0)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+        converted += cchConverted;
+    }
+
+    written = converted;
+    return S_OK;
+}
+
+// Routine Description:
+// - Converts UTF-8 to UTF-16 like MultiByteToWideChar would, but with
+//   Utf8ToUtf16. Ill-formed text, including a sequence cut off by the end of
+//   the source, is replaced with U+FFFD or fails with MB_ERR_INVALID_CHARS.
+// Arguments:
+// - see ToWide
+// Return Value:
+// - see ToWide
+[[nodiscard]]
+HRESULT CodepageTranscoder::s_Utf8ToWide(const DWORD flags,
+                                        const std::string_view source,
+                                        const gsl::span<wchar_t> target,
+                                        _Out_ size_t& written) noexcept
+{
+    written = 0;
+
+    size_t consumed;
+    size_t produced;
+    const HRESULT hr = Utf8ToUtf16(source, target, consumed, produced);
+    if (WI_IsFlagSet(flags, MB_ERR_INVALID_CHARS) && (hr == S_FALSE || consumed < source.size()))
+    {
+        return HRESULT_FROM_WIN32(ERROR_NO_UNICODE_TRANSLATION);
+    }
+
+    if (consumed < source.size())
+    {
+        // The conversion stops early either for a lack of room, or at a
+        // sequence cut off by the end of the source. Only the latter leaves
+        // less than a whole sequence behind.
+        const size_t room = gsl::narrow_cast<size_t>(target.size()) - produced;
+        if (room == 0 || source.size() - consumed >= 4)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER);
+        }
+        target[produced++] = UNICODE_REPLACEMENT;
+    }
+
+    written = produced;
+    return S_OK;
+}
@@ -0,0 +1,68 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- codepageTranscoder.hpp
+
+Abstract:
+- Converts the text of the A versions of the console APIs to and from UTF-16
+  without allocating on every call.
+- The converted text is stored in scratch buffers that belong to the console
+  and keep their largest size, so once a client's writes have grown them, its
+  next writes don't allocate. The buffers are only valid until the next
+  conversion, and the console lock must be held while using them.
+- Runs of ASCII, which is most of what narrow clients write, are copied
+  across directly in codepages that map ASCII to itself, instead of going
+  through MultiByteToWideChar and WideCharToMultiByte.
+--*/
+
+#pragma once
+
+class CodepageTranscoder final
+{
+public:
+    CodepageTranscoder() noexcept;
+
+    gsl::span<wchar_t> GetWideScratch(const size_t count);
+    gsl::span<char> GetNarrowScratch(const size_t count);
+
+    bool IsAsciiCompatible(const UINT codepage) noexcept;
+
+    [[nodiscard]]
+    HRESULT ToWide(const UINT codepage,
+                   const DWORD flags,
+                   const std::string_view source,
+                   const gsl::span<wchar_t> target,
+                   _Out_ size_t& written) noexcept;
+
+private:
+    struct AsciiCompatibility
+    {
+        UINT codepage;
+        bool compatible;
+    };
+
+    static bool s_CheckAsciiCompatible(const UINT codepage) noexcept;
+
+    [[nodiscard]]
+    static HRESULT s_Utf8ToWide(const DWORD flags,
+                               const std::string_view source,
+                               const gsl::span<wchar_t> target,
+                               _Out_ size_t& written) noexcept;
+
+    std::unique_ptr<wchar_t[]> _wide;
+    size_t _wideCapacity;
+    std::unique_ptr<char[]> _narrow;
+    size_t _narrowCapacity;
+
+    // The input and output codepages are usually the only ones asked about,
+    // so a few entries are plenty.
+    static constexpr size_t s_compatibilityCacheSize = 4;
+    AsciiCompatibility _compatibilityCache[s_compatibilityCacheSize];
+    size_t _nextCompatibilityEntry;
+
+#ifdef UNIT_TESTING
+    friend class CodepageTranscoderTests;
+#endif
+};
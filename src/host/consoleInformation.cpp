@@ -9,6 +9,7 @@
 #include "srvinit.h"
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
+#include "..\server\ApiStatistics.h"
 #include "..\types\inc\convert.hpp"
 
 CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
@@ -30,51 +31,220 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
     // ColorTable initialized below
     // CPInfo initialized below
     // OutputCPInfo initialized below
+    transcoder{},
     _cookedReadData(nullptr),
     ConsoleIme{},
     terminalMouseInput(HandleTerminalKeyEventCallback),
     _vtIo(),
     _blinker{},
-    renderData{}
+    renderData{},
+    _consoleLockOwner{ 0 },
+    _consoleLockRecursion{ 0 },
+    _consoleLockAcquiredAt{ 0 },
+    _lockCounters{}
 {
     ZeroMemory((void*)&CPInfo, sizeof(CPInfo));
     ZeroMemory((void*)&OutputCPInfo, sizeof(OutputCPInfo));
-    InitializeCriticalSection(&_csConsoleLock);
+    InitializeSRWLock(&_srwConsoleLock);
 }
 
 CONSOLE_INFORMATION::~CONSOLE_INFORMATION()
 {
-    DeleteCriticalSection(&_csConsoleLock);
+}
+
+// How deep this thread's shared hold on the console lock is. SRW locks can't
+//      be acquired shared recursively, a waiting writer would block the inner
+//      acquire, so only the outermost one touches the lock.
+static thread_local ULONG t_sharedConsoleLockDepth = 0;
+
+// The shared hold this thread gave up to take the console lock exclusively. It
+//      is taken back once the exclusive hold ends. See LockConsole.
+static thread_local ULONG t_sharedConsoleLockDepthToRestore = 0;
+
+static LONGLONG s_QueryTicks() noexcept
+{
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter(&ticks);
+    return ticks.QuadPart;
 }
 
 bool CONSOLE_INFORMATION::IsConsoleLocked() const
 {
-    // The critical section structure's OwningThread field contains the ThreadId despite having the HANDLE type.
-    // This requires us to hard cast the ID to compare.
-    return _csConsoleLock.OwningThread == (HANDLE)GetCurrentThreadId();
+    // Only this thread can have stored its own ID here, so a relaxed load is enough.
+    return _consoleLockOwner.load(std::memory_order_relaxed) == GetCurrentThreadId();
 }
 
 #pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::LockConsole()
 {
-    EnterCriticalSection(&_csConsoleLock);
+    if (IsConsoleLocked())
+    {
+        _consoleLockRecursion++;
+        return;
+    }
+
+    // Waiting for the exclusive lock while holding it shared would wait on
+    //      ourselves forever. Nothing that runs under a shared hold should
+    //      ask for it exclusively, but if something does, the shared hold is
+    //      let go of and taken back once the exclusive one ends. What the
+    //      caller read under the shared hold may have changed in between, so
+    //      these are counted to be looked into.
+    if (t_sharedConsoleLockDepth != 0)
+    {
+        t_sharedConsoleLockDepthToRestore = std::exchange(t_sharedConsoleLockDepth, 0);
+        ReleaseSRWLockShared(&_srwConsoleLock);
+        _lockCounters.promotedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!TryAcquireSRWLockExclusive(&_srwConsoleLock))
+    {
+        const auto start = s_QueryTicks();
+        AcquireSRWLockExclusive(&_srwConsoleLock);
+        _CountLockWait(s_QueryTicks() - start);
+    }
+
+    _consoleLockOwner.store(GetCurrentThreadId(), std::memory_order_relaxed);
+    _consoleLockRecursion = 1;
+    _consoleLockAcquiredAt = s_QueryTicks();
+    _lockCounters.exclusiveAcquisitions.fetch_add(1, std::memory_order_relaxed);
 }
 
 #pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
 bool CONSOLE_INFORMATION::TryLockConsole()
 {
-    return !!TryEnterCriticalSection(&_csConsoleLock);
+    if (IsConsoleLocked())
+    {
+        _consoleLockRecursion++;
+        return true;
+    }
+
+    if (t_sharedConsoleLockDepth != 0 || !TryAcquireSRWLockExclusive(&_srwConsoleLock))
+    {
+        return false;
+    }
+
+    _consoleLockOwner.store(GetCurrentThreadId(), std::memory_order_relaxed);
+    _consoleLockRecursion = 1;
+    _consoleLockAcquiredAt = s_QueryTicks();
+    _lockCounters.exclusiveAcquisitions.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
 #pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::UnlockConsole()
 {
-    LeaveCriticalSection(&_csConsoleLock);
+    if (--_consoleLockRecursion != 0)
+    {
+        return;
+    }
+
+    // Only the owner updates the longest hold, so this can't race with another store.
+    const auto held = s_QueryTicks() - _consoleLockAcquiredAt;
+    _lockCounters.exclusiveHoldTicks.fetch_add(held, std::memory_order_relaxed);
+    if (held > _lockCounters.longestExclusiveHoldTicks.load(std::memory_order_relaxed))
+    {
+        _lockCounters.longestExclusiveHoldTicks.store(held, std::memory_order_relaxed);
+    }
+
+    _consoleLockOwner.store(0, std::memory_order_relaxed);
+    ReleaseSRWLockExclusive(&_srwConsoleLock);
+
+    if (t_sharedConsoleLockDepthToRestore != 0)
+    {
+        // This exclusive hold was taken in the middle of a shared one.
+        if (!TryAcquireSRWLockShared(&_srwConsoleLock))
+        {
+            const auto start = s_QueryTicks();
+            AcquireSRWLockShared(&_srwConsoleLock);
+            _CountLockWait(s_QueryTicks() - start);
+        }
+        t_sharedConsoleLockDepth = std::exchange(t_sharedConsoleLockDepthToRestore, 0);
+    }
 }
 
 ULONG CONSOLE_INFORMATION::GetCSRecursionCount()
 {
-    return _csConsoleLock.RecursionCount;
+    return IsConsoleLocked() ? _consoleLockRecursion : 0;
+}
+
+// Routine Description:
+// - Locks the console for reading only. Any number of threads can hold it
+//   shared at once, but not while another thread holds it exclusively.
+// - If this thread already holds it exclusively, that hold is just extended.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+#pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::LockConsoleShared()
+{
+    if (IsConsoleLocked())
+    {
+        _consoleLockRecursion++;
+        return;
+    }
+
+    if (t_sharedConsoleLockDepth++ != 0)
+    {
+        return;
+    }
+
+    if (!TryAcquireSRWLockShared(&_srwConsoleLock))
+    {
+        const auto start = s_QueryTicks();
+        AcquireSRWLockShared(&_srwConsoleLock);
+        _CountLockWait(s_QueryTicks() - start);
+    }
+
+    _lockCounters.sharedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Routine Description:
+// - Undoes one call to LockConsoleShared.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+#pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::UnlockConsoleShared()
+{
+    if (t_sharedConsoleLockDepth == 0)
+    {
+        // It was taken as part of an exclusive hold.
+        UnlockConsole();
+        return;
+    }
+
+    if (--t_sharedConsoleLockDepth == 0)
+    {
+        ReleaseSRWLockShared(&_srwConsoleLock);
+    }
+}
+
+// Routine Description:
+// - Gets how the console lock has been used since the console started.
+// Arguments:
+// - <none>
+// Return Value:
+// - A copy of the counters.
+ConsoleLockStatistics CONSOLE_INFORMATION::GetLockStatistics() const noexcept
+{
+    ConsoleLockStatistics statistics;
+    statistics.exclusiveAcquisitions = _lockCounters.exclusiveAcquisitions.load(std::memory_order_relaxed);
+    statistics.sharedAcquisitions = _lockCounters.sharedAcquisitions.load(std::memory_order_relaxed);
+    statistics.promotedAcquisitions = _lockCounters.promotedAcquisitions.load(std::memory_order_relaxed);
+    statistics.contendedAcquisitions = _lockCounters.contendedAcquisitions.load(std::memory_order_relaxed);
+    statistics.waitTicks = _lockCounters.waitTicks.load(std::memory_order_relaxed);
+    statistics.exclusiveHoldTicks = _lockCounters.exclusiveHoldTicks.load(std::memory_order_relaxed);
+    statistics.longestExclusiveHoldTicks = _lockCounters.longestExclusiveHoldTicks.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void CONSOLE_INFORMATION::_CountLockWait(const LONGLONG waitTicks) noexcept
+{
+    _lockCounters.contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+    _lockCounters.waitTicks.fetch_add(waitTicks, std::memory_order_relaxed);
+    ApiStatistics::s_AddLockWait(waitTicks);
 }
 
 // Routine Description:
@@ -151,6 +151,9 @@ BOOL IsAvailableEastAsianCodePage(const UINT uiCodePage)
     }
 }
 
+// Routine Description:
+// - Converts the chars a read returns to the input codepage, as many as fit.
+// - The two buffers must not overlap.
 _Ret_range_(0, cbAnsi)
 ULONG TranslateUnicodeToOem(_In_reads_(cchUnicode) PCWCHAR pwchUnicode,
                             const ULONG cchUnicode,
@@ -158,14 +161,8 @@ ULONG TranslateUnicodeToOem(_In_reads_(cchUnicode) PCWCHAR pwchUnicode,
                             const ULONG cbAnsi,
                             _Out_ std::unique_ptr<IInputEvent>& partialEvent)
 {
-    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    PWCHAR const TmpUni = new(std::nothrow) WCHAR[cchUnicode];
-    if (TmpUni == nullptr)
-    {
-        return 0;
-    }
-
-    memcpy(TmpUni, pwchUnicode, cchUnicode* sizeof(WCHAR));
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const bool asciiCompatible = gci.transcoder.IsAsciiCompatible(gci.CP);
 
     BYTE AsciiDbcs[2];
     AsciiDbcs[1] = 0;
@@ -173,10 +170,21 @@ ULONG TranslateUnicodeToOem(_In_reads_(cchUnicode) PCWCHAR pwchUnicode,
     ULONG i, j;
     for (i = 0, j = 0; i < cchUnicode && j < cbAnsi; i++, j++)
     {
-        if (IsGlyphFullWidth(TmpUni[i]))
+        if (asciiCompatible && pwchUnicode[i] < 0x80)
+        {
+            // Copy the whole run of ASCII across at once, instead of asking
+            // the codepage about every char of it.
+            const size_t copied = NarrowAscii({ pwchUnicode + i, cchUnicode - i },
+                                              { pchAnsi + j, gsl::narrow<ptrdiff_t>(cbAnsi - j) });
+
+            // The loop steps past the last one.
+            i += gsl::narrow_cast<ULONG>(copied) - 1;
+            j += gsl::narrow_cast<ULONG>(copied) - 1;
+        }
+        else if (IsGlyphFullWidth(pwchUnicode[i]))
         {
             ULONG const NumBytes = sizeof(AsciiDbcs);
-            ConvertToOem(gci.CP, &TmpUni[i], 1, (LPSTR) & AsciiDbcs[0], NumBytes);
+            ConvertToOem(gci.CP, &pwchUnicode[i], 1, (LPSTR) & AsciiDbcs[0], NumBytes);
             if (IsDBCSLeadByteConsole(AsciiDbcs[0], &gci.CPInfo))
             {
                 if (j < cbAnsi - 1)
@@ -200,7 +208,7 @@ ULONG TranslateUnicodeToOem(_In_reads_(cchUnicode) PCWCHAR pwchUnicode,
         }
         else
         {
-            ConvertToOem(gci.CP, &TmpUni[i], 1, &pchAnsi[j], 1);
+            ConvertToOem(gci.CP, &pwchUnicode[i], 1, &pchAnsi[j], 1);
         }
     }
 
@@ -221,6 +229,5 @@ ULONG TranslateUnicodeToOem(_In_reads_(cchUnicode) PCWCHAR pwchUnicode,
         }
     }
 
-    delete[] TmpUni;
     return j;
 }
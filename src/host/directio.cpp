@@ -133,8 +133,9 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 //   from the input buffer and in the peek case they are not.
 // Arguments:
 // - pInputBuffer - The input buffer to take records from to return to the client
-// - outEvents - The storage location to fill with input events
-// - eventReadCount - The number of events to read
+// - buffer - The storage location to fill with input events. Its size is the
+// number of events to read.
+// - written - on output, the number of events stored in buffer
 // - pInputReadHandleData - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -154,8 +155,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - Or an out of memory/math/string error message in NTSTATUS format.
 [[nodiscard]]
 static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
-                                   std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                   const size_t eventReadCount,
+                                   gsl::span<INPUT_RECORD> buffer,
+                                   size_t& written,
                                    INPUT_READ_HANDLE_DATA& readHandleState,
                                    const bool IsUnicode,
                                    const bool IsPeek,
@@ -163,8 +164,10 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
 {
     try
     {
+        written = 0;
         waiter.reset();
 
+        const size_t eventReadCount = gsl::narrow<size_t>(buffer.size());
         if (eventReadCount == 0)
         {
             return STATUS_SUCCESS;
@@ -173,13 +176,33 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-        std::deque<std::unique_ptr<IInputEvent>> partialEvents;
-        if (!IsUnicode)
+        // Unicode records are copied straight into the client's buffer.
+        if (IsUnicode)
         {
-            if (inputBuffer.IsReadPartialByteSequenceAvailable())
+            const NTSTATUS Status = inputBuffer.Read(buffer,
+                                                     written,
+                                                     IsPeek,
+                                                     true,
+                                                     true,
+                                                     false);
+
+            if (CONSOLE_STATUS_WAIT == Status)
             {
-                partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek));
+                FAIL_FAST_IF(written != 0);
+                waiter = std::make_unique<DirectReadData>(&inputBuffer,
+                                                          &readHandleState,
+                                                          eventReadCount,
+                                                          std::deque<std::unique_ptr<IInputEvent>>{});
             }
+            return Status;
+        }
+
+        // Codepage reads may split a character into several records, and keep
+        //      a piece of one for the next read, which is done on events.
+        std::deque<std::unique_ptr<IInputEvent>> partialEvents;
+        if (inputBuffer.IsReadPartialByteSequenceAvailable())
+        {
+            partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek));
         }
 
         size_t amountToRead;
@@ -207,15 +230,12 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
         }
         else if (NT_SUCCESS(Status))
         {
-            // split key events to oem chars if necessary
-            if (!IsUnicode)
+            // split key events to oem chars
+            try
             {
-                try
-                {
-                    SplitToOem(readEvents);
-                }
-                CATCH_LOG();
+                SplitToOem(readEvents);
             }
+            CATCH_LOG();
 
             // combine partial and readEvents
             while (!partialEvents.empty())
@@ -225,14 +245,11 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
             }
 
             // move events over
-            for (size_t i = 0; i < eventReadCount; ++i)
+            while (written < eventReadCount && !readEvents.empty())
             {
-                if (readEvents.empty())
-                {
-                    break;
-                }
-                outEvents.push_back(std::move(readEvents.front()));
+                buffer[written] = readEvents.front()->ToInputRecord();
                 readEvents.pop_front();
+                ++written;
             }
 
             // store partial event if necessary
@@ -257,8 +274,8 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - buffer - storage location for read events. Its size is the number of events to read.
+// - written - on output, the number of events stored in buffer
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -269,16 +286,16 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> buffer,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           buffer,
+                                           written,
                                            readHandleState,
                                            false,
                                            true,
@@ -293,8 +310,8 @@ HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - buffer - storage location for read events. Its size is the number of events to read.
+// - written - on output, the number of events stored in buffer
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -305,16 +322,16 @@ HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> buffer,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           buffer,
+                                           written,
                                            readHandleState,
                                            true,
                                            true,
@@ -329,8 +346,8 @@ HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - buffer - storage location for read events. Its size is the number of events to read.
+// - written - on output, the number of events stored in buffer
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -341,16 +358,16 @@ HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> buffer,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           buffer,
+                                           written,
                                            readHandleState,
                                            false,
                                            false,
@@ -365,8 +382,8 @@ HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - buffer - storage location for read events. Its size is the number of events to read.
+// - written - on output, the number of events stored in buffer
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -377,16 +394,16 @@ HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> buffer,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           buffer,
+                                           written,
                                            readHandleState,
                                            true,
                                            false,
@@ -449,6 +466,29 @@ HRESULT DoSrvPrivateWriteConsoleInputW(_Inout_ InputBuffer* const pInputBuffer,
     return _WriteConsoleInputWImplHelper(*pInputBuffer, events, eventsWritten, append);
 }
 
+// Routine Description:
+// - Types a string into the end of the input buffer as key events (private call)
+// Arguments:
+// - pInputBuffer - the input buffer to write to
+// - text - the string to type
+// - eventsWritten - on output, the number of events written
+// Return Value:
+// - HRESULT indicating success or failure
+[[nodiscard]]
+HRESULT DoSrvPrivateWriteConsoleInputText(_Inout_ InputBuffer* const pInputBuffer,
+                                          const std::wstring_view text,
+                                          _Out_ size_t& eventsWritten) noexcept
+{
+    eventsWritten = 0;
+    try
+    {
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        eventsWritten = pInputBuffer->WriteText(text, gci.OutputCP);
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
 // Routine Description:
 // - Writes events to the input buffer, translating from codepage to unicode first
 // Arguments:
@@ -590,6 +630,10 @@ HRESULT DoSrvPrivateWriteConsoleControlInput(_Inout_ InputBuffer* const /*pInput
 // Routine Description:
 // - This is used when the app is reading output as cells and needs them converted
 //   into a particular codepage on the way out.
+// - The conversion happens in a single pass over the buffer. Cells that are
+//   dropped (a trailing half without its leading half) only ever make the
+//   output fall behind the input, so every cell is read before it can be
+//   overwritten and no copy of the buffer is needed.
 // Arguments:
 // - codepage - The relevant codepage for translation
 // - buffer - This is the buffer containing all of the character data to be converted
@@ -601,10 +645,8 @@ static HRESULT _ConvertCellsToAInplace(const UINT codepage, const gsl::span<CHAR
 {
     try
     {
-        std::vector<CHAR_INFO> tempBuffer(buffer.cbegin(), buffer.cend());
-
         const auto size = rectangle.Dimensions();
-        auto tempIter = tempBuffer.cbegin();
+        auto readIter = buffer.cbegin();
         auto outIter = buffer.begin();
 
         for (int i = 0; i < size.Y; i++)
@@ -614,7 +656,7 @@ static HRESULT _ConvertCellsToAInplace(const UINT codepage, const gsl::span<CHAR
                 // Any time we see the lead flag, we presume there will be a trailing one following it.
                 // Giving us two bytes of space (one per cell in the ascii part of the character union)
                 // to fill with whatever this Unicode character converts into.
-                if (WI_IsFlagSet(tempIter->Attributes, COMMON_LVB_LEADING_BYTE))
+                if (WI_IsFlagSet(readIter->Attributes, COMMON_LVB_LEADING_BYTE))
                 {
                     // As long as we're not looking at the exact last column of the buffer...
                     if (j < size.X - 1)
@@ -622,40 +664,48 @@ static HRESULT _ConvertCellsToAInplace(const UINT codepage, const gsl::span<CHAR
                         // Walk forward one because we're about to consume two cells.
                         j++;
 
+                        // Read both cells before writing, the output might be sitting on top of them.
+                        const WCHAR wch = readIter->Char.UnicodeChar;
+                        const WORD leadingAttributes = readIter->Attributes;
+                        const WORD trailingAttributes = (readIter + 1)->Attributes;
+                        readIter += 2;
+
                         // Try to convert the unicode character (2 bytes) in the leading cell to the codepage.
                         CHAR AsciiDbcs[2] = { 0 };
                         UINT NumBytes = gsl::narrow<UINT>(sizeof(AsciiDbcs));
-                        NumBytes = ConvertToOem(codepage, &tempIter->Char.UnicodeChar, 1, &AsciiDbcs[0], NumBytes);
+                        NumBytes = ConvertToOem(codepage, &wch, 1, &AsciiDbcs[0], NumBytes);
 
                         // Fill the 1 byte (AsciiChar) portion of the leading and trailing cells with each of the bytes returned.
                         outIter->Char.AsciiChar = AsciiDbcs[0];
-                        outIter->Attributes = tempIter->Attributes;
+                        outIter->Attributes = leadingAttributes;
                         outIter++;
-                        tempIter++;
                         outIter->Char.AsciiChar = AsciiDbcs[1];
-                        outIter->Attributes = tempIter->Attributes;
+                        outIter->Attributes = trailingAttributes;
                         outIter++;
-                        tempIter++;
                     }
                     else
                     {
                         // When we're in the last column with only a leading byte, we can't return that without a trailing.
                         // Instead, replace the output data with just a space and clear all flags.
+                        const WORD attributes = readIter->Attributes;
                         outIter->Char.AsciiChar = UNICODE_SPACE;
-                        outIter->Attributes = tempIter->Attributes;
+                        outIter->Attributes = attributes;
                         WI_ClearAllFlags(outIter->Attributes, COMMON_LVB_SBCSDBCS);
                         outIter++;
-                        tempIter++;
+                        readIter++;
                     }
                 }
-                else if (WI_AreAllFlagsClear(tempIter->Attributes, COMMON_LVB_SBCSDBCS))
+                else if (WI_AreAllFlagsClear(readIter->Attributes, COMMON_LVB_SBCSDBCS))
                 {
                     // If there are no leading/trailing pair flags, then we only have 1 ascii byte to try to fit the
                     // 2 byte UTF-16 character into. Give it a go.
-                    ConvertToOem(codepage, &tempIter->Char.UnicodeChar, 1, &outIter->Char.AsciiChar, 1);
-                    outIter->Attributes = tempIter->Attributes;
+                    const WCHAR wch = readIter->Char.UnicodeChar;
+                    const WORD attributes = readIter->Attributes;
+                    readIter++;
+
+                    ConvertToOem(codepage, &wch, 1, &outIter->Char.AsciiChar, 1);
+                    outIter->Attributes = attributes;
                     outIter++;
-                    tempIter++;
                 }
             }
         }
@@ -806,6 +856,47 @@ static std::vector<CHAR_INFO> _ConvertCellsToMungedW(gsl::span<CHAR_INFO> buffer
     return result;
 }
 
+// Routine Description:
+// - Copies a span of one row of the buffer into CHAR_INFOs. The colors are
+//   converted to the legacy format once per run of the row, not once per cell.
+// Arguments:
+// - gci - The console, which decides how colors map to the legacy format
+// - row - The row to read from
+// - column - The first column of the row to read
+// - target - Where to put the cells. Its size is the number of cells to read.
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error.
+static void _ReadRowAsCharInfos(const CONSOLE_INFORMATION& gci,
+                                const ROW& row,
+                                const size_t column,
+                                gsl::span<CHAR_INFO> target)
+{
+    const auto& charRow = row.GetCharRow();
+    const auto& attrRow = row.GetAttrRow();
+
+    auto cellIter = charRow.cbegin() + column;
+    auto targetIter = target.begin();
+    size_t currentColumn = column;
+    while (targetIter < target.end())
+    {
+        size_t applies = 0;
+        const auto attr = attrRow.GetAttrByColumn(currentColumn, &applies);
+        const WORD legacyAttributes = gci.GenerateLegacyAttributes(attr);
+
+        const auto runEnd = targetIter + std::min<ptrdiff_t>(applies, target.end() - targetIter);
+        currentColumn += runEnd - targetIter;
+        for (; targetIter < runEnd; ++targetIter, ++cellIter)
+        {
+            // A glyph stored outside the row is more than one UTF-16 unit, so it can't fit in a CHAR_INFO.
+            const auto& dbcsAttr = cellIter->DbcsAttr();
+            targetIter->Char.UnicodeChar = dbcsAttr.IsGlyphStored() ? UNICODE_REPLACEMENT : cellIter->Char();
+            targetIter->Attributes = legacyAttributes | dbcsAttr.GeneratePublicApiAttributeFormat();
+        }
+    }
+}
+
 [[nodiscard]]
 static HRESULT _ReadConsoleOutputWImplHelper(const SCREEN_INFORMATION& context,
                                              gsl::span<CHAR_INFO> targetBuffer,
@@ -854,41 +945,28 @@ static HRESULT _ReadConsoleOutputWImplHelper(const SCREEN_INFORMATION& context,
         // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
         const auto sourcePoint = clippedRequestRectangle.Origin();
 
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        COORD targetPos = { 0 };
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backgin store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        // Copy the clipped request one row at a time, straight out of the row storage.
+        // The target rows are laid out at the width of the original request, and
+        // might be offset if we clipped the top or left of the request.
+        const auto& textBuffer = storageBuffer.GetTextBuffer();
+        const auto readSize = clippedRequestRectangle.Dimensions();
+        for (SHORT row = 0; row < readSize.Y; row++)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
-            {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                sourceIter++;
-            }
-
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            targetIter++;
+            ptrdiff_t targetOffset = 0;
+            RETURN_IF_FAILED(PtrdiffTMult(targetPoint.Y + row, targetSize.X, &targetOffset));
+            RETURN_IF_FAILED(PtrdiffTAdd(targetOffset, targetPoint.X, &targetOffset));
 
-            // Increment the target
-            targetPos.X++;
-            if (targetPos.X >= targetSize.X)
+            // Stop at the end of the user's buffer, even partway through a row.
+            if (targetOffset >= targetBuffer.size())
             {
-                targetPos.X = 0;
-                targetPos.Y++;
+                break;
             }
+            const auto count = std::min<ptrdiff_t>(readSize.X, targetBuffer.size() - targetOffset);
+
+            _ReadRowAsCharInfos(gci,
+                                textBuffer.GetRowByOffset(sourcePoint.Y + row),
+                                sourcePoint.X,
+                                targetBuffer.subspan(targetOffset, count));
         }
 
         // Reply with the region we read out of the backing buffer (potentially clipped)
@@ -928,8 +1006,8 @@ HRESULT ApiRoutines::ReadConsoleOutputWImpl(const SCREEN_INFORMATION& context,
                                             const Microsoft::Console::Types::Viewport& sourceRectangle,
                                             Microsoft::Console::Types::Viewport& readRectangle) noexcept
 {
-    LockConsole();
-    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+    LockConsoleShared();
+    auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
     try
     {
@@ -1038,12 +1116,9 @@ static HRESULT _WriteConsoleOutputWImplHelper(SCREEN_INFORMATION& context,
             // Now we make a subspan starting from that offset for as much of the original request as would fit
             const auto subspan = buffer.subspan(totalOffset, writeRectangle.Width());
 
-            // Convert to a CHAR_INFO view to fit into the iterator
+            // Convert to a CHAR_INFO view and store it into the row as a block.
             const auto charInfos = std::basic_string_view<CHAR_INFO>(subspan.data(), subspan.size());
-
-            // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
+            storageBuffer.GetTextBuffer().WriteCharInfos(charInfos, target);
         }
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
@@ -27,6 +27,11 @@ HRESULT DoSrvPrivateWriteConsoleInputW(_Inout_ InputBuffer* const pInputBuffer,
                                        _Out_ size_t& eventsWritten,
                                        const bool append) noexcept;
 
+[[nodiscard]]
+HRESULT DoSrvPrivateWriteConsoleInputText(_Inout_ InputBuffer* const pInputBuffer,
+                                          const std::wstring_view text,
+                                          _Out_ size_t& eventsWritten) noexcept;
+
 [[nodiscard]]
 NTSTATUS ConsoleCreateScreenBuffer(std::unique_ptr<ConsoleHandleData>& handle,
                                    _In_ PCONSOLE_API_MSG Message,
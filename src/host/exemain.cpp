@@ -5,6 +5,7 @@
 
 #include "ConsoleArguments.hpp"
 #include "srvinit.h"
+#include "Benchmark.hpp"
 #include "..\server\Entrypoints.h"
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
@@ -166,6 +167,13 @@ int CALLBACK wWinMain(
                           GetStdHandle(STD_OUTPUT_HANDLE));
 
     HRESULT hr = args.ParseCommandline();
+    if (SUCCEEDED(hr) && args.IsBenchmark())
+    {
+        // The benchmark needs neither a client nor the driver, and there's
+        //      nothing to keep running once it has written its report.
+        ServiceLocator::RundownAndExit(RunBenchmark(args));
+    }
+
     if (SUCCEEDED(hr))
     {
         if (ShouldUseLegacyConhost(args.GetForceV1()))
@@ -42,8 +42,8 @@ void ApiRoutines::GetConsoleInputModeImpl(InputBuffer& context, ULONG& mode) noe
     {
         Telemetry::Instance().LogApiCall(Telemetry::ApiCall::GetConsoleMode);
         const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         mode = context.InputMode;
 
@@ -67,8 +67,8 @@ void ApiRoutines::GetConsoleOutputModeImpl(SCREEN_INFORMATION& context, ULONG& m
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         mode = context.GetActiveBuffer().OutputMode;
     }
@@ -87,8 +87,8 @@ HRESULT ApiRoutines::GetNumberOfConsoleInputEventsImpl(const InputBuffer& contex
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         const auto readyEventCount = context.GetNumberOfReadyEvents();
         RETURN_IF_FAILED(SizeTToULong(readyEventCount, &events));
@@ -108,8 +108,8 @@ void ApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& con
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         data.bFullscreenSupported = FALSE; // traditional full screen with the driver support is no longer supported.
         // see MSFT: 19918103
@@ -146,8 +146,8 @@ void ApiRoutines::GetConsoleCursorInfoImpl(const SCREEN_INFORMATION& context,
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         size = context.GetActiveBuffer().GetTextBuffer().GetCursor().GetSize();
         isVisible = context.GetTextBuffer().GetCursor().IsVisible();
@@ -26,3 +26,18 @@ void UnlockConsole()
         gci.UnlockConsole();
     }
 }
+
+// Shared holds don't process ctrl events on the way out. They only read, so
+//      they can't have queued any, and an exclusive hold this one is part of
+//      will process them when it ends.
+void LockConsoleShared()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsoleShared();
+}
+
+void UnlockConsoleShared()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.UnlockConsoleShared();
+}
@@ -19,3 +19,5 @@ Revision History:
 
 void LockConsole();
 void UnlockConsole();
+void LockConsoleShared();
+void UnlockConsoleShared();
@@ -5,6 +5,7 @@
 #include "inputBuffer.hpp"
 #include "dbcs.h"
 #include "stream.h"
+#include "../types/inc/convert.hpp"
 #include "../types/inc/GlyphWidth.hpp"
 
 #include <functional>
@@ -209,11 +210,44 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event)
+    _storage.RemoveIf([](const INPUT_RECORD& record)
     {
-        return event->EventType() != InputEventType::KeyEvent;
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
+}
+
+// Routine Description:
+// - This routine reads from the input buffer into the given records.
+// - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
+//   if there isn't enough data in the buffer, and it can be set to not remove records as it reads them out.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - OutRecords - where to store the read events. Its size is the amount of events to try to read.
+// - EventsRead - on output, the number of events stored in OutRecords
+// - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. OutRecords must have a size of 1 if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]]
+NTSTATUS InputBuffer::Read(const gsl::span<INPUT_RECORD> OutRecords,
+                           _Out_ size_t& EventsRead,
+                           const bool Peek,
+                           const bool WaitForData,
+                           const bool Unicode,
+                           const bool Stream)
+{
+    return _Read(OutRecords,
+                 gsl::narrow_cast<size_t>(OutRecords.size()),
+                 EventsRead,
+                 Peek,
+                 WaitForData,
+                 Unicode,
+                 Stream);
 }
 
 // Routine Description:
@@ -243,39 +277,22 @@ NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEv
 {
     try
     {
-        if (_storage.empty())
-        {
-            if (!WaitForData)
-            {
-                return STATUS_SUCCESS;
-            }
-            return CONSOLE_STATUS_WAIT;
-        }
-
-        // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
-        size_t eventsRead;
-        bool resetWaitEvent;
-        _ReadBuffer(events,
-                    AmountToRead,
-                    eventsRead,
-                    Peek,
-                    resetWaitEvent,
-                    Unicode,
-                    Stream);
-
-        // copy events to outEvents
-        while (!events.empty())
-        {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
-        }
-
-        if (resetWaitEvent)
+        // No more than what's stored can be read, whatever was asked for.
+        std::vector<INPUT_RECORD> records(std::min(AmountToRead, _storage.size()));
+        size_t eventsRead = 0;
+        const NTSTATUS Status = _Read(records,
+                                      AmountToRead,
+                                      eventsRead,
+                                      Peek,
+                                      WaitForData,
+                                      Unicode,
+                                      Stream);
+
+        for (size_t i = 0; i < eventsRead; ++i)
         {
-            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+            OutEvents.push_back(IInputEvent::Create(records[i]));
         }
-        return STATUS_SUCCESS;
+        return Status;
     }
     catch (...)
     {
@@ -309,16 +326,17 @@ NTSTATUS InputBuffer::Read(_Out_ std::unique_ptr<IInputEvent>& outEvent,
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
-                      1,
+        INPUT_RECORD record;
+        size_t eventsRead = 0;
+        Status = Read({ &record, 1 },
+                      eventsRead,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (eventsRead > 0)
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(record);
         }
     }
     catch (...)
@@ -329,10 +347,66 @@ NTSTATUS InputBuffer::Read(_Out_ std::unique_ptr<IInputEvent>& outEvent,
     return Status;
 }
 
+// Routine Description:
+// - Reads from the input buffer and signals when it has become empty.
+// Arguments:
+// - outRecords - where to store the read events. Must be large enough to hold readCount events,
+//   or as many as are stored, whichever is less.
+// - readCount - the amount of events to try to read
+// - eventsRead - on output, the number of events stored in outRecords
+// - peek - If true, copy events to outRecords but don't remove them from the input buffer.
+// - waitForData - if true, wait until an event is input. if false, return immediately
+// - unicode - true if the data in key events should be treated as unicode.
+// - stream - true if read should unpack KeyEvents that have a >1 repeat count.
+// Return Value:
+// - STATUS_SUCCESS, CONSOLE_STATUS_WAIT or an error in NTSTATUS form, as for Read.
+[[nodiscard]]
+NTSTATUS InputBuffer::_Read(const gsl::span<INPUT_RECORD> outRecords,
+                            const size_t readCount,
+                            _Out_ size_t& eventsRead,
+                            const bool peek,
+                            const bool waitForData,
+                            const bool unicode,
+                            const bool stream)
+{
+    eventsRead = 0;
+    try
+    {
+        if (_storage.empty())
+        {
+            if (!waitForData)
+            {
+                return STATUS_SUCCESS;
+            }
+            return CONSOLE_STATUS_WAIT;
+        }
+
+        // read from buffer
+        bool resetWaitEvent;
+        _ReadBuffer(outRecords,
+                    readCount,
+                    eventsRead,
+                    peek,
+                    resetWaitEvent,
+                    unicode,
+                    stream);
+
+        if (resetWaitEvent)
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+        return STATUS_SUCCESS;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
+// - outRecords - where read events are placed
 // - readCount - amount of events to read
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
@@ -343,7 +417,7 @@ NTSTATUS InputBuffer::Read(_Out_ std::unique_ptr<IInputEvent>& outEvent,
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+void InputBuffer::_ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                               const size_t readCount,
                               _Out_ size_t& eventsRead,
                               const bool peek,
@@ -356,96 +430,58 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
     FAIL_FAST_IF(streamRead && readCount != 1);
 
     resetWaitEvent = false;
+    eventsRead = 0;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
     // of events actually put into outRecords.
     size_t virtualReadCount = 0;
 
-    while (!_storage.empty() && virtualReadCount < readCount)
+    // When peeking, nothing is removed, so walk the storage by position instead.
+    size_t peekIndex = 0;
+
+    while (peekIndex < _storage.size() &&
+           virtualReadCount < readCount &&
+           eventsRead < gsl::narrow_cast<size_t>(outRecords.size()))
     {
-        bool performNormalRead = true;
+        INPUT_RECORD& storedRecord = _storage[peekIndex];
+        INPUT_RECORD& outRecord = outRecords[eventsRead];
+        outRecord = storedRecord;
+
         // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
+        if (streamRead &&
+            storedRecord.EventType == KEY_EVENT &&
+            storedRecord.Event.KeyEvent.wRepeatCount > 1)
         {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
+            // split the key event, leaving the rest of the repeats stored
+            outRecord.Event.KeyEvent.wRepeatCount = 1;
+            if (!peek)
             {
-                KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    std::unique_ptr<KeyEvent> streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
+                storedRecord.Event.KeyEvent.wRepeatCount--;
             }
         }
-
-        if (performNormalRead)
+        else if (peek)
+        {
+            ++peekIndex;
+        }
+        else
         {
-            readEvents.push_back(std::move(_storage.front()));
             _storage.pop_front();
         }
 
+        ++eventsRead;
         ++virtualReadCount;
         if (!unicode)
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
-            {
-                const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
-            }
-        }
-    }
-
-    // the amount of events that were actually read
-    eventsRead = readEvents.size();
-
-    // copy the events back if we were supposed to peek
-    if (peek)
-    {
-        if (streamRead)
-        {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                                static_cast<const KeyEvent&>(*_storage.front())))
+            if (outRecord.EventType == KEY_EVENT &&
+                IsGlyphFullWidth(outRecord.Event.KeyEvent.uChar.UnicodeChar))
             {
-                KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
-            else
-            {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
-            }
-        }
-        else
-        {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
-            {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
+                ++virtualReadCount;
             }
         }
     }
 
-    // move events read to proper deque
-    while (!readEvents.empty())
-    {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
-    }
-
     // signal if we emptied the buffer
     if (_storage.empty())
     {
@@ -456,18 +492,18 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 // Routine Description:
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
-// - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
+// - inRecords - events to write to buffer.
 // Return Value:
-// S_OK if successful.
+// - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> keptRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, keptRecords);
+        if (records.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -476,18 +512,18 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
+        std::vector<INPUT_RECORD> existingStorage(_storage.size());
+        _storage.Read(existingStorage);
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
+        // However, because we emptied the storage, it will always
+        // return true after the first one (as it is filling the newly emptied storage.)
         // Then after the second one, because we've inserted some input, it will always say false.
         bool unusedWaitStatus = false;
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(records, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         // write all previously existing records
@@ -499,9 +535,8 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // input queue when we started.
         // Because we did interesting manipulation of the wait queue
         // in order to prepend, we can't trust what _WriteBuffer said
-        // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
-        // when this whole thing started.
+        // and instead need to set the event if the original
+        // storage was empty when this whole thing started.
         if (existingStorage.empty())
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
@@ -517,6 +552,29 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
     }
 }
 
+// Routine Description:
+// -  Writes events to the beginning of the input buffer.
+// Arguments:
+// - inEvents - events to write to buffer. They are consumed by the write.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
 // Routine Description:
 // - Writes event to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
@@ -532,9 +590,9 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const INPUT_RECORD record = inEvent->ToInputRecord();
+        inEvent.reset();
+        return Write({ &record, 1 });
     }
     catch (...)
     {
@@ -547,7 +605,7 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 // - Writes events to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
 // Arguments:
-// - inEvents - input events to store in the buffer.
+// - inEvents - input events to store in the buffer. They are consumed by the write.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
@@ -556,8 +614,36 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Write(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes events to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// - This is the batch version of Write, for callers that already have their
+// events as records. The records are copied into the buffer as a block
+// whenever they don't need to be looked at one by one.
+// Arguments:
+// - inRecords - input events to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> keptRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, keptRecords);
+        if (records.empty())
         {
             return 0;
         }
@@ -565,7 +651,7 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(records, EventsWritten, SetWaitEvent);
 
         if (SetWaitEvent)
         {
@@ -583,6 +669,34 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
     }
 }
 
+// Routine Description:
+// - Types a string into the input buffer. The whole string is converted to
+// key events at once (see CharsToInputRecords) and written as a block.
+// - Every character gets its own key press, even in a run of the same one.
+// Any reader might be a ReadConsoleInput client that doesn't look at the
+// repeat count, whatever the input mode is.
+// Arguments:
+// - text - the string to type
+// - codepage - the codepage for characters that have to be typed with Alt + numpad
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::WriteText(const std::wstring_view text, const unsigned int codepage)
+{
+    try
+    {
+        _textRecords.clear();
+        CharsToInputRecords(text, codepage, _textRecords);
+        return Write(_textRecords);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
 // Routine Description:
 // - Coalesces input events and transfers them to storage queue.
 // Arguments:
@@ -595,77 +709,64 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const bool initiallyEmptyQueue = _storage.empty();
-    const size_t initialInEventsSize = inEvents.size();
     const bool vtInputMode = IsInVirtualTerminalInputMode();
 
-    while(!inEvents.empty())
+    // we only check for possible coalescing when storing one
+    // record at a time because this is the original behavior of
+    // the input buffer. Changing this behavior may break stuff
+    // that was depending on it.
+    const bool canCoalesce = inRecords.size() == 1;
+
+    if (!vtInputMode && !canCoalesce)
     {
-        // Pop the next event.
-        // If we're in vt mode, try and handle it with the vt input module.
-        // If it was handled, do nothing else for it.
-        // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
-        // If it's not coalesced, append it to the buffer.
-        std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        // Nothing needs to look at the events one at a time, so store them as a block.
+        _storage.Append(inRecords);
+        eventsWritten = gsl::narrow_cast<size_t>(inRecords.size());
+    }
+    else
+    {
+        for (const auto& inRecord : inRecords)
         {
-            const bool handled = _termInput.HandleKey(inEvent.get());
-            if (handled)
+            // If we're in vt mode, try and handle it with the vt input module.
+            // If it was handled, do nothing else for it.
+            if (vtInputMode && inRecord.EventType == KEY_EVENT)
             {
-                eventsWritten++;
-                continue;
+                const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+                const bool handled = _termInput.HandleKey(&keyEvent);
+                if (handled)
+                {
+                    eventsWritten++;
+                    continue;
+                }
             }
-        }
 
-        // we only check for possible coalescing when storing one
-        // record at a time because this is the original behavior of
-        // the input buffer. Changing this behavior may break stuff
-        // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
-        {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            bool coalesced = false;
+            // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
+            //
             // this looks kinda weird but we don't want to coalesce a
             // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
-            {
-                eventsWritten = 1;
-                return;
-            }
-            else
+            if (canCoalesce && !_storage.empty())
             {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
+                if (_CoalesceMouseMovedEvents(inRecord) ||
+                    _CoalesceRepeatedKeyPressEvents(inRecord))
+                {
+                    eventsWritten = 1;
+                    return;
+                }
             }
+
+            // At this point, the event was neither coalesced, nor processed by VT.
+            _storage.push_back(inRecord);
+            ++eventsWritten;
         }
-        // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
-        ++eventsWritten;
     }
+
     if (initiallyEmptyQueue && !_storage.empty())
     {
         setWaitEvent = true;
@@ -673,67 +774,53 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
+// - Checks if the last saved event and the incoming event are
 // both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// updated with the new mouse position.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    INPUT_RECORD& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastStoredRecord.EventType == MOUSE_EVENT &&
+        inRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED &&
+        lastStoredRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
     {
-        const MouseEvent* const pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const MouseEvent* const pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
-
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
-        {
-            // update mouse moved position
-            MouseEvent* const pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
-            return true;
-        }
+        // update mouse moved position
+        lastStoredRecord.Event.MouseEvent.dwMousePosition = inRecord.Event.MouseEvent.dwMousePosition;
+        return true;
     }
     return false;
 }
 
 // Routine Description:
-// - checks two KeyEvents to see if they're similiar enough to be coalesced
+// - checks two key events to see if they're similiar enough to be coalesced
 // Arguments:
-// - a - the first KeyEvent
-// - b - the other KeyEvent
+// - a - the first key event
+// - b - the other key event
 // Return Value:
 // - true if the events could be coalesced, false otherwise
-bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept
+bool InputBuffer::_CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept
 {
-    if (WI_IsFlagSet(a.GetActiveModifierKeys(), NLS_IME_CONVERSION) &&
-        a.GetCharData() == b.GetCharData() &&
-        a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    if (WI_IsFlagSet(a.dwControlKeyState, NLS_IME_CONVERSION) &&
+        a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+        a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
     // other key events check
-    else if (a.GetVirtualScanCode() == b.GetVirtualScanCode() &&
-                a.GetCharData() == b.GetCharData() &&
-                a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    else if (a.wVirtualScanCode == b.wVirtualScanCode &&
+             a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+             a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
@@ -741,44 +828,35 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
+// - If the last input event saved and the incoming event
 // are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// count of the saved event.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const KeyEvent* const pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const KeyEvent* const pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    INPUT_RECORD& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastStoredRecord.EventType == KEY_EVENT)
+    {
+        const KEY_EVENT_RECORD& inKeyEvent = inRecord.Event.KeyEvent;
+        KEY_EVENT_RECORD& lastKeyEvent = lastStoredRecord.Event.KeyEvent;
+
+        if (inKeyEvent.bKeyDown &&
+            lastKeyEvent.bKeyDown &&
+            !IsGlyphFullWidth(inKeyEvent.uChar.UnicodeChar) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastKeyEvent.wRepeatCount = lastKeyEvent.wRepeatCount + inKeyEvent.wRepeatCount;
             return true;
         }
     }
@@ -788,42 +866,58 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - records to check for pause/unpause events
+// - keptRecords - storage for the records that are left, used only if some
+//   of them had to be removed.
 // Return Value:
-// - None
+// - The records to write to the buffer. This is inRecords itself unless some
+//   of them were removed.
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+gsl::span<const INPUT_RECORD> InputBuffer::_HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                          _Inout_ std::vector<INPUT_RECORD>& keptRecords)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    bool removedAny = false;
+    for (ptrdiff_t i = 0; i < inRecords.size(); ++i)
     {
-        std::unique_ptr<IInputEvent> currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        const INPUT_RECORD& record = inRecords[i];
+        bool remove = false;
+        if (record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown)
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
+            const KeyEvent keyEvent{ record.Event.KeyEvent };
+            if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+                !IsSystemKey(keyEvent.GetVirtualKeyCode()))
             {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
+                UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+                remove = true;
+            }
+            else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && keyEvent.IsPauseKey())
+            {
+                WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+                remove = true;
             }
         }
-        outEvents.push_back(std::move(currEvent));
+
+        if (remove && !removedAny)
+        {
+            // The first record to go. Only now do we need to copy the ones before it.
+            removedAny = true;
+            keptRecords.assign(inRecords.begin(), inRecords.begin() + i);
+        }
+        else if (!remove && removedAny)
+        {
+            keptRecords.push_back(record);
+        }
+    }
+
+    if (removedAny)
+    {
+        return keptRecords;
     }
-    inEvents.swap(outEvents);
+    return inRecords;
 }
 
 // Routine Description:
@@ -852,9 +946,8 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
         // add all input events to the storage queue
         while (!inEvents.empty())
         {
-            std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
+            _storage.push_back(inEvents.front()->ToInputRecord());
             inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
         }
     }
     catch (...)
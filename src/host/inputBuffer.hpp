@@ -19,6 +19,7 @@ Revision History:
 #pragma once
 
 #include "inputReadHandleData.h"
+#include "inputRecordQueue.hpp"
 #include "readData.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
@@ -55,6 +56,14 @@ public:
     void Flush();
     void FlushAllButKeys();
 
+    [[nodiscard]]
+    NTSTATUS Read(const gsl::span<INPUT_RECORD> OutRecords,
+                  _Out_ size_t& EventsRead,
+                  const bool Peek,
+                  const bool WaitForData,
+                  const bool Unicode,
+                  const bool Stream);
+
     [[nodiscard]]
     NTSTATUS Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
                   const size_t AmountToRead,
@@ -71,21 +80,35 @@ public:
                   const bool Stream);
 
 
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
+    size_t WriteText(const std::wstring_view text, const unsigned int codepage);
+
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordQueue _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
+    std::vector<INPUT_RECORD> _textRecords; // reused by WriteText
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+    [[nodiscard]]
+    NTSTATUS _Read(const gsl::span<INPUT_RECORD> outRecords,
+                   const size_t readCount,
+                   _Out_ size_t& eventsRead,
+                   const bool peek,
+                   const bool waitForData,
+                   const bool unicode,
+                   const bool stream);
+
+    void _ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                      const size_t readCount,
                      _Out_ size_t& eventsRead,
                      const bool peek,
@@ -93,14 +116,15 @@ private:
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
-    bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept;
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord);
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord);
+    gsl::span<const INPUT_RECORD> _HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                 _Inout_ std::vector<INPUT_RECORD>& keptRecords);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
@@ -0,0 +1,216 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inputRecordQueue.hpp"
+
+// Routine Description:
+// - Creates an empty queue. No storage is allocated until the first record
+//   is queued.
+InputRecordQueue::InputRecordQueue() noexcept :
+    _ring{},
+    _capacity{ 0 },
+    _head{ 0 },
+    _size{ 0 }
+{
+}
+
+size_t InputRecordQueue::size() const noexcept
+{
+    return _size;
+}
+
+bool InputRecordQueue::empty() const noexcept
+{
+    return _size == 0;
+}
+
+// Routine Description:
+// - Removes all records. The storage is kept for the next ones.
+void InputRecordQueue::clear() noexcept
+{
+    _head = 0;
+    _size = 0;
+}
+
+INPUT_RECORD& InputRecordQueue::operator[](const size_t index) noexcept
+{
+    return _ring[_Position(index)];
+}
+
+const INPUT_RECORD& InputRecordQueue::operator[](const size_t index) const noexcept
+{
+    return _ring[_Position(index)];
+}
+
+INPUT_RECORD& InputRecordQueue::front() noexcept
+{
+    return (*this)[0];
+}
+
+const INPUT_RECORD& InputRecordQueue::front() const noexcept
+{
+    return (*this)[0];
+}
+
+INPUT_RECORD& InputRecordQueue::back() noexcept
+{
+    return (*this)[_size - 1];
+}
+
+const INPUT_RECORD& InputRecordQueue::back() const noexcept
+{
+    return (*this)[_size - 1];
+}
+
+// Routine Description:
+// - Adds a record to the end of the queue.
+// Arguments:
+// - record - the record to add
+// Return Value:
+// - <none>
+// Note:
+// - will throw if the ring needs to grow and can't.
+void InputRecordQueue::push_back(const INPUT_RECORD& record)
+{
+    _Reserve(_size + 1);
+    _ring[_Position(_size)] = record;
+    _size++;
+}
+
+// Routine Description:
+// - Adds a record to the front of the queue.
+// Arguments:
+// - record - the record to add
+// Return Value:
+// - <none>
+// Note:
+// - will throw if the ring needs to grow and can't.
+void InputRecordQueue::push_front(const INPUT_RECORD& record)
+{
+    _Reserve(_size + 1);
+    _head = (_head + _capacity - 1) & (_capacity - 1);
+    _ring[_head] = record;
+    _size++;
+}
+
+// Routine Description:
+// - Removes the record at the front of the queue. The queue must not be empty.
+void InputRecordQueue::pop_front() noexcept
+{
+    Discard(1);
+}
+
+// Routine Description:
+// - Adds a run of records to the end of the queue, copying them into the ring
+//   in at most two blocks.
+// Arguments:
+// - records - the records to add
+// Return Value:
+// - <none>
+// Note:
+// - will throw if the ring needs to grow and can't.
+void InputRecordQueue::Append(const gsl::span<const INPUT_RECORD> records)
+{
+    if (records.empty())
+    {
+        return;
+    }
+
+    const size_t count = gsl::narrow<size_t>(records.size());
+    _Reserve(_size + count);
+
+    // The free space starts after the last record, and might wrap around the
+    // end of the ring.
+    const size_t tail = _Position(_size);
+    const size_t firstCount = std::min(count, _capacity - tail);
+    std::copy_n(records.data(), firstCount, _ring.get() + tail);
+    std::copy_n(records.data() + firstCount, count - firstCount, _ring.get());
+    _size += count;
+}
+
+// Routine Description:
+// - Copies records from the front of the queue without removing them.
+// Arguments:
+// - records - where to copy the records. Its size is the most to copy.
+// Return Value:
+// - The number of records copied.
+size_t InputRecordQueue::Peek(const gsl::span<INPUT_RECORD> records) const noexcept
+{
+    const size_t count = std::min(_size, gsl::narrow_cast<size_t>(records.size()));
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    const size_t firstCount = std::min(count, _capacity - _head);
+    std::copy_n(_ring.get() + _head, firstCount, records.data());
+    std::copy_n(_ring.get(), count - firstCount, records.data() + firstCount);
+    return count;
+}
+
+// Routine Description:
+// - Copies records from the front of the queue and removes them.
+// Arguments:
+// - records - where to copy the records. Its size is the most to read.
+// Return Value:
+// - The number of records read.
+size_t InputRecordQueue::Read(const gsl::span<INPUT_RECORD> records) noexcept
+{
+    const size_t count = Peek(records);
+    Discard(count);
+    return count;
+}
+
+// Routine Description:
+// - Removes records from the front of the queue.
+// Arguments:
+// - count - the number of records to remove. Must not be more than the size.
+// Return Value:
+// - <none>
+void InputRecordQueue::Discard(const size_t count) noexcept
+{
+    _size -= count;
+    // Start over at the beginning of the ring once it's empty, so the next
+    // run of records is more likely to be copied in one block.
+    _head = _size == 0 ? 0 : _Position(count);
+}
+
+// Routine Description:
+// - Makes sure the ring can hold at least the given number of records,
+//   doubling it as often as needed. The records keep their order, starting
+//   at the beginning of the new ring.
+// Arguments:
+// - minimumCapacity - the number of records the ring has to hold
+// Return Value:
+// - <none>
+// Note:
+// - will throw if the ring can't be allocated.
+void InputRecordQueue::_Reserve(const size_t minimumCapacity)
+{
+    if (minimumCapacity <= _capacity)
+    {
+        return;
+    }
+
+    size_t newCapacity = std::max(_capacity, s_initialCapacity);
+    while (newCapacity < minimumCapacity)
+    {
+        THROW_HR_IF(E_OUTOFMEMORY, newCapacity > SIZE_MAX / 2);
+        newCapacity *= 2;
+    }
+
+    auto newRing = std::make_unique<INPUT_RECORD[]>(newCapacity);
+    Peek({ newRing.get(), gsl::narrow<ptrdiff_t>(_size) });
+
+    _ring = std::move(newRing);
+    _capacity = newCapacity;
+    _head = 0;
+}
+
+// Routine Description:
+// - Finds where the record at the given index from the front is in the ring.
+size_t InputRecordQueue::_Position(const size_t index) const noexcept
+{
+    return (_head + index) & (_capacity - 1);
+}
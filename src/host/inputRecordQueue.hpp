@@ -0,0 +1,73 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- inputRecordQueue.hpp
+
+Abstract:
+- A queue of input events for the input buffer, stored by value as
+  INPUT_RECORDs in a ring. Unlike a deque of IInputEvents, queueing an event
+  doesn't allocate it on the heap, and whole runs of events can be copied in
+  and out at once.
+- The ring doubles in size when it fills up, and never shrinks, so a console
+  that has seen a large paste once doesn't allocate for the next one.
+--*/
+
+#pragma once
+
+class InputRecordQueue final
+{
+public:
+    InputRecordQueue() noexcept;
+
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+    void clear() noexcept;
+
+    INPUT_RECORD& operator[](const size_t index) noexcept;
+    const INPUT_RECORD& operator[](const size_t index) const noexcept;
+
+    INPUT_RECORD& front() noexcept;
+    const INPUT_RECORD& front() const noexcept;
+    INPUT_RECORD& back() noexcept;
+    const INPUT_RECORD& back() const noexcept;
+
+    void push_back(const INPUT_RECORD& record);
+    void push_front(const INPUT_RECORD& record);
+    void pop_front() noexcept;
+
+    void Append(const gsl::span<const INPUT_RECORD> records);
+    size_t Peek(const gsl::span<INPUT_RECORD> records) const noexcept;
+    size_t Read(const gsl::span<INPUT_RECORD> records) noexcept;
+    void Discard(const size_t count) noexcept;
+
+    // Routine Description:
+    // - Removes every record the predicate returns true for, keeping the
+    //   order of the others.
+    template<typename Predicate>
+    void RemoveIf(Predicate predicate)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; i++)
+        {
+            const INPUT_RECORD& record = (*this)[i];
+            if (!predicate(record))
+            {
+                (*this)[kept++] = record;
+            }
+        }
+        _size = kept;
+    }
+
+private:
+    void _Reserve(const size_t minimumCapacity);
+    size_t _Position(const size_t index) const noexcept;
+
+    static constexpr size_t s_initialCapacity = 64;
+
+    std::unique_ptr<INPUT_RECORD[]> _ring;
+    size_t _capacity; // always 0 or a power of two
+    size_t _head; // the position of the first record in the ring
+    size_t _size;
+};
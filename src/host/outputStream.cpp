@@ -291,6 +291,21 @@ BOOL ConhostInternalGetSet::PrivateWriteConsoleInputW(_Inout_ std::deque<std::un
                                                     true)); // append
 }
 
+// Routine Description:
+// - Types a string into the input buffer, as key events, for the attached process to read
+// Arguments:
+// - text - the string to type
+// - eventsWritten - on output, the number of events written
+// Return Value:
+// - TRUE if successful (see DoSrvPrivateWriteConsoleInputText). FALSE otherwise.
+BOOL ConhostInternalGetSet::PrivateWriteConsoleInputText(const std::wstring_view text,
+                                                         _Out_ size_t& eventsWritten)
+{
+    return SUCCEEDED(DoSrvPrivateWriteConsoleInputText(_io.GetActiveInputBuffer(),
+                                                       text,
+                                                       eventsWritten));
+}
+
 // Routine Description:
 // - Connects the ScrollConsoleScreenBuffer API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -92,6 +92,9 @@ public:
     BOOL PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
                             _Out_ size_t& eventsWritten) override;
 
+    BOOL PrivateWriteConsoleInputText(const std::wstring_view text,
+                                      _Out_ size_t& eventsWritten) override;
+
     BOOL ScrollConsoleScreenBufferW(const SMALL_RECT* pScrollRectangle,
                                     _In_opt_ const SMALL_RECT* pClipRectangle,
                                     _In_ COORD coordDestinationOrigin,
@@ -466,6 +466,57 @@ void COOKED_READ_DATA::ProcessAliases(DWORD& lineCount)
                                      lineCount);
 }
 
+// Routine Description:
+// - Brings the edit line on screen up to date after an edit in the middle of it.
+// - Only the part of the line from the first changed character on is written,
+//   starting at the cursor, which must be where that character is displayed.
+//   Cells before it keep what they had, and if the line got shorter, only
+//   the cells it no longer covers are blanked.
+// Arguments:
+// - firstChanged - Index of the first character of the edit line that changed
+// - scrollY - Receives how far the screen buffer scrolled while writing
+// Return Value:
+// - Status from writing the characters.
+[[nodiscard]]
+NTSTATUS COOKED_READ_DATA::_rewriteLineFrom(const size_t firstChanged, SHORT& scrollY)
+{
+    const Cursor& cursor = _screenInfo.GetTextBuffer().GetCursor();
+    const COORD start = cursor.GetPosition();
+    const SHORT width = _screenInfo.GetBufferSize().Width();
+
+    // The cells from the start of the line to the cursor don't change.
+    const ptrdiff_t cellsBefore = (start.Y - _originalCursorPosition.Y) * width + (start.X - _originalCursorPosition.X);
+
+    size_t bytesToWrite = _bytesRead - (firstChanged * sizeof(WCHAR));
+    size_t cellsWritten = 0;
+    const NTSTATUS status = WriteCharsLegacy(_screenInfo,
+                                             _backupLimit,
+                                             _backupLimit + firstChanged,
+                                             _backupLimit + firstChanged,
+                                             &bytesToWrite,
+                                             &cellsWritten,
+                                             _originalCursorPosition.X,
+                                             WC_DESTRUCTIVE_BACKSPACE | WC_ECHO,
+                                             &scrollY);
+    if (!NT_SUCCESS(status))
+    {
+        return status;
+    }
+
+    const size_t visibleCharCount = gsl::narrow_cast<size_t>(std::max<ptrdiff_t>(cellsBefore, 0)) + cellsWritten;
+    if (visibleCharCount < _visibleCharCount)
+    {
+        try
+        {
+            _screenInfo.Write(OutputCellIterator(UNICODE_SPACE, _visibleCharCount - visibleCharCount), cursor.GetPosition());
+        }
+        CATCH_LOG();
+    }
+    _visibleCharCount = visibleCharCount;
+
+    return STATUS_SUCCESS;
+}
+
 // Routine Description:
 // - This method handles the various actions that occur on the edit line like pressing keys left/right/up/down, paging, and
 //   the final ENTER key press that will end the wait and finally return the data.
@@ -707,27 +758,32 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
             CursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
             CursorPosition.X = (SHORT)(CursorPosition.X + NumSpaces);
 
-            // clear the current command line from the screen
-#pragma prefast(suppress:__WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
-            DeleteCommandLine(*this, FALSE);
-
-            // write the new command line to the screen
-            NumToWrite = _bytesRead;
-
-            DWORD dwFlags = WC_DESTRUCTIVE_BACKSPACE | WC_ECHO;
             if (wch == UNICODE_CARRIAGERETURN)
             {
-                dwFlags |= WC_KEEP_CURSOR_VISIBLE;
+                // clear the current command line from the screen
+#pragma prefast(suppress:__WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
+                DeleteCommandLine(*this, FALSE);
+
+                // write the new command line to the screen
+                NumToWrite = _bytesRead;
+                status = WriteCharsLegacy(_screenInfo,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          &NumToWrite,
+                                          &_visibleCharCount,
+                                          _originalCursorPosition.X,
+                                          WC_DESTRUCTIVE_BACKSPACE | WC_ECHO | WC_KEEP_CURSOR_VISIBLE,
+                                          &ScrollY);
+            }
+            else
+            {
+                // The cursor still sits on the first character the edit changed, either
+                // because it was inserted or overwritten there or because backspace
+                // already moved it back. Everything before that is unchanged on screen.
+                const size_t firstChanged = (wch == UNICODE_BACKSPACE && _processedInput) ? _currentPosition : _currentPosition - 1;
+                status = _rewriteLineFrom(firstChanged, ScrollY);
             }
-            status = WriteCharsLegacy(_screenInfo,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      &NumToWrite,
-                                      &_visibleCharCount,
-                                      _originalCursorPosition.X,
-                                      dwFlags,
-                                      &ScrollY);
             if (!NT_SUCCESS(status))
             {
                 RIPMSG1(RIP_WARNING, "WriteCharsLegacy failed 0x%x", status);
@@ -1160,10 +1216,11 @@ NTSTATUS COOKED_READ_DATA::_handlePostCharInputLoop(const bool isUnicode, size_t
     if (!isUnicode)
     {
         // if ansi, translate string.
-        std::unique_ptr<char[]> tempBuffer;
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gsl::span<char> tempBuffer;
         try
         {
-            tempBuffer = std::make_unique<char[]>(NumBytes);
+            tempBuffer = gci.transcoder.GetNarrowScratch(NumBytes);
         }
         catch (...)
         {
@@ -1173,7 +1230,7 @@ NTSTATUS COOKED_READ_DATA::_handlePostCharInputLoop(const bool isUnicode, size_t
         std::unique_ptr<IInputEvent> partialEvent;
         numBytes = TranslateUnicodeToOem(_userBuffer,
                                             gsl::narrow<ULONG>(numBytes / sizeof(wchar_t)),
-                                            tempBuffer.get(),
+                                            tempBuffer.data(),
                                             gsl::narrow<ULONG>(NumBytes),
                                             partialEvent);
 
@@ -1188,7 +1245,7 @@ NTSTATUS COOKED_READ_DATA::_handlePostCharInputLoop(const bool isUnicode, size_t
             return STATUS_BUFFER_OVERFLOW;
         }
 
-        memmove(_userBuffer, tempBuffer.get(), numBytes);
+        memmove(_userBuffer, tempBuffer.data(), numBytes);
         if (fAddDbcsLead)
         {
             numBytes++;
@@ -161,4 +161,7 @@ private:
 
     [[nodiscard]]
     NTSTATUS _handlePostCharInputLoop(const bool isUnicode, size_t& numBytes, ULONG& controlKeyState) noexcept;
+
+    [[nodiscard]]
+    NTSTATUS _rewriteLineFrom(const size_t firstChanged, SHORT& scrollY);
 };
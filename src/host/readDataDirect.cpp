@@ -28,8 +28,7 @@ DirectReadData::DirectReadData(_In_ InputBuffer* const pInputBuffer,
                                _In_ std::deque<std::unique_ptr<IInputEvent>> partialEvents) :
     ReadData(pInputBuffer, pInputReadHandleData),
     _eventReadCount{ eventReadCount },
-    _partialEvents{ std::move(partialEvents) },
-    _outEvents{ }
+    _partialEvents{ std::move(partialEvents) }
 {
 }
 
@@ -58,9 +57,8 @@ DirectReadData::~DirectReadData()
 // - pNumBytes - not used
 // - pControlKeyState - For certain types of reads, this specifies
 // which modifier keys were held.
-// - pOutputData - a pointer to a
-// std::deque<std::unique_ptr<IInputEvent>> that is used to the read
-// input events back to the server
+// - pOutputData - a pointer to a gsl::span<INPUT_RECORD>, the buffer
+// of the reply that the read input events are stored in
 // Return Value:
 // - true if the wait is done and result buffer/status code can be sent back to the client.
 // - false if we need to continue to wait until more data is available.
@@ -82,6 +80,9 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
     *pControlKeyState = 0;
     *pNumBytes = 0;
     bool retVal = true;
+    const gsl::span<INPUT_RECORD> outRecords = *reinterpret_cast<gsl::span<INPUT_RECORD>*>(pOutputData);
+    FAIL_FAST_IF(gsl::narrow<size_t>(outRecords.size()) < _eventReadCount);
+    size_t written = 0;
     std::deque<std::unique_ptr<IInputEvent>> readEvents;
 
     // If ctrl-c or ctrl-break was seen, ignore it.
@@ -117,27 +118,33 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
         // if we get to here, this routine was called either by the input
         // thread or a write routine.  both of these callers grab the
         // current console lock.
-
-        // calculate how many events we need to read
-        size_t amountAlreadyRead;
-        if (FAILED(SizeTAdd(_partialEvents.size(), _outEvents.size(), &amountAlreadyRead)))
+        if (fIsUnicode)
         {
-            *pReplyStatus = STATUS_INTEGER_OVERFLOW;
-            return retVal;
+            // Unicode records are copied straight into the reply's buffer.
+            *pReplyStatus = _pInputBuffer->Read(outRecords.first(_eventReadCount),
+                                                written,
+                                                false,
+                                                false,
+                                                true,
+                                                false);
         }
-        size_t amountToRead;
-        if (FAILED(SizeTSub(_eventReadCount, amountAlreadyRead, &amountToRead)))
+        else
         {
-            *pReplyStatus = STATUS_INTEGER_OVERFLOW;
-            return retVal;
-        }
+            // calculate how many events we need to read
+            size_t amountToRead;
+            if (FAILED(SizeTSub(_eventReadCount, _partialEvents.size(), &amountToRead)))
+            {
+                *pReplyStatus = STATUS_INTEGER_OVERFLOW;
+                return retVal;
+            }
 
-        *pReplyStatus = _pInputBuffer->Read(readEvents,
-                                            amountToRead,
-                                            false,
-                                            false,
-                                            fIsUnicode,
-                                            false);
+            *pReplyStatus = _pInputBuffer->Read(readEvents,
+                                                amountToRead,
+                                                false,
+                                                false,
+                                                fIsUnicode,
+                                                false);
+        }
 
         if (*pReplyStatus == CONSOLE_STATUS_WAIT)
         {
@@ -165,14 +172,11 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
         }
 
         // move read events to out storage
-        for (size_t i = 0; i < _eventReadCount; ++i)
+        while (written < _eventReadCount && !readEvents.empty())
         {
-            if (readEvents.empty())
-            {
-                break;
-            }
-            _outEvents.push_back(std::move(readEvents.front()));
+            outRecords[written] = readEvents.front()->ToInputRecord();
             readEvents.pop_front();
+            ++written;
         }
 
         // store partial event if necessary
@@ -183,10 +187,7 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
             FAIL_FAST_IF(!(readEvents.empty()));
         }
 
-        // move events to pOutputData
-        std::deque<std::unique_ptr<IInputEvent>>* const pOutputDeque = reinterpret_cast<std::deque<std::unique_ptr<IInputEvent>>* const>(pOutputData);
-        *pNumBytes = _outEvents.size() * sizeof(INPUT_RECORD);
-        pOutputDeque->swap(_outEvents);
+        *pNumBytes = written * sizeof(INPUT_RECORD);
     }
     return retVal;
 }
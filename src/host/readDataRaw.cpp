@@ -189,10 +189,11 @@ bool RAW_READ_DATA::Notify(const WaitTerminationReason TerminationReason,
         !fIsUnicode)
     {
         // It's ansi, so translate the string.
-        std::unique_ptr<char[]> tempBuffer;
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gsl::span<char> tempBuffer;
         try
         {
-            tempBuffer = std::make_unique<char[]>(NumBytes);
+            tempBuffer = gci.transcoder.GetNarrowScratch(NumBytes);
         }
         catch (...)
         {
@@ -204,7 +205,7 @@ bool RAW_READ_DATA::Notify(const WaitTerminationReason TerminationReason,
 
         *pNumBytes = TranslateUnicodeToOem(lpBuffer,
                                            gsl::narrow<ULONG>(*pNumBytes / sizeof(wchar_t)),
-                                           tempBuffer.get(),
+                                           tempBuffer.data(),
                                            gsl::narrow<ULONG>(NumBytes),
                                            partialEvent);
         if (partialEvent.get())
@@ -212,7 +213,7 @@ bool RAW_READ_DATA::Notify(const WaitTerminationReason TerminationReason,
             _pInputBuffer->StoreReadPartialByteSequence(std::move(partialEvent));
         }
 
-        memmove(lpBuffer, tempBuffer.get(), *pNumBytes);
+        memmove(lpBuffer, tempBuffer.data(), *pNumBytes);
         if (fAddDbcsLead)
         {
             (*pNumBytes)++;
@@ -313,17 +313,18 @@ const COLORREF RenderData::GetBackgroundColor(const TextAttribute& attr) const n
 // Method Description:
 // - Lock the console for reading the contents of the buffer. Ensures that the
 //      contents of the console won't be changed in the middle of a paint
-//      operation.
+//      operation. The lock is only taken shared, so clients querying the
+//      console don't have to wait for the paint.
 //   Callers should make sure to also call RenderData::UnlockConsole once
 //      they're done with any querying they need to do.
 void RenderData::LockConsole() noexcept
 {
-    ::LockConsole();
+    ::LockConsoleShared();
 }
 
 // Method Description:
 // - Unlocks the console after a call to RenderData::LockConsole.
 void RenderData::UnlockConsole() noexcept
 {
-    ::UnlockConsole();
+    ::UnlockConsoleShared();
 }
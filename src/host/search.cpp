@@ -7,8 +7,6 @@
 
 #include "dbcs.h"
 #include "../buffer/out/CharRow.hpp"
-#include "../types/inc/Utf16Parser.hpp"
-#include "../types/inc/GlyphWidth.hpp"
 
 // Routine Description:
 // - Constructs a Search object.
@@ -26,10 +24,9 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
     _direction(direction),
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
-    _needle(s_CreateNeedleFromString(str)),
+    _needle(s_CreateNeedleFromString(str, sensitivity)),
     _coordAnchor(s_GetInitialAnchor(screenInfo, direction))
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description:
@@ -50,14 +47,15 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
     _direction(direction),
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
-    _needle(s_CreateNeedleFromString(str)),
+    _needle(s_CreateNeedleFromString(str, sensitivity)),
     _coordAnchor(anchor)
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description
 // - Locates the next instance of the search term within the screen buffer.
+// - The whole buffer is searched once, on the first call. Later calls walk
+//   the matches found then, starting from the anchor in our direction.
 // Arguments:
 // - <none> - Uses internal state from constructor
 // Return Value:
@@ -65,28 +63,26 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
 // - NOTE: You can FindNext() again after False to go around the buffer again.
 bool Search::FindNext()
 {
-    if (_reachedEnd)
+    if (!_searched)
     {
-        _reachedEnd = false;
-        return false;
+        _FindAllMatches();
     }
 
-    do
+    if (_matchesReturned == _matches.size())
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
-        {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
-        }
-        else
-        {
-            _UpdateNextPosition();
-        }
+        _matchesReturned = 0;
+        return false;
+    }
 
-    } while (_coordNext != _coordAnchor);
+    const size_t count = _matches.size();
+    const size_t index = _direction == Direction::Forward ?
+                             (_firstMatch + _matchesReturned) % count :
+                             (_firstMatch + count - _matchesReturned) % count;
+    _matchesReturned++;
 
-    return false;
+    _coordSelStart = _GetCoordOfCell(_matches.at(index).first);
+    _coordSelEnd = _GetCoordOfCell(_matches.at(index).second);
+    return true;
 }
 
 // Routine Description:
@@ -113,6 +109,23 @@ void Search::Color(const TextAttribute attr) const
     }
 }
 
+// Routine Description:
+// - Applies the given color to every instance of the search term in the screen buffer.
+// Arguments:
+// - attr - The color to apply to the words
+void Search::ColorAll(const TextAttribute attr)
+{
+    if (!_searched)
+    {
+        _FindAllMatches();
+    }
+
+    for (const auto& match : _matches)
+    {
+        Selection::Instance().ColorSelection(_GetCoordOfCell(match.first), _GetCoordOfCell(match.second), attr);
+    }
+}
+
 // Routine Description:
 // - gets start and end position of text sound by search. only guaranteed to have valid data if FindNext has
 // been called and returned true.
@@ -164,128 +177,162 @@ COORD Search::s_GetInitialAnchor(const SCREEN_INFORMATION& screenInfo, const Dir
 }
 
 // Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
-// Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
-// Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
+// - Finds every instance of the search term in the screen buffer in one pass.
+// - Each logical line (rows joined where they wrapped) is read out once, case
+//   folded as needed, and searched as a whole string. The cell that every
+//   character came from is kept alongside so matches map back to positions.
+// - Matches are stored in buffer order as their first and last cell index.
+// - This runs under the console lock like the rest of Search, so it's done
+//   synchronously rather than on a background thread.
+void Search::_FindAllMatches()
 {
-    start = { 0 };
-    end = { 0 };
+    _searched = true;
+    _matches.clear();
+    if (_needle.empty())
+    {
+        return;
+    }
 
-    COORD bufferPos = pos;
+    const TextBuffer& textBuffer = _screenInfo.GetTextBuffer();
+    const COORD bufferSize = _screenInfo.GetBufferSize().Dimensions();
 
-    for (const auto& needleCell : _needle)
-    {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _screenInfo.GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
+    std::wstring line;
+    std::vector<uint32_t> cells;
+    line.reserve(bufferSize.X);
+    cells.reserve(bufferSize.X);
 
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
+    for (SHORT y = 0; y < bufferSize.Y; y++)
+    {
+        const CharRow& charRow = textBuffer.GetRowByOffset(y).GetCharRow();
+        const uint32_t rowStart = gsl::narrow<uint32_t>(y) * bufferSize.X;
+        for (size_t x = 0; x < charRow.size(); x++)
         {
-            return false;
-        }
+            const DbcsAttribute& dbcsAttr = charRow.DbcsAttrAt(x);
+            if (dbcsAttr.IsTrailing())
+            {
+                continue;
+            }
 
-        _IncrementCoord(bufferPos);
-    }
+            uint32_t cell = rowStart + gsl::narrow_cast<uint32_t>(x);
+            if (dbcsAttr.IsLeading())
+            {
+                cell |= s_wideGlyph;
+            }
 
-    _DecrementCoord(bufferPos);
+            const std::wstring_view glyph = charRow.GlyphAt(x);
+            for (size_t i = 0; i < glyph.size(); i++)
+            {
+                line.push_back(s_ApplySensitivity(glyph.at(i), _sensitivity));
+                cells.push_back(i == 0 ? cell : (cell | s_glyphContinuation));
+            }
+        }
 
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
+        // A row that wrapped continues on the next one, so matches can span the two.
+        if (!charRow.WasWrapForced() || y == bufferSize.Y - 1)
+        {
+            _FindMatchesInLine(line, cells);
+            line.clear();
+            cells.clear();
+        }
+    }
 
-    return true;
+    _firstMatch = _GetFirstMatchIndex();
 }
 
 // Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
+// - Finds every instance of the search term within one logical line of the buffer.
+// - The scan for candidates is std::wstring_view::find, which looks for the first
+//   character of the needle with wmemchr before comparing the rest.
 // Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
-// Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const
+// - line - The folded text of the line
+// - cells - For each character of the line, the cell index it came from with flags
+void Search::_FindMatchesInLine(const std::wstring_view line, const std::vector<uint32_t>& cells)
 {
-    if (one.size() != two.size())
+    for (size_t pos = line.find(_needle); pos != std::wstring_view::npos; pos = line.find(_needle, pos + 1))
     {
-        return false;
-    }
+        const size_t next = pos + _needle.size();
 
-    for (size_t i = 0; i < one.size(); i++)
-    {
-        if (_ApplySensitivity(one[i]) != _ApplySensitivity(two[i]))
+        // Only whole glyphs can match, not the middle of a surrogate pair or such.
+        if (WI_IsFlagSet(cells.at(pos), s_glyphContinuation) ||
+            (next < cells.size() && WI_IsFlagSet(cells.at(next), s_glyphContinuation)))
         {
-            return false;
+            continue;
         }
-    }
 
-    return true;
+        // The match ends in the last cell of its last glyph.
+        size_t last = next - 1;
+        while (WI_IsFlagSet(cells.at(last), s_glyphContinuation))
+        {
+            last--;
+        }
+        uint32_t end = cells.at(last) & s_cellMask;
+        if (WI_IsFlagSet(cells.at(last), s_wideGlyph))
+        {
+            end++;
+        }
+
+        _matches.emplace_back(cells.at(pos) & s_cellMask, end);
+    }
 }
 
 // Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
-// Arguments:
-// - wch - Character to adjust if necessary
+// - Finds the match that a search from the anchor comes across first.
+// - That's the first one starting at or after the anchor going forward, and the
+//   last one starting at or before it going backward, wrapping around the buffer.
 // Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const
+// - Index into the found matches. Zero if there were none.
+size_t Search::_GetFirstMatchIndex() const
 {
-    if (_sensitivity == Sensitivity::CaseInsensitive)
+    if (_matches.empty())
     {
-        return ::towlower(wch);
+        return 0;
+    }
+
+    const uint32_t anchor = gsl::narrow<uint32_t>(_coordAnchor.Y) * _screenInfo.GetBufferSize().Width() + _coordAnchor.X;
+    if (_direction == Direction::Forward)
+    {
+        const auto it = std::lower_bound(_matches.cbegin(), _matches.cend(), anchor, [](const auto& match, const uint32_t value) {
+            return match.first < value;
+        });
+        return it == _matches.cend() ? 0 : gsl::narrow_cast<size_t>(it - _matches.cbegin());
     }
     else
     {
-        return wch;
+        const auto it = std::upper_bound(_matches.cbegin(), _matches.cend(), anchor, [](const uint32_t value, const auto& match) {
+            return value < match.first;
+        });
+        return it == _matches.cbegin() ? _matches.size() - 1 : gsl::narrow_cast<size_t>(it - _matches.cbegin()) - 1;
     }
 }
 
 // Routine Description:
-// - Helper to increment a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to increment one position (will wrap X and Y direction)
-void Search::_IncrementCoord(COORD& coord) const
-{
-    _screenInfo.GetBufferSize().IncrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to decrement a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to decrement one position (will wrap X and Y direction)
-void Search::_DecrementCoord(COORD& coord) const
+// - Helper to turn a cell index from the search back into a buffer position
+// Arguments:
+// - cell - Index of the cell, counting across rows from the top left
+// Return Value:
+// - Position of the cell in the screen buffer
+COORD Search::_GetCoordOfCell(const uint32_t cell) const
 {
-    _screenInfo.GetBufferSize().DecrementInBoundsCircular(coord);
+    const uint32_t width = _screenInfo.GetBufferSize().Width();
+    return { gsl::narrow<SHORT>(cell % width), gsl::narrow<SHORT>(cell / width) };
 }
 
 // Routine Description:
-// - Helper to update the coordinate position to the next point to be searched
+// - Provides an abstraction for conditionally applying case sensitivity
+// Arguments:
+// - wch - Character to adjust if necessary
+// - sensitivity - Whether or not we care about case
 // Return Value:
-// - True if we haven't reached the end of the buffer. False otherwise.
-void Search::_UpdateNextPosition()
+// - Adjusted value (or not).
+wchar_t Search::s_ApplySensitivity(const wchar_t wch, const Sensitivity sensitivity)
 {
-    if (_direction == Direction::Forward)
-    {
-        _IncrementCoord(_coordNext);
-    }
-    else if (_direction == Direction::Backward)
+    if (sensitivity == Sensitivity::CaseInsensitive)
     {
-        _DecrementCoord(_coordNext);
+        return ::towlower(wch);
     }
     else
     {
-        THROW_HR(E_NOTIMPL);
+        return wch;
     }
 }
 
@@ -294,19 +341,16 @@ void Search::_UpdateNextPosition()
 //   that we can use for our search
 // Arguments:
 // - wstr - String that will be our search term
+// - sensitivity - Whether or not we care about case
 // Return Value:
-// - Structured text data for comparison to screen buffer text data.
-std::vector<std::vector<wchar_t>> Search::s_CreateNeedleFromString(const std::wstring& wstr)
+// - The search term, case folded the same way the screen buffer text will be.
+std::wstring Search::s_CreateNeedleFromString(const std::wstring& wstr, const Sensitivity sensitivity)
 {
-    const auto charData = Utf16Parser::Parse(wstr);
-    std::vector<std::vector<wchar_t>> cells;
-    for (const auto chars : charData)
+    std::wstring needle;
+    needle.reserve(wstr.size());
+    for (const auto wch : wstr)
     {
-        if (IsGlyphFullWidth(std::wstring_view{ chars.data(), chars.size() }))
-        {
-            cells.emplace_back(chars);
-        }
-        cells.emplace_back(chars);
+        needle.push_back(s_ApplySensitivity(wch, sensitivity));
     }
-    return cells;
+    return needle;
 }
@@ -49,29 +49,35 @@ public:
     bool FindNext();
     void Select() const;
     void Color(const TextAttribute attr) const;
+    void ColorAll(const TextAttribute attr);
 
     std::pair<COORD, COORD> GetFoundLocation() const noexcept;
 
 private:
 
-    wchar_t _ApplySensitivity(const wchar_t wch) const;
-    bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const;
-    void _UpdateNextPosition();
-
-    void _IncrementCoord(COORD& coord) const;
-    void _DecrementCoord(COORD& coord) const;
+    void _FindAllMatches();
+    void _FindMatchesInLine(const std::wstring_view line, const std::vector<uint32_t>& cells);
+    size_t _GetFirstMatchIndex() const;
+    COORD _GetCoordOfCell(const uint32_t cell) const;
 
+    static wchar_t s_ApplySensitivity(const wchar_t wch, const Sensitivity sensitivity);
     static COORD s_GetInitialAnchor(const SCREEN_INFORMATION& screenInfo, const Direction dir);
-    static std::vector<std::vector<wchar_t>> s_CreateNeedleFromString(const std::wstring& wstr);
+    static std::wstring s_CreateNeedleFromString(const std::wstring& wstr, const Sensitivity sensitivity);
+
+    // Flags kept in the top bits of the cell indices used while indexing the buffer.
+    static constexpr uint32_t s_glyphContinuation = 0x80000000;
+    static constexpr uint32_t s_wideGlyph = 0x40000000;
+    static constexpr uint32_t s_cellMask = 0x3FFFFFFF;
 
-    bool _reachedEnd = false;
-    COORD _coordNext = { 0 };
+    bool _searched = false;
+    size_t _firstMatch = 0;
+    size_t _matchesReturned = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> _matches;
     COORD _coordSelStart = { 0 };
     COORD _coordSelEnd = { 0 };
 
     const COORD _coordAnchor;
-    const std::vector<std::vector<wchar_t>> _needle;
+    const std::wstring _needle;
     const Direction _direction;
     const Sensitivity _sensitivity;
     const SCREEN_INFORMATION& _screenInfo;
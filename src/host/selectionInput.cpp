@@ -703,10 +703,7 @@ bool Selection::_HandleColorSelection(const INPUT_KEY_INFO* const pInputKeyInfo)
                     Telemetry::Instance().LogColorSelectionUsed();
 
                     Search search(screenInfo, str, Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
-                    while (search.FindNext())
-                    {
-                        search.Color(TextAttribute{ static_cast<WORD>(ulAttr) });
-                    }
+                    search.ColorAll(TextAttribute{ static_cast<WORD>(ulAttr) });
                 }
             }
             CATCH_LOG();
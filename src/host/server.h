@@ -24,6 +24,7 @@ Revision History:
 #include "..\terminal\adapter\MouseInput.hpp"
 #include "VtIo.hpp"
 #include "CursorBlinker.hpp"
+#include "codepageTranscoder.hpp"
 
 #include "..\server\ProcessList.h"
 #include "..\server\WaitQueue.h"
@@ -72,6 +73,19 @@ Revision History:
 class COOKED_READ_DATA;
 class CommandHistory;
 
+// How the console lock has been used, to measure contention between clients,
+//      the input thread and the renderer. Times are in QueryPerformanceCounter ticks.
+struct ConsoleLockStatistics
+{
+    size_t exclusiveAcquisitions;
+    size_t sharedAcquisitions;
+    size_t promotedAcquisitions; // exclusive, by a thread that held it shared
+    size_t contendedAcquisitions; // had to wait for another thread to let go
+    LONGLONG waitTicks;
+    LONGLONG exclusiveHoldTicks;
+    LONGLONG longestExclusiveHoldTicks;
+};
+
 class CONSOLE_INFORMATION :
     public Settings,
     public Microsoft::Console::IIoProvider,
@@ -103,6 +117,8 @@ public:
     CPINFO CPInfo;
     CPINFO OutputCPInfo;
 
+    CodepageTranscoder transcoder; // scratch for the A versions of the APIs
+
     ConsoleImeInfo ConsoleIme;
 
     Microsoft::Console::VirtualTerminal::MouseInput terminalMouseInput;
@@ -113,6 +129,10 @@ public:
     bool IsConsoleLocked() const;
     ULONG GetCSRecursionCount();
 
+    void LockConsoleShared();
+    void UnlockConsoleShared();
+    ConsoleLockStatistics GetLockStatistics() const noexcept;
+
     Microsoft::Console::VirtualTerminal::VtIo* GetVtIo();
 
     static void HandleTerminalKeyEventCallback(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events);
@@ -154,7 +174,37 @@ public:
     RenderData renderData;
 
 private:
-    CRITICAL_SECTION _csConsoleLock;   // serialize input and output using this
+    // Serializes input and output. Anything that changes console state takes it
+    //      exclusively. Queries and painting, which only read, may share it.
+    // Under a shared hold, nothing the console owns may be changed: not the
+    //      screen buffers, the input buffer, the settings or the title. The
+    //      only state changed under a shared hold is state with a lock of its
+    //      own, like the renderer's pending invalidations and previous
+    //      viewport (its paint and engine locks) and the lock counters
+    //      (atomics).
+    // Exclusive holds are recursive. Shared holds are recursive too. A thread
+    //      holding it shared that asks for it exclusively gives up the shared
+    //      hold until the exclusive one ends; see LockConsole. The render
+    //      thread must never do that, since it holds the paint lock while
+    //      capturing a frame.
+    SRWLOCK _srwConsoleLock;
+    std::atomic<DWORD> _consoleLockOwner; // the thread holding it exclusively
+    ULONG _consoleLockRecursion; // only touched by the owner
+    LONGLONG _consoleLockAcquiredAt;
+
+    struct
+    {
+        std::atomic<size_t> exclusiveAcquisitions;
+        std::atomic<size_t> sharedAcquisitions;
+        std::atomic<size_t> promotedAcquisitions;
+        std::atomic<size_t> contendedAcquisitions;
+        std::atomic<LONGLONG> waitTicks;
+        std::atomic<LONGLONG> exclusiveHoldTicks;
+        std::atomic<LONGLONG> longestExclusiveHoldTicks;
+    } _lockCounters;
+
+    void _CountLockWait(const LONGLONG waitTicks) noexcept;
+
     std::wstring _Title;
     std::wstring _TitlePrefix; // Eg Select, Mark - things that we manually prepend to the title.
     std::wstring _OriginalTitle;
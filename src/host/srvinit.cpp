@@ -14,8 +14,10 @@
 
 #include "../types/inc/GlyphWidth.hpp"
 
+#include "..\server\ApiStatistics.h"
 #include "..\server\Entrypoints.h"
 #include "..\server\IoSorter.h"
+#include "..\server\IoWorkerPool.h"
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 #include "..\interactivity\base\ApiDetector.hpp"
@@ -631,9 +633,70 @@ NTSTATUS ConsoleAllocateConsole(PCONSOLE_API_CONNECTINFO p)
     return Status;
 }
 
+// Routine Description:
+// - Services one message on an IO worker and completes it, unless it had to wait.
+// Arguments:
+// - pMsg - The message as read from the driver.
+// Return Value:
+// - <none>
+static void _ServiceAndCompleteIo(_In_ CONSOLE_API_MSG* const pMsg)
+{
+    PCONSOLE_API_MSG ReplyMsg = nullptr;
+    IoSorter::ServiceIoOperation(pMsg, &ReplyMsg);
+
+    // A null reply means the message was copied into a wait block, which
+    //      completes it whenever the wait is satisfied.
+    if (ReplyMsg != nullptr)
+    {
+        LOG_IF_FAILED(ReplyMsg->ReleaseMessageBuffers());
+        LOG_IF_FAILED(ReplyMsg->_pDeviceComm->CompleteIo(&ReplyMsg->Complete));
+    }
+}
+
+// Routine Description:
+// - Reads IO requests and hands them to a pool of workers, so that requests
+//   from different clients can be serviced at the same time.
+// Arguments:
+// - pool - The workers to hand requests to.
+// Return Value:
+// - This routine never returns. The process exits when no more references or clients exist.
+static DWORD _ConsoleIoThreadWithWorkers(IoWorkerPool& pool)
+{
+    auto& globals = ServiceLocator::LocateGlobals();
+
+    while (true)
+    {
+        CONSOLE_API_MSG* const pMsg = pool.AcquireMessage();
+        pMsg->_pApiRoutines = &globals.api;
+        pMsg->_pDeviceComm = globals.pDeviceComm;
+
+        // Replies are completed by the workers, so there's never one to hand back here.
+        HRESULT hr = globals.pDeviceComm->ReadIo(nullptr, pMsg);
+        if (FAILED(hr))
+        {
+            if (hr == HRESULT_FROM_WIN32(ERROR_PIPE_NOT_CONNECTED))
+            {
+                // Let the workers finish what they have before we tear everything down.
+                pool.Drain();
+
+                ApiStatistics::Instance().WriteReportIfRequested();
+
+                // This will not return. Terminate immediately when disconnected.
+                ServiceLocator::RundownAndExit(STATUS_SUCCESS);
+            }
+            RIPMSG1(RIP_WARNING, "DeviceIoControl failed with Result 0x%x", hr);
+            pool.ReturnMessage(pMsg);
+            continue;
+        }
+
+        pool.Dispatch(pMsg);
+    }
+}
+
 // Routine Description:
 // - This routine is the main one in the console server IO thread.
 // - It reads IO requests submitted by clients through the driver, services and completes them in a loop.
+// - With more than one processor, requests are serviced on a small pool of workers instead.
 // Arguments:
 // - <none>
 // Return Value:
@@ -642,6 +705,24 @@ DWORD ConsoleIoThread()
 {
     auto& globals = ServiceLocator::LocateGlobals();
 
+    // Each API takes the console lock for the bulk of its work, so past a few
+    //      workers more threads only add contention.
+    const size_t workerCount = std::min<size_t>(std::thread::hardware_concurrency(), 4);
+    if (workerCount > 1)
+    {
+        std::unique_ptr<IoWorkerPool> pool;
+        try
+        {
+            pool = std::make_unique<IoWorkerPool>(workerCount, _ServiceAndCompleteIo);
+        }
+        CATCH_LOG();
+
+        if (pool)
+        {
+            return _ConsoleIoThreadWithWorkers(*pool);
+        }
+    }
+
     CONSOLE_API_MSG ReceiveMsg;
     ReceiveMsg._pApiRoutines = &globals.api;
     ReceiveMsg._pDeviceComm = globals.pDeviceComm;
@@ -663,6 +744,8 @@ DWORD ConsoleIoThread()
             {
                 fShouldExit = true;
 
+                ApiStatistics::Instance().WriteReportIfRequested();
+
                 // This will not return. Terminate immediately when disconnected.
                 ServiceLocator::RundownAndExit(STATUS_SUCCESS);
             }
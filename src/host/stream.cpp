@@ -59,8 +59,10 @@ NTSTATUS GetChar(_Inout_ InputBuffer* const pInputBuffer,
     NTSTATUS Status;
     for (;;)
     {
-        std::unique_ptr<IInputEvent> inputEvent;
-        Status = pInputBuffer->Read(inputEvent,
+        INPUT_RECORD record;
+        size_t eventsRead = 0;
+        Status = pInputBuffer->Read({ &record, 1 },
+                                    eventsRead,
                                     false, // peek
                                     Wait,
                                     true, // unicode
@@ -70,43 +72,44 @@ NTSTATUS GetChar(_Inout_ InputBuffer* const pInputBuffer,
         {
             return Status;
         }
-        else if (inputEvent.get() == nullptr)
+        else if (eventsRead == 0)
         {
             FAIL_FAST_IF(Wait);
             return STATUS_UNSUCCESSFUL;
         }
 
-        if (inputEvent->EventType() == InputEventType::KeyEvent)
+        if (record.EventType == KEY_EVENT)
         {
-            std::unique_ptr<KeyEvent> keyEvent = std::unique_ptr<KeyEvent>(static_cast<KeyEvent*>(inputEvent.release()));
+            // Looked at where it was read to, so reading a character doesn't allocate.
+            const KeyEvent keyEvent{ record.Event.KeyEvent };
 
             bool commandLineEditKey = false;
             if (pCommandLineEditingKeys)
             {
-                commandLineEditKey = keyEvent->IsCommandLineEditingKey();
+                commandLineEditKey = keyEvent.IsCommandLineEditingKey();
             }
             else if (pPopupKeys)
             {
-                commandLineEditKey = keyEvent->IsPopupKey();
+                commandLineEditKey = keyEvent.IsPopupKey();
             }
 
             if (pdwKeyState)
             {
-                *pdwKeyState = keyEvent->GetActiveModifierKeys();
+                *pdwKeyState = keyEvent.GetActiveModifierKeys();
             }
 
-            if (keyEvent->GetCharData() != 0 && !commandLineEditKey)
+            if (keyEvent.GetCharData() != 0 && !commandLineEditKey)
             {
                 // chars that are generated using alt + numpad
-                if (!keyEvent->IsKeyDown() && keyEvent->GetVirtualKeyCode() == VK_MENU)
+                if (!keyEvent.IsKeyDown() && keyEvent.GetVirtualKeyCode() == VK_MENU)
                 {
-                    if (keyEvent->IsAltNumpadSet())
+                    if (keyEvent.IsAltNumpadSet())
                     {
-                        if (HIBYTE(keyEvent->GetCharData()))
+                        if (HIBYTE(keyEvent.GetCharData()))
                         {
                             char chT[2] = {
-                                static_cast<char>(HIBYTE(keyEvent->GetCharData())),
-                                static_cast<char>(LOBYTE(keyEvent->GetCharData())),
+                                static_cast<char>(HIBYTE(keyEvent.GetCharData())),
+                                static_cast<char>(LOBYTE(keyEvent.GetCharData())),
                             };
                             *pwchOut = CharToWchar(chT, 2);
                         }
@@ -115,39 +118,39 @@ NTSTATUS GetChar(_Inout_ InputBuffer* const pInputBuffer,
                             // Because USER doesn't know our codepage,
                             // it gives us the raw OEM char and we
                             // convert it to a Unicode character.
-                            char chT = LOBYTE(keyEvent->GetCharData());
+                            char chT = LOBYTE(keyEvent.GetCharData());
                             *pwchOut = CharToWchar(&chT, 1);
                         }
                     }
                     else
                     {
-                        *pwchOut = keyEvent->GetCharData();
+                        *pwchOut = keyEvent.GetCharData();
                     }
                     return STATUS_SUCCESS;
                 }
                 // Ignore Escape and Newline chars
-                else if (keyEvent->IsKeyDown() &&
+                else if (keyEvent.IsKeyDown() &&
                     (WI_IsFlagSet(pInputBuffer->InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT) ||
-                         (keyEvent->GetVirtualKeyCode() != VK_ESCAPE &&
-                          keyEvent->GetCharData() != UNICODE_LINEFEED)))
+                         (keyEvent.GetVirtualKeyCode() != VK_ESCAPE &&
+                          keyEvent.GetCharData() != UNICODE_LINEFEED)))
                 {
-                    *pwchOut = keyEvent->GetCharData();
+                    *pwchOut = keyEvent.GetCharData();
                     return STATUS_SUCCESS;
                 }
             }
 
-            if (keyEvent->IsKeyDown())
+            if (keyEvent.IsKeyDown())
             {
                 if (pCommandLineEditingKeys && commandLineEditKey)
                 {
                     *pCommandLineEditingKeys = true;
-                    *pwchOut = static_cast<wchar_t>(keyEvent->GetVirtualKeyCode());
+                    *pwchOut = static_cast<wchar_t>(keyEvent.GetVirtualKeyCode());
                     return STATUS_SUCCESS;
                 }
                 else if (pPopupKeys && commandLineEditKey)
                 {
                     *pPopupKeys = true;
-                    *pwchOut = static_cast<char>(keyEvent->GetVirtualKeyCode());
+                    *pwchOut = static_cast<char>(keyEvent.GetVirtualKeyCode());
                     return STATUS_SUCCESS;
                 }
                 else
@@ -161,11 +164,11 @@ NTSTATUS GetChar(_Inout_ InputBuffer* const pInputBuffer,
                         // Convert real Windows NT modifier bit into bizarre Console bits
                         std::unordered_set<ModifierKeyState> consoleModKeyState = FromVkKeyScan(zeroControlKeyState);
 
-                        if (zeroVKey == keyEvent->GetVirtualKeyCode() &&
-                            keyEvent->DoActiveModifierKeysMatch(consoleModKeyState))
+                        if (zeroVKey == keyEvent.GetVirtualKeyCode() &&
+                            keyEvent.DoActiveModifierKeysMatch(consoleModKeyState))
                         {
                             // This really is the character 0x0000
-                            *pwchOut = keyEvent->GetCharData();
+                            *pwchOut = keyEvent.GetCharData();
                             return STATUS_SUCCESS;
                         }
                     }
@@ -405,12 +408,13 @@ static NTSTATUS _ReadPendingInput(InputBuffer& inputBuffer,
     {
         // if ansi, translate string.  we allocated the capture buffer
         // large enough to handle the translated string.
-        std::unique_ptr<char[]> tempBuffer = std::make_unique<char[]>(NumToBytes);
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto tempBuffer = gci.transcoder.GetNarrowScratch(NumToBytes);
         std::unique_ptr<IInputEvent> partialEvent;
 
         NumToWrite = TranslateUnicodeToOem(pBuffer,
                                            gsl::narrow<ULONG>(NumToWrite / sizeof(wchar_t)),
-                                           tempBuffer.get(),
+                                           tempBuffer.data(),
                                            gsl::narrow<ULONG>(NumToBytes),
                                            partialEvent);
         if (partialEvent.get())
@@ -419,7 +423,7 @@ static NTSTATUS _ReadPendingInput(InputBuffer& inputBuffer,
         }
 
 #pragma prefast(suppress:__WARNING_POTENTIAL_BUFFER_OVERFLOW_HIGH_PRIORITY, "This access is fine but prefast can't follow it, evidently")
-        memmove(pBuffer, tempBuffer.get(), NumToWrite);
+        memmove(pBuffer, tempBuffer.data(), NumToWrite);
 
         if (fAddDbcsLead)
         {
@@ -616,10 +620,11 @@ static NTSTATUS _ReadCharacterInput(InputBuffer& inputBuffer,
         // if ansi, translate string.  we allocated the capture buffer large enough to handle the translated string.
         if (!unicode)
         {
-            std::unique_ptr<char[]> tempBuffer;
+            CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+            gsl::span<char> tempBuffer;
             try
             {
-                tempBuffer = std::make_unique<char[]>(bytesRead);
+                tempBuffer = gci.transcoder.GetNarrowScratch(bytesRead);
             }
             catch (...)
             {
@@ -631,7 +636,7 @@ static NTSTATUS _ReadCharacterInput(InputBuffer& inputBuffer,
 
             bytesRead = TranslateUnicodeToOem(pBuffer,
                                               gsl::narrow<ULONG>(NumToWrite / sizeof(wchar_t)),
-                                              tempBuffer.get(),
+                                              tempBuffer.data(),
                                               gsl::narrow<ULONG>(bytesRead),
                                               partialEvent);
 
@@ -641,7 +646,7 @@ static NTSTATUS _ReadCharacterInput(InputBuffer& inputBuffer,
             }
 
 #pragma prefast(suppress:26053 26015, "PREfast claims read overflow. *pReadByteCount is the exact size of tempBuffer as allocated above.")
-            memmove(pBuffer, tempBuffer.get(), bytesRead);
+            memmove(pBuffer, tempBuffer.data(), bytesRead);
 
             if (addDbcsLead)
             {
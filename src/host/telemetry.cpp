@@ -164,20 +164,22 @@ void Telemetry::LogApiCall(const ApiCall api, const BOOLEAN fUnicode)
     // to use an array which has very quick access times.
     // The downside is we have to create an enum type, and then convert them to strings when we finally
     // send out the telemetry, but the upside is we should have very good performance.
+    // Calls from different clients are dispatched on several IO threads before they take the console lock,
+    // so the counts are bumped atomically.
     if (fUnicode)
     {
-        _rguiTimesApiUsed[api]++;
+        _rguiTimesApiUsed[api].fetch_add(1, std::memory_order_relaxed);
     }
     else
     {
-        _rguiTimesApiUsedAnsi[api]++;
+        _rguiTimesApiUsedAnsi[api].fetch_add(1, std::memory_order_relaxed);
     }
 }
 
 // Log an API call was used.
 void Telemetry::LogApiCall(const ApiCall api)
 {
-    _rguiTimesApiUsed[api]++;
+    _rguiTimesApiUsed[api].fetch_add(1, std::memory_order_relaxed);
 }
 
 // Log usage of the Find Dialog.
@@ -453,70 +455,70 @@ void Telemetry::WriteFinalTraceLog()
 #pragma prefast(suppress:__WARNING_NONCONST_LOCAL, "Activity can't be const, since it's set to a random value on startup.")
             TraceLoggingWriteTagged(_activity,
                 "ApiUsed",
-                TraceLoggingUInt32(_rguiTimesApiUsed[AddConsoleAlias], "AddConsoleAlias"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[AllocConsole], "AllocConsole"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[AttachConsole], "AttachConsole"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[CreateConsoleScreenBuffer], "CreateConsoleScreenBuffer"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GenerateConsoleCtrlEvent], "GenerateConsoleCtrlEvent"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[FillConsoleOutputAttribute], "FillConsoleOutputAttribute"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[FillConsoleOutputCharacter], "FillConsoleOutputCharacter"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[FlushConsoleInputBuffer], "FlushConsoleInputBuffer"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[FreeConsole], "FreeConsole"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAlias], "GetConsoleAlias"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliases], "GetConsoleAliases"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliasExesLength], "GetConsoleAliasExesLength"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliasesLength], "GetConsoleAliasesLength"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliasExes], "GetConsoleAliasExes"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleCP], "GetConsoleCP"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleCursorInfo], "GetConsoleCursorInfo"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleDisplayMode], "GetConsoleDisplayMode"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleFontSize], "GetConsoleFontSize"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleHistoryInfo], "GetConsoleHistoryInfo"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleLangId], "GetConsoleLangId"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleMode], "GetConsoleMode"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleOriginalTitle], "GetConsoleOriginalTitle"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleOutputCP], "GetConsoleOutputCP"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleProcessList], "GetConsoleProcessList"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleScreenBufferInfoEx], "GetConsoleScreenBufferInfoEx"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleSelectionInfo], "GetConsoleSelectionInfo"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleTitle], "GetConsoleTitle"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleWindow], "GetConsoleWindow"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetCurrentConsoleFontEx], "GetCurrentConsoleFontEx"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetLargestConsoleWindowSize], "GetLargestConsoleWindowSize"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetNumberOfConsoleInputEvents], "GetNumberOfConsoleInputEvents"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[GetNumberOfConsoleMouseButtons], "GetNumberOfConsoleMouseButtons"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[PeekConsoleInput], "PeekConsoleInput"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsole], "ReadConsole"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleInput], "ReadConsoleInput"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleOutput], "ReadConsoleOutput"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleOutputAttribute], "ReadConsoleOutputAttribute"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleOutputCharacter], "ReadConsoleOutputCharacter"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[ScrollConsoleScreenBuffer], "ScrollConsoleScreenBuffer"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleActiveScreenBuffer], "SetConsoleActiveScreenBuffer"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleCP], "SetConsoleCP"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleCursorInfo], "SetConsoleCursorInfo"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleCursorPosition], "SetConsoleCursorPosition"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleDisplayMode], "SetConsoleDisplayMode"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleHistoryInfo], "SetConsoleHistoryInfo"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleMode], "SetConsoleMode"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleOutputCP], "SetConsoleOutputCP"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleScreenBufferInfoEx], "SetConsoleScreenBufferInfoEx"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleScreenBufferSize], "SetConsoleScreenBufferSize"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleTextAttribute], "SetConsoleTextAttribute"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleTitle], "SetConsoleTitle"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleWindowInfo], "SetConsoleWindowInfo"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[SetCurrentConsoleFontEx], "SetCurrentConsoleFontEx"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsole], "WriteConsole"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleInput], "WriteConsoleInput"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleOutput], "WriteConsoleOutput"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleOutputAttribute], "WriteConsoleOutputAttribute"),
-                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleOutputCharacter], "WriteConsoleOutputCharacter"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[AddConsoleAlias].load(std::memory_order_relaxed), "AddConsoleAlias"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[AllocConsole].load(std::memory_order_relaxed), "AllocConsole"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[AttachConsole].load(std::memory_order_relaxed), "AttachConsole"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[CreateConsoleScreenBuffer].load(std::memory_order_relaxed), "CreateConsoleScreenBuffer"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GenerateConsoleCtrlEvent].load(std::memory_order_relaxed), "GenerateConsoleCtrlEvent"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[FillConsoleOutputAttribute].load(std::memory_order_relaxed), "FillConsoleOutputAttribute"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[FillConsoleOutputCharacter].load(std::memory_order_relaxed), "FillConsoleOutputCharacter"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[FlushConsoleInputBuffer].load(std::memory_order_relaxed), "FlushConsoleInputBuffer"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[FreeConsole].load(std::memory_order_relaxed), "FreeConsole"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAlias].load(std::memory_order_relaxed), "GetConsoleAlias"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliases].load(std::memory_order_relaxed), "GetConsoleAliases"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliasExesLength].load(std::memory_order_relaxed), "GetConsoleAliasExesLength"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliasesLength].load(std::memory_order_relaxed), "GetConsoleAliasesLength"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleAliasExes].load(std::memory_order_relaxed), "GetConsoleAliasExes"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleCP].load(std::memory_order_relaxed), "GetConsoleCP"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleCursorInfo].load(std::memory_order_relaxed), "GetConsoleCursorInfo"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleDisplayMode].load(std::memory_order_relaxed), "GetConsoleDisplayMode"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleFontSize].load(std::memory_order_relaxed), "GetConsoleFontSize"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleHistoryInfo].load(std::memory_order_relaxed), "GetConsoleHistoryInfo"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleLangId].load(std::memory_order_relaxed), "GetConsoleLangId"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleMode].load(std::memory_order_relaxed), "GetConsoleMode"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleOriginalTitle].load(std::memory_order_relaxed), "GetConsoleOriginalTitle"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleOutputCP].load(std::memory_order_relaxed), "GetConsoleOutputCP"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleProcessList].load(std::memory_order_relaxed), "GetConsoleProcessList"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleScreenBufferInfoEx].load(std::memory_order_relaxed), "GetConsoleScreenBufferInfoEx"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleSelectionInfo].load(std::memory_order_relaxed), "GetConsoleSelectionInfo"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleTitle].load(std::memory_order_relaxed), "GetConsoleTitle"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetConsoleWindow].load(std::memory_order_relaxed), "GetConsoleWindow"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetCurrentConsoleFontEx].load(std::memory_order_relaxed), "GetCurrentConsoleFontEx"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetLargestConsoleWindowSize].load(std::memory_order_relaxed), "GetLargestConsoleWindowSize"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetNumberOfConsoleInputEvents].load(std::memory_order_relaxed), "GetNumberOfConsoleInputEvents"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[GetNumberOfConsoleMouseButtons].load(std::memory_order_relaxed), "GetNumberOfConsoleMouseButtons"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[PeekConsoleInput].load(std::memory_order_relaxed), "PeekConsoleInput"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsole].load(std::memory_order_relaxed), "ReadConsole"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleInput].load(std::memory_order_relaxed), "ReadConsoleInput"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleOutput].load(std::memory_order_relaxed), "ReadConsoleOutput"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleOutputAttribute].load(std::memory_order_relaxed), "ReadConsoleOutputAttribute"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[ReadConsoleOutputCharacter].load(std::memory_order_relaxed), "ReadConsoleOutputCharacter"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[ScrollConsoleScreenBuffer].load(std::memory_order_relaxed), "ScrollConsoleScreenBuffer"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleActiveScreenBuffer].load(std::memory_order_relaxed), "SetConsoleActiveScreenBuffer"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleCP].load(std::memory_order_relaxed), "SetConsoleCP"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleCursorInfo].load(std::memory_order_relaxed), "SetConsoleCursorInfo"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleCursorPosition].load(std::memory_order_relaxed), "SetConsoleCursorPosition"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleDisplayMode].load(std::memory_order_relaxed), "SetConsoleDisplayMode"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleHistoryInfo].load(std::memory_order_relaxed), "SetConsoleHistoryInfo"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleMode].load(std::memory_order_relaxed), "SetConsoleMode"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleOutputCP].load(std::memory_order_relaxed), "SetConsoleOutputCP"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleScreenBufferInfoEx].load(std::memory_order_relaxed), "SetConsoleScreenBufferInfoEx"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleScreenBufferSize].load(std::memory_order_relaxed), "SetConsoleScreenBufferSize"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleTextAttribute].load(std::memory_order_relaxed), "SetConsoleTextAttribute"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleTitle].load(std::memory_order_relaxed), "SetConsoleTitle"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetConsoleWindowInfo].load(std::memory_order_relaxed), "SetConsoleWindowInfo"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[SetCurrentConsoleFontEx].load(std::memory_order_relaxed), "SetCurrentConsoleFontEx"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsole].load(std::memory_order_relaxed), "WriteConsole"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleInput].load(std::memory_order_relaxed), "WriteConsoleInput"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleOutput].load(std::memory_order_relaxed), "WriteConsoleOutput"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleOutputAttribute].load(std::memory_order_relaxed), "WriteConsoleOutputAttribute"),
+                TraceLoggingUInt32(_rguiTimesApiUsed[WriteConsoleOutputCharacter].load(std::memory_order_relaxed), "WriteConsoleOutputCharacter"),
                 TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
                 TelemetryPrivacyDataTag(PDT_ProductAndServiceUsage));
 
             for (int n = 0; n < ARRAYSIZE(_rguiTimesApiUsedAnsi); n++)
             {
-                if (_rguiTimesApiUsedAnsi[n])
+                if (_rguiTimesApiUsedAnsi[n].load(std::memory_order_relaxed))
                 {
                     // Ansi specific API's are used less, so check if we have anything to send back.
                     // Also breaking it up into a separate TraceLoggingWriteTagged fixes a compilation warning that
@@ -524,25 +526,25 @@ void Telemetry::WriteFinalTraceLog()
 #pragma prefast(suppress:__WARNING_NONCONST_LOCAL, "Activity can't be const, since it's set to a random value on startup.")
                     TraceLoggingWriteTagged(_activity,
                         "ApiAnsiUsed",
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[AddConsoleAlias], "AddConsoleAlias"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[FillConsoleOutputCharacter], "FillConsoleOutputCharacter"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAlias], "GetConsoleAlias"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliases], "GetConsoleAliases"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliasesLength], "GetConsoleAliasesLength"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliasExes], "GetConsoleAliasExes"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliasExesLength], "GetConsoleAliasExesLength"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleOriginalTitle], "GetConsoleOriginalTitle"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleTitle], "GetConsoleTitle"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[PeekConsoleInput], "PeekConsoleInput"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsole], "ReadConsole"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsoleInput], "ReadConsoleInput"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsoleOutput], "ReadConsoleOutput"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsoleOutputCharacter], "ReadConsoleOutputCharacter"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[SetConsoleTitle], "SetConsoleTitle"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsole], "WriteConsole"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsoleInput], "WriteConsoleInput"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsoleOutput], "WriteConsoleOutput"),
-                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsoleOutputCharacter], "WriteConsoleOutputCharacter"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[AddConsoleAlias].load(std::memory_order_relaxed), "AddConsoleAlias"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[FillConsoleOutputCharacter].load(std::memory_order_relaxed), "FillConsoleOutputCharacter"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAlias].load(std::memory_order_relaxed), "GetConsoleAlias"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliases].load(std::memory_order_relaxed), "GetConsoleAliases"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliasesLength].load(std::memory_order_relaxed), "GetConsoleAliasesLength"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliasExes].load(std::memory_order_relaxed), "GetConsoleAliasExes"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleAliasExesLength].load(std::memory_order_relaxed), "GetConsoleAliasExesLength"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleOriginalTitle].load(std::memory_order_relaxed), "GetConsoleOriginalTitle"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[GetConsoleTitle].load(std::memory_order_relaxed), "GetConsoleTitle"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[PeekConsoleInput].load(std::memory_order_relaxed), "PeekConsoleInput"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsole].load(std::memory_order_relaxed), "ReadConsole"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsoleInput].load(std::memory_order_relaxed), "ReadConsoleInput"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsoleOutput].load(std::memory_order_relaxed), "ReadConsoleOutput"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[ReadConsoleOutputCharacter].load(std::memory_order_relaxed), "ReadConsoleOutputCharacter"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[SetConsoleTitle].load(std::memory_order_relaxed), "SetConsoleTitle"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsole].load(std::memory_order_relaxed), "WriteConsole"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsoleInput].load(std::memory_order_relaxed), "WriteConsoleInput"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsoleOutput].load(std::memory_order_relaxed), "WriteConsoleOutput"),
+                        TraceLoggingUInt32(_rguiTimesApiUsedAnsi[WriteConsoleOutputCharacter].load(std::memory_order_relaxed), "WriteConsoleOutputCharacter"),
                         TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
                         TelemetryPrivacyDataTag(PDT_ProductAndServiceUsage));
                     break;
@@ -163,9 +163,10 @@ private:
     unsigned int _rguiProcessFileNamesFailedCodesCount[c_iMaxProcessesConnected];
     // Total of how many failed codes each process used outside the valid range.
     unsigned int _rguiProcessFileNamesFailedOutsideCodesCount[c_iMaxProcessesConnected];
-    unsigned int _rguiTimesApiUsed[NUMBER_OF_APIS];
+    // Bumped from every IO thread before the console lock is taken.
+    std::atomic<unsigned int> _rguiTimesApiUsed[NUMBER_OF_APIS];
     // Most of this array will be empty, and is only used if an API has an ansi specific variant.
-    unsigned int _rguiTimesApiUsedAnsi[NUMBER_OF_APIS];
+    std::atomic<unsigned int> _rguiTimesApiUsedAnsi[NUMBER_OF_APIS];
     // Total number of file names we've added.
     UINT16 _uiNumberProcessFileNames;
 
@@ -15,6 +15,7 @@
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
 using namespace Microsoft::Console::Types;
+using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
 
@@ -416,6 +417,54 @@ class ApiRoutinesTests
         }
     }
 
+    TEST_METHOD(ApiWriteConsoleAShortAndChunkedWrites)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:dwCodePage", L"{437, 65001}")
+        END_TEST_METHOD_PROPERTIES();
+
+        // Narrow clients write through WriteConsoleA both in many short writes
+        //      and in large ones split into pipe sized chunks. Every byte of
+        //      either has to be taken.
+        DWORD dwCodePage;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"dwCodePage", dwCodePage));
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        gci.OutputCP = dwCodePage;
+        SetConsoleCPInfo(TRUE);
+
+        const std::string shortLine{ "short line of text\r\n" };
+        std::string largeText;
+        while (largeText.size() < 64 * 1024)
+        {
+            largeText.append("the quick brown fox jumps over the lazy dog 0123456789\r\n");
+        }
+
+        const auto writeAll = [&](const std::string_view text, const size_t chunk) {
+            for (size_t i = 0; i < text.size(); i += chunk)
+            {
+                const auto piece = text.substr(i, chunk);
+                size_t cchRead = 0;
+                std::unique_ptr<IWaitRoutine> waiter;
+                VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleAImpl(si, piece, cchRead, waiter));
+                VERIFY_ARE_EQUAL(piece.size(), cchRead);
+            }
+        };
+
+        const size_t shortWrites = 100;
+        for (size_t i = 0; i < shortWrites; i++)
+        {
+            writeAll(shortLine, shortLine.size());
+        }
+
+        writeAll(largeText, 4096);
+    }
+
     TEST_METHOD(ApiWriteConsoleW)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
@@ -854,4 +903,122 @@ class ApiRoutinesTests
 
         ValidateComplexScreen(si, background, fill, scrollRect, Viewport::FromInclusive(scroll), destination, clipViewport);
     }
+
+    TEST_METHOD(ApiWriteReadConsoleOutputW)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+
+        VERIFY_SUCCEEDED(si.GetTextBuffer().ResizeTraditional({ 8, 4 }));
+        si.GetActiveBuffer().ClearTextData();
+
+        // Every column gets a different character, and the colors change in runs of varying length.
+        std::vector<CHAR_INFO> written(8 * 4);
+        for (size_t i = 0; i < written.size(); i++)
+        {
+            written[i].Char.UnicodeChar = static_cast<wchar_t>(L'a' + i % 26);
+            written[i].Attributes = static_cast<WORD>(((i / 3) % 2) ? FOREGROUND_RED | BACKGROUND_BLUE : FOREGROUND_GREEN);
+        }
+
+        Log::Comment(L"Write the whole buffer and read it back.");
+        const auto whole = Viewport::FromDimensions({ 0, 0 }, { 8, 4 });
+        Viewport writtenRectangle = Viewport::Empty();
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, written, whole, writtenRectangle));
+        VERIFY_ARE_EQUAL(whole.ToInclusive(), writtenRectangle.ToInclusive());
+
+        std::vector<CHAR_INFO> read(written.size());
+        Viewport readRectangle = Viewport::Empty();
+        VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, read, whole, readRectangle));
+        VERIFY_ARE_EQUAL(whole.ToInclusive(), readRectangle.ToInclusive());
+        for (size_t i = 0; i < read.size(); i++)
+        {
+            VERIFY_ARE_EQUAL(written[i].Char.UnicodeChar, read[i].Char.UnicodeChar);
+            VERIFY_ARE_EQUAL(written[i].Attributes, read[i].Attributes);
+        }
+
+        Log::Comment(L"Read a request hanging off the top left corner. Only the part inside the buffer is filled in.");
+        const auto offset = Viewport::FromDimensions({ -2, -1 }, { 4, 3 });
+        CHAR_INFO untouched;
+        untouched.Char.UnicodeChar = L'#';
+        untouched.Attributes = FOREGROUND_BLUE;
+        std::vector<CHAR_INFO> clipped(4 * 3, untouched);
+        VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, clipped, offset, readRectangle));
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 0 }, { 2, 2 }).ToInclusive(), readRectangle.ToInclusive());
+        for (SHORT y = 0; y < 3; y++)
+        {
+            for (SHORT x = 0; x < 4; x++)
+            {
+                const auto& cell = clipped[y * 4 + x];
+                if (x < 2 || y < 1)
+                {
+                    VERIFY_ARE_EQUAL(untouched.Char.UnicodeChar, cell.Char.UnicodeChar);
+                }
+                else
+                {
+                    const auto& expected = written[(y - 1) * 8 + (x - 2)];
+                    VERIFY_ARE_EQUAL(expected.Char.UnicodeChar, cell.Char.UnicodeChar);
+                    VERIFY_ARE_EQUAL(expected.Attributes, cell.Attributes);
+                }
+            }
+        }
+
+        Log::Comment(L"Write a request hanging off the bottom right corner. Only the part inside the buffer is written.");
+        CHAR_INFO fill;
+        fill.Char.UnicodeChar = L'Z';
+        fill.Attributes = FOREGROUND_INTENSITY | BACKGROUND_RED;
+        std::vector<CHAR_INFO> overlay(3 * 3, fill);
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, overlay, Viewport::FromDimensions({ 6, 2 }, { 3, 3 }), writtenRectangle));
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 6, 2 }, { 2, 2 }).ToInclusive(), writtenRectangle.ToInclusive());
+
+        VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, read, whole, readRectangle));
+        for (SHORT y = 0; y < 4; y++)
+        {
+            for (SHORT x = 0; x < 8; x++)
+            {
+                const auto& expected = (x >= 6 && y >= 2) ? fill : written[y * 8 + x];
+                const auto& cell = read[y * 8 + x];
+                VERIFY_ARE_EQUAL(expected.Char.UnicodeChar, cell.Char.UnicodeChar);
+                VERIFY_ARE_EQUAL(expected.Attributes, cell.Attributes);
+            }
+        }
+    }
+
+    TEST_METHOD(ApiConsoleOutputReadModifyWriteCycles)
+    {
+        // Full screen read-modify-write cycles through the API routines, like
+        //      an app that redraws its whole window with CHAR_INFOs. Every read
+        //      has to return what the cycle before it wrote.
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+
+        VERIFY_SUCCEEDED(si.GetTextBuffer().ResizeTraditional({ 120, 30 }));
+        const auto whole = si.GetBufferSize();
+
+        std::vector<CHAR_INFO> cells(whole.Width() * whole.Height());
+        Viewport rectangle = Viewport::Empty();
+
+        const auto charAt = [](const size_t i, const size_t cycle) { return static_cast<wchar_t>(L'A' + (i + cycle) % 26); };
+        const auto attributesAt = [](const size_t i, const size_t cycle) { return static_cast<WORD>((i / 8 + cycle) % 16); };
+
+        const size_t cycles = 4;
+        for (size_t cycle = 0; cycle < cycles; cycle++)
+        {
+            VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, cells, whole, rectangle));
+            if (cycle > 0)
+            {
+                for (size_t i = 0; i < cells.size(); i++)
+                {
+                    VERIFY_ARE_EQUAL(charAt(i, cycle - 1), cells[i].Char.UnicodeChar);
+                    VERIFY_ARE_EQUAL(attributesAt(i, cycle - 1), cells[i].Attributes);
+                }
+            }
+
+            for (size_t i = 0; i < cells.size(); i++)
+            {
+                cells[i].Char.UnicodeChar = charAt(i, cycle);
+                cells[i].Attributes = attributesAt(i, cycle);
+            }
+            VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, whole, rectangle));
+        }
+    }
 };
@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "..\..\server\ApiStatistics.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class ApiStatisticsTests
+{
+    TEST_CLASS(ApiStatisticsTests);
+
+    TEST_METHOD(BucketsCoverEveryLatency)
+    {
+        size_t previousBucket = 0;
+        for (ULONGLONG microseconds = 0; microseconds < 1000000; microseconds++)
+        {
+            const size_t bucket = ApiStatistics::s_GetBucket(microseconds);
+            VERIFY_IS_LESS_THAN(bucket, ApiStatistics::s_bucketCount);
+
+            // Buckets only go up, one at a time, and each latency falls
+            //      between the bounds of its bucket and the one before.
+            if (bucket != previousBucket)
+            {
+                VERIFY_ARE_EQUAL(previousBucket + 1, bucket);
+                VERIFY_ARE_EQUAL(ApiStatistics::s_GetBucketUpperBound(previousBucket) + 1, microseconds);
+                previousBucket = bucket;
+            }
+
+            const ULONGLONG upperBound = ApiStatistics::s_GetBucketUpperBound(bucket);
+            VERIFY_IS_LESS_THAN_OR_EQUAL(microseconds, upperBound);
+            VERIFY_IS_LESS_THAN_OR_EQUAL(upperBound - microseconds, microseconds / 4, L"Each bucket is within a quarter of its latencies.");
+        }
+
+        Log::Comment(L"Latencies past the last bucket land in it.");
+        VERIFY_ARE_EQUAL(ApiStatistics::s_bucketCount - 1, ApiStatistics::s_GetBucket(~0ull));
+    }
+
+    TEST_METHOD(AddsUpCallsFromEveryThread)
+    {
+        ApiStatistics statistics;
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+
+        const ULONGLONG callsPerThread = 1000;
+        const auto record = [&]() {
+            for (ULONGLONG call = 0; call < callsPerThread; call++)
+            {
+                const auto start = ApiStatistics::s_BeginCall();
+                ApiStatistics::s_AddLockWait(frequency.QuadPart / 1000);
+                statistics.RecordCall(start, 0, 6, "WriteConsole", 100, 0);
+                statistics.RecordCall(ApiStatistics::s_BeginCall(), 1, 7, "GetConsoleScreenBufferInfo", 40, 96);
+            }
+        };
+
+        std::thread first(record);
+        std::thread second(record);
+        first.join();
+        second.join();
+
+        Log::Comment(L"APIs out of range are ignored.");
+        statistics.RecordCall(ApiStatistics::s_BeginCall(), ApiStatistics::s_layerCount, 0, "Bogus", 1, 1);
+
+        const auto summaries = statistics.Summarize();
+        VERIFY_ARE_EQUAL(size_t{ 2 }, summaries.size());
+
+        const auto& write = summaries[0];
+        VERIFY_ARE_EQUAL(std::string("WriteConsole"), std::string(write.name));
+        VERIFY_ARE_EQUAL(0ul, write.layer);
+        VERIFY_ARE_EQUAL(6ul, write.api);
+        VERIFY_ARE_EQUAL(2 * callsPerThread, write.calls);
+        VERIFY_ARE_EQUAL(2 * callsPerThread * 100, write.bytesIn);
+        VERIFY_ARE_EQUAL(0ull, write.bytesOut);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(write.lockWaitMicroseconds, 2 * callsPerThread * 999, L"Each call waited about a millisecond for the lock.");
+        VERIFY_IS_LESS_THAN_OR_EQUAL(write.lockWaitMicroseconds, 2 * callsPerThread * 1000);
+
+        const auto& query = summaries[1];
+        VERIFY_ARE_EQUAL(2 * callsPerThread, query.calls);
+        VERIFY_ARE_EQUAL(2 * callsPerThread * 96, query.bytesOut);
+        VERIFY_ARE_EQUAL(0ull, query.lockWaitMicroseconds);
+        VERIFY_IS_LESS_THAN_OR_EQUAL(query.Percentile(0.5), query.Percentile(0.99));
+        VERIFY_IS_LESS_THAN_OR_EQUAL(query.Percentile(0.99), query.Percentile(1.0));
+
+        const std::string report = statistics.FormatReport();
+        Log::Comment(NoThrowString().Format(L"%hs", report.c_str()));
+        VERIFY_ARE_NOT_EQUAL(std::string::npos, report.find("GetConsoleScreenBufferInfo"));
+    }
+};
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "codepageTranscoder.hpp"
+#include "../types/inc/convert.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class CodepageTranscoderTests
+{
+    TEST_CLASS(CodepageTranscoderTests);
+
+    TEST_METHOD(ChecksAsciiCompatibility)
+    {
+        CodepageTranscoder transcoder;
+        VERIFY_IS_TRUE(transcoder.IsAsciiCompatible(CP_UTF8));
+        VERIFY_IS_TRUE(transcoder.IsAsciiCompatible(437));
+        VERIFY_IS_TRUE(transcoder.IsAsciiCompatible(1252));
+        VERIFY_IS_TRUE(transcoder.IsAsciiCompatible(932));
+
+        // IBM EBCDIC US-Canada puts letters and digits elsewhere.
+        VERIFY_IS_FALSE(transcoder.IsAsciiCompatible(37));
+
+        Log::Comment(L"More codepages than the cache holds should still all be answered correctly.");
+        VERIFY_IS_TRUE(transcoder.IsAsciiCompatible(850));
+        VERIFY_IS_FALSE(transcoder.IsAsciiCompatible(37));
+        VERIFY_IS_TRUE(transcoder.IsAsciiCompatible(CP_UTF8));
+    }
+
+    TEST_METHOD(ToWideMatchesConvertToW)
+    {
+        CodepageTranscoder transcoder;
+
+        const std::pair<UINT, std::string_view> cases[] = {
+            { CP_UTF8, "plain ASCII, longer than one block" },
+            { CP_UTF8, "ASCII, then \xe3\x82\xab and ASCII again" },
+            { 437, "box \xc9\xcd\xbb drawing" },
+            { 932, "J\x82\xa0\x82\xa2 Shift-JIS with ASCII after it" },
+            { 37, "\xc8\x85\x93\x93\x96" }, // "Hello" in EBCDIC
+        };
+
+        for (const auto& [codepage, source] : cases)
+        {
+            const auto expected = ConvertToW(codepage, source);
+
+            const auto scratch = transcoder.GetWideScratch(source.size());
+            size_t written = 0;
+            VERIFY_SUCCEEDED(transcoder.ToWide(codepage, 0, source, scratch, written));
+            VERIFY_ARE_EQUAL(expected, std::wstring(scratch.data(), written));
+        }
+    }
+
+    TEST_METHOD(ToWideReportsIncompleteUtf8)
+    {
+        Log::Comment(L"A sequence cut off at the end should fail with MB_ERR_INVALID_CHARS, so callers can fall back.");
+
+        CodepageTranscoder transcoder;
+        const std::string_view source{ "ASCII then half of \xe3\x82" };
+        const auto scratch = transcoder.GetWideScratch(source.size());
+        size_t written = 0;
+        VERIFY_ARE_EQUAL(HRESULT_FROM_WIN32(ERROR_NO_UNICODE_TRANSLATION),
+                         transcoder.ToWide(CP_UTF8, MB_ERR_INVALID_CHARS, source, scratch, written));
+        VERIFY_ARE_EQUAL(0u, written);
+    }
+
+    TEST_METHOD(ToWideReplacesIncompleteUtf8)
+    {
+        Log::Comment(L"Without MB_ERR_INVALID_CHARS, a sequence cut off at the end becomes U+FFFD, like MultiByteToWideChar does.");
+
+        CodepageTranscoder transcoder;
+        const std::string_view source{ "cut \xf0\x9f\x98" };
+        const auto scratch = transcoder.GetWideScratch(source.size());
+        size_t written = 0;
+        VERIFY_SUCCEEDED(transcoder.ToWide(CP_UTF8, 0, source, scratch, written));
+        VERIFY_ARE_EQUAL(std::wstring(L"cut \xfffd"), std::wstring(scratch.data(), written));
+
+        Log::Comment(L"Running out of room isn't mistaken for a cut off sequence.");
+        VERIFY_ARE_EQUAL(HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER),
+                         transcoder.ToWide(CP_UTF8, 0, "\xf0\x9f\x98\x80", scratch.subspan(0, 1), written));
+    }
+
+    TEST_METHOD(ScratchKeepsItsLargestSize)
+    {
+        CodepageTranscoder transcoder;
+
+        const auto large = transcoder.GetWideScratch(100);
+        const auto small = transcoder.GetWideScratch(10);
+        VERIFY_ARE_EQUAL(large.data(), small.data());
+        VERIFY_ARE_EQUAL(10, small.size());
+
+        const auto largeNarrow = transcoder.GetNarrowScratch(100);
+        const auto smallNarrow = transcoder.GetNarrowScratch(10);
+        VERIFY_ARE_EQUAL(largeNarrow.data(), smallNarrow.data());
+    }
+};
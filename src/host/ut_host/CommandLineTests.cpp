@@ -538,4 +538,91 @@ class CommandLineTests
             }
         }
     }
+
+    TEST_METHOD(MidLineEditsShiftTheRestOfTheLine)
+    {
+        auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
+        VERIFY_IS_NOT_NULL(buffer.get());
+        auto& consoleInfo = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& screenInfo = consoleInfo.GetActiveOutputBuffer();
+        auto& cursor = screenInfo.GetTextBuffer().GetCursor();
+        auto& cookedReadData = consoleInfo.CookedReadData();
+        InitCookedReadData(cookedReadData, m_pHistory, buffer.get(), PROMPT_SIZE);
+        cookedReadData._insertMode = true;
+        cursor.SetPosition({ 0, 0 });
+
+        const auto screenText = [&](const size_t length) {
+            std::wstring text;
+            for (size_t row = 0; text.size() < length; row++)
+            {
+                text += screenInfo.GetTextBuffer().GetRowByOffset(row).GetText();
+            }
+            return text.substr(0, length);
+        };
+
+        Log::Comment(L"Type a line long enough to wrap, then go back into the middle of it.");
+        std::wstring line;
+        for (size_t i = 0; i < 150; i++)
+        {
+            line.push_back(static_cast<wchar_t>(L'a' + i % 26));
+        }
+        VERIFY_ARE_EQUAL(line.size(), cookedReadData.Write(line));
+        MoveCursor(cookedReadData, 10);
+        cursor.SetPosition({ 10, 0 });
+
+        Log::Comment(L"Inserting moves the rest of the line right, across the wrap.");
+        NTSTATUS status = STATUS_SUCCESS;
+        VERIFY_IS_FALSE(cookedReadData.ProcessInput(L'#', 0, status));
+        line.insert(10, 1, L'#');
+        VerifyPromptText(cookedReadData, line);
+        VERIFY_ARE_EQUAL(line + L" ", screenText(line.size() + 1));
+        VERIFY_ARE_EQUAL(COORD({ 11, 0 }), cursor.GetPosition());
+
+        Log::Comment(L"Backspace moves it back and blanks the cell the line no longer reaches.");
+        VERIFY_IS_FALSE(cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status));
+        line.erase(10, 1);
+        VerifyPromptText(cookedReadData, line);
+        VERIFY_ARE_EQUAL(line + L"  ", screenText(line.size() + 2));
+        VERIFY_ARE_EQUAL(COORD({ 10, 0 }), cursor.GetPosition());
+        VERIFY_ARE_EQUAL(line.size(), cookedReadData._visibleCharCount);
+    }
+
+    TEST_METHOD(MidLineKeystrokesInLongLine)
+    {
+        // Typing and then deleting in the middle of a line several rows long
+        //      has to leave the line as it was.
+        constexpr size_t lineLength = 2000;
+        constexpr size_t keystrokes = 20;
+        auto buffer = std::make_unique<wchar_t[]>(lineLength * 2);
+        VERIFY_IS_NOT_NULL(buffer.get());
+        auto& consoleInfo = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& screenInfo = consoleInfo.GetActiveOutputBuffer();
+        auto& cursor = screenInfo.GetTextBuffer().GetCursor();
+        auto& cookedReadData = consoleInfo.CookedReadData();
+        InitCookedReadData(cookedReadData, m_pHistory, buffer.get(), lineLength * 2);
+        cookedReadData._insertMode = true;
+        cursor.SetPosition({ 0, 0 });
+
+        std::wstring line;
+        for (size_t i = 0; i < lineLength; i++)
+        {
+            line.push_back(static_cast<wchar_t>(L'a' + i % 26));
+        }
+        VERIFY_ARE_EQUAL(line.size(), cookedReadData.Write(line));
+
+        const SHORT width = screenInfo.GetBufferSize().Width();
+        MoveCursor(cookedReadData, lineLength / 2);
+        cursor.SetPosition({ gsl::narrow<SHORT>((lineLength / 2) % width), gsl::narrow<SHORT>((lineLength / 2) / width) });
+
+        NTSTATUS status = STATUS_SUCCESS;
+        for (size_t i = 0; i < keystrokes / 2; i++)
+        {
+            cookedReadData.ProcessInput(L'#', 0, status);
+        }
+        for (size_t i = 0; i < keystrokes / 2; i++)
+        {
+            cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status);
+        }
+        VerifyPromptText(cookedReadData, line);
+    }
 };
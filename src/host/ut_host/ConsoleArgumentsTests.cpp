@@ -32,6 +32,7 @@ public:
     TEST_METHOD(HeadlessArgTests);
     TEST_METHOD(SignalHandleTests);
     TEST_METHOD(FeatureArgTests);
+    TEST_METHOD(BenchmarkArgTests);
 
 };
 
@@ -1122,3 +1123,27 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     false), // inheritCursor
                    false); // successful parse?
 }
+
+void ConsoleArgumentsTests::BenchmarkArgTests()
+{
+    std::wstring commandline;
+
+    commandline = L"conhost.exe --benchmark";
+    Log::Comment(commandline.c_str());
+    ConsoleArguments args = CreateAndParse(commandline, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE);
+    VERIFY_IS_TRUE(args.IsBenchmark());
+    VERIFY_IS_TRUE(args.GetClientCommandline().empty());
+
+    commandline = L"conhost.exe --width 120 --benchmark --height 30";
+    Log::Comment(L"The benchmark takes the other settings along.");
+    args = CreateAndParse(commandline, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE);
+    VERIFY_IS_TRUE(args.IsBenchmark());
+    VERIFY_ARE_EQUAL(short{ 120 }, args.GetWidth());
+    VERIFY_ARE_EQUAL(short{ 30 }, args.GetHeight());
+
+    commandline = L"conhost.exe -- foo.exe --benchmark";
+    Log::Comment(L"--benchmark as a client commandline doesn't run the benchmark");
+    args = CreateAndParse(commandline, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE);
+    VERIFY_IS_FALSE(args.IsBenchmark());
+    VERIFY_ARE_EQUAL(std::wstring(L"foo.exe --benchmark"), args.GetClientCommandline());
+}
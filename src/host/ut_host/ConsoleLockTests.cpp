@@ -0,0 +1,279 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "ApiRoutines.h"
+#include "selection.hpp"
+
+#include "..\interactivity\inc\ServiceLocator.hpp"
+
+#include "..\..\renderer\base\renderer.hpp"
+#include "..\..\renderer\inc\RecordingRenderEngine.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+// The tests paint frames themselves, so the renderer doesn't need a thread.
+class LockTestRenderThread final : public IRenderThread
+{
+public:
+    void NotifyPaint() override {}
+    void EnablePainting() override {}
+    void WaitForPaintCompletionAndDisable(const DWORD /*dwTimeoutMs*/) override {}
+};
+
+class ConsoleLockTests
+{
+    TEST_CLASS(ConsoleLockTests);
+
+    TEST_METHOD(ExclusiveHoldsAreRecursive)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        VERIFY_IS_FALSE(gci.IsConsoleLocked());
+
+        gci.LockConsole();
+        gci.LockConsole();
+        VERIFY_IS_TRUE(gci.IsConsoleLocked());
+        VERIFY_ARE_EQUAL(2u, gci.GetCSRecursionCount());
+
+        Log::Comment(L"Taking it shared while holding it exclusively just extends the exclusive hold.");
+        gci.LockConsoleShared();
+        VERIFY_ARE_EQUAL(3u, gci.GetCSRecursionCount());
+        gci.UnlockConsoleShared();
+        VERIFY_ARE_EQUAL(2u, gci.GetCSRecursionCount());
+
+        gci.UnlockConsole();
+        VERIFY_IS_TRUE(gci.IsConsoleLocked());
+        gci.UnlockConsole();
+        VERIFY_IS_FALSE(gci.IsConsoleLocked());
+    }
+
+    TEST_METHOD(SharedHoldsOnlyKeepOutWriters)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        gci.LockConsoleShared();
+        gci.LockConsoleShared();
+        VERIFY_IS_FALSE(gci.IsConsoleLocked(), L"A shared hold doesn't make this thread the owner.");
+
+        bool otherReaderGotIn = false;
+        bool otherWriterGotIn = true;
+        std::thread other([&]() {
+            gci.LockConsoleShared();
+            otherReaderGotIn = true;
+            gci.UnlockConsoleShared();
+
+            otherWriterGotIn = gci.TryLockConsole();
+            if (otherWriterGotIn)
+            {
+                gci.UnlockConsole();
+            }
+        });
+        other.join();
+
+        VERIFY_IS_TRUE(otherReaderGotIn);
+        VERIFY_IS_FALSE(otherWriterGotIn);
+
+        gci.UnlockConsoleShared();
+        gci.UnlockConsoleShared();
+
+        Log::Comment(L"Once the last shared hold is gone, writers get in again.");
+        std::thread writer([&]() {
+            otherWriterGotIn = gci.TryLockConsole();
+            if (otherWriterGotIn)
+            {
+                gci.UnlockConsole();
+            }
+        });
+        writer.join();
+        VERIFY_IS_TRUE(otherWriterGotIn);
+    }
+
+    TEST_METHOD(ExclusiveHoldUnderASharedOneFallsBack)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto before = gci.GetLockStatistics();
+
+        gci.LockConsoleShared();
+
+        Log::Comment(L"Asking for it exclusively gives up the shared hold, instead of waiting on it forever.");
+        gci.LockConsole();
+        VERIFY_IS_TRUE(gci.IsConsoleLocked());
+        VERIFY_ARE_EQUAL(before.promotedAcquisitions + 1, gci.GetLockStatistics().promotedAcquisitions);
+
+        gci.UnlockConsole();
+        VERIFY_IS_FALSE(gci.IsConsoleLocked());
+
+        Log::Comment(L"Once the exclusive hold ends, the shared one is back and keeps writers out again.");
+        bool otherWriterGotIn = true;
+        std::thread writer([&]() {
+            otherWriterGotIn = gci.TryLockConsole();
+            if (otherWriterGotIn)
+            {
+                gci.UnlockConsole();
+            }
+        });
+        writer.join();
+        VERIFY_IS_FALSE(otherWriterGotIn);
+
+        gci.UnlockConsoleShared();
+
+        std::thread laterWriter([&]() {
+            otherWriterGotIn = gci.TryLockConsole();
+            if (otherWriterGotIn)
+            {
+                gci.UnlockConsole();
+            }
+        });
+        laterWriter.join();
+        VERIFY_IS_TRUE(otherWriterGotIn);
+    }
+
+    TEST_METHOD(SharedPathsNeverTakeItExclusively)
+    {
+        // Everything that takes the lock shared may only read console state.
+        //      If anything under a shared hold asked for it exclusively, it'd
+        //      have to give up the shared hold first, which is counted.
+        CommonState state;
+        state.PrepareGlobalFont();
+        state.PrepareGlobalScreenBuffer();
+        state.PrepareGlobalInputBuffer();
+        auto cleanup = wil::scope_exit([&]() {
+            state.CleanupGlobalInputBuffer();
+            state.CleanupGlobalScreenBuffer();
+            state.CleanupGlobalFont();
+        });
+
+        Globals& g = ServiceLocator::LocateGlobals();
+        CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        InputBuffer& inputBuffer = *gci.pInputBuffer;
+        ApiRoutines routines;
+
+        RecordingRenderEngine engine{ si.GetViewport().Dimensions() };
+        IRenderEngine* engines[] = { &engine };
+        Renderer renderer{ &gci.renderData, engines, ARRAYSIZE(engines), std::make_unique<LockTestRenderThread>() };
+
+        auto* const pPreviousRenderer = g.pRender;
+        g.pRender = &renderer;
+        auto restoreRenderer = wil::scope_exit([&]() { g.pRender = pPreviousRenderer; });
+
+        const auto verifyOnlyShared = [&](PCWSTR name, const std::function<void()>& call) {
+            Log::Comment(name);
+            const auto before = gci.GetLockStatistics();
+            call();
+            const auto after = gci.GetLockStatistics();
+            VERIFY_ARE_EQUAL(before.exclusiveAcquisitions, after.exclusiveAcquisitions);
+            VERIFY_ARE_EQUAL(before.promotedAcquisitions, after.promotedAcquisitions);
+            VERIFY_IS_GREATER_THAN(after.sharedAcquisitions, before.sharedAcquisitions);
+        };
+
+        verifyOnlyShared(L"GetConsoleMode on the input buffer", [&]() {
+            ULONG mode = 0;
+            routines.GetConsoleInputModeImpl(inputBuffer, mode);
+        });
+        verifyOnlyShared(L"GetConsoleMode on the output buffer", [&]() {
+            ULONG mode = 0;
+            routines.GetConsoleOutputModeImpl(si, mode);
+        });
+        verifyOnlyShared(L"GetNumberOfConsoleInputEvents", [&]() {
+            ULONG events = 0;
+            VERIFY_SUCCEEDED(routines.GetNumberOfConsoleInputEventsImpl(inputBuffer, events));
+        });
+        verifyOnlyShared(L"GetConsoleScreenBufferInfoEx", [&]() {
+            CONSOLE_SCREEN_BUFFER_INFOEX info{ sizeof(info) };
+            routines.GetConsoleScreenBufferInfoExImpl(si, info);
+        });
+        verifyOnlyShared(L"GetConsoleCursorInfo", [&]() {
+            ULONG size = 0;
+            bool isVisible = false;
+            routines.GetConsoleCursorInfoImpl(si, size, isVisible);
+        });
+        verifyOnlyShared(L"ReadConsoleOutputW", [&]() {
+            const auto viewport = si.GetViewport();
+            std::vector<CHAR_INFO> buffer(static_cast<size_t>(viewport.Width()) * viewport.Height());
+            Viewport readRectangle = Viewport::Empty();
+            VERIFY_SUCCEEDED(routines.ReadConsoleOutputWImpl(si, buffer, viewport, readRectangle));
+        });
+
+        // Put some text, a selection and a title in the frame, so capturing it
+        //      goes through all of those.
+        std::wstring_view text{ L"Compiling src\\host\\consoleInformation.cpp ... \x1b[32mok\x1b[m\r\n" };
+        si.GetStateMachine().ProcessString(text.data(), text.size());
+        Selection::Instance().SelectNewRegion({ 0, 0 }, { 10, 0 });
+        auto clearSelection = wil::scope_exit([]() { Selection::Instance().ClearSelection(); });
+        gci.SetTitle(L"ConsoleLockTests");
+        renderer.TriggerRedrawAll();
+
+        verifyOnlyShared(L"Painting a frame", [&]() {
+            VERIFY_SUCCEEDED(renderer.PaintFrame());
+        });
+        VERIFY_ARE_EQUAL(1u, engine.FrameCount());
+    }
+
+    TEST_METHOD(ParallelWritersAndQueries)
+    {
+        // Several "build" processes write to the console while others poll it,
+        //      like a parallel build with a progress display. Every query has
+        //      to have taken the lock shared.
+        CommonState state;
+        state.PrepareGlobalFont();
+        state.PrepareGlobalScreenBuffer();
+        state.PrepareGlobalInputBuffer();
+        auto cleanup = wil::scope_exit([&]() {
+            state.CleanupGlobalInputBuffer();
+            state.CleanupGlobalScreenBuffer();
+            state.CleanupGlobalFont();
+        });
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        ApiRoutines routines;
+
+        const size_t writers = 4;
+        const size_t queriers = 4;
+        const size_t callsPerThread = 200;
+
+        const auto before = gci.GetLockStatistics();
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < writers; i++)
+        {
+            threads.emplace_back([&]() {
+                const std::wstring_view line{ L"Compiling src\\host\\consoleInformation.cpp ... ok\r\n" };
+                for (size_t call = 0; call < callsPerThread; call++)
+                {
+                    size_t cchRead = 0;
+                    std::unique_ptr<IWaitRoutine> waiter;
+                    LOG_IF_FAILED(routines.WriteConsoleWImpl(si, line, cchRead, waiter));
+                }
+            });
+        }
+        for (size_t i = 0; i < queriers; i++)
+        {
+            threads.emplace_back([&]() {
+                for (size_t call = 0; call < callsPerThread; call++)
+                {
+                    CONSOLE_SCREEN_BUFFER_INFOEX info{ sizeof(info) };
+                    routines.GetConsoleScreenBufferInfoExImpl(si, info);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        const auto after = gci.GetLockStatistics();
+        const auto shared = after.sharedAcquisitions - before.sharedAcquisitions;
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(shared, queriers * callsPerThread);
+    }
+};
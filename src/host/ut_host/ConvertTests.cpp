@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../types/inc/convert.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class ConvertTests
+{
+    TEST_CLASS(ConvertTests);
+
+    // Samples of the kinds of text the conversions see, from one to four
+    // bytes a character in UTF-8.
+    static constexpr std::wstring_view s_ascii{ L"The quick brown fox jumps over the lazy dog. 0123456789" };
+    static constexpr std::wstring_view s_latin{ L"Gr\x00f6\x00df" L"e, caf\x00e9, na\x00ef" L"ve, fa\x00e7" L"ade, \x00c6r\x00f8sk\x00f8" L"bing" };
+    static constexpr std::wstring_view s_cjk{ L"\x65e5\x672c\x8a9e\x306e\x30c6\x30ad\x30b9\x30c8\x3001\x4e2d\x6587\xd55c\xad6d\xc5b4" };
+    static constexpr std::wstring_view s_emoji{ L"\xd83d\xde00\xd83d\xde80\xd83c\xdf89\xd83d\xdc4d\xd83e\xdd16" };
+
+    static std::string s_ToUtf8(const std::wstring_view text)
+    {
+        const int length = WideCharToMultiByte(CP_UTF8, 0, text.data(), gsl::narrow<int>(text.size()), nullptr, 0, nullptr, nullptr);
+        std::string utf8(length, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, text.data(), gsl::narrow<int>(text.size()), utf8.data(), length, nullptr, nullptr);
+        return utf8;
+    }
+
+    static std::wstring s_Utf8ToUtf16(const std::string_view utf8)
+    {
+        std::wstring text(utf8.size(), L'\0');
+        size_t consumed = 0;
+        size_t produced = 0;
+        VERIFY_SUCCEEDED(Utf8ToUtf16(utf8, { text.data(), gsl::narrow<ptrdiff_t>(text.size()) }, consumed, produced));
+        VERIFY_ARE_EQUAL(utf8.size(), consumed);
+        text.resize(produced);
+        return text;
+    }
+
+    TEST_METHOD(WidenAsciiStopsAtFirstNonAsciiByte)
+    {
+        Log::Comment(L"Every position of the first non-ASCII byte, inside and outside of a whole block, should be found.");
+
+        for (size_t length = 0; length < 40; ++length)
+        {
+            for (size_t stop = 0; stop <= length; ++stop)
+            {
+                std::string source(length, 'a');
+                if (stop < length)
+                {
+                    source[stop] = '\x80';
+                }
+
+                std::wstring target(length, L'\xffff');
+                const size_t copied = WidenAscii(source, { target.data(), gsl::narrow<ptrdiff_t>(target.size()) });
+                VERIFY_ARE_EQUAL(stop, copied);
+                VERIFY_ARE_EQUAL(std::wstring(stop, L'a'), target.substr(0, stop));
+            }
+        }
+    }
+
+    TEST_METHOD(NarrowAsciiStopsAtFirstNonAsciiChar)
+    {
+        Log::Comment(L"Every position of the first non-ASCII char, inside and outside of a whole block, should be found.");
+
+        for (size_t length = 0; length < 20; ++length)
+        {
+            for (size_t stop = 0; stop <= length; ++stop)
+            {
+                std::wstring source(length, L'a');
+                if (stop < length)
+                {
+                    // Only the high byte is set, to make sure both halves are checked.
+                    source[stop] = L'\x0161';
+                }
+
+                std::string target(length, '\xff');
+                const size_t copied = NarrowAscii(source, { target.data(), gsl::narrow<ptrdiff_t>(target.size()) });
+                VERIFY_ARE_EQUAL(stop, copied);
+                VERIFY_ARE_EQUAL(std::string(stop, 'a'), target.substr(0, stop));
+            }
+        }
+    }
+
+    TEST_METHOD(AsciiCopiesAreBoundedByTarget)
+    {
+        const std::string_view narrow{ "0123456789abcdef" };
+        wchar_t wide[5] = { 0 };
+        VERIFY_ARE_EQUAL(4u, WidenAscii(narrow, { wide, 4 }));
+        VERIFY_ARE_EQUAL(L'\0', wide[4]);
+
+        char bytes[5] = { 0 };
+        VERIFY_ARE_EQUAL(4u, NarrowAscii(L"0123456789abcdef", { bytes, 4 }));
+        VERIFY_ARE_EQUAL('\0', bytes[4]);
+    }
+
+    TEST_METHOD(ConversionsMatchTheSystemForWellFormedText)
+    {
+        const std::wstring mixed = std::wstring(s_ascii) + std::wstring(s_latin) + std::wstring(s_cjk) + std::wstring(s_emoji);
+        for (const std::wstring_view text : { s_ascii, s_latin, s_cjk, s_emoji, std::wstring_view(mixed) })
+        {
+            const std::string utf8 = s_ToUtf8(text);
+
+            VERIFY_ARE_EQUAL(std::wstring(text), s_Utf8ToUtf16(utf8));
+            VERIFY_ARE_EQUAL(std::wstring(text), ConvertToW(CP_UTF8, utf8));
+            VERIFY_ARE_EQUAL(utf8, ConvertToA(CP_UTF8, text));
+            VERIFY_ARE_EQUAL(utf8.size(), GetALengthFromW(CP_UTF8, text));
+        }
+    }
+
+    TEST_METHOD(Utf8ToUtf16ReplacesIllFormedSequences)
+    {
+        Log::Comment(L"Each maximal part of an ill-formed sequence becomes one U+FFFD.");
+
+        const std::pair<std::string_view, std::wstring_view> cases[] = {
+            { "a\x80z", L"a\xfffdz" }, // lone trailing byte
+            { "\xc0\xaf", L"\xfffd\xfffd" }, // overlong '/'
+            { "\xe0\x80\xaf", L"\xfffd\xfffd\xfffd" }, // overlong, caught at the second byte
+            { "\xed\xa0\x80", L"\xfffd\xfffd\xfffd" }, // encoded surrogate
+            { "\xf4\x90\x80\x80", L"\xfffd\xfffd\xfffd\xfffd" }, // past U+10FFFF
+            { "\xe3\x82z", L"\xfffdz" }, // sequence cut short by ASCII
+            { "\xf0\x9f\x98z\xe3\x82\xab", L"\xfffdz\x30ab" }, // cut short, then well-formed
+        };
+
+        for (const auto& [utf8, expected] : cases)
+        {
+            std::wstring text(utf8.size(), L'\0');
+            size_t consumed = 0;
+            size_t produced = 0;
+            VERIFY_ARE_EQUAL(S_FALSE, Utf8ToUtf16(utf8, { text.data(), gsl::narrow<ptrdiff_t>(text.size()) }, consumed, produced));
+            VERIFY_ARE_EQUAL(utf8.size(), consumed);
+            VERIFY_ARE_EQUAL(std::wstring(expected), text.substr(0, produced));
+        }
+    }
+
+    TEST_METHOD(Utf8ToUtf16StreamsAcrossPieces)
+    {
+        Log::Comment(L"Splitting the text anywhere and carrying the unconsumed bytes over should give the same result.");
+
+        const std::string utf8 = s_ToUtf8(std::wstring(s_latin) + std::wstring(s_cjk) + std::wstring(s_emoji));
+        const std::wstring expected = s_Utf8ToUtf16(utf8);
+
+        for (size_t split = 0; split <= utf8.size(); split++)
+        {
+            std::wstring text(utf8.size(), L'\0');
+            size_t consumed = 0;
+            size_t produced = 0;
+            VERIFY_SUCCEEDED(Utf8ToUtf16({ utf8.data(), split }, { text.data(), gsl::narrow<ptrdiff_t>(text.size()) }, consumed, produced));
+            VERIFY_IS_TRUE(split - consumed < 4);
+
+            size_t restConsumed = 0;
+            size_t restProduced = 0;
+            VERIFY_SUCCEEDED(Utf8ToUtf16(std::string_view(utf8).substr(consumed),
+                                         { text.data() + produced, gsl::narrow<ptrdiff_t>(text.size() - produced) },
+                                         restConsumed,
+                                         restProduced));
+            VERIFY_ARE_EQUAL(utf8.size(), consumed + restConsumed);
+            VERIFY_ARE_EQUAL(expected, text.substr(0, produced + restProduced));
+        }
+
+        Log::Comment(L"A cut off sequence at the very end is replaced by ConvertToW.");
+        VERIFY_ARE_EQUAL(std::wstring(L"ab\xfffd"), ConvertToW(CP_UTF8, "ab\xf0\x9f\x98"));
+    }
+
+    TEST_METHOD(ConversionsStopWhenTargetIsFull)
+    {
+        const std::string utf8 = s_ToUtf8(s_emoji);
+
+        wchar_t wide[3];
+        size_t consumed = 0;
+        size_t produced = 0;
+        VERIFY_SUCCEEDED(Utf8ToUtf16(utf8, { wide, 3 }, consumed, produced));
+        VERIFY_ARE_EQUAL(4u, consumed, L"Only the first emoji fits, since the second needs two wchar_ts.");
+        VERIFY_ARE_EQUAL(2u, produced);
+
+        char narrow[6];
+        VERIFY_SUCCEEDED(Utf16ToUtf8(s_emoji, { narrow, 6 }, consumed, produced));
+        VERIFY_ARE_EQUAL(2u, consumed);
+        VERIFY_ARE_EQUAL(4u, produced);
+    }
+
+    TEST_METHOD(Utf16ToUtf8ReplacesUnpairedSurrogates)
+    {
+        char narrow[32];
+        size_t consumed = 0;
+        size_t produced = 0;
+        const std::wstring_view unpaired{ L"a\xdc00" L"b\xd800" L"c" };
+        VERIFY_ARE_EQUAL(S_FALSE, Utf16ToUtf8(unpaired, { narrow, ARRAYSIZE(narrow) }, consumed, produced));
+        VERIFY_ARE_EQUAL(unpaired.size(), consumed);
+        VERIFY_ARE_EQUAL(std::string("a\xef\xbf\xbd" "b\xef\xbf\xbd" "c"), std::string(narrow, produced));
+
+        Log::Comment(L"A leading surrogate at the end waits for the next piece, unless the text is converted as a whole.");
+        const std::wstring_view cutOff{ L"ab\xd83d" };
+        VERIFY_SUCCEEDED(Utf16ToUtf8(cutOff, { narrow, ARRAYSIZE(narrow) }, consumed, produced));
+        VERIFY_ARE_EQUAL(2u, consumed);
+        VERIFY_ARE_EQUAL(std::string("ab\xef\xbf\xbd"), ConvertToA(CP_UTF8, cutOff));
+        VERIFY_ARE_EQUAL(5u, GetALengthFromW(CP_UTF8, cutOff));
+    }
+
+    TEST_METHOD(ConversionMatchesSystem)
+    {
+        // A few kilobytes of each kind of text, converted both ways, have to
+        //      come out the same as the system's conversions.
+        const size_t targetLength = 4096;
+
+        const std::pair<const wchar_t*, std::wstring_view> samples[] = {
+            { L"ASCII", s_ascii },
+            { L"Latin", s_latin },
+            { L"CJK", s_cjk },
+            { L"emoji", s_emoji },
+        };
+
+        for (const auto& [name, sample] : samples)
+        {
+            Log::Comment(name);
+
+            std::wstring text;
+            while (text.size() < targetLength)
+            {
+                text.append(sample);
+            }
+
+            const std::string expectedNarrow = s_ToUtf8(text);
+
+            std::string narrow(text.size() * 3, '\0');
+            size_t consumed;
+            size_t produced;
+            VERIFY_SUCCEEDED(Utf16ToUtf8(text, { narrow.data(), gsl::narrow<ptrdiff_t>(narrow.size()) }, consumed, produced));
+            VERIFY_ARE_EQUAL(text.size(), consumed);
+            narrow.resize(produced);
+            VERIFY_ARE_EQUAL(expectedNarrow, narrow);
+
+            std::wstring wide(narrow.size(), L'\0');
+            VERIFY_SUCCEEDED(Utf8ToUtf16(narrow, { wide.data(), gsl::narrow<ptrdiff_t>(wide.size()) }, consumed, produced));
+            VERIFY_ARE_EQUAL(narrow.size(), consumed);
+            wide.resize(produced);
+            VERIFY_ARE_EQUAL(text, wide);
+        }
+    }
+};
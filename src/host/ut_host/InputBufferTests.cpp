@@ -8,7 +8,9 @@
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 #include "..\types\inc\IInputEvent.hpp"
+#include "..\types\inc\convert.hpp"
 
+using namespace WEX::Common;
 using namespace WEX::Logging;
 
 class InputBufferTests
@@ -77,7 +79,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -97,7 +99,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -120,10 +122,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const MouseEvent* const pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const MouseEvent mouseEvent{ inputBuffer._storage.front().Event.MouseEvent };
+        VERIFY_ARE_EQUAL(mouseEvent.GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(mouseEvent.GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -161,10 +162,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -220,10 +221,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -238,7 +239,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -381,10 +382,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(RECORD_INSERT_COUNT);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 1,
                                 eventsRead,
                                 false,
@@ -395,8 +396,7 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 RECORD_INSERT_COUNT - 1,
                                 eventsRead,
                                 false,
@@ -430,10 +430,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(recordInsertCount);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 recordInsertCount,
                                 eventsRead,
                                 false,
@@ -443,10 +443,9 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -588,22 +587,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         INPUT_RECORD record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        std::unique_ptr<IInputEvent> inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         bool waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         INPUT_RECORD record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        std::unique_ptr<IInputEvent> inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -624,7 +618,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -644,8 +638,176 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
+    TEST_METHOD(StorageKeepsOrderAcrossWrapAndGrowth)
+    {
+        Log::Comment(L"Records should come out in order after the ring wraps around and grows.");
+
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> inRecords;
+        for (WCHAR ch = L'a'; ch < L'a' + 48; ++ch)
+        {
+            inRecords.push_back(MakeKeyEvent(TRUE, 1, ch, 0, ch, 0));
+        }
+
+        // Move the front of the ring towards its end, then write enough that
+        // the records wrap around it, and then enough that it has to grow.
+        VERIFY_ARE_EQUAL(inputBuffer.Write(inRecords), inRecords.size());
+        std::vector<INPUT_RECORD> outRecords(inRecords.size());
+        size_t eventsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(eventsRead, inRecords.size());
+
+        VERIFY_ARE_EQUAL(inputBuffer.Write(inRecords), inRecords.size());
+        VERIFY_ARE_EQUAL(inputBuffer.Write(inRecords), inRecords.size());
+
+        // Stick one in front of everything, too.
+        const INPUT_RECORD first = MakeKeyEvent(TRUE, 1, L'0', 0, L'0', 0);
+        VERIFY_ARE_EQUAL(inputBuffer.Prepend({ &first, 1 }), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), inRecords.size() * 2 + 1);
+
+        outRecords.resize(inRecords.size() * 2 + 1);
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(eventsRead, outRecords.size());
+        VERIFY_ARE_EQUAL(outRecords[0], first);
+        for (size_t i = 0; i < inRecords.size() * 2; ++i)
+        {
+            VERIFY_ARE_EQUAL(outRecords[i + 1], inRecords[i % inRecords.size()]);
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
+
+    TEST_METHOD(ReadingInChunksKeepsOrder)
+    {
+        Log::Comment(L"A run of key events much bigger than one read, like a paste, should come back in order a chunk at a time.");
+
+        const size_t recordCount = 4096;
+        const size_t chunkSize = 512;
+
+        std::vector<INPUT_RECORD> inRecords;
+        inRecords.reserve(recordCount);
+        for (size_t i = 0; i < recordCount; ++i)
+        {
+            const WCHAR ch = static_cast<WCHAR>(L'a' + (i % 26));
+            inRecords.push_back(MakeKeyEvent(i % 2 == 0, 1, ch, 0, ch, 0));
+        }
+
+        InputBuffer inputBuffer;
+        VERIFY_ARE_EQUAL(inputBuffer.Write(inRecords), recordCount);
+
+        std::vector<INPUT_RECORD> outRecords(chunkSize);
+        for (size_t offset = 0; offset < recordCount; offset += chunkSize)
+        {
+            size_t eventsRead = 0;
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+            VERIFY_ARE_EQUAL(eventsRead, chunkSize);
+            for (size_t i = 0; i < chunkSize; ++i)
+            {
+                VERIFY_ARE_EQUAL(outRecords[i], inRecords[offset + i]);
+            }
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
+
+    TEST_METHOD(WritingTextMatchesCharToKeyEvents)
+    {
+        Log::Comment(L"Typing a string should store the same events as typing each character of it.");
+
+        const std::wstring_view text{ L"Hello, World!\r\naab\x3042\x00e9~" };
+        std::vector<INPUT_RECORD> expectedRecords;
+        for (const auto wch : text)
+        {
+            for (const auto& keyEvent : CharToKeyEvents(wch, CP_USA))
+            {
+                expectedRecords.push_back(keyEvent->ToInputRecord());
+            }
+        }
+
+        InputBuffer inputBuffer;
+        inputBuffer.InputMode = ENABLE_PROCESSED_INPUT;
+        VERIFY_ARE_EQUAL(inputBuffer.WriteText(text, CP_USA), expectedRecords.size());
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), expectedRecords.size());
+        for (size_t i = 0; i < expectedRecords.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], expectedRecords[i]);
+        }
+    }
+
+    TEST_METHOD(WritingTextInLineModeKeepsEveryPress)
+    {
+        Log::Comment(L"In the default line mode, a run of the same character should still be typed one key press at a time.");
+
+        const size_t aEventCount = CharToKeyEvents(L'a', CP_USA).size();
+        const size_t bEventCount = CharToKeyEvents(L'b', CP_USA).size();
+
+        InputBuffer inputBuffer;
+        inputBuffer.InputMode = ENABLE_PROCESSED_INPUT | ENABLE_LINE_INPUT;
+        VERIFY_ARE_EQUAL(inputBuffer.WriteText(L"aaab", CP_USA), 3 * aEventCount + bEventCount);
+
+        size_t aPresses = 0;
+        for (size_t i = 0; i < inputBuffer._storage.size(); ++i)
+        {
+            const auto& keyEvent = inputBuffer._storage[i].Event.KeyEvent;
+            if (keyEvent.bKeyDown && keyEvent.uChar.UnicodeChar == L'a')
+            {
+                VERIFY_ARE_EQUAL(keyEvent.wRepeatCount, 1u);
+                aPresses++;
+            }
+        }
+        VERIFY_ARE_EQUAL(aPresses, 3u);
+
+        std::wstring typed;
+        std::unique_ptr<IInputEvent> outEvent;
+        while (inputBuffer.GetNumberOfReadyEvents() > 0)
+        {
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outEvent, false, false, true, true));
+            const auto& keyEvent = static_cast<const KeyEvent&>(*outEvent);
+            if (keyEvent.IsKeyDown() && keyEvent.GetCharData() != UNICODE_NULL)
+            {
+                typed.push_back(keyEvent.GetCharData());
+            }
+        }
+        VERIFY_ARE_EQUAL(typed, L"aaab");
+    }
+
+    TEST_METHOD(WritingTextInChunksMatchesCharToKeyEvents)
+    {
+        Log::Comment(L"A paste typed in the chunks the VT input thread hands over should store the same events as typing each character of it.");
+
+        const size_t pasteSize = 1024;
+        const size_t chunkSize = 100;
+
+        std::wstring paste;
+        const std::wstring_view line{ L"    for (size_t i = 0; i < count; ++i) // ====\r\n" };
+        while (paste.size() < pasteSize)
+        {
+            paste.append(line);
+        }
+        paste.resize(pasteSize);
+
+        std::vector<INPUT_RECORD> expectedRecords;
+        for (const auto wch : paste)
+        {
+            for (const auto& keyEvent : CharToKeyEvents(wch, CP_USA))
+            {
+                expectedRecords.push_back(keyEvent->ToInputRecord());
+            }
+        }
+
+        InputBuffer inputBuffer;
+        inputBuffer.InputMode = ENABLE_PROCESSED_INPUT;
+        for (size_t offset = 0; offset < pasteSize; offset += chunkSize)
+        {
+            inputBuffer.WriteText(std::wstring_view{ paste }.substr(offset, chunkSize), CP_USA);
+        }
+
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), expectedRecords.size());
+        for (size_t i = 0; i < expectedRecords.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], expectedRecords[i]);
+        }
+    }
 };
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "ApiRoutines.h"
+#include "..\..\server\IoWorkerPool.h"
+
+#include "..\interactivity\inc\ServiceLocator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class IoWorkerPoolTests
+{
+    TEST_CLASS(IoWorkerPoolTests);
+
+    // The pool never looks past the descriptor, so the tests stash a sequence
+    //      number in the input size to check the order messages come out in.
+    static void s_Dispatch(IoWorkerPool& pool, const ULONG function, const ULONG_PTR client, const ULONG sequence)
+    {
+        CONSOLE_API_MSG* const pMsg = pool.AcquireMessage();
+        pMsg->Descriptor.Function = function;
+        pMsg->Descriptor.Process = client;
+        pMsg->Descriptor.InputSize = sequence;
+        pool.Dispatch(pMsg);
+    }
+
+    TEST_METHOD(KeepsEachClientInOrder)
+    {
+        const size_t clients = 6;
+        const ULONG messagesPerClient = 500;
+
+        std::mutex lock;
+        std::vector<std::vector<ULONG>> seen(clients);
+        std::vector<bool> active(clients, false);
+        bool overlapped = false;
+        std::atomic<size_t> running{ 0 };
+        size_t mostRunning = 0;
+
+        {
+            IoWorkerPool pool(4, [&](CONSOLE_API_MSG* const pMsg) {
+                const size_t client = pMsg->Descriptor.Process;
+                const size_t nowRunning = ++running;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    overlapped = overlapped || active[client];
+                    active[client] = true;
+                    mostRunning = std::max(mostRunning, nowRunning);
+                }
+
+                std::this_thread::yield();
+
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    seen[client].push_back(pMsg->Descriptor.InputSize);
+                    active[client] = false;
+                }
+                --running;
+            });
+
+            for (ULONG sequence = 0; sequence < messagesPerClient; sequence++)
+            {
+                for (ULONG_PTR client = 0; client < clients; client++)
+                {
+                    s_Dispatch(pool, client % 2 ? CONSOLE_IO_RAW_WRITE : CONSOLE_IO_USER_DEFINED, client, sequence);
+                }
+            }
+
+            pool.Drain();
+        }
+
+        VERIFY_IS_FALSE(overlapped, L"No client had two messages serviced at once.");
+        for (size_t client = 0; client < clients; client++)
+        {
+            VERIFY_ARE_EQUAL(static_cast<size_t>(messagesPerClient), seen[client].size());
+            for (ULONG sequence = 0; sequence < messagesPerClient; sequence++)
+            {
+                VERIFY_ARE_EQUAL(sequence, seen[client][sequence]);
+            }
+        }
+
+        Log::Comment(NoThrowString().Format(L"Up to %zu messages were serviced at once.", mostRunning));
+    }
+
+    TEST_METHOD(CreateAndCloseRunAlone)
+    {
+        std::atomic<size_t> running{ 0 };
+        std::atomic<size_t> barriers{ 0 };
+        bool barrierHadCompany = false;
+
+        {
+            IoWorkerPool pool(4, [&](CONSOLE_API_MSG* const pMsg) {
+                const size_t nowRunning = ++running;
+                if (!IoWorkerPool::s_CanRunConcurrently(*pMsg))
+                {
+                    barriers++;
+                    barrierHadCompany = barrierHadCompany || nowRunning != 1;
+                }
+                Sleep(1);
+                --running;
+            });
+
+            for (ULONG sequence = 0; sequence < 20; sequence++)
+            {
+                for (ULONG_PTR client = 0; client < 4; client++)
+                {
+                    s_Dispatch(pool, CONSOLE_IO_USER_DEFINED, client, sequence);
+                }
+
+                s_Dispatch(pool, sequence % 2 ? CONSOLE_IO_CREATE_OBJECT : CONSOLE_IO_CLOSE_OBJECT, sequence % 4, sequence);
+            }
+
+            pool.Drain();
+        }
+
+        VERIFY_ARE_EQUAL(size_t{ 20 }, barriers.load());
+        VERIFY_IS_FALSE(barrierHadCompany, L"Nothing else was serviced while a handle was created or closed.");
+    }
+
+    TEST_METHOD(ServicesEveryCallFromSeveralClients)
+    {
+        // Several clients each write a line and query the buffer, with the
+        //      console lock taken around each call like the dispatchers do.
+        CommonState state;
+        state.PrepareGlobalFont();
+        state.PrepareGlobalScreenBuffer();
+        state.PrepareGlobalInputBuffer();
+        auto cleanup = wil::scope_exit([&]() {
+            state.CleanupGlobalInputBuffer();
+            state.CleanupGlobalScreenBuffer();
+            state.CleanupGlobalFont();
+        });
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        ApiRoutines routines;
+
+        const size_t clients = 4;
+        const ULONG callsPerClient = 50;
+
+        std::atomic<size_t> succeeded{ 0 };
+        {
+            IoWorkerPool pool(4, [&](CONSOLE_API_MSG* const pMsg) {
+                gci.LockConsole();
+                auto unlock = wil::scope_exit([&]() { gci.UnlockConsole(); });
+
+                HRESULT hr;
+                if (pMsg->Descriptor.InputSize % 2)
+                {
+                    CONSOLE_SCREEN_BUFFER_INFOEX info{ sizeof(info) };
+                    routines.GetConsoleScreenBufferInfoExImpl(si, info);
+                    hr = S_OK;
+                }
+                else
+                {
+                    const std::wstring_view line{ L"[client] building target 42 of 128\r\n" };
+                    size_t cchRead = 0;
+                    std::unique_ptr<IWaitRoutine> waiter;
+                    hr = routines.WriteConsoleWImpl(si, line, cchRead, waiter);
+                }
+
+                if (SUCCEEDED(hr))
+                {
+                    succeeded++;
+                }
+            });
+
+            for (ULONG sequence = 0; sequence < callsPerClient; sequence++)
+            {
+                for (ULONG_PTR client = 0; client < clients; client++)
+                {
+                    s_Dispatch(pool, CONSOLE_IO_USER_DEFINED, client, sequence);
+                }
+            }
+            pool.Drain();
+        }
+
+        VERIFY_ARE_EQUAL(clients * static_cast<size_t>(callsPerClient), succeeded.load());
+    }
+};
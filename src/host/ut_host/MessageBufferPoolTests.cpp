@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "ApiRoutines.h"
+#include "..\..\server\MessageBufferPool.h"
+
+#include "..\interactivity\inc\ServiceLocator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class MessageBufferPoolTests
+{
+    TEST_CLASS(MessageBufferPoolTests);
+
+    TEST_METHOD(ReusesBuffersBySizeClass)
+    {
+        auto& pool = MessageBufferPool::Instance();
+        const auto before = pool.GetStatistics();
+
+        BYTE* const first = pool.Acquire(100);
+        VERIFY_IS_NOT_NULL(first);
+        pool.Release(first, 100);
+
+        Log::Comment(L"Anything up to 256 bytes shares a size class, so the same buffer comes back.");
+        BYTE* const second = pool.Acquire(256);
+        VERIFY_ARE_EQUAL(first, second);
+
+        Log::Comment(L"A bigger size class needs a buffer of its own.");
+        BYTE* const third = pool.Acquire(257);
+        VERIFY_IS_NOT_NULL(third);
+        VERIFY_ARE_NOT_EQUAL(second, third);
+
+        pool.Release(second, 256);
+        pool.Release(third, 257);
+
+        Log::Comment(L"Payloads too big for any class go to the heap every time.");
+        BYTE* const huge = pool.Acquire(1024 * 1024);
+        VERIFY_IS_NOT_NULL(huge);
+        pool.Release(huge, 1024 * 1024);
+
+        const auto after = pool.GetStatistics();
+        VERIFY_ARE_EQUAL(4u, after.acquired - before.acquired);
+        VERIFY_IS_LESS_THAN_OR_EQUAL(after.allocated - before.allocated, 3u);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(after.allocated - before.allocated, 1u);
+    }
+
+    TEST_METHOD(RepeatedWriteConsoleReusesOnePayload)
+    {
+        // Drives WriteConsoleW the way the server dispatches it, payload
+        //      buffer and all, and checks that the calls share one buffer.
+        CommonState state;
+        state.PrepareGlobalFont();
+        state.PrepareGlobalScreenBuffer();
+        state.PrepareGlobalInputBuffer();
+        auto cleanup = wil::scope_exit([&]() {
+            state.CleanupGlobalInputBuffer();
+            state.CleanupGlobalScreenBuffer();
+            state.CleanupGlobalFont();
+        });
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        ApiRoutines routines;
+
+        const std::wstring_view text{ L"ok\r\n" };
+        const ULONG cbText = gsl::narrow<ULONG>(text.size() * sizeof(wchar_t));
+        const size_t calls = 100;
+
+        auto& pool = MessageBufferPool::Instance();
+        const auto before = pool.GetStatistics();
+
+        for (size_t i = 0; i < calls; i++)
+        {
+            BYTE* const payload = pool.Acquire(cbText);
+            VERIFY_IS_NOT_NULL(payload);
+
+            // This stands in for reading the payload from the driver.
+            memcpy(payload, text.data(), cbText);
+
+            const std::wstring_view buffer{ reinterpret_cast<const wchar_t*>(payload), text.size() };
+            size_t cchRead = 0;
+            std::unique_ptr<IWaitRoutine> waiter;
+            gci.LockConsole();
+            VERIFY_SUCCEEDED(routines.WriteConsoleWImpl(si, buffer, cchRead, waiter));
+            gci.UnlockConsole();
+            VERIFY_ARE_EQUAL(text.size(), cchRead);
+
+            pool.Release(payload, cbText);
+        }
+
+        const auto after = pool.GetStatistics();
+        VERIFY_ARE_EQUAL(calls, after.acquired - before.acquired);
+        VERIFY_IS_LESS_THAN_OR_EQUAL(after.allocated - before.allocated, 1u);
+    }
+};
@@ -0,0 +1,270 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/inc/RecordingRenderEngine.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Render;
+
+// These drive the Renderer over the workloads conhost --benchmark times, with
+//      a RecordingRenderEngine, and check that every frame gets painted. The
+//      timing itself lives in the benchmark.
+
+// The tests call PaintFrame themselves, so the renderer doesn't need a thread.
+class NoopRenderThread final : public IRenderThread
+{
+public:
+    void NotifyPaint() override {}
+    void EnablePainting() override {}
+    void WaitForPaintCompletionAndDisable(const DWORD /*dwTimeoutMs*/) override {}
+};
+
+// Counts how often the renderer wakes its thread. The real RenderThread makes
+//      a SetEvent call for each of these.
+class CountingRenderThread final : public IRenderThread
+{
+public:
+    CountingRenderThread(size_t& notifications) noexcept :
+        _notifications{ notifications }
+    {
+    }
+
+    void NotifyPaint() override { _notifications++; }
+    void EnablePainting() override {}
+    void WaitForPaintCompletionAndDisable(const DWORD /*dwTimeoutMs*/) override {}
+
+private:
+    size_t& _notifications;
+};
+
+class RendererPaintTests
+{
+    TEST_CLASS(RendererPaintTests);
+
+    CommonState* m_state;
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = new CommonState();
+
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalScreenBuffer();
+        m_state->PrepareGlobalInputBuffer();
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalInputBuffer();
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalFont();
+
+        delete m_state;
+
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        m_state->PrepareNewTextBufferInfo();
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        m_state->CleanupNewTextBufferInfo();
+        return true;
+    }
+
+    TEST_METHOD(FullScreenPlainText);
+    TEST_METHOD(FullScreenColoredText);
+    TEST_METHOD(FullScreenWideText);
+    TEST_METHOD(ScrollingOutput);
+    TEST_METHOD(OneNotificationPerChunk);
+
+    void _PaintFrames(const size_t frames,
+                      const std::function<void(StateMachine&, const size_t)>& prepareFrame);
+    void _FillViewport(StateMachine& stateMachine, const std::wstring_view pattern);
+};
+
+// Method Description:
+// - Paints the given number of frames and checks that each was painted and
+//      that they had clusters in them.
+// Arguments:
+// - frames: How many frames to paint.
+// - prepareFrame: Called before every frame with the active state machine and
+//      the frame number, to change the buffer or invalidate parts of it.
+// Return Value:
+// - <none>
+void RendererPaintTests::_PaintFrames(const size_t frames,
+                                      const std::function<void(StateMachine&, const size_t)>& prepareFrame)
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+    SCREEN_INFORMATION& screenInfo = gci.GetActiveOutputBuffer();
+    StateMachine& stateMachine = screenInfo.GetStateMachine();
+
+    RecordingRenderEngine engine{ screenInfo.GetViewport().Dimensions() };
+    IRenderEngine* engines[] = { &engine };
+    Renderer renderer{ &gci.renderData, engines, ARRAYSIZE(engines), std::make_unique<NoopRenderThread>() };
+
+    // Let the buffer invalidate through this renderer while the frames are painted.
+    auto* const pPreviousRenderer = g.pRender;
+    g.pRender = &renderer;
+    auto restoreRenderer = wil::scope_exit([&]() { g.pRender = pPreviousRenderer; });
+
+    prepareFrame(stateMachine, 0);
+    renderer.TriggerRedrawAll();
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+    engine.ClearLog();
+
+    const auto firstFrame = engine.FrameCount();
+    const auto firstCluster = engine.ClusterCount();
+
+    for (size_t frame = 1; frame <= frames; frame++)
+    {
+        prepareFrame(stateMachine, frame);
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+        engine.ClearLog();
+    }
+
+    VERIFY_ARE_EQUAL(frames, engine.FrameCount() - firstFrame);
+    VERIFY_IS_GREATER_THAN(engine.ClusterCount(), firstCluster);
+}
+
+// Method Description:
+// - Fills the whole viewport with the pattern, repeated, by writing it through
+//      the VT parser.
+void RendererPaintTests::_FillViewport(StateMachine& stateMachine, const std::wstring_view pattern)
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto view = gci.GetActiveOutputBuffer().GetViewport();
+
+    std::wstring line;
+    while (line.size() < gsl::narrow<size_t>(view.Width()))
+    {
+        line.append(pattern);
+    }
+
+    std::wstring screen{ L"\x1b[H" };
+    for (auto row = 0; row < view.Height(); row++)
+    {
+        screen.append(L"\x1b[");
+        screen.append(std::to_wstring(row + 1));
+        screen.append(L";1H");
+        screen.append(line);
+    }
+    screen.append(L"\x1b[m");
+
+    stateMachine.ProcessString(screen.data(), screen.size());
+}
+
+void RendererPaintTests::FullScreenPlainText()
+{
+    bool filled = false;
+    _PaintFrames(3, [&](StateMachine& stateMachine, const size_t /*frame*/) {
+        if (!filled)
+        {
+            _FillViewport(stateMachine, L"The quick brown fox jumps over the lazy dog. ");
+            filled = true;
+        }
+        ServiceLocator::LocateGlobals().pRender->TriggerRedrawAll();
+    });
+}
+
+void RendererPaintTests::FullScreenColoredText()
+{
+    bool filled = false;
+    _PaintFrames(3, [&](StateMachine& stateMachine, const size_t /*frame*/) {
+        if (!filled)
+        {
+            // Every word gets a different color, so every line is many runs.
+            _FillViewport(stateMachine, L"\x1b[31mred \x1b[1;32mgreen \x1b[0;44mblue\x1b[m \x1b[38;2;255;128;0morange \x1b[7mreverse\x1b[m ");
+            filled = true;
+        }
+        ServiceLocator::LocateGlobals().pRender->TriggerRedrawAll();
+    });
+}
+
+void RendererPaintTests::FullScreenWideText()
+{
+    bool filled = false;
+    _PaintFrames(3, [&](StateMachine& stateMachine, const size_t /*frame*/) {
+        if (!filled)
+        {
+            _FillViewport(stateMachine, L"\x3042\x3044\x3046\x3048\x304a\x4e2d\x6587 ");
+            filled = true;
+        }
+        ServiceLocator::LocateGlobals().pRender->TriggerRedrawAll();
+    });
+}
+
+void RendererPaintTests::ScrollingOutput()
+{
+    // One new line of output per frame, like a build log streaming by. The
+    //      buffer invalidates whatever the output touched, with nothing else
+    //      asking for a redraw.
+    _PaintFrames(10, [&](StateMachine& stateMachine, const size_t frame) {
+        std::wstring line{ L"\r\n[" };
+        line.append(std::to_wstring(frame));
+        line.append(L"] Compiling \x1b[36msrc\\renderer\\base\\renderer.cpp\x1b[m ... \x1b[32mok\x1b[m");
+        stateMachine.ProcessString(line.data(), line.size());
+    });
+}
+
+void RendererPaintTests::OneNotificationPerChunk()
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+    SCREEN_INFORMATION& screenInfo = gci.GetActiveOutputBuffer();
+    StateMachine& stateMachine = screenInfo.GetStateMachine();
+
+    size_t notifications = 0;
+    RecordingRenderEngine engine{ screenInfo.GetViewport().Dimensions() };
+    IRenderEngine* engines[] = { &engine };
+    Renderer renderer{ &gci.renderData, engines, ARRAYSIZE(engines), std::make_unique<CountingRenderThread>(notifications) };
+
+    auto* const pPreviousRenderer = g.pRender;
+    g.pRender = &renderer;
+    auto restoreRenderer = wil::scope_exit([&]() { g.pRender = pPreviousRenderer; });
+
+    // A build log, handed over in pipe sized chunks, with a frame painted after
+    //      every chunk like the render thread would.
+    std::wstring chunk;
+    for (size_t line = 0; chunk.size() < 4096; line++)
+    {
+        chunk.append(L"[");
+        chunk.append(std::to_wstring(line));
+        chunk.append(L"] Compiling \x1b[36msrc\\renderer\\base\\renderer.cpp\x1b[m ... \x1b[32mok\x1b[m\r\n");
+    }
+
+    const size_t chunks = 8;
+
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+    notifications = 0;
+    const auto firstInvalidation = engine.InvalidationCount();
+    const auto firstFrame = engine.FrameCount();
+
+    for (size_t i = 0; i < chunks; i++)
+    {
+        stateMachine.ProcessString(chunk.data(), chunk.size());
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+        engine.ClearLog();
+    }
+
+    // Every chunk changes the buffer, so each one should wake the thread once
+    //      and get painted, no matter how many lines it wrote.
+    VERIFY_ARE_EQUAL(chunks, notifications);
+    VERIFY_ARE_EQUAL(chunks, engine.FrameCount() - firstFrame);
+    VERIFY_IS_GREATER_THAN(engine.InvalidationCount(), firstInvalidation);
+}
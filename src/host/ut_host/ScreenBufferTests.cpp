@@ -158,6 +158,10 @@ class ScreenBufferTests
     TEST_METHOD(ScrollUpInMargins);
     TEST_METHOD(ScrollDownInMargins);
 
+    TEST_METHOD(VtPlainTextMatchesStateMachine);
+    TEST_METHOD(VtPlainTextKeepsParserState);
+    TEST_METHOD(VtPlainTextMatchesStateMachine);
+
 };
 
 void ScreenBufferTests::SingleAlternateBufferCreationTest()
@@ -3015,3 +3019,171 @@ void ScreenBufferTests::ScrollDownInMargins()
         VERIFY_ARE_EQUAL(L"B" , iter5->Chars());
     }
 }
+
+void ScreenBufferTests::VtPlainTextMatchesStateMachine()
+{
+    // Plain text in VT mode skips the state machine. Write the same text both
+    //      ways, and make sure the buffer and cursor end up the same.
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    const DWORD originalMode = si.OutputMode;
+    WI_SetAllFlags(si.OutputMode, ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    auto restoreMode = wil::scope_exit([&] { si.OutputMode = originalMode; });
+
+    // Backspaces at the start of a row, in the middle of one and right after
+    //      a delayed wrap, tabs, a line too long for the buffer and enough
+    //      lines to scroll.
+    std::wstring text = L"\bstart\tof\ttext\r\nab\b\bc\b\r\n";
+    text.append(80, L'w');
+    text.append(L"\bx");
+    text.append(30, L'v');
+    text.append(L"\r\n");
+    for (size_t line = 0; line < 40; line++)
+    {
+        text.append(L"line\tof text\r\n\n");
+    }
+    text.append(L"no newline");
+
+    struct Result
+    {
+        std::vector<std::wstring> rows;
+        COORD cursor;
+        SMALL_RECT viewport;
+    };
+
+    const auto write = [&](const bool throughStateMachine) {
+        m_state->CleanupNewTextBufferInfo();
+        m_state->PrepareNewTextBufferInfo();
+        VERIFY_SUCCEEDED(si.SetViewportOrigin(true, { 0, 0 }, true));
+
+        if (throughStateMachine)
+        {
+            si.GetStateMachine().ProcessString(text);
+        }
+        else
+        {
+            size_t cb = text.size() * sizeof(wchar_t);
+            VERIFY_SUCCESS_NTSTATUS(WriteChars(si, text.data(), text.data(), text.data(), &cb, nullptr, 0, WC_LIMIT_BACKSPACE, nullptr));
+            VERIFY_ARE_EQUAL(text.size() * sizeof(wchar_t), cb);
+        }
+
+        const auto& tbi = si.GetTextBuffer();
+        Result result;
+        result.cursor = tbi.GetCursor().GetPosition();
+        result.viewport = si.GetViewport().ToInclusive();
+        for (SHORT row = 0; row <= result.cursor.Y; row++)
+        {
+            result.rows.push_back(tbi.GetRowByOffset(row).GetText());
+        }
+        return result;
+    };
+
+    const Result expected = write(true);
+    const Result actual = write(false);
+
+    VERIFY_ARE_EQUAL(expected.cursor, actual.cursor);
+    VERIFY_ARE_EQUAL(expected.viewport, actual.viewport);
+    VERIFY_ARE_EQUAL(expected.rows.size(), actual.rows.size());
+    for (size_t row = 0; row < expected.rows.size(); row++)
+    {
+        VERIFY_ARE_EQUAL(expected.rows[row], actual.rows[row]);
+    }
+}
+
+void ScreenBufferTests::VtPlainTextKeepsParserState()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& tbi = si.GetTextBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    auto& cursor = tbi.GetCursor();
+    const DWORD originalMode = si.OutputMode;
+    WI_SetAllFlags(si.OutputMode, ENABLE_PROCESSED_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    auto restoreMode = wil::scope_exit([&] { si.OutputMode = originalMode; });
+
+    const auto writeChars = [&](std::wstring text) {
+        size_t cb = text.size() * sizeof(wchar_t);
+        VERIFY_SUCCESS_NTSTATUS(WriteChars(si, text.data(), text.data(), text.data(), &cb, nullptr, cursor.GetPosition().X, WC_LIMIT_BACKSPACE, nullptr));
+    };
+
+    Log::Comment(L"REP repeats the last character of plain text.");
+    writeChars(L"ab");
+    stateMachine.ProcessString(L"\x1b[3b");
+    VERIFY_ARE_EQUAL(std::wstring(L"abbbb"), tbi.GetRowByOffset(0).GetText().substr(0, 5));
+    VERIFY_ARE_EQUAL(COORD({ 5, 0 }), cursor.GetPosition());
+
+    Log::Comment(L"...but not once a control character came after it.");
+    writeChars(L"cd\r\n");
+    stateMachine.ProcessString(L"\x1b[3b");
+    VERIFY_ARE_EQUAL(COORD({ 0, 1 }), cursor.GetPosition());
+
+    Log::Comment(L"Text is still translated to the DEC line drawing set.");
+    stateMachine.ProcessString(L"\x1b(0");
+    writeChars(L"q");
+    stateMachine.ProcessString(L"\x1b(B");
+    VERIFY_ARE_EQUAL(L"\x2500", tbi.GetCellDataAt({ 0, 1 })->Chars());
+
+    Log::Comment(L"Text that finishes a sequence split across writes goes to the state machine.");
+    stateMachine.ProcessString(L"\x1b[");
+    writeChars(L"2C");
+    VERIFY_ARE_EQUAL(COORD({ 3, 1 }), cursor.GetPosition());
+}
+
+void ScreenBufferTests::VtPlainTextMatchesStateMachine()
+{
+    // Enough lines of text, as `type bigfile.txt` would write them, that the
+    //      buffer scrolls. Writing it directly with VT processing on has to
+    //      end up where writing it without VT, and through the state machine,
+    //      do.
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& textBuffer = si.GetTextBuffer();
+    const DWORD originalMode = si.OutputMode;
+    auto restoreMode = wil::scope_exit([&] { si.OutputMode = originalMode; });
+
+    std::wstring text;
+    for (size_t line = 0; line < 400; line++)
+    {
+        text.append(line % 7, L'\t');
+        text.append(line % 97, static_cast<wchar_t>(L'a' + line % 26));
+        text.append(L"\r\n");
+    }
+
+    const size_t cchChunk = 4096;
+    const auto writeAll = [&](const DWORD mode, const bool throughStateMachine) {
+        si.OutputMode = mode;
+        textBuffer.GetCursor().SetPosition({ 0, 0 });
+
+        for (size_t offset = 0; offset < text.size(); offset += cchChunk)
+        {
+            const size_t cch = std::min(cchChunk, text.size() - offset);
+            wchar_t* const pwch = text.data() + offset;
+            if (throughStateMachine)
+            {
+                si.GetStateMachine().ProcessString(pwch, cch);
+            }
+            else
+            {
+                size_t cb = cch * sizeof(wchar_t);
+                VERIFY_SUCCESS_NTSTATUS(WriteChars(si, pwch, pwch, pwch, &cb, nullptr, textBuffer.GetCursor().GetPosition().X, WC_LIMIT_BACKSPACE, nullptr));
+            }
+        }
+
+        // The last line ended with a newline, so its text is in the two rows
+        //      above the cursor. Both are new since the buffer scrolled.
+        const COORD cursor = textBuffer.GetCursor().GetPosition();
+        return std::make_tuple(cursor, textBuffer.GetRowByOffset(gsl::narrow<size_t>(cursor.Y - 2)).GetText(), textBuffer.GetRowByOffset(gsl::narrow<size_t>(cursor.Y - 1)).GetText());
+    };
+
+    const DWORD processed = ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT;
+    const auto [expectedCursor, expectedAbove, expectedLast] = writeAll(processed, false);
+    VERIFY_ARE_EQUAL(gsl::narrow<SHORT>(si.GetBufferSize().Height() - 1), expectedCursor.Y);
+
+    for (const bool throughStateMachine : { true, false })
+    {
+        const auto [cursor, above, last] = writeAll(processed | ENABLE_VIRTUAL_TERMINAL_PROCESSING, throughStateMachine);
+        VERIFY_ARE_EQUAL(expectedCursor, cursor);
+        VERIFY_ARE_EQUAL(expectedAbove, above);
+        VERIFY_ARE_EQUAL(expectedLast, last);
+    }
+}
@@ -163,4 +163,88 @@ class SearchTests
         Search s(outputBuffer, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(MatchesOnlySpanWrappedRows)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& outputBuffer = gci.GetActiveOutputBuffer();
+
+        Log::Comment(L"Rows 1 and 3 wrapped into the next one, so only the end of row 1 runs into the AB starting row 2.");
+        Search s(outputBuffer, L" AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_IS_TRUE(s.FindNext());
+        VERIFY_ARE_EQUAL(COORD({ outputBuffer.GetBufferSize().RightInclusive(), 1 }), s._coordSelStart);
+        VERIFY_ARE_EQUAL(COORD({ 1, 2 }), s._coordSelEnd);
+        VERIFY_IS_FALSE(s.FindNext());
+
+        Log::Comment(L"Going around again finds it again.");
+        VERIFY_IS_TRUE(s.FindNext());
+        VERIFY_ARE_EQUAL(COORD({ 1, 2 }), s._coordSelEnd);
+    }
+
+    TEST_METHOD(FindsAllMatchesFromAnchor)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& outputBuffer = gci.GetActiveOutputBuffer();
+
+        Log::Comment(L"Starting mid-buffer wraps around to the matches before the anchor.");
+        Search s(outputBuffer, L"\x304d" L"de", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive, { 10, 1 });
+
+        const SHORT expectedRows[] = { 2, 3, 0, 1 };
+        for (const auto row : expectedRows)
+        {
+            VERIFY_IS_TRUE(s.FindNext());
+            VERIFY_ARE_EQUAL(COORD({ 5, row }), s._coordSelStart);
+            VERIFY_ARE_EQUAL(COORD({ 8, row }), s._coordSelEnd);
+        }
+        VERIFY_IS_FALSE(s.FindNext());
+    }
+
+    TEST_METHOD(FindsWhatCellByCellComparisonFinds)
+    {
+        // Every match in a buffer full of text, next to the cell-by-cell
+        //      comparison that Search used to do.
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& outputBuffer = gci.GetActiveOutputBuffer();
+        auto& textBuffer = outputBuffer.GetTextBuffer();
+
+        VERIFY_SUCCEEDED(textBuffer.ResizeTraditional({ 120, 40 }));
+        const auto bufferSize = outputBuffer.GetBufferSize();
+
+        const std::wstring_view text{ L"The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs! 0123456789 Sphinx of black quartz." };
+        for (SHORT y = 0; y < bufferSize.Height(); y++)
+        {
+            textBuffer.Write(OutputCellIterator(text.substr(y % 10, bufferSize.Width())), { 0, y });
+        }
+
+        for (const std::wstring needle : { L"lazy DOG", L"not in there" })
+        {
+            size_t found = 0;
+            Search s(outputBuffer, needle, Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+            while (s.FindNext())
+            {
+                found++;
+            }
+
+            size_t foundByCell = 0;
+            COORD pos{ 0, 0 };
+            do
+            {
+                COORD at = pos;
+                bool match = true;
+                for (const auto wch : needle)
+                {
+                    const std::wstring_view glyph = *outputBuffer.GetTextDataAt(at);
+                    if (glyph.size() != 1 || ::towlower(glyph.front()) != ::towlower(wch))
+                    {
+                        match = false;
+                        break;
+                    }
+                    bufferSize.IncrementInBoundsCircular(at);
+                }
+                foundByCell += match ? 1 : 0;
+            } while (bufferSize.IncrementInBoundsCircular(pos));
+
+            VERIFY_ARE_EQUAL(foundByCell, found, needle.c_str());
+        }
+    }
 };
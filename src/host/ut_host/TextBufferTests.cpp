@@ -142,6 +142,14 @@ class TextBufferTests
 
     TEST_METHOD(TestBurrito);
 
+    TEST_METHOD(CopyRectangleOverlapping);
+
+    TEST_METHOD(ExportSelectionWalksAttributeRuns);
+    TEST_METHOD(ExportSelectionOfFullRows);
+
+    TEST_METHOD(ReplaceAttributesMergesRuns);
+    TEST_METHOD(ReplaceAttributesInChunksMatchesRowByRow);
+
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -1964,3 +1972,235 @@ void TextBufferTests::TestBurrito()
     _buffer->IncrementCursor();
     VERIFY_IS_FALSE(afterBurritoIter);
 }
+
+void TextBufferTests::CopyRectangleOverlapping()
+{
+    COORD bufferSize{ 10, 4 };
+    UINT cursorSize = 12;
+    const TextAttribute attrA{ FOREGROUND_RED };
+    const TextAttribute attrB{ FOREGROUND_BLUE };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, TextAttribute{ 0x07 }, cursorSize, _renderTarget);
+
+    // This is the peach emoji: 🍑
+    // It's encoded in UTF-16, as needed by the buffer.
+    const auto emoji = L"\xD83C\xDF51";
+
+    _buffer->WriteLine(OutputCellIterator{ L"0123456789", attrA }, { 0, 0 });
+    _buffer->WriteLine(OutputCellIterator{ L"abcdefghij", attrB }, { 0, 1 });
+    _buffer->GetRowByOffset(1).GetCharRow().GlyphAt(1) = emoji;
+
+    Log::Comment(L"Move the top left 5x2 block down and right, so it overlaps itself.");
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 0, 0 }, { 5, 2 }), { 3, 1 });
+
+    auto verifyCells = [&](const SHORT row, const SHORT left, const std::vector<std::wstring>& glyphs, const TextAttribute attr) {
+        for (size_t i = 0; i < glyphs.size(); i++)
+        {
+            const COORD pos{ gsl::narrow<SHORT>(left + i), row };
+            const auto text = *_buffer->GetTextDataAt(pos);
+            VERIFY_ARE_EQUAL(String(glyphs.at(i).c_str()), String(text.data(), gsl::narrow<int>(text.size())));
+            VERIFY_ARE_EQUAL(attr, _buffer->GetRowByOffset(row).GetAttrRow().GetAttrByColumn(pos.X));
+        }
+    };
+
+    Log::Comment(L"The first row is untouched.");
+    verifyCells(0, 0, { L"0", L"1", L"2", L"3", L"4", L"5", L"6", L"7", L"8", L"9" }, attrA);
+
+    Log::Comment(L"The second row was read before it was overwritten by the first one.");
+    verifyCells(1, 0, { L"a", emoji, L"c" }, attrB);
+    verifyCells(1, 3, { L"0", L"1", L"2", L"3", L"4" }, attrA);
+    verifyCells(1, 8, { L"i", L"j" }, attrB);
+
+    Log::Comment(L"The third row has the second row's old text, including the stored glyph.");
+    verifyCells(2, 3, { L"a", emoji, L"c", L"d", L"e" }, attrB);
+}
+
+void TextBufferTests::ExportSelectionWalksAttributeRuns()
+{
+    COORD bufferSize{ 10, 2 };
+    UINT cursorSize = 12;
+    const TextAttribute attrDefault{ 0x07 };
+    const TextAttribute attrA{ FOREGROUND_RED };
+    const TextAttribute attrB{ FOREGROUND_BLUE };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attrDefault, cursorSize, _renderTarget);
+
+    _buffer->WriteLine(OutputCellIterator{ L"abc", attrA }, { 0, 0 });
+    _buffer->WriteLine(OutputCellIterator{ L"de", attrB }, { 3, 0 });
+    _buffer->WriteLine(OutputCellIterator{ L"x", attrB }, { 2, 1 });
+    _buffer->WriteLine(OutputCellIterator{ L"\x3042", attrA }, { 5, 1 });
+
+    const std::vector<SMALL_RECT> selection{ { 0, 0, 9, 0 }, { 0, 1, 9, 1 } };
+
+    std::vector<std::pair<std::wstring, TextAttribute>> runs;
+    std::vector<bool> lineBreaks;
+    const auto exportSelection = [&](const bool trimTrailingWhitespace) {
+        runs.clear();
+        lineBreaks.clear();
+        _buffer->ExportSelection(false,
+                                 trimTrailingWhitespace,
+                                 selection,
+                                 [&](const std::wstring_view text, const TextAttribute& attributes) { runs.emplace_back(text, attributes); },
+                                 [&](const bool lineBreak) { lineBreaks.push_back(lineBreak); });
+    };
+
+    Log::Comment(L"Trimmed, each row ends at its last non-space, and all but the last end in a line break.");
+    exportSelection(true);
+    const std::vector<std::pair<std::wstring, TextAttribute>> trimmed{
+        { L"abc", attrA },
+        { L"de", attrB },
+        { L"  ", attrDefault },
+        { L"x", attrB },
+        { L"  ", attrDefault },
+        { L"\x3042", attrA },
+    };
+    VERIFY_ARE_EQUAL(trimmed.size(), runs.size());
+    for (size_t i = 0; i < trimmed.size(); i++)
+    {
+        VERIFY_ARE_EQUAL(String(trimmed.at(i).first.c_str()), String(runs.at(i).first.c_str()));
+        VERIFY_ARE_EQUAL(trimmed.at(i).second, runs.at(i).second);
+    }
+    VERIFY_ARE_EQUAL(2u, lineBreaks.size());
+    VERIFY_IS_TRUE(lineBreaks.at(0));
+    VERIFY_IS_FALSE(lineBreaks.at(1));
+
+    Log::Comment(L"Untrimmed, the trailing spaces are their own run, and there are no line breaks.");
+    exportSelection(false);
+    VERIFY_ARE_EQUAL(8u, runs.size());
+    VERIFY_ARE_EQUAL(String(L"     "), String(runs.at(2).first.c_str()));
+    VERIFY_ARE_EQUAL(attrDefault, runs.at(2).second);
+    VERIFY_ARE_EQUAL(String(L"   "), String(runs.at(7).first.c_str()));
+    VERIFY_IS_FALSE(lineBreaks.at(0));
+
+    Log::Comment(L"The clipboard text and colors are built from the same runs.");
+    const auto colorOf = [](TextAttribute& attr) { return static_cast<COLORREF>(attr.GetLegacyAttributes()); };
+    const auto data = _buffer->GetTextForClipboard(false, true, selection, colorOf, colorOf);
+    VERIFY_ARE_EQUAL(String(L"abcde\r\n"), String(data.text.at(0).c_str()));
+    VERIFY_ARE_EQUAL(String(L"  x  \x3042"), String(data.text.at(1).c_str()));
+    VERIFY_ARE_EQUAL(3u, data.colors.at(0).size());
+    VERIFY_ARE_EQUAL(2u, data.colors.at(0).at(2).length, L"The line break has a run of its own.");
+}
+
+void TextBufferTests::ExportSelectionOfFullRows()
+{
+    // Whole rows, each in several colors, like copying all of a scrollback.
+    const COORD bufferSize{ 120, 20 };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, TextAttribute{ 0x07 }, 12, _renderTarget);
+
+    const std::wstring segment(30, L'x');
+    std::vector<SMALL_RECT> selection;
+    selection.reserve(bufferSize.Y);
+    for (SHORT row = 0; row < bufferSize.Y; row++)
+    {
+        for (SHORT segmentIndex = 0; segmentIndex < 4; segmentIndex++)
+        {
+            const TextAttribute attr{ static_cast<WORD>((row + segmentIndex) % 16) };
+            _buffer->WriteLine(OutputCellIterator{ segment, attr }, { gsl::narrow<SHORT>(segmentIndex * 30), row });
+        }
+        selection.push_back({ 0, row, gsl::narrow<SHORT>(bufferSize.X - 1), row });
+    }
+
+    size_t chars = 0;
+    size_t runs = 0;
+    _buffer->ExportSelection(false,
+                             true,
+                             selection,
+                             [&](const std::wstring_view text, const TextAttribute&) {
+                                 chars += text.size();
+                                 runs++;
+                             },
+                             [&](const bool lineBreak) { chars += lineBreak ? 2 : 0; });
+
+    Log::Comment(L"Every row is exported as one run per color, and all but the last end in a line break.");
+    const size_t rows = selection.size();
+    VERIFY_ARE_EQUAL(rows * bufferSize.X + (rows - 1) * 2, chars);
+    VERIFY_ARE_EQUAL(rows * 4, runs);
+
+    const auto colorOf = [](TextAttribute& attr) { return static_cast<COLORREF>(attr.GetLegacyAttributes()); };
+    const auto data = _buffer->GetTextForClipboard(false, true, selection, colorOf, colorOf);
+    VERIFY_ARE_EQUAL(rows, data.colors.size());
+    for (size_t row = 0; row < rows; row++)
+    {
+        // The line break has a run of its own.
+        VERIFY_ARE_EQUAL(row + 1 < rows ? size_t{ 5 } : size_t{ 4 }, data.colors.at(row).size());
+    }
+}
+
+void TextBufferTests::ReplaceAttributesMergesRuns()
+{
+    TextBuffer buffer({ 12, 3 }, TextAttribute{ 0x07 }, 12, _renderTarget);
+
+    const std::wstring segment(4, L'x');
+    for (SHORT row = 0; row < 3; row++)
+    {
+        buffer.WriteLine(OutputCellIterator{ segment, TextAttribute{ 0x1f } }, { 0, row });
+        buffer.WriteLine(OutputCellIterator{ segment, TextAttribute{ 0x2f } }, { 4, row });
+        buffer.WriteLine(OutputCellIterator{ segment, TextAttribute{ 0x3f } }, { 8, row });
+    }
+    buffer.WriteLine(OutputCellIterator{ segment, TextAttribute{ 0x4f } }, { 4, 2 });
+
+    Log::Comment(L"Swap two attributes, and turn one into the attribute its neighbor is becoming.");
+    const std::pair<TextAttribute, TextAttribute> replacements[] = {
+        { TextAttribute{ 0x1f }, TextAttribute{ 0x3f } },
+        { TextAttribute{ 0x3f }, TextAttribute{ 0x1f } },
+        { TextAttribute{ 0x2f }, TextAttribute{ 0x3f } },
+    };
+    buffer.ReplaceAttributes(replacements);
+
+    for (SHORT row = 0; row < 2; row++)
+    {
+        const auto& attrRow = buffer.GetRowByOffset(row).GetAttrRow();
+        VERIFY_ARE_EQUAL(2u, attrRow.GetNumberOfRuns());
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x3f }, attrRow.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x3f }, attrRow.GetAttrByColumn(7));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x1f }, attrRow.GetAttrByColumn(8));
+    }
+
+    Log::Comment(L"Runs that didn't match are left alone.");
+    const auto& lastRow = buffer.GetRowByOffset(2).GetAttrRow();
+    VERIFY_ARE_EQUAL(3u, lastRow.GetNumberOfRuns());
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x4f }, lastRow.GetAttrByColumn(4));
+}
+
+void TextBufferTests::ReplaceAttributesInChunksMatchesRowByRow()
+{
+    // Enough rows that ReplaceAttributes splits them into more than one chunk,
+    //      but narrow ones, so that it doesn't take long.
+    const COORD bufferSize{ 16, 2500 };
+    const auto makeBuffer = [&]() {
+        auto buffer = std::make_unique<TextBuffer>(bufferSize, TextAttribute{ 0x07 }, 12, _renderTarget);
+        const std::wstring segment(4, L'x');
+        for (SHORT row = 0; row < bufferSize.Y; row++)
+        {
+            for (SHORT segmentIndex = 0; segmentIndex < 4; segmentIndex++)
+            {
+                const TextAttribute attr{ static_cast<WORD>((row + segmentIndex) % 16) };
+                buffer->WriteLine(OutputCellIterator{ segment, attr }, { gsl::narrow<SHORT>(segmentIndex * 4), row });
+            }
+        }
+        return buffer;
+    };
+
+    const std::pair<TextAttribute, TextAttribute> replacements[] = {
+        { TextAttribute{ 0x07 }, TextAttribute{ 0x08 } },
+        { TextAttribute{ 0x01 }, TextAttribute{ 0x02 } },
+    };
+
+    auto serial = makeBuffer();
+    for (SHORT row = 0; row < bufferSize.Y; row++)
+    {
+        serial->GetRowByOffset(row).GetAttrRow().ReplaceAttrs(replacements);
+    }
+
+    auto chunked = makeBuffer();
+    chunked->ReplaceAttributes(replacements);
+
+    for (SHORT row = 0; row < bufferSize.Y; row++)
+    {
+        const auto& expected = serial->GetRowByOffset(row).GetAttrRow();
+        const auto& actual = chunked->GetRowByOffset(row).GetAttrRow();
+        VERIFY_ARE_EQUAL(expected.GetNumberOfRuns(), actual.GetNumberOfRuns());
+        for (size_t column = 0; column < gsl::narrow<size_t>(bufferSize.X); column += 4)
+        {
+            VERIFY_ARE_EQUAL(expected.GetAttrByColumn(column), actual.GetAttrByColumn(column));
+        }
+    }
+}
@@ -0,0 +1,132 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "VtInputThread.hpp"
+
+#include "..\interactivity\inc\ServiceLocator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console;
+
+class VtInputThreadTests
+{
+    TEST_CLASS(VtInputThreadTests);
+
+    CommonState* m_state;
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = new CommonState();
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalScreenBuffer();
+        m_state->PrepareGlobalInputBuffer();
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalInputBuffer();
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalFont();
+        delete m_state;
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer->Flush();
+        return true;
+    }
+
+    // Lowercase letters, each typed as a key down and a key up.
+    static std::string s_MakeInput(const size_t cb)
+    {
+        std::string input;
+        input.reserve(cb);
+        for (size_t i = 0; i < cb; i++)
+        {
+            input.push_back(static_cast<char>('a' + i % 26));
+        }
+        return input;
+    }
+
+    static void s_Write(const HANDLE hPipe, const std::string& input, const size_t cbWrite)
+    {
+        for (size_t offset = 0; offset < input.size(); offset += cbWrite)
+        {
+            DWORD cbWritten = 0;
+            const DWORD cb = gsl::narrow<DWORD>(std::min(cbWrite, input.size() - offset));
+            VERIFY_WIN32_BOOL_SUCCEEDED(WriteFile(hPipe, input.data() + offset, cb, &cbWritten, nullptr));
+            VERIFY_ARE_EQUAL(cb, cbWritten);
+        }
+    }
+
+    TEST_METHOD(WaitingInputIsHandledAtOnce)
+    {
+        const size_t cbInput = 16 * 1024;
+
+        wil::unique_hfile readPipe;
+        wil::unique_hfile writePipe;
+        VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(&readPipe, &writePipe, nullptr, 2 * cbInput));
+
+        VtInputThread thread(std::move(readPipe), false);
+
+        Log::Comment(L"Many small writes land in the pipe before anything reads it.");
+        const std::string input = s_MakeInput(cbInput);
+        s_Write(writePipe.get(), input, 100);
+
+        thread.DoReadInput(true);
+        VERIFY_IS_FALSE(thread._exitRequested);
+
+        const InputBuffer* const pInputBuffer = ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer;
+        VERIFY_ARE_EQUAL(2 * cbInput, pInputBuffer->GetNumberOfReadyEvents(), L"One read took in all of it.");
+        VERIFY_IS_TRUE(thread._inputIsBulk);
+
+        Log::Comment(L"A keypress after that is still handled on its own.");
+        s_Write(writePipe.get(), "z", 1);
+        thread.DoReadInput(true);
+        VERIFY_ARE_EQUAL(2 * cbInput + 2, pInputBuffer->GetNumberOfReadyEvents());
+        VERIFY_IS_FALSE(thread._inputIsBulk);
+    }
+
+    TEST_METHOD(BulkInputInSmallWrites)
+    {
+        // Another thread writes input in small pieces, like a terminal
+        //      forwarding a paste. All of it has to arrive, however the reads
+        //      happen to batch it.
+        const size_t cbInput = 16 * 1024;
+
+        for (const size_t cbWrite : { 16u, 256u, 4096u })
+        {
+            wil::unique_hfile readPipe;
+            wil::unique_hfile writePipe;
+            VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(&readPipe, &writePipe, nullptr, 0));
+
+            VtInputThread thread(std::move(readPipe), false);
+            const std::string input = s_MakeInput(cbInput);
+
+            std::thread writer([&]() {
+                s_Write(writePipe.get(), input, cbWrite);
+                writePipe.reset();
+            });
+
+            while (!thread._exitRequested)
+            {
+                thread.DoReadInput(true);
+            }
+            writer.join();
+
+            auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+            VERIFY_ARE_EQUAL(2 * cbInput, gci.pInputBuffer->GetNumberOfReadyEvents());
+            gci.pInputBuffer->Flush();
+        }
+    }
+};
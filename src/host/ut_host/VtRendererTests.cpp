@@ -109,6 +109,8 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestResize);
 
+    TEST_METHOD(TestPipeWriter);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -247,6 +249,21 @@ void VtRendererTest::VtSequenceHelperTests()
 
     qExpectedInput.push_back("\x1b[10C");
     VERIFY_SUCCEEDED(engine->_CursorForward(10));
+
+    qExpectedInput.push_back("\x1b[9999;32767H");
+    VERIFY_SUCCEEDED(engine->_CursorPosition({32766, 9998}));
+
+    qExpectedInput.push_back("\x1b[31m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRendition16Color(FOREGROUND_RED, true));
+
+    qExpectedInput.push_back("\x1b[107m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRendition16Color(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY, false));
+
+    qExpectedInput.push_back("\x1b[38;2;0;128;255m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRenditionRGBColor(RGB(0, 128, 255), true));
+
+    qExpectedInput.push_back("\x1b[48;2;255;255;255m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRenditionRGBColor(RGB(255, 255, 255), false));
 }
 
 void VtRendererTest::Xterm256TestInvalidate()
@@ -428,8 +445,7 @@ void VtRendererTest::Xterm256TestColors()
         L"Begin by setting some test values - FG,BG = (1,2,3), (4,5,6) to start"
         L"These values were picked for ease of formatting raw COLORREF values."
     ));
-    qExpectedInput.push_back("\x1b[38;2;1;2;3m");
-    qExpectedInput.push_back("\x1b[48;2;5;6;7m");
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(0x00030201, 0x00070605, 0, false, false));
 
     TestPaint(*engine, [&]()
@@ -515,6 +531,27 @@ void VtRendererTest::Xterm256TestColors()
         WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
 
     });
+
+    TestPaint(*engine, [&]()
+    {
+        Log::Comment(NoThrowString().Format(
+            L"----Bold, underline and a color in the 256 color palette go out as one sequence----"
+        ));
+        qExpectedInput.push_back("\x1b[1;4;38;5;196m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(RGB(255, 0, 0), g_ColorTable[0], COMMON_LVB_UNDERSCORE, true, false));
+
+        Log::Comment(NoThrowString().Format(
+            L"----Resetting is shorter than turning off bold and underline one by one----"
+        ));
+        qExpectedInput.push_back("\x1b[0;38;5;244m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(RGB(128, 128, 128), g_ColorTable[0], 0, false, false));
+
+        Log::Comment(NoThrowString().Format(
+            L"----Back to defaults----"
+        ));
+        qExpectedInput.push_back("\x1b[m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15], g_ColorTable[0], 0, false, false));
+    });
 }
 
 void VtRendererTest::Xterm256TestCursor()
@@ -1338,3 +1375,81 @@ void VtRendererTest::TestResize()
 
 
 }
+
+void VtRendererTest::TestPipeWriter()
+{
+    Log::Comment(NoThrowString().Format(
+        L"The pipe writer should deliver what was queued, in order, from its own thread."
+    ));
+
+    wil::unique_handle readPipe;
+    wil::unique_handle writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(&readPipe, &writePipe, nullptr, 0));
+
+    auto writer = std::make_unique<VtPipeWriter>(writePipe.get());
+    VERIFY_SUCCEEDED(writer->Start());
+
+    const std::string_view first{ "\x1b[H" };
+    const std::string_view second{ "Hello" };
+    VERIFY_SUCCEEDED(writer->Write(first));
+    VERIFY_SUCCEEDED(writer->Write(second));
+
+    std::string received(first.size() + second.size(), '\0');
+    size_t total = 0;
+    while (total < received.size())
+    {
+        DWORD dwRead = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), received.data() + total, static_cast<DWORD>(received.size() - total), &dwRead, nullptr));
+        total += dwRead;
+    }
+    VERIFY_ARE_EQUAL(std::string(first) + std::string(second), received);
+
+    Log::Comment(NoThrowString().Format(
+        L"A consumer that keeps up shouldn't cause any frames to be dropped."
+    ));
+    VERIFY_IS_FALSE(writer->ShouldDropFrame());
+    VERIFY_ARE_EQUAL(0u, writer->GetStatistics().droppedFrames);
+
+    Log::Comment(NoThrowString().Format(
+        L"Waiting for the queue to drain times out while the consumer isn't reading."
+    ));
+    const std::string big(64 * 1024, 'x');
+    VERIFY_SUCCEEDED(writer->Write(big));
+    VERIFY_IS_FALSE(writer->WaitForDrain(50));
+
+    received.resize(big.size());
+    total = 0;
+    while (total < received.size())
+    {
+        DWORD dwRead = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), received.data() + total, static_cast<DWORD>(received.size() - total), &dwRead, nullptr));
+        total += dwRead;
+    }
+    VERIFY_IS_TRUE(writer->WaitForDrain(5000));
+
+    Log::Comment(NoThrowString().Format(
+        L"Writes fail once the consumer is gone."
+    ));
+    readPipe.reset();
+    HRESULT hr = S_OK;
+    for (int i = 0; i < 100 && SUCCEEDED(hr); i++)
+    {
+        hr = writer->Write(second);
+        Sleep(10);
+    }
+    VERIFY_FAILED(hr);
+
+    writer.reset();
+
+    Log::Comment(NoThrowString().Format(
+        L"Destroying the writer doesn't hang on a consumer that stopped reading."
+    ));
+    wil::unique_handle stuckReadPipe;
+    wil::unique_handle stuckWritePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(&stuckReadPipe, &stuckWritePipe, nullptr, 0));
+
+    writer = std::make_unique<VtPipeWriter>(stuckWritePipe.get());
+    VERIFY_SUCCEEDED(writer->Start());
+    VERIFY_SUCCEEDED(writer->Write(big));
+    writer.reset();
+}
@@ -0,0 +1,195 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "..\..\server\ApiSorter.h"
+#include "..\..\server\WaitQueue.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+// Never satisfied, so blocks stay queued. Notes which waits were visited.
+class RecordingWaiter final : public IWaitRoutine
+{
+public:
+    RecordingWaiter(std::vector<size_t>& visits, const size_t id) :
+        IWaitRoutine(ReplyDataType::Read),
+        _visits(visits),
+        _id(id)
+    {
+    }
+
+    bool Notify(const WaitTerminationReason /*TerminationReason*/,
+                const bool /*fIsUnicode*/,
+                _Out_ NTSTATUS* const pReplyStatus,
+                _Out_ size_t* const pNumBytes,
+                _Out_ DWORD* const pControlKeyState,
+                _Out_ void* const /*pOutputData*/) override
+    {
+        *pReplyStatus = STATUS_SUCCESS;
+        *pNumBytes = 0;
+        *pControlKeyState = 0;
+        _visits.push_back(_id);
+        return false;
+    }
+
+private:
+    std::vector<size_t>& _visits;
+    const size_t _id;
+};
+
+class WaitQueueTests
+{
+    TEST_CLASS(WaitQueueTests);
+
+    // The queues only use the handle as a key, so the tests make up their own.
+    static const ConsoleHandleData* s_Handle(const size_t index)
+    {
+        return reinterpret_cast<const ConsoleHandleData*>((index + 1) * sizeof(void*));
+    }
+
+    static ConsoleWaitBlock* s_Wait(ConsoleWaitQueue& processQueue,
+                                    ConsoleWaitQueue& objectQueue,
+                                    const ConsoleHandleData* const pHandle,
+                                    std::vector<size_t>& visits,
+                                    const size_t id)
+    {
+        CONSOLE_API_MSG msg;
+        msg.msgHeader.ApiNumber = API_NUMBER_READCONSOLE;
+        msg.Descriptor.Object = reinterpret_cast<ULONG_PTR>(pHandle);
+        return new ConsoleWaitBlock(&processQueue, &objectQueue, &msg, new RecordingWaiter(visits, id));
+    }
+
+    TEST_METHOD(RemovingWaitsKeepsTheRestInOrder)
+    {
+        ConsoleWaitQueue processQueue;
+        ConsoleWaitQueue objectQueue;
+        std::vector<size_t> visits;
+
+        std::vector<ConsoleWaitBlock*> blocks;
+        for (size_t id = 0; id < 6; id++)
+        {
+            blocks.push_back(s_Wait(processQueue, objectQueue, s_Handle(id % 2), visits, id));
+        }
+        VERIFY_ARE_EQUAL(size_t{ 6 }, processQueue.GetWaitCount());
+        VERIFY_ARE_EQUAL(size_t{ 6 }, objectQueue.GetWaitCount());
+
+        Log::Comment(L"Take out the first, one in the middle and the last.");
+        for (const size_t id : { 0u, 3u, 5u })
+        {
+            delete blocks[id];
+            blocks[id] = nullptr;
+        }
+        VERIFY_ARE_EQUAL(size_t{ 3 }, processQueue.GetWaitCount());
+        VERIFY_ARE_EQUAL(size_t{ 3 }, objectQueue.GetWaitCount());
+
+        VERIFY_IS_FALSE(objectQueue.NotifyWaiters(true));
+        VERIFY_IS_TRUE((std::vector<size_t>{ 1, 2, 4 }) == visits);
+
+        visits.clear();
+        VERIFY_IS_FALSE(objectQueue.NotifyWaiters(false));
+        VERIFY_IS_TRUE((std::vector<size_t>{ 1 }) == visits, L"Only the oldest wait is tried when not notifying all.");
+
+        for (auto pBlock : blocks)
+        {
+            delete pBlock;
+        }
+        VERIFY_ARE_EQUAL(size_t{ 0 }, processQueue.GetWaitCount());
+        VERIFY_ARE_EQUAL(size_t{ 0 }, objectQueue.GetWaitCount());
+    }
+
+    TEST_METHOD(HandleWaitersAreNotifiedAlone)
+    {
+        ConsoleWaitQueue processQueue;
+        ConsoleWaitQueue objectQueue;
+        std::vector<size_t> visits;
+
+        std::vector<ConsoleWaitBlock*> blocks;
+        for (size_t id = 0; id < 9; id++)
+        {
+            blocks.push_back(s_Wait(processQueue, objectQueue, s_Handle(id % 3), visits, id));
+        }
+
+        VERIFY_IS_FALSE(objectQueue.NotifyHandleWaiters(s_Handle(1), WaitTerminationReason::HandleClosing));
+        VERIFY_IS_TRUE((std::vector<size_t>{ 1, 4, 7 }) == visits);
+
+        visits.clear();
+        VERIFY_IS_FALSE(objectQueue.NotifyHandleWaiters(s_Handle(7), WaitTerminationReason::HandleClosing));
+        VERIFY_IS_TRUE(visits.empty(), L"A handle nobody waits on has nothing to notify.");
+
+        Log::Comment(L"Once the last wait on a handle is gone, so is its index entry.");
+        for (const size_t id : { 1u, 4u, 7u })
+        {
+            delete blocks[id];
+            blocks[id] = nullptr;
+        }
+        VERIFY_ARE_EQUAL(size_t{ 2 }, objectQueue._blocksByHandle.size());
+
+        for (auto pBlock : blocks)
+        {
+            delete pBlock;
+        }
+        VERIFY_IS_TRUE(objectQueue._blocksByHandle.empty());
+    }
+
+    TEST_METHOD(BlocksAreReused)
+    {
+        ConsoleWaitQueue processQueue;
+        ConsoleWaitQueue objectQueue;
+        std::vector<size_t> visits;
+
+        ConsoleWaitBlock* const pFirst = s_Wait(processQueue, objectQueue, s_Handle(0), visits, 0);
+        delete pFirst;
+
+        ConsoleWaitBlock* const pSecond = s_Wait(processQueue, objectQueue, s_Handle(0), visits, 1);
+        VERIFY_ARE_EQUAL(static_cast<void*>(pFirst), static_cast<void*>(pSecond));
+        delete pSecond;
+    }
+
+    TEST_METHOD(ManyPendingWaits)
+    {
+        // Hundreds of reads pend on the input buffer through many handles,
+        //      like a build fanning out to many attached processes, and handles
+        //      close one at a time. Closing one only visits its own waits.
+        const size_t processes = 10;
+        const size_t handles = 100;
+        const size_t waits = 500;
+
+        ConsoleWaitQueue objectQueue;
+        std::vector<ConsoleWaitQueue> processQueues(processes);
+        std::vector<size_t> visits;
+        visits.reserve(waits);
+
+        std::vector<ConsoleWaitBlock*> blocks;
+        auto cleanup = wil::scope_exit([&]() {
+            for (auto pBlock : blocks)
+            {
+                delete pBlock;
+            }
+        });
+
+        for (size_t id = 0; id < waits; id++)
+        {
+            blocks.push_back(s_Wait(processQueues[id % processes], objectQueue, s_Handle(id % handles), visits, id));
+        }
+
+        for (size_t handle = 0; handle < handles; handle++)
+        {
+            visits.clear();
+            objectQueue.NotifyHandleWaiters(s_Handle(handle), WaitTerminationReason::HandleClosing);
+            VERIFY_ARE_EQUAL(waits / handles, visits.size());
+            for (const auto id : visits)
+            {
+                VERIFY_ARE_EQUAL(handle, id % handles);
+            }
+        }
+
+        visits.clear();
+        objectQueue.NotifyWaiters(true, WaitTerminationReason::HandleClosing);
+        VERIFY_ARE_EQUAL(waits, visits.size());
+    }
+};
@@ -54,6 +54,18 @@ void Utf8ToWideCharParser::SetCodePage(const unsigned int codePage)
     }
 }
 
+// Routine Description:
+// - Checks whether the parser holds on to any bytes from previous calls, or
+// needs to look at the next input more carefully because of them.
+// Arguments:
+// - <none>
+// Return Value:
+// - false if the next input can be converted without the parser.
+bool Utf8ToWideCharParser::HasPartialSequence() const noexcept
+{
+    return _currentState != _State::Ready;
+}
+
 // Routine Description:
 // - Parses the input multi-byte sequence.
 // Arguments:
@@ -21,6 +21,7 @@ class Utf8ToWideCharParser final
 public:
     Utf8ToWideCharParser(const unsigned int codePage);
     void SetCodePage(const unsigned int codePage);
+    bool HasPartialSequence() const noexcept;
     [[nodiscard]]
     HRESULT Parse(_In_reads_(cchBuffer) const byte* const pBytes,
                   _In_ unsigned int const cchBuffer,
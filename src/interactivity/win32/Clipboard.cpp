@@ -342,7 +342,7 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
         szClipboard.append(szHtmlHeader);
         szClipboard.append(szHtmlFragStart);
 
-        COLORREF iBgColor = rows.BkAttr.at(0).at(0);
+        const COLORREF iBgColor = rows.colors.empty() || rows.colors.front().empty() ? RGB(0x00, 0x00, 0x00) : rows.colors.front().front().background;
 
         szDivOuter.resize(cbDivOuter + 1);
         sprintf_s(szDivOuter.data(), cbDivOuter + 1, szDivOuterBackgroundPattern.data(), GetRValue(iBgColor), GetGValue(iBgColor), GetBValue(iBgColor));
@@ -356,53 +356,30 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
         szClipboard.append(szSpanFontSize);
 
         bool bColorFound = false;
+        COLORREF fgColor = RGB(0x00, 0x00, 0x00);
+        COLORREF bkColor = RGB(0x00, 0x00, 0x00);
 
-        // copy all text into the final clipboard data handle. There should be no nulls between rows of
-        // characters, but there should be a \0 at the end.
-        for (UINT iRow = 0; iRow < rows.text.size(); iRow++)
+        // copy all text into the final clipboard data handle, a run of colors at a time. There should be
+        // no nulls between rows of characters, but there should be a \0 at the end.
+        for (size_t iRow = 0; iRow < rows.text.size(); iRow++)
         {
-            size_t cbStartOffset = 0;
-            size_t cchCharsToPrint = 0;
+            const std::wstring_view rowText{ rows.text.at(iRow) };
+            size_t cchOffset = 0;
 
-            COLORREF const Blackness = RGB(0x00, 0x00, 0x00);
-            COLORREF fgColor = Blackness;
-            COLORREF bkColor = Blackness;
-
-            for (UINT iCol = 0; iCol < rows.text.at(iRow).length(); iCol++)
+            for (const auto& run : rows.colors.at(iRow))
             {
-                bool fColorDelta = false;
-
-                if (!bColorFound)
-                {
-                    fgColor = rows.FgAttr.at(iRow).at(iCol);
-                    bkColor = rows.BkAttr.at(iRow).at(iCol);
-                    bColorFound = true;
-                    fColorDelta = true;
-                }
-                else if ((rows.FgAttr.at(iRow).at(iCol) != fgColor) || (rows.BkAttr.at(iRow).at(iCol) != bkColor))
+                if (!bColorFound || run.foreground != fgColor || run.background != bkColor)
                 {
-                    fgColor = rows.FgAttr.at(iRow).at(iCol);
-                    bkColor = rows.BkAttr.at(iRow).at(iCol);
-                    fColorDelta = true;
-                }
-
-                if (fColorDelta)
-                {
-                    if (cchCharsToPrint > 0)
+                    if (bColorFound)
                     {
-                        // write accumulated characters to stream ....
-                        std::string TempBuff;
-                        int const cbTempCharsNeeded = WideCharToMultiByte(CP_UTF8, 0, rows.text[iRow].data() + cbStartOffset, static_cast<int>(cchCharsToPrint), nullptr, 0, nullptr, nullptr);
-                        TempBuff.resize(cbTempCharsNeeded);
-                        WideCharToMultiByte(CP_UTF8, 0, rows.text[iRow].data() + cbStartOffset, static_cast<int>(cchCharsToPrint), TempBuff.data(), cbTempCharsNeeded, nullptr, nullptr);
-                        szClipboard.append(TempBuff);
-                        cbStartOffset += cchCharsToPrint;
-                        cchCharsToPrint = 0;
-
                         // close previous span
                         szClipboard += szSpanEnd;
                     }
 
+                    fgColor = run.foreground;
+                    bkColor = run.background;
+                    bColorFound = true;
+
                     // start new span
 
                     // format with color then copy formatted string
@@ -412,21 +389,12 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
                         GetRValue(bkColor), GetGValue(bkColor), GetBValue(bkColor));
                     szSpanStart.resize(cbSpanStart);        // chop null from sprintf
                     szClipboard.append(szSpanStart);
-
                 }
 
-                // accumulate 1 character
-                cchCharsToPrint++;
+                // write the run's characters to the stream
+                AppendUtf16AsUtf8(rowText.substr(cchOffset, run.length), szClipboard);
+                cchOffset += run.length;
             }
-
-            PCWCHAR pwchAccumulateStart = rows.text.at(iRow).data() + cbStartOffset;
-
-            // write accumulated characters to stream
-            std::string CharsConverted;
-            int cbCharsConverted = WideCharToMultiByte(CP_UTF8, 0, pwchAccumulateStart, static_cast<int>(cchCharsToPrint), nullptr, 0, nullptr, nullptr);
-            CharsConverted.resize(cbCharsConverted);
-            WideCharToMultiByte(CP_UTF8, 0, pwchAccumulateStart, static_cast<int>(cchCharsToPrint), CharsConverted.data(), cbCharsConverted, nullptr, nullptr);
-            szClipboard.append(CharsConverted);
         }
 
         if (bColorFound)
@@ -489,16 +457,15 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
 // - rows - Rows of text data to copy
 void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, bool const fAlsoCopyHtml)
 {
-    std::wstring finalString;
-
-    // Concatenate strings into one giant string to put onto the clipboard.
+    // Measure the rows, so they can be concatenated straight into the clipboard data.
+    size_t cchText = 0;
     for (const auto& str : rows.text)
     {
-        finalString += str;
+        cchText += str.size();
     }
 
     // allocate the final clipboard data
-    const size_t cchNeeded = finalString.size() + 1;
+    const size_t cchNeeded = cchText + 1;
     const size_t cbNeeded = sizeof(wchar_t) * cchNeeded;
     wil::unique_hglobal globalHandle(GlobalAlloc(GMEM_MOVEABLE | GMEM_DDESHARE, cbNeeded));
     THROW_LAST_ERROR_IF_NULL(globalHandle.get());
@@ -506,11 +473,14 @@ void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows,
     PWSTR pwszClipboard = (PWSTR)GlobalLock(globalHandle.get());
     THROW_LAST_ERROR_IF_NULL(pwszClipboard);
 
-    // The pattern gets a bit strange here because there's no good wil built-in for global lock of this type.
-    // Try to copy then immediately unlock. Don't throw until after (so the hglobal won't be freed until we unlock).
-    const HRESULT hr = StringCchCopyW(pwszClipboard, cchNeeded, finalString.data());
+    // Nothing here throws, so the global lock is always released.
+    for (const auto& str : rows.text)
+    {
+        std::copy(str.cbegin(), str.cend(), pwszClipboard);
+        pwszClipboard += str.size();
+    }
+    *pwszClipboard = L'\0';
     GlobalUnlock(globalHandle.get());
-    THROW_IF_FAILED(hr);
 
     // Set global data to clipboard
     THROW_LAST_ERROR_IF(!OpenClipboard(ServiceLocator::LocateConsoleWindow()->GetWindowHandle()));
@@ -584,7 +584,27 @@ void Menu::s_PropertiesUpdate(PCONSOLE_STATE_INFO pStateInfo)
     gci.SetDefaultBackgroundColor(pStateInfo->DefaultBackground);
 
     // Set the screen info's default text attributes to defaults -
-    ScreenInfo.SetDefaultAttributes(gci.GetDefaultAttributes(), { gci.GetPopupFillAttribute() });
+    SCREEN_INFORMATION& mainBuffer = ScreenInfo.GetMainBuffer();
+    const TextAttribute oldAttributes = ScreenInfo.GetAttributes();
+    const TextAttribute oldMainAttributes = mainBuffer.GetAttributes();
+    const TextAttribute newAttributes = gci.GetDefaultAttributes();
+    ScreenInfo.SetDefaultAttributes(newAttributes, { gci.GetPopupFillAttribute() });
+
+    // Changing the colors in the properties dialog also changes the text that's
+    //      already on the screen in the old default colors. (Clients changing
+    //      the default attributes through the API only change new text.)
+    const auto recolor = [&](SCREEN_INFORMATION& screenInfo, const TextAttribute& oldDefault) {
+        if (oldDefault != newAttributes)
+        {
+            const std::pair<TextAttribute, TextAttribute> replacement{ oldDefault, newAttributes };
+            screenInfo.GetTextBuffer().ReplaceAttributes({ &replacement, 1 });
+        }
+    };
+    recolor(ScreenInfo, oldAttributes);
+    if (&mainBuffer != &ScreenInfo)
+    {
+        recolor(mainBuffer, oldMainAttributes);
+    }
 
     CommandHistory::s_ResizeAll(pStateInfo->HistoryBufferSize);
     gci.SetNumberOfHistoryBuffers(pStateInfo->NumberOfHistoryBuffers);
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "FrameSnapshot.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Empties the snapshot so a new frame can be captured into it.
+// - Capacity of the backing storage is retained to avoid allocations on the next frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FrameSnapshot::Reset() noexcept
+{
+    _text.clear();
+    _cells.clear();
+    _runs.clear();
+    _clusters.clear();
+
+    dirty = { 0 };
+    isGridLineDrawingAllowed = false;
+    selectionRects.clear();
+    isCursorVisible = false;
+    cursor = {};
+    title.clear();
+}
+
+// Routine Description:
+// - Copies one line of cells out of the buffer into the snapshot, splitting it
+//   into runs of equal attributes with their colors already resolved.
+// - Must be called with the console lock held.
+// Arguments:
+// - data - The console data used to resolve attributes into colors
+// - it - Iterator over the cells of the line to capture
+// - target - Where on the screen (relative to the viewport) the line should start
+// Return Value:
+// - <none>
+void FrameSnapshot::AppendLine(const IRenderData& data,
+                               TextBufferCellIterator it,
+                               const COORD target)
+{
+    auto screenPoint = target;
+
+    while (it)
+    {
+        const auto attr = it->TextAttr();
+
+        Run run;
+        run.attr = attr;
+        run.foreground = data.GetForegroundColor(attr);
+        run.background = data.GetBackgroundColor(attr);
+        run.target = screenPoint;
+        run.firstCluster = _cells.size();
+        run.clusterCount = 0;
+        run.columns = 0;
+
+        do
+        {
+            const auto chars = it->Chars();
+            const auto columns = it->Columns();
+
+            _cells.push_back({ _text.size(), chars.size(), columns });
+            _text.append(chars);
+
+            run.clusterCount++;
+            run.columns += columns;
+
+            it += columns > 0 ? columns : 1; // prevent infinite loop for no visible columns
+        } while (it && it->TextAttr() == attr);
+
+        screenPoint.X += gsl::narrow<SHORT>(run.columns);
+        _runs.push_back(run);
+    }
+}
+
+// Routine Description:
+// - Finishes capturing by building the clusters over the packed text.
+// - No more lines may be appended after this until the next Reset().
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FrameSnapshot::Seal()
+{
+    _clusters.reserve(_cells.size());
+    for (const auto& cell : _cells)
+    {
+        _clusters.emplace_back(std::wstring_view{ _text.data() + cell.offset, cell.length }, cell.columns);
+    }
+}
+
+// Routine Description:
+// - Gets the captured runs in paint order.
+const std::vector<FrameSnapshot::Run>& FrameSnapshot::Runs() const noexcept
+{
+    return _runs;
+}
+
+// Routine Description:
+// - Gets the clusters that belong to the given run. Only valid after Seal().
+std::basic_string_view<Cluster> FrameSnapshot::ClustersOf(const Run& run) const noexcept
+{
+    return { _clusters.data() + run.firstCluster, run.clusterCount };
+}
@@ -0,0 +1,81 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FrameSnapshot.hpp
+
+Abstract:
+- A copy of everything the renderer needs from the console to paint one frame.
+- The renderer fills this in while holding the console lock, then releases the
+  lock and drives the render engines from the copy. Output producers can keep
+  writing into the text buffer while a slow engine is still painting.
+- Storage is retained between frames so that capturing a frame of a similar
+  size as the last one does not allocate.
+--*/
+
+#pragma once
+
+#include "../inc/IRenderEngine.hpp"
+#include "../inc/IRenderData.hpp"
+
+#include "../../buffer/out/textBufferCellIterator.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class FrameSnapshot final
+    {
+    public:
+        // A horizontal span of clusters that share one set of attributes.
+        struct Run
+        {
+            TextAttribute attr;
+            COLORREF foreground;
+            COLORREF background;
+            COORD target;
+            size_t firstCluster;
+            size_t clusterCount;
+            size_t columns;
+        };
+
+        FrameSnapshot() = default;
+
+        void Reset() noexcept;
+
+        void AppendLine(const IRenderData& data,
+                        TextBufferCellIterator it,
+                        const COORD target);
+
+        void Seal();
+
+        const std::vector<Run>& Runs() const noexcept;
+        std::basic_string_view<Cluster> ClustersOf(const Run& run) const noexcept;
+
+        // Frame-wide state captured alongside the text.
+        SMALL_RECT dirty;
+        TextAttribute defaultAttributes;
+        COLORREF defaultForeground;
+        COLORREF defaultBackground;
+        bool isGridLineDrawingAllowed;
+        std::vector<SMALL_RECT> selectionRects;
+        bool isCursorVisible;
+        IRenderEngine::CursorOptions cursor;
+        std::wstring title;
+
+    private:
+        // All cluster text of the frame, packed back to back. Clusters are only
+        // materialized in Seal() because this string may grow while capturing.
+        std::wstring _text;
+
+        struct CellRecord
+        {
+            size_t offset;
+            size_t length;
+            size_t columns;
+        };
+        std::vector<CellRecord> _cells;
+
+        std::vector<Run> _runs;
+        std::vector<Cluster> _clusters;
+    };
+}
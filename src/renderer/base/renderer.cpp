@@ -63,6 +63,9 @@ HRESULT Renderer::PaintFrame()
         return S_FALSE;
     }
 
+    // Anything triggered from here on needs another frame, so it has to wake the thread again.
+    _paintRequested = false;
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         LOG_IF_FAILED(_PaintFrameForEngine(pEngine));
@@ -72,6 +75,15 @@ HRESULT Renderer::PaintFrame()
 }
 
 
+// Routine Description:
+// - Paints one frame for the given engine.
+// - The console lock is only held while the frame is copied into the snapshot.
+//   The engine then paints from the snapshot so that output producers waiting
+//   on the console lock are not held up by slow painting or presentation.
+// Arguments:
+// - pEngine - The engine to paint
+// Return Value:
+// - S_OK or a suitable error from the engine.
 [[nodiscard]]
 HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine)
 {
@@ -83,11 +95,19 @@ HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine)
         _pData->UnlockConsole();
     });
 
+    // Frames share the snapshot storage, so only one may be composed at a time.
+    // This must be taken after the console lock: TriggerCircling paints while
+    // already holding the console lock.
+    std::lock_guard<std::recursive_mutex> paintGuard(_paintLock);
+
+    // Hand whatever the buffer has invalidated since the last frame to the engines.
+    _FlushPendingInvalidation();
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
-    // Try to start painting a frame
-    HRESULT const hr = pEngine->StartPaint();
+    // Try to start painting a frame and copy out what it needs.
+    HRESULT const hr = _CaptureFrame(pEngine);
     RETURN_IF_FAILED(hr);
 
     // Return early if there's nothing to paint.
@@ -98,13 +118,27 @@ HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine)
         return S_OK;
     }
 
+    // Once the frame is in flight, invalidations are queued up and replayed
+    // into the engines after the frame is done.
+    auto finishFrame = wil::scope_exit([&]()
+    {
+        _FinishFrame();
+    });
+
+    // Let go of global lock so other threads can run while we paint.
+    unlock.reset();
+
     auto endPaint = wil::scope_exit([&]()
     {
         LOG_IF_FAILED(pEngine->EndPaint());
     });
 
     // A. Prep Colors
-    RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, _pData->GetDefaultBrushColors(), true));
+    RETURN_IF_FAILED(pEngine->UpdateDrawingBrushes(_frame.defaultForeground,
+                                                   _frame.defaultBackground,
+                                                   _frame.defaultAttributes.GetLegacyAttributes(),
+                                                   _frame.defaultAttributes.IsBold(),
+                                                   true));
 
     // B. Perform Scroll Operations
     RETURN_IF_FAILED(_PerformScrolling(pEngine));
@@ -113,10 +147,9 @@ HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine)
     RETURN_IF_FAILED(_PaintBackground(pEngine));
 
     // 2. Paint Rows of Text
-    _PaintBufferOutput(pEngine);
-
     // 3. Paint overlays that reside above the text buffer
-    _PaintOverlays(pEngine);
+    // (Both were captured into the snapshot in order, text first.)
+    _PaintFrameText(pEngine);
 
     // 4. Paint Selection
     _PaintSelection(pEngine);
@@ -125,25 +158,311 @@ HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine)
     _PaintCursor(pEngine);
 
     // 6. Paint window title
-    RETURN_IF_FAILED(_PaintTitle(pEngine));
+    RETURN_IF_FAILED(pEngine->UpdateTitle(_frame.title));
 
     // Force scope exit end paint to finish up collecting information and possibly painting
     endPaint.reset();
 
-    // Force scope exit unlock to let go of global lock so other threads can run
-    unlock.reset();
-
-    // Trigger out-of-lock presentation for renderers that can support it
+    // Trigger presentation for renderers that can support it
     RETURN_IF_FAILED(pEngine->Present());
 
-    // As we leave the scope, EndPaint will be called (declared above)
+    // As we leave the scope, the frame is finished and queued invalidations are replayed.
+    return S_OK;
+}
+
+// Routine Description:
+// - Starts a paint on the engine and copies all the console state the frame
+//   needs into the snapshot.
+// - Must be called with the console lock held.
+// Arguments:
+// - pEngine - The engine that is about to paint
+// Return Value:
+// - S_OK if a frame was captured and is now in flight.
+// - S_FALSE if the engine has nothing to paint.
+// - Otherwise, a suitable error.
+[[nodiscard]]
+HRESULT Renderer::_CaptureFrame(_In_ IRenderEngine* const pEngine)
+{
+    std::lock_guard<std::mutex> guard(_engineLock);
+
+    HRESULT const hr = pEngine->StartPaint();
+    RETURN_IF_FAILED(hr);
+    if (S_FALSE == hr)
+    {
+        return hr;
+    }
+
+    // If the capture fails, the engine still expects a matching EndPaint.
+    auto endPaint = wil::scope_exit([&]()
+    {
+        LOG_IF_FAILED(pEngine->EndPaint());
+    });
+
+    try
+    {
+        _frame.Reset();
+
+        _frame.dirty = pEngine->GetDirtyRectInChars();
+
+        _frame.defaultAttributes = _pData->GetDefaultBrushColors();
+        _frame.defaultForeground = _pData->GetForegroundColor(_frame.defaultAttributes);
+        _frame.defaultBackground = _pData->GetBackgroundColor(_frame.defaultAttributes);
+        _frame.isGridLineDrawingAllowed = _pData->IsGridLineDrawingAllowed();
+
+        _CaptureBufferOutput();
+        _CaptureOverlays();
+        _frame.Seal();
+
+        _frame.selectionRects = _GetSelectionRects();
+        _CaptureCursor();
+        _frame.title = _pData->GetConsoleTitle();
+    }
+    CATCH_RETURN();
+
+    endPaint.release();
+    _frameInFlight = true;
     return S_OK;
 }
 
+// Routine Description:
+// - Marks the frame in flight as done and replays any invalidations that
+//   arrived while it was being painted so they land in the next frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_FinishFrame() noexcept
+{
+    std::lock_guard<std::mutex> guard(_engineLock);
+
+    for (const auto& invalidation : _deferredInvalidations)
+    {
+        for (IRenderEngine* const pEngine : _rgpEngines)
+        {
+            try
+            {
+                _ApplyInvalidation(pEngine, invalidation);
+            }
+            CATCH_LOG();
+        }
+    }
+
+    const bool needsAnotherFrame = !_deferredInvalidations.empty();
+    _deferredInvalidations.clear();
+    _deferredRects.clear();
+    _frameInFlight = false;
+
+    if (needsAnotherFrame)
+    {
+        _NotifyPaintFrame();
+    }
+}
+
+// Routine Description:
+// - Runs an invalidation against every engine.
+// - If a frame is currently being painted outside the console lock, the
+//   invalidation is queued instead and applied once that frame has finished.
+// - Selection and title invalidations carry more than fits in the record, see
+//   TriggerSelection and TriggerTitleChange.
+// Arguments:
+// - invalidation - The call to make on each engine.
+// Return Value:
+// - <none>
+void Renderer::_InvalidateEngines(const EngineInvalidation& invalidation)
+{
+    std::lock_guard<std::mutex> guard(_engineLock);
+
+    if (_frameInFlight)
+    {
+        _deferredInvalidations.push_back(invalidation);
+        return;
+    }
+
+    for (IRenderEngine* const pEngine : _rgpEngines)
+    {
+        _ApplyInvalidation(pEngine, invalidation);
+    }
+}
+
+// Routine Description:
+// - Makes the calls on an engine that an invalidation stands for.
+// - Must be called with the engine lock held.
+// Arguments:
+// - pEngine - The engine to invalidate.
+// - invalidation - What to invalidate.
+// Return Value:
+// - <none>
+void Renderer::_ApplyInvalidation(IRenderEngine* const pEngine, const EngineInvalidation& invalidation)
+{
+    switch (invalidation.kind)
+    {
+    case EngineInvalidation::Kind::Batch:
+    {
+        const PendingInvalidation& pending = invalidation.pending;
+        if (pending.scrollDelta.X != 0 || pending.scrollDelta.Y != 0)
+        {
+            LOG_IF_FAILED(pEngine->InvalidateScroll(&pending.scrollDelta));
+        }
+
+        if (pending.hasRegion)
+        {
+            LOG_IF_FAILED(pEngine->Invalidate(&pending.region));
+        }
+
+        const auto invalidateCursor = [pEngine](const PendingInvalidation::CursorMark& mark) {
+            COORD coord = mark.coord;
+            LOG_IF_FAILED(pEngine->InvalidateCursor(&coord));
+
+            // Double-wide cursors need to invalidate the right half as well.
+            if (mark.isDoubleWidth)
+            {
+                coord.X++;
+                LOG_IF_FAILED(pEngine->InvalidateCursor(&coord));
+            }
+        };
+
+        if (pending.cursorMoves > 0)
+        {
+            invalidateCursor(pending.cursorFirst);
+        }
+
+        if (pending.cursorMoves > 1)
+        {
+            if (pending.cursorTop.coord.Y < pending.cursorLast.coord.Y)
+            {
+                invalidateCursor(pending.cursorTop);
+            }
+            invalidateCursor(pending.cursorLast);
+        }
+        break;
+    }
+    case EngineInvalidation::Kind::System:
+        LOG_IF_FAILED(pEngine->InvalidateSystem(&invalidation.system));
+        break;
+    case EngineInvalidation::Kind::All:
+        LOG_IF_FAILED(pEngine->InvalidateAll());
+        break;
+    case EngineInvalidation::Kind::Viewport:
+        LOG_IF_FAILED(pEngine->UpdateViewport(invalidation.viewport));
+        LOG_IF_FAILED(pEngine->InvalidateScroll(&invalidation.scrollDelta));
+        break;
+    case EngineInvalidation::Kind::Selection:
+    {
+        const auto previous = _deferredRects.cbegin() + invalidation.firstRect;
+        const auto current = previous + invalidation.previousRects;
+        _replayRects.assign(previous, current);
+        LOG_IF_FAILED(pEngine->InvalidateSelection(_replayRects));
+        _replayRects.assign(current, current + invalidation.currentRects);
+        LOG_IF_FAILED(pEngine->InvalidateSelection(_replayRects));
+        break;
+    }
+    case EngineInvalidation::Kind::Title:
+        LOG_IF_FAILED(pEngine->InvalidateTitle(_deferredTitle));
+        break;
+    }
+}
+
+// Routine Description:
+// - Runs a query against an engine that can't be deferred, like asking it
+//   whether it wants to paint right now.
+// - The caller must hold the paint lock so no frame is in flight.
+// Arguments:
+// - query - The call to make on the engine.
+// Return Value:
+// - The result of the query.
+[[nodiscard]]
+HRESULT Renderer::_PrepareEngine(const std::function<HRESULT()>& query)
+{
+    std::lock_guard<std::mutex> guard(_engineLock);
+    return query();
+}
+
 void Renderer::_NotifyPaintFrame()
 {
-    // The thread will provide throttling for us.
-    _pThread->NotifyPaint();
+    // The thread will provide throttling for us. Only the first trigger
+    //      since the last frame started needs to wake it.
+    if (!_paintRequested.exchange(true))
+    {
+        _pThread->NotifyPaint();
+    }
+}
+
+// Routine Description:
+// - Adds a region to the pending batch of invalidations.
+// Arguments:
+// - region - The exclusive region to invalidate, relative to the viewport.
+// Return Value:
+// - <none>
+void Renderer::_QueueRegion(const SMALL_RECT region)
+{
+    // The engines union everything into one dirty rectangle anyway, so the
+    //      batch only needs to keep the bounds.
+    if (!_pending.hasRegion)
+    {
+        _pending.region = region;
+        _pending.hasRegion = true;
+    }
+    else
+    {
+        _pending.region.Left = std::min(_pending.region.Left, region.Left);
+        _pending.region.Top = std::min(_pending.region.Top, region.Top);
+        _pending.region.Right = std::max(_pending.region.Right, region.Right);
+        _pending.region.Bottom = std::max(_pending.region.Bottom, region.Bottom);
+    }
+
+    _NotifyPaintFrame();
+}
+
+// Routine Description:
+// - Adds a cursor move to the pending batch of invalidations.
+// - Only the first and last positions, and the topmost one in between, are
+//      kept. That's what GDI needs to erase the old cursor and draw the new
+//      one, and what the VT engine needs to know how far up it has to repaint.
+// Arguments:
+// - coord - The position of the cursor, relative to the viewport.
+// - isDoubleWidth - Whether the cursor covers two cells there.
+// Return Value:
+// - <none>
+void Renderer::_QueueCursor(const COORD coord, const bool isDoubleWidth)
+{
+    const PendingInvalidation::CursorMark mark{ coord, isDoubleWidth };
+
+    if (_pending.cursorMoves == 0)
+    {
+        _pending.cursorFirst = mark;
+    }
+    else if (_pending.cursorMoves == 1 || coord.Y < _pending.cursorTop.coord.Y)
+    {
+        _pending.cursorTop = mark;
+    }
+    _pending.cursorLast = mark;
+    _pending.cursorMoves++;
+
+    _NotifyPaintFrame();
+}
+
+// Routine Description:
+// - Hands the pending batch of invalidations to the engines and starts a new one.
+// - Must be called with the console lock held, before any invalidation that
+//      isn't batched, so the engines still see everything in order.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_FlushPendingInvalidation()
+{
+    const PendingInvalidation pending = _pending;
+    _pending = {};
+
+    if (pending.IsEmpty())
+    {
+        return;
+    }
+
+    EngineInvalidation invalidation{};
+    invalidation.kind = EngineInvalidation::Kind::Batch;
+    invalidation.pending = pending;
+    _InvalidateEngines(invalidation);
 }
 
 // Routine Description:
@@ -154,9 +473,10 @@ void Renderer::_NotifyPaintFrame()
 // - <none>
 void Renderer::TriggerSystemRedraw(const RECT* const prcDirtyClient)
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
-    });
+    EngineInvalidation invalidation{};
+    invalidation.kind = EngineInvalidation::Kind::System;
+    invalidation.system = *prcDirtyClient;
+    _InvalidateEngines(invalidation);
 
     _NotifyPaintFrame();
 }
@@ -175,11 +495,7 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        });
-
-        _NotifyPaintFrame();
+        _QueueRegion(srUpdateRegion); // this will notify to paint if we need it.
     }
 }
 
@@ -211,19 +527,7 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
     if (view.IsInBounds(updateCoord))
     {
         view.ConvertToOrigin(&updateCoord);
-        for (IRenderEngine* pEngine : _rgpEngines)
-        {
-            LOG_IF_FAILED(pEngine->InvalidateCursor(&updateCoord));
-
-            // Double-wide cursors need to invalidate the right half as well.
-            if (_pData->IsCursorDoubleWidth())
-            {
-                updateCoord.X++;
-                LOG_IF_FAILED(pEngine->InvalidateCursor(&updateCoord));
-            }
-        }
-
-        _NotifyPaintFrame();
+        _QueueCursor(updateCoord, _pData->IsCursorDoubleWidth()); // this will notify to paint if we need it.
     }
 }
 
@@ -236,13 +540,28 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll()
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateAll());
-    });
+    _FlushPendingInvalidation();
+
+    EngineInvalidation invalidation{};
+    invalidation.kind = EngineInvalidation::Kind::All;
+    _InvalidateEngines(invalidation);
 
     _NotifyPaintFrame();
 }
 
+// Method Description:
+// - Called when an engine that declined to paint earlier is ready to paint
+//      again, such as the VT engine once its terminal has caught up. Nothing
+//      is invalidated here, the engine kept track of what's changed.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::TriggerPaint()
+{
+    _NotifyPaintFrame();
+}
+
 // Method Description:
 // - Called when the host is about to die, to give the renderer one last chance
 //      to paint before the host exits.
@@ -255,11 +574,20 @@ void Renderer::TriggerTeardown()
     // We need to shut down the paint thread on teardown.
     _pThread->WaitForPaintCompletionAndDisable(INFINITE);
 
+    // Someone else may still be painting a frame (see TriggerCircling).
+    // Take the locks in the same order as a paint does before touching the engines.
+    _pData->LockConsole();
+    auto unlock = wil::scope_exit([&]()
+    {
+        _pData->UnlockConsole();
+    });
+    std::lock_guard<std::recursive_mutex> paintGuard(_paintLock);
+
     // Then walk through and do one final paint on the caller's thread.
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         bool fEngineRequestsRepaint = false;
-        HRESULT hr = pEngine->PrepareForTeardown(&fEngineRequestsRepaint);
+        HRESULT hr = _PrepareEngine([&]() { return pEngine->PrepareForTeardown(&fEngineRequestsRepaint); });
         LOG_IF_FAILED(hr);
 
         if (SUCCEEDED(hr) && fEngineRequestsRepaint)
@@ -282,10 +610,32 @@ void Renderer::TriggerSelection()
         // Get selection rectangles
         const auto rects = _GetSelectionRects();
 
-        std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
-        });
+        _FlushPendingInvalidation();
+
+        {
+            std::lock_guard<std::mutex> guard(_engineLock);
+
+            if (_frameInFlight)
+            {
+                // The rectangles are queued alongside the record.
+                EngineInvalidation invalidation{};
+                invalidation.kind = EngineInvalidation::Kind::Selection;
+                invalidation.firstRect = _deferredRects.size();
+                invalidation.previousRects = _previousSelection.size();
+                invalidation.currentRects = rects.size();
+                _deferredRects.insert(_deferredRects.end(), _previousSelection.cbegin(), _previousSelection.cend());
+                _deferredRects.insert(_deferredRects.end(), rects.cbegin(), rects.cend());
+                _deferredInvalidations.push_back(invalidation);
+            }
+            else
+            {
+                for (IRenderEngine* const pEngine : _rgpEngines)
+                {
+                    LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
+                    LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
+                }
+            }
+        }
 
         _previousSelection = rects;
 
@@ -309,10 +659,13 @@ bool Renderer::_CheckViewportAndScroll()
     coordDelta.X = srOldViewport.Left - srNewViewport.Left;
     coordDelta.Y = srOldViewport.Top - srNewViewport.Top;
 
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->UpdateViewport(srNewViewport));
-        LOG_IF_FAILED(pEngine->InvalidateScroll(&coordDelta));
-    });
+    _FlushPendingInvalidation();
+
+    EngineInvalidation invalidation{};
+    invalidation.kind = EngineInvalidation::Kind::Viewport;
+    invalidation.viewport = srNewViewport;
+    invalidation.scrollDelta = coordDelta;
+    _InvalidateEngines(invalidation);
     _srViewportPrevious = srNewViewport;
 
     return coordDelta.X != 0 || coordDelta.Y != 0;
@@ -344,9 +697,15 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
-    });
+    // A scroll moves everything invalidated before it, so it can only join a
+    //      batch that holds nothing but other scrolls. Those just add up.
+    if (_pending.hasRegion || _pending.cursorMoves != 0)
+    {
+        _FlushPendingInvalidation();
+    }
+
+    _pending.scrollDelta.X += pcoordDelta->X;
+    _pending.scrollDelta.Y += pcoordDelta->Y;
 
     _NotifyPaintFrame();
 }
@@ -360,10 +719,14 @@ void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 // - <none>
 void Renderer::TriggerCircling()
 {
+    // The caller holds the console lock, so this waits out any frame still
+    // being painted from a snapshot before we ask the engines about circling.
+    std::lock_guard<std::recursive_mutex> paintGuard(_paintLock);
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         bool fEngineRequestsRepaint = false;
-        HRESULT hr = pEngine->InvalidateCircling(&fEngineRequestsRepaint);
+        HRESULT hr = _PrepareEngine([&]() { return pEngine->InvalidateCircling(&fEngineRequestsRepaint); });
         LOG_IF_FAILED(hr);
 
         if (SUCCEEDED(hr) && fEngineRequestsRepaint)
@@ -383,23 +746,29 @@ void Renderer::TriggerCircling()
 void Renderer::TriggerTitleChange()
 {
     const std::wstring newTitle = _pData->GetConsoleTitle();
-    for (IRenderEngine* const pEngine : _rgpEngines)
+
     {
-        LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
+        std::lock_guard<std::mutex> guard(_engineLock);
+
+        if (_frameInFlight)
+        {
+            // Only the latest title matters, so every queued record uses it.
+            _deferredTitle = newTitle;
+
+            EngineInvalidation invalidation{};
+            invalidation.kind = EngineInvalidation::Kind::Title;
+            _deferredInvalidations.push_back(invalidation);
+        }
+        else
+        {
+            for (IRenderEngine* const pEngine : _rgpEngines)
+            {
+                LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
+            }
+        }
     }
-    _NotifyPaintFrame();
-}
 
-// Routine Description:
-// - Update the title for a particular engine.
-// Arguments:
-// - pEngine: the engine to update the title for.
-// Return Value:
-// - the HRESULT of the underlying engine's UpdateTitle call.
-HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
-{
-    const std::wstring newTitle = _pData->GetConsoleTitle();
-    return pEngine->UpdateTitle(newTitle);
+    _NotifyPaintFrame();
 }
 
 // Routine Description:
@@ -412,6 +781,10 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    // Font changes can't be queued behind a frame in flight, the caller needs the result now.
+    std::lock_guard<std::recursive_mutex> paintGuard(_paintLock);
+    std::lock_guard<std::mutex> engineGuard(_engineLock);
+
     std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
         LOG_IF_FAILED(pEngine->UpdateFont(FontInfoDesired, FontInfo));
@@ -446,6 +819,11 @@ HRESULT Renderer::GetProposedFont(const int iDpi, const FontInfoDesired& FontInf
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
     FAIL_FAST_IF(!(_rgpEngines.size() <= 2));
+
+    // Engines can't be queried while they paint a frame outside the console lock.
+    std::lock_guard<std::recursive_mutex> paintGuard(_paintLock);
+    std::lock_guard<std::mutex> engineGuard(_engineLock);
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         const HRESULT hr = LOG_IF_FAILED(pEngine->GetProposedFont(FontInfoDesired, FontInfo, iDpi));
@@ -478,6 +856,12 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
     FAIL_FAST_IF(!(_rgpEngines.size() <= 2));
+
+    // Engines can't be queried while they paint a frame outside the console lock.
+    // Callers cache these answers, so waiting out a frame here is rare.
+    std::lock_guard<std::recursive_mutex> paintGuard(_paintLock);
+    std::lock_guard<std::mutex> engineGuard(_engineLock);
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         const HRESULT hr = LOG_IF_FAILED(pEngine->IsGlyphWideByFont(glyph, &fIsFullWidth));
@@ -491,6 +875,24 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
     return fIsFullWidth;
 }
 
+// Routine Description:
+// - Makes a call on one of the engines between frames. Engines paint outside
+//   the console lock, so anything that changes an engine's state or asks it
+//   about its state from another thread has to go through here, or it would
+//   race with the frame in flight.
+// - Like painting, this must be called after the console lock is taken, if
+//   it's taken at all.
+// Arguments:
+// - call - The call to make on the engine.
+// Return Value:
+// - The result of the call.
+[[nodiscard]]
+HRESULT Renderer::CallEngine(const std::function<HRESULT()>& call)
+{
+    std::lock_guard<std::recursive_mutex> paintGuard(_paintLock);
+    return _PrepareEngine(call);
+}
+
 // Routine Description:
 // - Sets an event in the render thread that allows it to proceed, thus enabling painting.
 // Arguments:
@@ -528,14 +930,14 @@ HRESULT Renderer::_PaintBackground(_In_ IRenderEngine* const pEngine)
 }
 
 // Routine Description:
-// - Paint helper to copy the primary console buffer text onto the screen.
+// - Capture helper to copy the primary console buffer text into the frame snapshot.
 // - This portion primarily handles figuring the current viewport, comparing it/trimming it versus the invalid portion of the frame, and queuing up, row by row, which pieces of text need to be further processed.
 // - See also: Helper functions that seperate out each complexity of text rendering.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureBufferOutput()
 {
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
@@ -544,7 +946,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
 
     // This is effectively the number of cells on the visible screen that need to be redrawn.
     // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
-    auto dirty = Viewport::FromInclusive(pEngine->GetDirtyRectInChars());
+    auto dirty = Viewport::FromInclusive(_frame.dirty);
 
     // Shift the origin of the dirty region to match the underlying buffer so we can
     // compare the two regions directly for intersection.
@@ -578,81 +980,35 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // Retrieve the cell information iterator limited to just this line we want to redraw.
             auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
 
-            // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenLine.Origin());
+            // Copy this specific line into the snapshot.
+            _frame.AppendLine(*_pData, it, screenLine.Origin());
         }
     }
 }
 
-void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
-                                        const COORD target)
+// Routine Description:
+// - Paint helper to draw all the text runs captured into the frame snapshot.
+// - This covers both the primary buffer output and any overlays above it.
+// Arguments:
+// - pEngine - The engine to paint the text into
+// Return Value:
+// - <none>
+void Renderer::_PaintFrameText(_In_ IRenderEngine* const pEngine)
 {
-    // If we have valid data, let's figure out how to draw it.
-    if (it)
+    for (const auto& run : _frame.Runs())
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
-        std::vector<Cluster> clusters;
-        size_t cols = 0;
+        // Update the drawing brushes with our color.
+        THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, run));
 
-        // Retrieve the first color.
-        auto color = it->TextAttr();
+        // Do the painting.
+        // TODO: Calculate when trim left should be TRUE
+        THROW_IF_FAILED(pEngine->PaintBufferLine(_frame.ClustersOf(run), run.target, false));
 
-        // And hold the point where we should start drawing.
-        auto screenPoint = target;
-
-        // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+        // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
+        if (_frame.isGridLineDrawingAllowed)
         {
-            // Hold onto the current run color right here for the length of the outer loop.
-            // We'll be changing the persistent one as we run through the inner loops to detect
-            // when a run changes, but we will still need to know this color at the bottom
-            // when we go to draw gridlines for the length of the run.
-            const auto currentRunColor = color;
-
-            // Update the drawing brushes with our color.
-            THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, false));
-
-            // Advance the point by however many columns we've just outputted and reset the accumulator.
-            screenPoint.X += gsl::narrow<SHORT>(cols);
-            cols = 0;
-
-            // Ensure that our cluster vector is clear.
-            clusters.clear();
-
-            // This inner loop will accumulate clusters until the color changes.
-            // When the color changes, it will save the new color off and break.
-            do
-            {
-                if (color != it->TextAttr())
-                {
-                    color = it->TextAttr();
-                    break;
-                }
-
-                // Walk through the text data and turn it into rendering clusters.
-                clusters.emplace_back(it->Chars(), it->Columns());
-
-                // Advance the cluster and column counts.
-                const auto columnCount = clusters.back().GetColumns();
-                it += columnCount > 0 ? columnCount : 1; // prevent infinite loop for no visible columns
-                cols += columnCount;
-
-            } while (it);
-
-            // Do the painting.
-            // TODO: Calculate when trim left should be TRUE
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ clusters.data(), clusters.size() }, screenPoint, false));
-
-            // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
-            if (_pData->IsGridLineDrawingAllowed())
-            {
-                // We're only allowed to draw the grid lines under certain circumstances.
-                _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
-            }
+            // We're only allowed to draw the grid lines under certain circumstances.
+            _PaintBufferOutputGridLineHelper(pEngine, run.attr, run.foreground, run.columns, run.target);
         }
     }
 }
@@ -697,17 +1053,17 @@ IRenderEngine::GridLines Renderer::s_GetGridlines(const TextAttribute& textAttri
 // - See also: All related helpers and buffer output functions.
 // Arguments:
 // - textAttribute - The line/box drawing attributes to use for this particular run.
+// - rgb - The color to draw the lines with, resolved when the frame was captured.
 // - cchLine - The length of both pwsLine and pbKAttrsLine.
 // - coordTarget - The X/Y coordinate position in the buffer which we're attempting to start rendering from.
 // Return Value:
 // - <none>
 void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
                                                 const TextAttribute textAttribute,
+                                                const COLORREF rgb,
                                                 const size_t cchLine,
                                                 const COORD coordTarget)
 {
-    const COLORREF rgb = _pData->GetForegroundColor(textAttribute);
-
     // Convert console grid line representations into rendering engine enum representations.
     IRenderEngine::GridLines lines = Renderer::s_GetGridlines(textAttribute);
 
@@ -716,14 +1072,15 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
 }
 
 // Routine Description:
-// - Paint helper to draw the cursor within the buffer.
+// - Capture helper to record where and how the cursor should be drawn.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureCursor()
 {
-    if (_pData->IsCursorVisible())
+    _frame.isCursorVisible = _pData->IsCursorVisible();
+    if (_frame.isCursorVisible)
     {
         // Get cursor position in buffer
         COORD coordCursor = _pData->GetCursorPosition();
@@ -735,7 +1092,7 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
         bool useColor = cursorColor != INVALID_COLOR;
 
         // Build up the cursor parameters including position, color, and drawing options
-        IRenderEngine::CursorOptions options;
+        IRenderEngine::CursorOptions& options = _frame.cursor;
         options.coordCursor = coordCursor;
         options.ulCursorHeightPercent = _pData->GetCursorHeight();
         options.cursorPixelWidth = _pData->GetCursorPixelWidth();
@@ -744,23 +1101,32 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
         options.fUseColor = useColor;
         options.cursorColor = cursorColor;
         options.isOn = _pData->IsCursorOn();
+    }
+}
 
+// Routine Description:
+// - Paint helper to draw the cursor within the buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
+{
+    if (_frame.isCursorVisible)
+    {
         // Draw it within the viewport
-        LOG_IF_FAILED(pEngine->PaintCursor(options));
-
+        LOG_IF_FAILED(pEngine->PaintCursor(_frame.cursor));
     }
 }
 
 // Routine Description:
-// - Paint helper to draw text that overlays the main buffer to provide user interactivity regions
+// - Capture helper to copy text that overlays the main buffer to provide user interactivity regions
 // - This supports IME composition.
 // Arguments:
-// - engine - The render engine that we're targeting.
-// - overlay - The overlay to draw.
+// - overlay - The overlay to capture.
 // Return Value:
 // - <none>
-void Renderer::_PaintOverlay(IRenderEngine& engine,
-                             const RenderOverlay& overlay)
+void Renderer::_CaptureOverlay(const RenderOverlay& overlay)
 {
     try
     {
@@ -778,7 +1144,7 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
         // Set it up in a Viewport helper structure and trim it the IME viewport to be within the full console viewport.
         Viewport viewConv = Viewport::FromInclusive(srCaView);
 
-        SMALL_RECT srDirty = engine.GetDirtyRectInChars();
+        SMALL_RECT srDirty = _frame.dirty;
 
         // Dirty is an inclusive rectangle, but oddly enough the IME was an exclusive one, so correct it.
         srDirty.Bottom++;
@@ -795,7 +1161,7 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 
                 auto it = overlay.buffer.GetCellLineDataAt(source);
 
-                _PaintBufferOutputHelper(&engine, it, target);
+                _frame.AppendLine(*_pData, it, target);
             }
         }
     }
@@ -803,14 +1169,14 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 }
 
 // Routine Description:
-// - Paint helper to draw the composition string portion of the IME.
+// - Capture helper to copy the composition string portion of the IME.
 // - This specifically is the string that appears at the cursor on the input line showing what the user is currently typing.
-// - See also: Generic Paint IME helper method.
+// - See also: Generic capture IME helper method.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureOverlays()
 {
     try
     {
@@ -818,7 +1184,7 @@ void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 
         for (const auto& overlay : overlays)
         {
-            _PaintOverlay(*pEngine, overlay);
+            _CaptureOverlay(overlay);
         }
     }
     CATCH_LOG();
@@ -834,12 +1200,10 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 {
     try
     {
-        SMALL_RECT srDirty = pEngine->GetDirtyRectInChars();
-        Viewport dirtyView = Viewport::FromInclusive(srDirty);
+        Viewport dirtyView = Viewport::FromInclusive(_frame.dirty);
 
-        // Get selection rectangles
-        const auto rectangles = _GetSelectionRects();
-        for (auto rect : rectangles)
+        // Use the selection rectangles captured with the frame
+        for (auto rect : _frame.selectionRects)
         {
             if (dirtyView.TrimToViewport(&rect))
             {
@@ -851,27 +1215,22 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 }
 
 // Routine Description:
-// - Helper to convert the text attributes to actual RGB colors and update the rendering pen/brush within the rendering engine before the next draw operation.
+// - Helper to update the rendering pen/brush within the rendering engine before the next draw operation.
+// - The colors were already resolved from the text attributes when the frame was captured.
 // Arguments:
 // - pEngine - Which engine is being updated
-// - textAttributes - The 16 color foreground/background combination to set
-// - isSettingDefaultBrushes - Alerts that the default brushes are being set which will
-//                             impact whether or not to include the hung window/erase window brushes in this operation
-//                             and can affect other draw state that wants to know the default color scheme.
-//                             (Usually only happens when the default is changed, not when each individual color is swapped in a multi-color run.)
+// - run - The captured run of text whose colors should be used
 // Return Value:
 // - <none>
 [[nodiscard]]
-HRESULT Renderer::_UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute textAttributes, const bool isSettingDefaultBrushes)
+HRESULT Renderer::_UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const FrameSnapshot::Run& run)
 {
-    const COLORREF rgbForeground = _pData->GetForegroundColor(textAttributes);
-    const COLORREF rgbBackground = _pData->GetBackgroundColor(textAttributes);
-    const WORD legacyAttributes = textAttributes.GetLegacyAttributes();
-    const bool isBold = textAttributes.IsBold();
+    const WORD legacyAttributes = run.attr.GetLegacyAttributes();
+    const bool isBold = run.attr.IsBold();
 
     // The last color need's to be each engine's responsibility. If it's local to this function,
     //      then on the next engine we might not update the color.
-    RETURN_IF_FAILED(pEngine->UpdateDrawingBrushes(rgbForeground, rgbBackground, legacyAttributes, isBold, isSettingDefaultBrushes));
+    RETURN_IF_FAILED(pEngine->UpdateDrawingBrushes(run.foreground, run.background, legacyAttributes, isBold, false));
 
     return S_OK;
 }
@@ -21,6 +21,7 @@ Author(s):
 #include "../inc/IRenderData.hpp"
 
 #include "thread.hpp"
+#include "FrameSnapshot.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
 #include "../../buffer/out/CharRow.hpp"
@@ -56,6 +57,7 @@ namespace Microsoft::Console::Render
         void TriggerRedrawCursor(const COORD* const pcoord) override;
         void TriggerRedrawAll() override;
         void TriggerTeardown() override;
+        void TriggerPaint() override;
 
         void TriggerSelection() override;
         void TriggerScroll() override;
@@ -75,6 +77,9 @@ namespace Microsoft::Console::Render
 
         bool IsGlyphWideByFont(const std::wstring_view glyph) override;
 
+        [[nodiscard]]
+        HRESULT CallEngine(const std::function<HRESULT()>& call) override;
+
         void EnablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
 
@@ -93,32 +98,47 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine);
 
+        [[nodiscard]]
+        HRESULT _CaptureFrame(_In_ IRenderEngine* const pEngine);
+        void _FinishFrame() noexcept;
+
+        struct EngineInvalidation;
+        void _InvalidateEngines(const EngineInvalidation& invalidation);
+        void _ApplyInvalidation(IRenderEngine* const pEngine, const EngineInvalidation& invalidation);
+
+        void _QueueRegion(const SMALL_RECT region);
+        void _QueueCursor(const COORD coord, const bool isDoubleWidth);
+        void _FlushPendingInvalidation();
+
+        [[nodiscard]]
+        HRESULT _PrepareEngine(const std::function<HRESULT()>& query);
+
         bool _CheckViewportAndScroll();
 
         [[nodiscard]]
         HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
 
-        void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                      TextBufferCellIterator it,
-                                      const COORD target);
+        void _CaptureBufferOutput();
+        void _PaintFrameText(_In_ IRenderEngine* const pEngine);
 
         static IRenderEngine::GridLines s_GetGridlines(const TextAttribute& textAttribute) noexcept;
 
         void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
                                               const TextAttribute textAttribute,
+                                              const COLORREF rgb,
                                               const size_t cchLine,
                                               const COORD coordTarget);
 
         void _PaintSelection(_In_ IRenderEngine* const pEngine);
+
+        void _CaptureCursor();
         void _PaintCursor(_In_ IRenderEngine* const pEngine);
 
-        void _PaintOverlays(_In_ IRenderEngine* const pEngine);
-        void _PaintOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
+        void _CaptureOverlays();
+        void _CaptureOverlay(const RenderOverlay& overlay);
 
         [[nodiscard]]
-        HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute attr, const bool isSettingDefaultBrushes);
+        HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const FrameSnapshot::Run& run);
 
         [[nodiscard]]
         HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
@@ -128,8 +148,77 @@ namespace Microsoft::Console::Render
         std::vector<SMALL_RECT> _GetSelectionRects() const;
         std::vector<SMALL_RECT> _previousSelection;
 
-        [[nodiscard]]
-        HRESULT _PaintTitle(IRenderEngine* const pEngine);
+        // Everything needed to paint the current frame, copied out under the console lock.
+        FrameSnapshot _frame;
+
+        // Serializes composing frames, since they all share _frame.
+        // Always acquired after the console lock.
+        std::recursive_mutex _paintLock;
+
+        // Invalidations from writes to the buffer, gathered up and handed to the
+        // engines once per batch instead of once per call. Everything that
+        // triggers these holds the console lock, and so does the paint that
+        // drains them, so this needs no lock of its own.
+        struct PendingInvalidation
+        {
+            struct CursorMark
+            {
+                COORD coord;
+                bool isDoubleWidth;
+            };
+
+            COORD scrollDelta; // applied before the region and cursor
+            bool hasRegion;
+            SMALL_RECT region; // exclusive, relative to the viewport
+            size_t cursorMoves;
+            CursorMark cursorFirst; // where the cursor was
+            CursorMark cursorTop; // the topmost place it went after that
+            CursorMark cursorLast; // where it is now
+
+            bool IsEmpty() const noexcept
+            {
+                return !hasRegion && cursorMoves == 0 && scrollDelta.X == 0 && scrollDelta.Y == 0;
+            }
+        };
+        PendingInvalidation _pending{};
+
+        // One call to the engines, kept as plain data so that it can be queued
+        //      while a frame is in flight without allocating.
+        struct EngineInvalidation
+        {
+            enum class Kind
+            {
+                Batch, // pending
+                System, // system
+                All,
+                Viewport, // viewport, then scrollDelta
+                Selection, // previousRects then currentRects, starting at firstRect in _deferredRects
+                Title // _deferredTitle
+            };
+
+            Kind kind;
+            PendingInvalidation pending;
+            RECT system;
+            SMALL_RECT viewport;
+            COORD scrollDelta;
+            size_t firstRect;
+            size_t previousRects;
+            size_t currentRects;
+        };
+
+        // Guards the engines' invalidation state against the thread painting a frame.
+        // While a frame is in flight, invalidations are queued and replayed when it is done.
+        // The vectors keep their capacity from one frame to the next.
+        std::mutex _engineLock;
+        bool _frameInFlight = false;
+        std::vector<EngineInvalidation> _deferredInvalidations;
+        std::vector<SMALL_RECT> _deferredRects;
+        std::vector<SMALL_RECT> _replayRects;
+        std::wstring _deferredTitle;
+
+        // Set once the render thread has been woken for the next frame, so that
+        //      every other trigger before it starts doesn't wake it again.
+        std::atomic<bool> _paintRequested{ false };
 
         // Helper functions to diagnose issues with painting and layout.
         // These are only actually effective/on in Debug builds when the flag is set using an attached debugger.
@@ -37,6 +37,7 @@ namespace Microsoft::Console::Render
 
         virtual void TriggerRedrawAll() = 0;
         virtual void TriggerTeardown() = 0;
+        virtual void TriggerPaint() = 0;
 
         virtual void TriggerSelection() = 0;
         virtual void TriggerScroll() = 0;
@@ -54,6 +55,9 @@ namespace Microsoft::Console::Render
 
         virtual bool IsGlyphWideByFont(const std::wstring_view glyph) = 0;
 
+        [[nodiscard]]
+        virtual HRESULT CallEngine(const std::function<HRESULT()>& call) = 0;
+
         virtual void EnablePainting() = 0;
         virtual void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) = 0;
 
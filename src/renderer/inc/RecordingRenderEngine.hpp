@@ -0,0 +1,275 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RecordingRenderEngine.hpp
+
+Abstract:
+- Provides a headless implementation of the IRenderEngine interface, which
+    records the calls the Renderer makes into an in-memory frame log instead
+    of drawing anything.
+    This is used to test and measure the Renderer itself, without GDI, DirectX
+    or a pipe getting in the way. Storage for the log is retained between
+    frames, so once it has grown to fit a frame, recording doesn't allocate.
+--*/
+
+#pragma once
+#include "IRenderEngine.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class RecordingRenderEngine final : public IRenderEngine
+    {
+    public:
+        struct Call
+        {
+            enum class Kind : BYTE
+            {
+                BufferLine,
+                Cursor,
+                Brushes
+            };
+
+            Kind kind;
+            COORD coord; // Where a line or the cursor was painted.
+            size_t textOffset; // Where this line's text starts in Text().
+            size_t clusterCount;
+            size_t columns;
+            COLORREF foreground;
+            COLORREF background;
+        };
+
+        RecordingRenderEngine(const COORD size) :
+            _viewport{ 0, 0, size.X - 1, size.Y - 1 },
+            _dirty{ 0 },
+            _dirtyUsed{ false },
+            _frames{ 0 },
+            _clusters{ 0 },
+            _invalidations{ 0 }
+        {
+        }
+
+        // Method Description:
+        // - Empties the frame log, but keeps its storage for the next frames.
+        void ClearLog() noexcept
+        {
+            _calls.clear();
+            _text.clear();
+        }
+
+        const std::vector<Call>& Calls() const noexcept { return _calls; }
+        const std::wstring& Text() const noexcept { return _text; }
+        size_t FrameCount() const noexcept { return _frames; }
+        size_t ClusterCount() const noexcept { return _clusters; }
+        size_t InvalidationCount() const noexcept { return _invalidations; } // Calls to any of the Invalidate methods.
+
+        [[nodiscard]]
+        HRESULT StartPaint() noexcept override
+        {
+            return _dirtyUsed ? S_OK : S_FALSE;
+        }
+
+        [[nodiscard]]
+        HRESULT EndPaint() noexcept override
+        {
+            _dirty = { 0 };
+            _dirtyUsed = false;
+            _frames++;
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT Present() noexcept override { return S_FALSE; }
+
+        [[nodiscard]]
+        HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT ScrollFrame() noexcept override { return S_OK; }
+
+        [[nodiscard]]
+        HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept override
+        {
+            _invalidations++;
+            _Combine(*psrRegion);
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT InvalidateCursor(const COORD* const pcoordCursor) noexcept override
+        {
+            _invalidations++;
+            _Combine({ pcoordCursor->X, pcoordCursor->Y, pcoordCursor->X + 1, pcoordCursor->Y + 1 });
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT InvalidateSystem(const RECT* const /*prcDirtyClient*/) noexcept override { return InvalidateAll(); }
+
+        [[nodiscard]]
+        HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override
+        {
+            _invalidations++;
+            for (const auto& rect : rectangles)
+            {
+                _Combine(rect);
+            }
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT InvalidateScroll(const COORD* const /*pcoordDelta*/) noexcept override { return InvalidateAll(); }
+
+        [[nodiscard]]
+        HRESULT InvalidateAll() noexcept override
+        {
+            _invalidations++;
+            _Combine({ 0, 0, _viewport.Right - _viewport.Left + 1, _viewport.Bottom - _viewport.Top + 1 });
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT InvalidateTitle(const std::wstring& /*proposedTitle*/) noexcept override { return S_OK; }
+
+        [[nodiscard]]
+        HRESULT PaintBackground() noexcept override { return S_OK; }
+
+        [[nodiscard]]
+        HRESULT PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                const COORD coord,
+                                const bool /*fTrimLeft*/) noexcept override
+        {
+            try
+            {
+                Call call{ Call::Kind::BufferLine, coord, _text.size(), clusters.size(), 0, 0, 0 };
+                for (const auto& cluster : clusters)
+                {
+                    _text.append(cluster.GetText());
+                    call.columns += cluster.GetColumns();
+                }
+                _calls.push_back(call);
+                _clusters += clusters.size();
+                return S_OK;
+            }
+            CATCH_RETURN();
+        }
+
+        [[nodiscard]]
+        HRESULT PaintBufferGridLines(const GridLines /*lines*/,
+                                     const COLORREF /*color*/,
+                                     const size_t /*cchLine*/,
+                                     const COORD /*coordTarget*/) noexcept override { return S_OK; }
+
+        [[nodiscard]]
+        HRESULT PaintSelection(const SMALL_RECT /*rect*/) noexcept override { return S_OK; }
+
+        [[nodiscard]]
+        HRESULT PaintCursor(const CursorOptions& options) noexcept override
+        {
+            try
+            {
+                _calls.push_back({ Call::Kind::Cursor, options.coordCursor, _text.size(), 0, 0, options.cursorColor, 0 });
+                return S_OK;
+            }
+            CATCH_RETURN();
+        }
+
+        [[nodiscard]]
+        HRESULT UpdateDrawingBrushes(const COLORREF colorForeground,
+                                     const COLORREF colorBackground,
+                                     const WORD /*legacyColorAttribute*/,
+                                     const bool /*isBold*/,
+                                     const bool /*isSettingDefaultBrushes*/) noexcept override
+        {
+            try
+            {
+                _calls.push_back({ Call::Kind::Brushes, { 0 }, _text.size(), 0, 0, colorForeground, colorBackground });
+                return S_OK;
+            }
+            CATCH_RETURN();
+        }
+
+        [[nodiscard]]
+        HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/,
+                           _Out_ FontInfo& /*FontInfo*/) noexcept override { return S_OK; }
+
+        [[nodiscard]]
+        HRESULT UpdateDpi(const int /*iDpi*/) noexcept override { return S_OK; }
+
+        [[nodiscard]]
+        HRESULT UpdateViewport(const SMALL_RECT srNewViewport) noexcept override
+        {
+            _viewport = srNewViewport;
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                _Out_ FontInfo& /*FontInfo*/,
+                                const int /*iDpi*/) noexcept override { return S_FALSE; }
+
+        // Returns the dirty area as an inclusive rectangle, like the other engines.
+        SMALL_RECT GetDirtyRectInChars() override
+        {
+            return { _dirty.Left, _dirty.Top, _dirty.Right - 1, _dirty.Bottom - 1 };
+        }
+
+        [[nodiscard]]
+        HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override
+        {
+            *pFontSize = { 1, 1 };
+            return S_OK;
+        }
+
+        [[nodiscard]]
+        HRESULT IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept override
+        {
+            *pResult = false;
+            return S_FALSE;
+        }
+
+        [[nodiscard]]
+        HRESULT UpdateTitle(const std::wstring& /*newTitle*/) noexcept override { return S_FALSE; }
+
+    private:
+        // Adds an exclusive rectangle to the dirty area.
+        void _Combine(const SMALL_RECT rect) noexcept
+        {
+            if (!_dirtyUsed)
+            {
+                _dirty = rect;
+                _dirtyUsed = true;
+            }
+            else
+            {
+                _dirty.Left = std::min(_dirty.Left, rect.Left);
+                _dirty.Top = std::min(_dirty.Top, rect.Top);
+                _dirty.Right = std::max(_dirty.Right, rect.Right);
+                _dirty.Bottom = std::max(_dirty.Bottom, rect.Bottom);
+            }
+        }
+
+        SMALL_RECT _viewport;
+        SMALL_RECT _dirty; // exclusive
+        bool _dirtyUsed;
+
+        std::vector<Call> _calls;
+        std::wstring _text;
+
+        size_t _frames;
+        size_t _clusters;
+        size_t _invalidations;
+    };
+}
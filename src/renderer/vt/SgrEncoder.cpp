@@ -0,0 +1,280 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "SgrEncoder.hpp"
+#include "../../inc/conattrs.hpp"
+
+#pragma hdrstop
+using namespace Microsoft::Console::Render;
+
+// The channel levels of the 6x6x6 color cube in the xterm 256 color palette,
+//      which starts at index 16.
+static constexpr BYTE s_xtermCubeLevels[] = { 0x00, 0x5f, 0x87, 0xaf, 0xd7, 0xff };
+
+// Function Description:
+// - Finds the xterm color cube level index for a single channel value.
+// Return Value:
+// - The index of the level, or -1 if the value isn't exactly one of the levels.
+static int _CubeLevel(const BYTE value) noexcept
+{
+    for (int i = 0; i < ARRAYSIZE(s_xtermCubeLevels); i++)
+    {
+        if (s_xtermCubeLevels[i] == value)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Function Description:
+// - Looks for an exact match of the color in the xterm 256 color palette. Only
+//      the color cube and the grayscale ramp are considered, since the first
+//      16 entries depend on the terminal's own color scheme.
+// Arguments:
+// - color: the color to look for
+// - index: receives the palette index on success
+// Return Value:
+// - true if the color is exactly representable as a palette index.
+static bool _FindXterm256Index(const COLORREF color, _Out_ BYTE& index) noexcept
+{
+    const BYTE r = GetRValue(color);
+    const BYTE g = GetGValue(color);
+    const BYTE b = GetBValue(color);
+
+    const int rLevel = _CubeLevel(r);
+    const int gLevel = _CubeLevel(g);
+    const int bLevel = _CubeLevel(b);
+    if (rLevel >= 0 && gLevel >= 0 && bLevel >= 0)
+    {
+        index = static_cast<BYTE>(16 + (36 * rLevel) + (6 * gLevel) + bLevel);
+        return true;
+    }
+
+    // The grayscale ramp is 24 steps, from 8 to 238 in steps of 10.
+    if (r == g && g == b && r >= 8 && r <= 238 && (r - 8) % 10 == 0)
+    {
+        index = static_cast<BYTE>(232 + (r - 8) / 10);
+        return true;
+    }
+
+    index = 0;
+    return false;
+}
+
+bool SgrColor::operator==(const SgrColor& other) const noexcept
+{
+    if (kind != other.kind || kind == Kind::Unknown)
+    {
+        // Unknown is never equal to anything, not even itself, so the first
+        //      transition always sets the color explicitly.
+        return false;
+    }
+
+    switch (kind)
+    {
+    case Kind::Index16:
+        // The 16 color engine maps colors that aren't in the table to the
+        //      nearest entry, but still tells the terminal when the color
+        //      itself changes, like it always has.
+        return index == other.index && rgb == other.rgb;
+    case Kind::Index256:
+        return index == other.index;
+    case Kind::Rgb:
+        return rgb == other.rgb;
+    default:
+        return true;
+    }
+}
+
+bool SgrColor::operator!=(const SgrColor& other) const noexcept
+{
+    return !(*this == other);
+}
+
+// Routine Description:
+// - Gets the state we assume the terminal is in before we've told it anything.
+//      Both colors are unknown, so they'll be set on the first transition.
+SgrState SgrEncoder::s_UnknownState() noexcept
+{
+    SgrState state;
+    state.foreground = { SgrColor::Kind::Unknown, 0, INVALID_COLOR, false };
+    state.background = { SgrColor::Kind::Unknown, 0, INVALID_COLOR, false };
+    state.bold = false;
+    state.underline = false;
+    return state;
+}
+
+// Routine Description:
+// - Resolves a color for a terminal that supports true color, picking the
+//      cheapest form that represents the color exactly.
+// Arguments:
+// - color: The color to resolve.
+// - isDefault: true if this is the default color for its layer.
+// - ColorTable: The console's 16 color table.
+// - cColorTable: The number of entries in ColorTable.
+// Return Value:
+// - the resolved color.
+SgrColor SgrEncoder::s_ResolveTrueColor(const COLORREF color,
+                                        const bool isDefault,
+                                        _In_reads_(cColorTable) const COLORREF* const ColorTable,
+                                        const WORD cColorTable) noexcept
+{
+    if (isDefault)
+    {
+        return { SgrColor::Kind::Default, 0, color, true };
+    }
+
+    WORD tableIndex = 0;
+    if (::FindTableIndex(color, ColorTable, cColorTable, &tableIndex))
+    {
+        return { SgrColor::Kind::Index16, static_cast<BYTE>(tableIndex), color, false };
+    }
+
+    BYTE paletteIndex = 0;
+    if (_FindXterm256Index(color, paletteIndex))
+    {
+        return { SgrColor::Kind::Index256, paletteIndex, color, false };
+    }
+
+    return { SgrColor::Kind::Rgb, 0, color, false };
+}
+
+// Routine Description:
+// - Resolves a color for a terminal that only supports the 16 table colors.
+//      Colors that aren't in the table are mapped to the nearest entry. A
+//      default color is sent as its table entry too, unless both colors are
+//      the defaults, in which case a reset sets them. See Encode.
+// Arguments:
+// - color: The color to resolve.
+// - isDefault: true if this is the default color for its layer.
+// - ColorTable: The console's 16 color table.
+// - cColorTable: The number of entries in ColorTable.
+// Return Value:
+// - the resolved color.
+SgrColor SgrEncoder::s_Resolve16Color(const COLORREF color,
+                                      const bool isDefault,
+                                      _In_reads_(cColorTable) const COLORREF* const ColorTable,
+                                      const WORD cColorTable) noexcept
+{
+    const WORD tableIndex = ::FindNearestTableIndex(color, ColorTable, cColorTable);
+    return { SgrColor::Kind::Index16, static_cast<BYTE>(tableIndex), color, isDefault };
+}
+
+// Routine Description:
+// - Appends the SGR parameters that select the given color.
+// Arguments:
+// - sequence: The sequence to append to.
+// - color: The color to select. Must not be Unknown.
+// - isForeground: true to select the foreground color, false for the background.
+// Return Value:
+// - <none>
+void SgrEncoder::s_AppendColor(Sequence& sequence, const SgrColor& color, const bool isForeground) noexcept
+{
+    switch (color.kind)
+    {
+    case SgrColor::Kind::Default:
+        sequence.AppendParameter(isForeground ? 39 : 49);
+        break;
+    case SgrColor::Kind::Index16:
+    {
+        // Foreground sequences are in [30,37] U [90,97]
+        // Background sequences are in [40,47] U [100,107]
+        const WORD wAttr = color.index;
+        const int vtIndex = (isForeground ? 30 : 40)
+                            + (WI_IsFlagSet(wAttr, FOREGROUND_INTENSITY) ? 60 : 0)
+                            + (WI_IsFlagSet(wAttr, FOREGROUND_RED) ? 1 : 0)
+                            + (WI_IsFlagSet(wAttr, FOREGROUND_GREEN) ? 2 : 0)
+                            + (WI_IsFlagSet(wAttr, FOREGROUND_BLUE) ? 4 : 0);
+        sequence.AppendParameter(vtIndex);
+        break;
+    }
+    case SgrColor::Kind::Index256:
+        sequence.AppendParameter(isForeground ? 38 : 48);
+        sequence.AppendParameter(5);
+        sequence.AppendParameter(color.index);
+        break;
+    case SgrColor::Kind::Rgb:
+        sequence.AppendParameter(isForeground ? 38 : 48);
+        sequence.AppendParameter(2);
+        sequence.AppendParameter(GetRValue(color.rgb));
+        sequence.AppendParameter(GetGValue(color.rgb));
+        sequence.AppendParameter(GetBValue(color.rgb));
+        break;
+    default:
+        break;
+    }
+}
+
+// Routine Description:
+// - Computes the shortest single SGR sequence that moves the terminal from
+//      the previous renditions to the next ones.
+// Arguments:
+// - previous: What the terminal is currently using.
+// - next: What the terminal should be using after the sequence.
+// Return Value:
+// - The sequence to emit, or an empty string if nothing changes. The storage
+//      belongs to this encoder, and is only valid until the next call.
+std::string_view SgrEncoder::Encode(const SgrState& previous, const SgrState& next) noexcept
+{
+    // Candidate 1: only change what differs.
+    _incremental = {};
+    if (previous.bold != next.bold)
+    {
+        _incremental.AppendParameter(next.bold ? 1 : 22);
+    }
+    if (previous.underline != next.underline)
+    {
+        _incremental.AppendParameter(next.underline ? 4 : 24);
+    }
+    if (previous.foreground != next.foreground)
+    {
+        s_AppendColor(_incremental, next.foreground, true);
+    }
+    if (previous.background != next.background)
+    {
+        s_AppendColor(_incremental, next.background, false);
+    }
+
+    if (_incremental.ParameterCount() == 0)
+    {
+        return {};
+    }
+
+    // Candidate 2: reset everything, then set whatever isn't the default. The
+    //      16 color engine only leaves its defaults to the reset when both
+    //      colors are the defaults; the terminal's own default colors stand
+    //      in for that pair, but not for either color alone.
+    const bool resetSetsBothColors = next.foreground.isDefault && next.background.isDefault;
+    _reset = {};
+    _reset.AppendParameter(0);
+    if (next.bold)
+    {
+        _reset.AppendParameter(1);
+    }
+    if (next.underline)
+    {
+        _reset.AppendParameter(4);
+    }
+    if (next.foreground.kind != SgrColor::Kind::Default && !resetSetsBothColors)
+    {
+        s_AppendColor(_reset, next.foreground, true);
+    }
+    if (next.background.kind != SgrColor::Kind::Default && !resetSetsBothColors)
+    {
+        s_AppendColor(_reset, next.background, false);
+    }
+
+    if (_reset.Length() < _incremental.Length())
+    {
+        // A lone reset parameter can be left implicit.
+        if (_reset.ParameterCount() == 1)
+        {
+            return "\x1b[m";
+        }
+        return _reset.Finish('m');
+    }
+
+    return _incremental.Finish('m');
+}
@@ -0,0 +1,81 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SgrEncoder.hpp
+
+Abstract:
+- Computes the shortest SGR sequence that moves the terminal from one set of
+  graphics renditions to another.
+- Colors are first resolved into the cheapest form the terminal understands:
+  the default color, one of the 16 table colors, an exact match in the xterm
+  256 color palette, or a true RGB color.
+- Two candidates are built for every transition: one that only changes what
+  differs, and one that resets everything then sets what isn't default. All
+  the changes are combined into a single sequence, and the shorter candidate
+  is emitted.
+--*/
+
+#pragma once
+
+#include "VtSequenceBuilder.hpp"
+
+namespace Microsoft::Console::Render
+{
+    struct SgrColor
+    {
+        enum class Kind : BYTE
+        {
+            Unknown, // We don't know what the terminal is using right now.
+            Default,
+            Index16, // index is a Windows color table index
+            Index256, // index is an xterm 256 color palette index
+            Rgb
+        };
+
+        Kind kind;
+        BYTE index;
+        COLORREF rgb;
+        bool isDefault; // A reset sets this color, at least when paired with the other default.
+
+        bool operator==(const SgrColor& other) const noexcept;
+        bool operator!=(const SgrColor& other) const noexcept;
+    };
+
+    struct SgrState
+    {
+        SgrColor foreground;
+        SgrColor background;
+        bool bold;
+        bool underline;
+    };
+
+    class SgrEncoder final
+    {
+    public:
+        static SgrState s_UnknownState() noexcept;
+
+        static SgrColor s_ResolveTrueColor(const COLORREF color,
+                                           const bool isDefault,
+                                           _In_reads_(cColorTable) const COLORREF* const ColorTable,
+                                           const WORD cColorTable) noexcept;
+
+        static SgrColor s_Resolve16Color(const COLORREF color,
+                                         const bool isDefault,
+                                         _In_reads_(cColorTable) const COLORREF* const ColorTable,
+                                         const WORD cColorTable) noexcept;
+
+        std::string_view Encode(const SgrState& previous, const SgrState& next) noexcept;
+
+    private:
+        // Reset, bold, underline and two RGB colors of five parameters each.
+        static constexpr size_t s_maxParameters = 13;
+        using Sequence = CsiSequence<s_maxParameters>;
+
+        static void s_AppendColor(Sequence& sequence, const SgrColor& color, const bool isForeground) noexcept;
+
+        Sequence _incremental;
+        Sequence _reset;
+    };
+}
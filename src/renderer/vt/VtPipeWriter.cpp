@@ -0,0 +1,267 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "VtPipeWriter.hpp"
+
+#pragma hdrstop
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a new writer for the given pipe. The writer doesn't own the pipe,
+//      and it must outlive the writer.
+// - NOTE: Will throw if the ring buffer can't be allocated.
+// Arguments:
+// - pipe: the pipe to write the output to.
+VtPipeWriter::VtPipeWriter(const HANDLE pipe) :
+    _pipe{ pipe },
+    _hThread{},
+    _ring{ std::make_unique<char[]>(s_capacity) },
+    _head{ 0 },
+    _queued{ 0 },
+    _shutdown{ false },
+    _result{ S_OK },
+    _notifyWhenDrained{ false },
+    _pfnDrained{},
+    _droppedFrames{ 0 },
+    _writtenBytes{ 0 }
+{
+}
+
+// Routine Description:
+// - Stops the writer thread. Everything that was queued is still written to
+//      the pipe before the thread exits, so the final frame isn't lost.
+// - If the consumer has stopped reading, the thread would be stuck in
+//      WriteFile forever. Once it has had a while to finish, its write is
+//      cancelled, which fails it and makes the thread exit.
+VtPipeWriter::~VtPipeWriter()
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _shutdown = true;
+    }
+    _dataAvailable.notify_all();
+
+    if (_hThread)
+    {
+        // The thread may not have made it into WriteFile yet when we cancel,
+        //      so keep cancelling until it's gone.
+        while (WaitForSingleObject(_hThread.get(), s_shutdownTimeoutMs) == WAIT_TIMEOUT)
+        {
+            CancelSynchronousIo(_hThread.get());
+        }
+    }
+}
+
+// Routine Description:
+// - Starts the writer thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if the thread was started, else an appropriate HRESULT.
+[[nodiscard]]
+HRESULT VtPipeWriter::Start() noexcept
+{
+    _hThread.reset(CreateThread(nullptr, // non-inheritable security attributes
+                                0, // use default stack size
+                                s_WriterThreadProc,
+                                this,
+                                0, // create immediately
+                                nullptr)); // we don't need the thread ID
+    RETURN_LAST_ERROR_IF(!_hThread);
+    return S_OK;
+}
+
+// Routine Description:
+// - Queues the string to be written to the pipe. If the ring buffer is full,
+//      this blocks until the writer thread has made enough room, so the
+//      caller is slowed down to the speed of the consumer.
+// Arguments:
+// - str: the bytes to write.
+// Return Value:
+// - S_OK if the string was queued, otherwise the error the writer thread hit
+//      while writing the pipe.
+[[nodiscard]]
+HRESULT VtPipeWriter::Write(const std::string_view str) noexcept
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    auto remaining = str;
+    while (!remaining.empty() && SUCCEEDED(_result))
+    {
+        _spaceAvailable.wait(lock, [&]() { return _queued < s_capacity || FAILED(_result); });
+        if (FAILED(_result))
+        {
+            break;
+        }
+
+        // Fill the free space, which might wrap around the end of the ring.
+        const size_t tail = (_head + _queued) % s_capacity;
+        const size_t contiguous = std::min(s_capacity - _queued, s_capacity - tail);
+        const size_t count = std::min(remaining.size(), contiguous);
+        std::copy_n(remaining.data(), count, _ring.get() + tail);
+        _queued += count;
+        remaining.remove_prefix(count);
+
+        _dataAvailable.notify_one();
+    }
+
+    return _result;
+}
+
+// Routine Description:
+// - Checks whether the consumer has fallen behind far enough that the next
+//      frame should be skipped. If so, the dropped frame is counted, and the
+//      writer will call the drained callback once it has caught up, so that a
+//      frame with all the accumulated changes gets painted.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the caller should not paint a frame right now.
+bool VtPipeWriter::ShouldDropFrame() noexcept
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    if (FAILED(_result) || _queued <= s_backlogThreshold)
+    {
+        return false;
+    }
+
+    _droppedFrames++;
+    _notifyWhenDrained = true;
+    return true;
+}
+
+// Routine Description:
+// - Waits until everything that was queued has been written to the pipe, or
+//      until writing the pipe failed. Used on teardown, where the process is
+//      about to exit and take the writer thread with it.
+// Arguments:
+// - dwMilliseconds: how long to wait at most.
+// Return Value:
+// - true if nothing is left in the queue, false if we timed out.
+bool VtPipeWriter::WaitForDrain(const DWORD dwMilliseconds) noexcept
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    return _spaceAvailable.wait_for(lock,
+                                    std::chrono::milliseconds(dwMilliseconds),
+                                    [&]() { return _queued == 0 || FAILED(_result); });
+}
+
+// Routine Description:
+// - Sets the function to call when the writer has caught up after frames were
+//      dropped, or when writing the pipe failed. It's called on the writer
+//      thread, and should do no more than request a new frame.
+// Arguments:
+// - pfnDrained: the function to call.
+// Return Value:
+// - <none>
+void VtPipeWriter::SetDrainedCallback(std::function<void()> pfnDrained) noexcept
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _pfnDrained = std::move(pfnDrained);
+}
+
+// Routine Description:
+// - Gets the current queue depth and the running totals of this writer.
+// Arguments:
+// - <none>
+// Return Value:
+// - A snapshot of the writer's counters.
+VtPipeWriter::Statistics VtPipeWriter::GetStatistics() const noexcept
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return { _queued, _droppedFrames, _writtenBytes };
+}
+
+// Routine Description:
+// - Gets the error the writer thread hit while writing the pipe, if any.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or the error that stopped the writer thread.
+HRESULT VtPipeWriter::GetResult() const noexcept
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _result;
+}
+
+DWORD WINAPI VtPipeWriter::s_WriterThreadProc(_In_ LPVOID lpParameter)
+{
+    VtPipeWriter* const pContext = static_cast<VtPipeWriter*>(lpParameter);
+
+    if (pContext != nullptr)
+    {
+        return pContext->_WriterThreadProc();
+    }
+    else
+    {
+        return (DWORD)E_INVALIDARG;
+    }
+}
+
+// Routine Description:
+// - The writer thread. Writes the queued bytes to the pipe, one contiguous
+//      span of the ring buffer at a time. The lock is not held during the
+//      write, so the render thread can keep queueing behind it.
+DWORD VtPipeWriter::_WriterThreadProc()
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    while (true)
+    {
+        _dataAvailable.wait(lock, [&]() { return _queued > 0 || _shutdown; });
+        if (_queued == 0)
+        {
+            break;
+        }
+
+        // Only the render thread adds to the ring, and only outside of the
+        //      queued span, so this span stays put while we're unlocked.
+        const char* const data = _ring.get() + _head;
+        const size_t count = std::min(_queued, s_capacity - _head);
+
+        lock.unlock();
+        const bool fSuccess = !!WriteFile(_pipe, data, static_cast<DWORD>(count), nullptr, nullptr);
+        const HRESULT hr = fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+        lock.lock();
+
+        std::function<void()> pfnNotify;
+        if (FAILED(hr))
+        {
+            // Nothing else will make it to the terminal. Throw away what's
+            //      left, and let the render thread find out on its next write.
+            _result = hr;
+            _queued = 0;
+            pfnNotify = _pfnDrained;
+        }
+        else
+        {
+            _head = (_head + count) % s_capacity;
+            _queued -= count;
+            _writtenBytes += count;
+
+            if (_notifyWhenDrained && _queued <= s_backlogThreshold)
+            {
+                _notifyWhenDrained = false;
+                pfnNotify = _pfnDrained;
+            }
+        }
+
+        _spaceAvailable.notify_all();
+
+        if (pfnNotify)
+        {
+            lock.unlock();
+            pfnNotify();
+            lock.lock();
+        }
+
+        if (FAILED(_result))
+        {
+            break;
+        }
+    }
+
+    return S_OK;
+}
@@ -0,0 +1,94 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtPipeWriter.hpp
+
+Abstract:
+- Writes the output of the VT renderer to its pipe from a dedicated thread, so
+  that a slow consumer (a remote session, or a terminal that's busy parsing)
+  doesn't stall the render thread.
+- Frames are copied into a fixed size ring buffer and drained by the writer
+  thread. The bytes of a frame are never dropped, since every frame is painted
+  relative to the previous one. Instead, when the consumer falls behind, the
+  engine declines to paint (see ShouldDropFrame), and its invalid regions keep
+  accumulating. Once the consumer catches up, the writer asks for a repaint,
+  which then covers everything that changed in the meantime.
+- The process exits right after its last frame, which would kill the writer
+  thread along with whatever it still had queued. WaitForDrain lets the engine
+  wait for the queue to make it into the pipe first.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+namespace Microsoft::Console::Render
+{
+    class VtPipeWriter final
+    {
+    public:
+        struct Statistics
+        {
+            size_t queuedBytes;
+            size_t droppedFrames;
+            ULONGLONG writtenBytes;
+        };
+
+        VtPipeWriter(const HANDLE pipe);
+        ~VtPipeWriter();
+
+        [[nodiscard]]
+        HRESULT Start() noexcept;
+
+        [[nodiscard]]
+        HRESULT Write(const std::string_view str) noexcept;
+
+        bool ShouldDropFrame() noexcept;
+
+        bool WaitForDrain(const DWORD dwMilliseconds) noexcept;
+
+        void SetDrainedCallback(std::function<void()> pfnDrained) noexcept;
+
+        Statistics GetStatistics() const noexcept;
+
+        HRESULT GetResult() const noexcept;
+
+    private:
+        static DWORD WINAPI s_WriterThreadProc(_In_ LPVOID lpParameter);
+        DWORD _WriterThreadProc();
+
+        // The size of the ring buffer. Writes larger than this are copied in
+        //      pieces as the writer thread makes room.
+        static constexpr size_t s_capacity = 256 * 1024;
+
+        // Once more than this is waiting to be written, frames are dropped
+        //      until the queue has drained back below it.
+        static constexpr size_t s_backlogThreshold = s_capacity / 4;
+
+        // How long the destructor gives the writer thread to write what's left
+        //      before cancelling a write the consumer isn't reading.
+        static constexpr DWORD s_shutdownTimeoutMs = 1000;
+
+        const HANDLE _pipe;
+        wil::unique_handle _hThread;
+
+        mutable std::mutex _lock;
+        std::condition_variable _dataAvailable;
+        std::condition_variable _spaceAvailable;
+
+        std::unique_ptr<char[]> _ring;
+        size_t _head; // The offset of the first byte waiting to be written.
+        size_t _queued; // The number of bytes waiting to be written.
+
+        bool _shutdown;
+        HRESULT _result;
+
+        bool _notifyWhenDrained;
+        std::function<void()> _pfnDrained;
+
+        size_t _droppedFrames;
+        ULONGLONG _writtenBytes;
+    };
+}
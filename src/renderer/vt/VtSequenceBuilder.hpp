@@ -0,0 +1,71 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtSequenceBuilder.hpp
+
+Abstract:
+- Formats CSI sequences with numeric parameters into fixed storage on the
+  stack. The storage is sized at compile time from the number of parameters,
+  so emitting a sequence never touches the heap.
+- Used by VtSequences.cpp in place of printf-style formatting.
+--*/
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <string_view>
+
+namespace Microsoft::Console::Render
+{
+    template<size_t ParamCount>
+    class CsiSequence final
+    {
+    public:
+        CsiSequence() noexcept :
+            _length{ 2 },
+            _params{ 0 }
+        {
+            _data[0] = '\x1b';
+            _data[1] = '[';
+        }
+
+        void AppendParameter(const int value) noexcept
+        {
+            if (_params++ > 0)
+            {
+                _data[_length++] = ';';
+            }
+
+            const auto result = std::to_chars(_data.data() + _length, _data.data() + _data.size(), value);
+            _length = result.ptr - _data.data();
+        }
+
+        size_t ParameterCount() const noexcept
+        {
+            return _params;
+        }
+
+        // The length of the sequence so far, not counting the final char.
+        size_t Length() const noexcept
+        {
+            return _length;
+        }
+
+        std::string_view Finish(const char finalChar) noexcept
+        {
+            _data[_length++] = finalChar;
+            return { _data.data(), _length };
+        }
+
+    private:
+        // ESC [ + for every parameter: up to 11 chars for an int and a separator + the final char.
+        static constexpr size_t s_capacity = 2 + (ParamCount * 12) + 1;
+
+        std::array<char, s_capacity> _data;
+        size_t _length;
+        size_t _params;
+    };
+}
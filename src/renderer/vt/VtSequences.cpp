@@ -8,6 +8,17 @@
 #pragma hdrstop
 using namespace Microsoft::Console::Render;
 
+// The 16 color SGR sequences, precomputed. They're indexed by the RGBI bits of
+//      a legacy attribute: red is 1, green is 2, blue is 4, intensity is 8.
+static constexpr std::string_view s_sgr16ColorForeground[] = {
+    "\x1b[30m", "\x1b[31m", "\x1b[32m", "\x1b[33m", "\x1b[34m", "\x1b[35m", "\x1b[36m", "\x1b[37m",
+    "\x1b[90m", "\x1b[91m", "\x1b[92m", "\x1b[93m", "\x1b[94m", "\x1b[95m", "\x1b[96m", "\x1b[97m",
+};
+static constexpr std::string_view s_sgr16ColorBackground[] = {
+    "\x1b[40m", "\x1b[41m", "\x1b[42m", "\x1b[43m", "\x1b[44m", "\x1b[45m", "\x1b[46m", "\x1b[47m",
+    "\x1b[100m", "\x1b[101m", "\x1b[102m", "\x1b[103m", "\x1b[104m", "\x1b[105m", "\x1b[106m", "\x1b[107m",
+};
+
 // Method Description:
 // - Formats and writes a sequence to stop the cursor from blinking.
 // Arguments:
@@ -87,9 +98,7 @@ HRESULT VtEngine::_EraseLine() noexcept
 [[nodiscard]]
 HRESULT VtEngine::_EraseCharacter(const short chars) noexcept
 {
-    static const std::string format = "\x1b[%dX";
-
-    return _WriteFormattedString(&format, chars);
+    return _WriteCsi<'X'>(chars);
 }
 
 // Method Description:
@@ -101,10 +110,7 @@ HRESULT VtEngine::_EraseCharacter(const short chars) noexcept
 [[nodiscard]]
 HRESULT VtEngine::_CursorForward(const short chars) noexcept
 {
-
-    static const std::string format = "\x1b[%dC";
-
-    return _WriteFormattedString(&format, chars);
+    return _WriteCsi<'C'>(chars);
 }
 
 // Method Description:
@@ -139,9 +145,7 @@ HRESULT VtEngine::_InsertDeleteLine(const short sLines, const bool fInsertLine)
     {
         return _Write(fInsertLine ? "\x1b[L" : "\x1b[M");
     }
-    const std::string format = fInsertLine ? "\x1b[%dL" : "\x1b[%dM";
-
-    return _WriteFormattedString(&format, sLines);
+    return fInsertLine ? _WriteCsi<'L'>(sLines) : _WriteCsi<'M'>(sLines);
 }
 
 // Method Description:
@@ -181,14 +185,12 @@ HRESULT VtEngine::_InsertLine(const short sLines) noexcept
 [[nodiscard]]
 HRESULT VtEngine::_CursorPosition(const COORD coord) noexcept
 {
-    static const std::string cursorFormat = "\x1b[%d;%dH";
-
     // VT coords start at 1,1
     COORD coordVt = coord;
     coordVt.X++;
     coordVt.Y++;
 
-    return _WriteFormattedString(&cursorFormat, coordVt.Y, coordVt.X);
+    return _WriteCsi<'H'>(coordVt.Y, coordVt.X);
 }
 
 // Method Description:
@@ -212,8 +214,7 @@ HRESULT VtEngine::_CursorHome() noexcept
 [[nodiscard]]
 HRESULT VtEngine::_SetGraphicsBoldness(const bool isBold) noexcept
 {
-    const std::string fmt = isBold ? "\x1b[1m" : "\x1b[22m";
-    return _Write(fmt);
+    return _Write(isBold ? "\x1b[1m" : "\x1b[22m");
 }
 
 // Method Description:
@@ -239,8 +240,6 @@ HRESULT VtEngine::_SetGraphicsDefault() noexcept
 HRESULT VtEngine::_SetGraphicsRendition16Color(const WORD wAttr,
                                                const bool fIsForeground) noexcept
 {
-    static const std::string fmt = "\x1b[%dm";
-
     // Always check using the foreground flags, because the bg flags constants
     //  are a higher byte
     // Foreground sequences are in [30,37] U [90,97]
@@ -253,14 +252,12 @@ HRESULT VtEngine::_SetGraphicsRendition16Color(const WORD wAttr,
     //      terminals display the bright color when displaying bolded text.
     // By specifying the boldness and brightness seperately, we'll make sure the
     //      terminal has an accurate representation of our buffer.
-    const int vtIndex = 30
-                        + (fIsForeground? 0 : 10)
-                        + ((WI_IsFlagSet(wAttr, FOREGROUND_INTENSITY)) ? 60 : 0)
-                        + (WI_IsFlagSet(wAttr, FOREGROUND_RED) ? 1 : 0)
-                        + (WI_IsFlagSet(wAttr, FOREGROUND_GREEN) ? 2 : 0)
-                        + (WI_IsFlagSet(wAttr, FOREGROUND_BLUE) ? 4 : 0);
+    const size_t index = ((WI_IsFlagSet(wAttr, FOREGROUND_INTENSITY)) ? 8 : 0)
+                         + (WI_IsFlagSet(wAttr, FOREGROUND_RED) ? 1 : 0)
+                         + (WI_IsFlagSet(wAttr, FOREGROUND_GREEN) ? 2 : 0)
+                         + (WI_IsFlagSet(wAttr, FOREGROUND_BLUE) ? 4 : 0);
 
-    return _WriteFormattedString(&fmt, vtIndex);
+    return _Write(fIsForeground ? s_sgr16ColorForeground[index] : s_sgr16ColorBackground[index]);
 }
 
 // Method Description:
@@ -275,15 +272,11 @@ HRESULT VtEngine::_SetGraphicsRendition16Color(const WORD wAttr,
 HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
                                                 const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ?
-        "\x1b[38;2;%d;%d;%dm" :
-        "\x1b[48;2;%d;%d;%dm";
+    const int r = GetRValue(color);
+    const int g = GetGValue(color);
+    const int b = GetBValue(color);
 
-    DWORD const r = GetRValue(color);
-    DWORD const g = GetGValue(color);
-    DWORD const b = GetBValue(color);
-
-    return _WriteFormattedString(&fmt, r, g, b);
+    return _WriteCsi<'m'>(fIsForeground ? 38 : 48, 2, r, g, b);
 }
 
 // Method Description:
@@ -296,9 +289,7 @@ HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
 [[nodiscard]]
 HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ? ("\x1b[39m") : ("\x1b[49m");
-
-    return _Write(fmt);
+    return _Write(fIsForeground ? "\x1b[39m" : "\x1b[49m");
 }
 
 // Method Description:
@@ -311,13 +302,12 @@ HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) no
 [[nodiscard]]
 HRESULT VtEngine::_ResizeWindow(const short sWidth, const short sHeight) noexcept
 {
-    static const std::string resizeFormat = "\x1b[8;%d;%dt";
     if (sWidth < 0 || sHeight < 0)
     {
         return E_INVALIDARG;
     }
 
-    return _WriteFormattedString(&resizeFormat, sHeight, sWidth);
+    return _WriteCsi<'t'>(8, sHeight, sWidth);
 }
 
 // Method Description:
@@ -345,27 +335,3 @@ HRESULT VtEngine::_ChangeTitle(_In_ const std::string& title) noexcept
     const std::string titleFormat = "\x1b]0;" + title + "\x7";
     return _Write(titleFormat);
 }
-
-// Method Description:
-// - Writes a sequence to tell the terminal to start underlining text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]]
-HRESULT VtEngine::_BeginUnderline() noexcept
-{
-    return _Write("\x1b[4m");
-}
-
-// Method Description:
-// - Writes a sequence to tell the terminal to stop underlining text
-// Arguments:
-// - <none>
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]]
-HRESULT VtEngine::_EndUnderline() noexcept
-{
-    return _Write("\x1b[24m");
-}
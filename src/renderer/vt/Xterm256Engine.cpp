@@ -18,8 +18,9 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 }
 
 // Routine Description:
-// - Write a VT sequence to change the current colors of text. Writes true RGB
-//      color sequences.
+// - Write a VT sequence to change the current colors of text. Uses the 16
+//      color table or the 256 color palette where the color is exactly
+//      representable, and true RGB color sequences otherwise.
 // Arguments:
 // - colorForeground: The RGB Color to use to paint the foreground text.
 // - colorBackground: The RGB Color to use to paint the background of the text.
@@ -36,17 +37,22 @@ HRESULT Xterm256Engine::UpdateDrawingBrushes(const COLORREF colorForeground,
                                              const bool isBold,
                                              const bool /*isSettingDefaultBrushes*/) noexcept
 {
-    //When we update the brushes, check the wAttrs to see if the LVB_UNDERSCORE
-    //      flag is there. If the state of that flag is different then our
-    //      current state, change the underlining state.
+    // When we update the brushes, check the wAttrs to see if the LVB_UNDERSCORE
+    //      flag is there. The underlining state is updated along with the colors.
     // We have to do this here, instead of in PaintBufferGridLines, because
     //      we'll have already painted the text by the time PaintBufferGridLines
     //      is called.
-    RETURN_IF_FAILED(_UpdateUnderline(legacyColorAttribute));
+    SgrState rendition;
+    rendition.bold = isBold;
+    rendition.underline = WI_IsFlagSet(legacyColorAttribute, COMMON_LVB_UNDERSCORE);
+    rendition.foreground = SgrEncoder::s_ResolveTrueColor(colorForeground,
+                                                          colorForeground == _colorProvider.GetDefaultForeground(),
+                                                          _ColorTable,
+                                                          _cColorTable);
+    rendition.background = SgrEncoder::s_ResolveTrueColor(colorBackground,
+                                                          colorBackground == _colorProvider.GetDefaultBackground(),
+                                                          _ColorTable,
+                                                          _cColorTable);
 
-    return VtEngine::_RgbUpdateDrawingBrushes(colorForeground,
-                                              colorBackground,
-                                              isBold,
-                                              _ColorTable,
-                                              _cColorTable);
+    return _UpdateRendition(rendition);
 }
@@ -20,8 +20,8 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     _cColorTable(cColorTable),
     _fUseAsciiOnly(fUseAsciiOnly),
     _previousLineWrapped(false),
-    _usingUnderLine(false),
-    _needToDisableCursor(false)
+    _needToDisableCursor(false),
+    _lastRendition(SgrEncoder::s_UnknownState())
 {
     // Set out initial cursor position to -1, -1. This will force our initial
     //      paint to manually move the cursor to 0, 0, not just ignore it.
@@ -43,6 +43,13 @@ HRESULT XtermEngine::StartPaint() noexcept
 {
     RETURN_IF_FAILED(VtEngine::StartPaint());
 
+    // If the base engine won't paint at all this frame, leave all of the
+    //      invalid state alone so it's painted with the next frame.
+    if (_frameDeclined)
+    {
+        return S_FALSE;
+    }
+
     _trace.TraceLastText(_lastText);
 
     if (_firstPaint)
@@ -127,27 +134,22 @@ HRESULT XtermEngine::EndPaint() noexcept
 
 
 // Routine Description:
-// - Write a VT sequence to either start or stop underlining text.
+// - Write the shortest SGR sequence that changes the terminal's current
+//      colors, boldness and underlining to the given ones. Writes nothing if
+//      the terminal is already using them.
 // Arguments:
-// - legacyColorAttribute: A console attributes bit field containing information
-//      about the underlining state of the text.
+// - rendition: The graphics renditions the following text should use.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]]
-HRESULT XtermEngine::_UpdateUnderline(const WORD legacyColorAttribute) noexcept
+HRESULT XtermEngine::_UpdateRendition(const SgrState& rendition) noexcept
 {
-    bool textUnderlined = WI_IsFlagSet(legacyColorAttribute, COMMON_LVB_UNDERSCORE);
-    if (textUnderlined != _usingUnderLine)
+    SgrEncoder encoder;
+    const auto sequence = encoder.Encode(_lastRendition, rendition);
+    if (!sequence.empty())
     {
-        if (textUnderlined)
-        {
-            RETURN_IF_FAILED(_BeginUnderline());
-        }
-        else
-        {
-            RETURN_IF_FAILED(_EndUnderline());
-        }
-        _usingUnderLine = textUnderlined;
+        RETURN_IF_FAILED(_Write(sequence));
+        _lastRendition = rendition;
     }
     return S_OK;
 }
@@ -171,16 +173,26 @@ HRESULT XtermEngine::UpdateDrawingBrushes(const COLORREF colorForeground,
                                           const bool isBold,
                                           const bool /*isSettingDefaultBrushes*/) noexcept
 {
-    //When we update the brushes, check the wAttrs to see if the LVB_UNDERSCORE
-    //      flag is there. If the state of that flag is different then our
-    //      current state, change the underlining state.
+    // When we update the brushes, check the wAttrs to see if the LVB_UNDERSCORE
+    //      flag is there. The underlining state is updated along with the colors.
     // We have to do this here, instead of in PaintBufferGridLines, because
     //      we'll have already painted the text by the time PaintBufferGridLines
     //      is called.
+    SgrState rendition;
+    rendition.bold = isBold;
+    rendition.underline = WI_IsFlagSet(legacyColorAttribute, COMMON_LVB_UNDERSCORE);
 
-    RETURN_IF_FAILED(_UpdateUnderline(legacyColorAttribute));
     // The base xterm mode only knows about 16 colors
-    return VtEngine::_16ColorUpdateDrawingBrushes(colorForeground, colorBackground, isBold, _ColorTable, _cColorTable);
+    rendition.foreground = SgrEncoder::s_Resolve16Color(colorForeground,
+                                                        colorForeground == _colorProvider.GetDefaultForeground(),
+                                                        _ColorTable,
+                                                        _cColorTable);
+    rendition.background = SgrEncoder::s_Resolve16Color(colorBackground,
+                                                        colorBackground == _colorProvider.GetDefaultBackground(),
+                                                        _ColorTable,
+                                                        _cColorTable);
+
+    return _UpdateRendition(rendition);
 }
 
 // Routine Description:
@@ -219,27 +231,23 @@ HRESULT XtermEngine::_MoveCursor(COORD const coord) noexcept
             }
             else
             {
-                std::string seq = "\r\n";
-                hr = _Write(seq);
+                hr = _Write("\r\n");
             }
         }
         else if (coord.X == 0 && coord.Y == _lastText.Y)
         {
             // Start of this line
-            std::string seq = "\r";
-            hr = _Write(seq);
+            hr = _Write("\r");
         }
         else if (coord.X == _lastText.X && coord.Y == (_lastText.Y+1))
         {
             // Down one line, same X position
-            std::string seq = "\n";
-            hr = _Write(seq);
+            hr = _Write("\n");
         }
         else if (coord.X == (_lastText.X-1) && coord.Y == (_lastText.Y))
         {
             // Back one char, same Y position
-            std::string seq = "\b";
-            hr = _Write(seq);
+            hr = _Write("\b");
         }
         else if (coord.Y == _lastText.Y && coord.X > _lastText.X)
         {
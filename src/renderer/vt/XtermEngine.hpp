@@ -21,6 +21,7 @@ Author(s):
 #pragma once
 
 #include "vtrenderer.hpp"
+#include "SgrEncoder.hpp"
 
 namespace Microsoft::Console::Render
 {
@@ -65,14 +66,16 @@ namespace Microsoft::Console::Render
         const WORD _cColorTable;
         const bool _fUseAsciiOnly;
         bool _previousLineWrapped;
-        bool _usingUnderLine;
         bool _needToDisableCursor;
 
+        // The graphics renditions we last told the terminal to use.
+        SgrState _lastRendition;
+
         [[nodiscard]]
         HRESULT _MoveCursor(const COORD coord) noexcept override;
 
         [[nodiscard]]
-        HRESULT _UpdateUnderline(const WORD wLegacyAttrs) noexcept;
+        HRESULT _UpdateRendition(const SgrState& rendition) noexcept;
 
         [[nodiscard]]
         HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
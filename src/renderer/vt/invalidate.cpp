@@ -121,6 +121,11 @@ HRESULT VtEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
 // - Notifies us that we're about to be torn down. This gives us a last chance
 //      to force a repaint before the buffer contents are lost. The VT renderer
 //      needs to be able to render all text before it's lost, so we return true.
+// - The process is terminated right after this, and the pipe writer's thread
+//      with it. Whatever is still queued is written out first, and the final
+//      frame is neither dropped nor left in the queue (see _Flush). If the
+//      terminal has stopped reading altogether, we don't hold up the exit
+//      for a frame it would never see.
 // Arguments:
 // - Recieves a bool indicating if we should force the repaint.
 // Return Value:
@@ -128,7 +133,15 @@ HRESULT VtEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
 [[nodiscard]]
 HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
+    _inTeardown = true;
     *pForcePaint = true;
+
+    if (_writer && !_writer->WaitForDrain(s_teardownTimeoutMs))
+    {
+        LOG_HR(HRESULT_FROM_WIN32(ERROR_TIMEOUT));
+        *pForcePaint = false;
+    }
+
     return S_OK;
 }
 
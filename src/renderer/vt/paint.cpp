@@ -16,16 +16,30 @@ using namespace Microsoft::Console::Types;
 // Arguments:
 // - <none>
 // Return Value:
-// - S_OK if we started to paint. S_FALSE if we didn't need to paint.
+// - S_OK if we started to paint. S_FALSE if we didn't need to paint, or if
+//      the terminal is too far behind for us to paint right now.
 //      HRESULT error code if painting didn't start successfully.
 [[nodiscard]]
 HRESULT VtEngine::StartPaint() noexcept
 {
-    if (_pipeBroken)
+    _frameDeclined = _pipeBroken;
+    if (_frameDeclined)
     {
         return S_FALSE;
     }
 
+    // If the terminal hasn't consumed what we've already sent, skip this frame.
+    //      Nothing is cleared, so the next frame paints everything that changed
+    //      in the meantime. The writer will ask for that frame once it catches up.
+    //      The teardown frame is never skipped, there won't be another one.
+    if (_writer && !_inTeardown && _writer->ShouldDropFrame())
+    {
+        const auto stats = _writer->GetStatistics();
+        _trace.TraceDroppedFrame(stats.queuedBytes, stats.droppedFrames);
+        _frameDeclined = true;
+        return S_FALSE;
+    }
+
     // If there's nothing to do, quick return
     bool somethingToDo = _fInvalidRectUsed ||
         (_scrollDelta.X != 0 || _scrollDelta.Y != 0) ||
@@ -178,90 +192,6 @@ HRESULT VtEngine::PaintSelection(const SMALL_RECT /*rect*/) noexcept
     return S_OK;
 }
 
-// Routine Description:
-// - Write a VT sequence to change the current colors of text. Writes true RGB
-//      color sequences.
-// Arguments:
-// - colorForeground: The RGB Color to use to paint the foreground text.
-// - colorBackground: The RGB Color to use to paint the background of the text.
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]]
-HRESULT VtEngine::_RgbUpdateDrawingBrushes(const COLORREF colorForeground,
-                                           const COLORREF colorBackground,
-                                           const bool isBold,
-                                           _In_reads_(cColorTable) const COLORREF* const ColorTable,
-                                           const WORD cColorTable) noexcept
-{
-    const bool fgChanged = colorForeground != _LastFG;
-    const bool bgChanged = colorBackground != _LastBG;
-    const bool fgIsDefault = colorForeground == _colorProvider.GetDefaultForeground();
-    const bool bgIsDefault = colorBackground == _colorProvider.GetDefaultBackground();
-
-    // If both the FG and BG should be the defaults, emit a SGR reset.
-    if ((fgChanged || bgChanged) && fgIsDefault && bgIsDefault)
-    {
-        // SGR Reset will also clear out the boldness of the text.
-        RETURN_IF_FAILED(_SetGraphicsDefault());
-        _LastFG = colorForeground;
-        _LastBG = colorBackground;
-        _lastWasBold = false;
-
-        // I'm not sure this is possible currently, but if the text is bold, but
-        //      default colors, make sure we bold it.
-        if (isBold)
-        {
-            RETURN_IF_FAILED(_SetGraphicsBoldness(isBold));
-            _lastWasBold = isBold;
-        }
-    }
-    else
-    {
-        if (_lastWasBold != isBold)
-        {
-            RETURN_IF_FAILED(_SetGraphicsBoldness(isBold));
-            _lastWasBold = isBold;
-        }
-
-        WORD wFoundColor = 0;
-        if (fgChanged)
-        {
-            if (fgIsDefault)
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(true));
-            }
-            else if (::FindTableIndex(colorForeground, ColorTable, cColorTable, &wFoundColor))
-            {
-                RETURN_IF_FAILED(_SetGraphicsRendition16Color(wFoundColor, true));
-            }
-            else
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(colorForeground, true));
-            }
-            _LastFG = colorForeground;
-        }
-
-        if (bgChanged)
-        {
-            if (bgIsDefault)
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(false));
-            }
-            else if (::FindTableIndex(colorBackground, ColorTable, cColorTable, &wFoundColor))
-            {
-                RETURN_IF_FAILED(_SetGraphicsRendition16Color(wFoundColor, false));
-            }
-            else
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(colorBackground, false));
-            }
-            _LastBG = colorBackground;
-        }
-    }
-
-    return S_OK;
-}
-
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. It will try to
 //      find the colors in the color table that are nearest to the input colors,
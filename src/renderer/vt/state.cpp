@@ -50,6 +50,8 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     _firstPaint(true),
     _skipCursor(false),
     _pipeBroken(false),
+    _frameDeclined(false),
+    _inTeardown(false),
     _exitResult{ S_OK },
     _terminalOwner{ nullptr },
     _newBottomLine{ false },
@@ -63,6 +65,12 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    if (_hFile.get() != INVALID_HANDLE_VALUE)
+    {
+        _writer = std::make_unique<VtPipeWriter>(_hFile.get());
+        THROW_IF_FAILED(_writer->Start());
+    }
 }
 
 // Method Description:
@@ -94,6 +102,19 @@ HRESULT VtEngine::_Write(std::string_view const str) noexcept
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Hands everything written this frame to the pipe writer, which writes it
+//      to the pipe on its own thread. Only blocks if the writer's queue is
+//      full. A failure the writer hit since the last flush is reported here.
+// - This runs at the end of a frame, after the console lock was let go, so a
+//      failure is only recorded here. The terminal owner is told from the
+//      writer thread instead. See SetFrameReadyCallback.
+// - The teardown frame is the last thing before the process exits, so that
+//      one is waited on until it has been written to the pipe.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]]
 HRESULT VtEngine::_Flush() noexcept
 {
@@ -107,18 +128,19 @@ HRESULT VtEngine::_Flush() noexcept
 
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), static_cast<DWORD>(_buffer.size()), nullptr, nullptr);
+        const HRESULT hr = _writer->Write(_buffer);
         _buffer.clear();
-        if (!fSuccess)
+        if (FAILED(hr))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
+            _exitResult = hr;
             _pipeBroken = true;
-            if (_terminalOwner)
-            {
-                _terminalOwner->CloseOutput();
-            }
             return _exitResult;
         }
+
+        if (_inTeardown)
+        {
+            LOG_HR_IF(HRESULT_FROM_WIN32(ERROR_TIMEOUT), !_writer->WaitForDrain(s_teardownTimeoutMs));
+        }
     }
 
     return S_OK;
@@ -134,7 +156,8 @@ HRESULT VtEngine::WriteTerminalUtf8(const std::string& str) noexcept
 
 // Method Description:
 // - Writes a wstring to the tty, encoded as full utf-8. This is one
-//      implementation of the WriteTerminalW method.
+//      implementation of the WriteTerminalW method. The text is converted
+//      into a buffer that's reused from call to call.
 // Arguments:
 // - wstr - wstring of text to be written
 // Return Value:
@@ -144,8 +167,9 @@ HRESULT VtEngine::_WriteTerminalUtf8(const std::wstring& wstr) noexcept
 {
     try
     {
-        const auto converted = ConvertToA(CP_UTF8, wstr);
-        return _Write(converted);
+        _utf8Scratch.clear();
+        AppendUtf16AsUtf8(wstr, _utf8Scratch);
+        return _Write(_utf8Scratch);
     }
     CATCH_RETURN();
 }
@@ -177,42 +201,6 @@ HRESULT VtEngine::_WriteTerminalAscii(const std::wstring& wstr) noexcept
     return _Write(needed);
 }
 
-// Method Description:
-// - Helper for calling _Write with a string for formatting a sequence. Used
-//      extensively by VtSequences.cpp
-// Arguments:
-// - pFormat: the pointer to the string to write to the pipe.
-// - ...: a va_list of args to format the string with.
-// Return Value:
-// - S_OK, E_INVALIDARG for a invalid format string, or suitable HRESULT error
-//      from writing pipe.
-[[nodiscard]]
-HRESULT VtEngine::_WriteFormattedString(const std::string* const pFormat, ...) noexcept
-{
-
-    HRESULT hr = E_FAIL;
-    va_list argList;
-    va_start(argList, pFormat);
-
-    int cchNeeded = _scprintf(pFormat->c_str(), argList);
-    // -1 is the _scprintf error case https://msdn.microsoft.com/en-us/library/t32cf9tb.aspx
-    if (cchNeeded > -1)
-    {
-        wistd::unique_ptr<char[]> psz = wil::make_unique_nothrow<char[]>(cchNeeded + 1);
-        RETURN_IF_NULL_ALLOC(psz);
-
-        int cchWritten = _vsnprintf_s(psz.get(), cchNeeded + 1, cchNeeded, pFormat->c_str(), argList);
-        hr = _Write({ psz.get(), gsl::narrow<size_t>(cchWritten) });
-    }
-    else
-    {
-        hr = E_INVALIDARG;
-    }
-
-    va_end(argList);
-    return hr;
-}
-
 // Method Description:
 // - This method will update the active font on the current device context
 //      Does nothing for vt, the font is handed by the terminal.
@@ -420,6 +408,50 @@ void VtEngine::SetTerminalOwner(Microsoft::Console::ITerminalOwner* const termin
     _terminalOwner = terminalOwner;
 }
 
+// Method Description:
+// - Sets the function to call when we're ready to paint again after dropping
+//      frames because the terminal couldn't keep up, or when writing the pipe
+//      failed. It's called on the pipe writer's thread.
+// - When writing the pipe failed, the terminal owner is told to close the
+//      output first. The writer thread holds no locks, so the owner is free to
+//      take the console lock to detach us from the screen buffer.
+// Arguments:
+// - pfnFrameReady: the function to call, which should request a new frame.
+// Return Value:
+// - <none>
+void VtEngine::SetFrameReadyCallback(std::function<void()> pfnFrameReady) noexcept
+{
+    if (_writer)
+    {
+        try
+        {
+            _writer->SetDrainedCallback([this, pfnFrameReady{ std::move(pfnFrameReady) }]() {
+                if (FAILED(_writer->GetResult()) && _terminalOwner)
+                {
+                    _terminalOwner->CloseOutput();
+                }
+                if (pfnFrameReady)
+                {
+                    pfnFrameReady();
+                }
+            });
+        }
+        CATCH_LOG();
+    }
+}
+
+// Method Description:
+// - Gets the current depth of the output queue and how many frames we've
+//      dropped because the terminal couldn't keep up.
+// Arguments:
+// - <none>
+// Return Value:
+// - The pipe writer's counters, or all zeroes if we don't have a pipe.
+VtPipeWriter::Statistics VtEngine::GetOutputStatistics() const noexcept
+{
+    return _writer ? _writer->GetStatistics() : VtPipeWriter::Statistics{};
+}
+
 // Method Description:
 // - sends a sequence to request the end terminal to tell us the
 //      cursor position. The terminal will reply back on the vt input handle.
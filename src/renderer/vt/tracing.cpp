@@ -67,12 +67,17 @@ std::string toPrintableString(const std::string_view& inString)
 void RenderTracing::TraceString(const std::string_view& instr) const
 {
     #ifndef UNIT_TESTING
-    const std::string _seq = toPrintableString(instr);
-    const char* const seq = _seq.c_str();
-    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                      "VtEngine_TraceString",
-                      TraceLoggingString(seq),
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+    // Every sequence we emit passes through here, so don't pay for building
+    //      the printable copy unless someone is listening.
+    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, 0))
+    {
+        const std::string _seq = toPrintableString(instr);
+        const char* const seq = _seq.c_str();
+        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                          "VtEngine_TraceString",
+                          TraceLoggingString(seq),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+    }
     #else
     UNREFERENCED_PARAMETER(instr);
     #endif UNIT_TESTING
@@ -154,6 +159,20 @@ void RenderTracing::TraceTriggerCircling(const bool newFrame) const
     #endif UNIT_TESTING
 }
 
+void RenderTracing::TraceDroppedFrame(const size_t queuedBytes, const size_t droppedFrames) const
+{
+    #ifndef UNIT_TESTING
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceDroppedFrame",
+                      TraceLoggingUInt64(queuedBytes),
+                      TraceLoggingUInt64(droppedFrames),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+    #else
+    UNREFERENCED_PARAMETER(queuedBytes);
+    UNREFERENCED_PARAMETER(droppedFrames);
+    #endif UNIT_TESTING
+}
+
 void RenderTracing::TraceStartPaint(const bool quickReturn,
                                     const bool invalidRectUsed,
                                     const Microsoft::Console::Types::Viewport invalidRect,
@@ -39,5 +39,6 @@ namespace Microsoft::Console::VirtualTerminal
                              const COORD scrollDelta,
                              const bool cursorMoved) const;
         void TraceEndPaint() const;
+        void TraceDroppedFrame(const size_t queuedBytes, const size_t droppedFrames) const;
     };
 }
@@ -21,6 +21,8 @@ Author(s):
 #include "../../inc/ITerminalOwner.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include "VtSequenceBuilder.hpp"
+#include "VtPipeWriter.hpp"
 #include <string>
 #include <functional>
 
@@ -33,6 +35,10 @@ namespace Microsoft::Console::Render
         static const size_t ERASE_CHARACTER_STRING_LENGTH = 8;
         static const COORD INVALID_COORDS;
 
+        // How long teardown waits for the pipe writer to write out the
+        //      last frames before letting the process exit anyway.
+        static constexpr DWORD s_teardownTimeoutMs = 1000;
+
         VtEngine(_In_ wil::unique_hfile hPipe,
                  const Microsoft::Console::IDefaultColorProvider& colorProvider,
                  const Microsoft::Console::Types::Viewport initialViewport);
@@ -124,9 +130,14 @@ namespace Microsoft::Console::Render
 
         void SetTerminalOwner(Microsoft::Console::ITerminalOwner* const terminalOwner);
 
+        void SetFrameReadyCallback(std::function<void()> pfnFrameReady) noexcept;
+        VtPipeWriter::Statistics GetOutputStatistics() const noexcept;
+
     protected:
         wil::unique_hfile _hFile;
         std::string _buffer;
+        std::string _utf8Scratch; // keeps its storage across _WriteTerminalUtf8 calls
+        std::unique_ptr<VtPipeWriter> _writer;
 
         const Microsoft::Console::IDefaultColorProvider& _colorProvider;
 
@@ -157,6 +168,8 @@ namespace Microsoft::Console::Render
         COORD _deferredCursorPos;
 
         bool _pipeBroken;
+        bool _frameDeclined;
+        bool _inTeardown;
         HRESULT _exitResult;
         Microsoft::Console::ITerminalOwner* _terminalOwner;
 
@@ -164,8 +177,22 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]]
         HRESULT _Write(std::string_view const str) noexcept;
-        [[nodiscard]]
-        HRESULT _WriteFormattedString(const std::string* const pFormat, ...) noexcept;
+
+        // Method Description:
+        // - Formats a CSI sequence with the given numeric parameters on the
+        //      stack and writes it. Used extensively by VtSequences.cpp
+        // Arguments:
+        // - params: the numeric parameters of the sequence, in order.
+        // Return Value:
+        // - S_OK or suitable HRESULT error from writing pipe.
+        template<char FinalChar, typename... Params>
+        [[nodiscard]]
+        HRESULT _WriteCsi(const Params... params) noexcept
+        {
+            CsiSequence<sizeof...(Params)> sequence;
+            (sequence.AppendParameter(static_cast<int>(params)), ...);
+            return _Write(sequence.Finish(FinalChar));
+        }
         [[nodiscard]]
         HRESULT _Flush() noexcept;
 
@@ -224,24 +251,12 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT _ResizeWindow(const short sWidth, const short sHeight) noexcept;
 
-        [[nodiscard]]
-        HRESULT _BeginUnderline() noexcept;
-
-        [[nodiscard]]
-        HRESULT _EndUnderline() noexcept;
-
         [[nodiscard]]
         HRESULT _RequestCursor() noexcept;
 
         [[nodiscard]]
         virtual HRESULT _MoveCursor(const COORD coord) noexcept = 0;
         [[nodiscard]]
-        HRESULT _RgbUpdateDrawingBrushes(const COLORREF colorForeground,
-                                         const COLORREF colorBackground,
-                                         const bool isBold,
-                                         _In_reads_(cColorTable) const COLORREF* const ColorTable,
-                                         const WORD cColorTable) noexcept;
-        [[nodiscard]]
         HRESULT _16ColorUpdateDrawingBrushes(const COLORREF colorForeground,
                                              const COLORREF colorBackground,
                                              const bool isBold,
@@ -151,37 +151,37 @@ HRESULT ApiDispatchers::ServerGetConsoleInput(_Inout_ CONSOLE_API_MSG * const m,
 
     std::unique_ptr<IWaitRoutine> waiter;
     HRESULT hr;
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    size_t const eventsToRead = cRecords;
+    const gsl::span<INPUT_RECORD> buffer(rgRecords, cRecords);
+    size_t written = 0;
     if (a->Unicode)
     {
         if (fIsPeek)
         {
-            hr = m->_pApiRoutines->PeekConsoleInputWImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->PeekConsoleInputWImpl(*pInputBuffer, buffer, written, *pInputReadHandleData, waiter);
         }
         else
         {
-            hr = m->_pApiRoutines->ReadConsoleInputWImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->ReadConsoleInputWImpl(*pInputBuffer, buffer, written, *pInputReadHandleData, waiter);
         }
     }
     else
     {
         if (fIsPeek)
         {
-            hr = m->_pApiRoutines->PeekConsoleInputAImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->PeekConsoleInputAImpl(*pInputBuffer, buffer, written, *pInputReadHandleData, waiter);
         }
         else
         {
-            hr = m->_pApiRoutines->ReadConsoleInputAImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->ReadConsoleInputAImpl(*pInputBuffer, buffer, written, *pInputReadHandleData, waiter);
         }
     }
 
     // We must return the number of records in the message payload (to alert the client)
     // as well as in the message headers (below in SetReplyInfomration) to alert the driver.
-    LOG_IF_FAILED(SizeTToULong(outEvents.size(), &a->NumRecords));
+    LOG_IF_FAILED(SizeTToULong(written, &a->NumRecords));
 
     size_t cbWritten;
-    LOG_IF_FAILED(SizeTMult(outEvents.size(), sizeof(INPUT_RECORD), &cbWritten));
+    LOG_IF_FAILED(SizeTMult(written, sizeof(INPUT_RECORD), &cbWritten));
 
     if (nullptr != waiter.get())
     {
@@ -209,22 +209,6 @@ HRESULT ApiDispatchers::ServerGetConsoleInput(_Inout_ CONSOLE_API_MSG * const m,
             hr = S_OK;
         }
     }
-    else
-    {
-        try
-        {
-            for (size_t i = 0; i < cRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                rgRecords[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
-        }
-        CATCH_RETURN();
-    }
 
     if (SUCCEEDED(hr))
     {
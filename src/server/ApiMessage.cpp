@@ -7,6 +7,7 @@
 
 #include "ApiMessage.h"
 #include "DeviceComm.h"
+#include "MessageBufferPool.h"
 
 _CONSOLE_API_MSG::_CONSOLE_API_MSG() : 
     _pDeviceComm(nullptr),
@@ -67,12 +68,16 @@ HRESULT _CONSOLE_API_MSG::GetInputBuffer(_Outptr_result_bytebuffer_(*pcbSize) vo
 
         ULONG const cbReadSize = Descriptor.InputSize - State.ReadOffset;
 
-        wistd::unique_ptr<BYTE[]> pPayload = wil::make_unique_nothrow<BYTE[]>(cbReadSize);
+        // The whole buffer is read from the driver, so it doesn't need to be cleared first.
+        auto& pool = MessageBufferPool::Instance();
+        BYTE* const pPayload = pool.Acquire(cbReadSize);
         RETURN_IF_NULL_ALLOC(pPayload);
+        auto releasePayload = wil::scope_exit([&]() { pool.Release(pPayload, cbReadSize); });
 
-        RETURN_IF_FAILED(ReadMessageInput(0, pPayload.get(), cbReadSize));
+        RETURN_IF_FAILED(ReadMessageInput(0, pPayload, cbReadSize));
 
-        State.InputBuffer = pPayload.release(); // TODO: MSFT: 9565140 - don't release, maintain as smart pointer.
+        releasePayload.release();
+        State.InputBuffer = pPayload; // TODO: MSFT: 9565140 - maintain as smart pointer.
         State.InputBufferSize = cbReadSize;
     }
 
@@ -106,8 +111,12 @@ HRESULT _CONSOLE_API_MSG::GetAugmentedOutputBuffer(const ULONG cbFactor,
         ULONG cbWriteSize = Descriptor.OutputSize - State.WriteOffset;
         RETURN_IF_FAILED(ULongMult(cbWriteSize, cbFactor, &cbWriteSize));
 
-        BYTE* pPayload = new(std::nothrow) BYTE[cbWriteSize];
+        BYTE* const pPayload = MessageBufferPool::Instance().Acquire(cbWriteSize);
         RETURN_IF_NULL_ALLOC(pPayload);
+
+        // APIs don't promise to fill all of what they report as written, and
+        //      whatever they leave behind goes back to the client. Pooled buffers
+        //      hold the last message's payload, so this has to stay.
         ZeroMemory(pPayload, sizeof(BYTE) * cbWriteSize);
 
         State.OutputBuffer = pPayload; // TODO: MSFT: 9565140 - maintain as smart pointer.
@@ -153,7 +162,7 @@ HRESULT _CONSOLE_API_MSG::ReleaseMessageBuffers()
 
     if (State.InputBuffer != nullptr)
     {
-        delete[] State.InputBuffer;
+        MessageBufferPool::Instance().Release(static_cast<BYTE*>(State.InputBuffer), State.InputBufferSize);
         State.InputBuffer = nullptr;
     }
 
@@ -170,7 +179,7 @@ HRESULT _CONSOLE_API_MSG::ReleaseMessageBuffers()
             LOG_IF_FAILED(_pDeviceComm->WriteOutput(&IoOperation));
         }
 
-        delete[] State.OutputBuffer;
+        MessageBufferPool::Instance().Release(static_cast<BYTE*>(State.OutputBuffer), State.OutputBufferSize);
         State.OutputBuffer = nullptr;
     }
 
@@ -6,6 +6,7 @@
 #include "ApiSorter.h"
 
 #include "ApiDispatchers.h"
+#include "ApiStatistics.h"
 
 #include "../host/tracing.hpp"
 
@@ -163,7 +164,12 @@ PCONSOLE_API_MSG ApiSorter::ConsoleDispatchRequest(_Inout_ PCONSOLE_API_MSG Mess
     // alias API.
     {
         const auto trace = Tracing::s_TraceApiCall(Status, Descriptor->TraceName);
+        const auto start = ApiStatistics::s_BeginCall();
         Status = (*Descriptor->Routine)(Message, &ReplyPending);
+
+        // A reply that pends is counted up to the point it started waiting.
+        const size_t bytesOut = (!ReplyPending && Message->State.OutputBuffer != nullptr) ? Message->Complete.IoStatus.Information : 0;
+        ApiStatistics::Instance().RecordCall(start, LayerNumber, ApiNumber, Descriptor->TraceName, Message->Descriptor.InputSize, bytesOut);
     }
 	if (Status != STATUS_BUFFER_TOO_SMALL)
 	{
@@ -0,0 +1,317 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ApiStatistics.h"
+
+// Every thread gets a block of counters from the instance it records into.
+//      The blocks belong to the instance, so a thread exiting doesn't lose what
+//      it counted. Instances are told apart by ID rather than address, since a
+//      new one could be made where a destroyed one used to be.
+static std::atomic<ULONGLONG> s_nextInstanceId{ 1 };
+static thread_local ULONGLONG t_countersOwnerId = 0;
+static thread_local void* t_counters = nullptr;
+
+// How long this thread has waited for the console lock, in total.
+static thread_local LONGLONG t_lockWaitTicks = 0;
+
+static constexpr size_t s_subBucketShift = 2; // four buckets per power of two
+static constexpr size_t s_subBucketCount = 1 << s_subBucketShift;
+
+ApiStatistics::ApiStatistics() :
+    _id{ s_nextInstanceId.fetch_add(1, std::memory_order_relaxed) }
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    _frequency = frequency.QuadPart;
+}
+
+// Routine Description:
+// - Notes the time and the lock wait so far, for RecordCall to work out how
+//   long the call took and how much of that it waited for the console lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - The start of the call.
+ApiStatistics::CallStart ApiStatistics::s_BeginCall() noexcept
+{
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter(&ticks);
+    return { ticks.QuadPart, t_lockWaitTicks };
+}
+
+// Routine Description:
+// - Adds to the time this thread has spent waiting for the console lock.
+// Arguments:
+// - waitTicks - How long the last wait took, in performance counter ticks.
+// Return Value:
+// - <none>
+void ApiStatistics::s_AddLockWait(const LONGLONG waitTicks) noexcept
+{
+    t_lockWaitTicks += waitTicks;
+}
+
+// Routine Description:
+// - Counts a finished call into this thread's counters.
+// Arguments:
+// - start - What s_BeginCall returned when the call started.
+// - layer - The layer of the API, 0-based.
+// - api - The index of the API in its layer.
+// - name - The name of the API. Must outlive the instance.
+// - bytesIn - The size of the payload the client sent.
+// - bytesOut - The size of the payload sent back to the client.
+// Return Value:
+// - <none>
+void ApiStatistics::RecordCall(const CallStart& start,
+                               const ULONG layer,
+                               const ULONG api,
+                               _In_ PCSTR name,
+                               const size_t bytesIn,
+                               const size_t bytesOut) noexcept
+{
+    if (layer >= s_layerCount || api >= s_apisPerLayer)
+    {
+        return;
+    }
+
+    ThreadCounters* const pThreadCounters = _GetThreadCounters();
+    if (pThreadCounters == nullptr)
+    {
+        return;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    const ULONGLONG microseconds = _ToMicroseconds(now.QuadPart - start.ticks);
+    const ULONGLONG lockWaitMicroseconds = _ToMicroseconds(t_lockWaitTicks - start.lockWaitTicks);
+
+    const size_t slot = layer * s_apisPerLayer + api;
+    _names[slot].store(name, std::memory_order_relaxed);
+
+    const auto add = [](auto& counter, const auto value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    };
+
+    ApiCounters& counters = pThreadCounters->apis[slot];
+    add(counters.calls, 1ull);
+    add(counters.bytesIn, static_cast<ULONGLONG>(bytesIn));
+    add(counters.bytesOut, static_cast<ULONGLONG>(bytesOut));
+    add(counters.totalMicroseconds, microseconds);
+    add(counters.lockWaitMicroseconds, lockWaitMicroseconds);
+    add(counters.histogram[s_GetBucket(microseconds)], 1ul);
+}
+
+// Routine Description:
+// - Adds up the counters of every thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - One summary per API that has been called at least once, in layer and API order.
+std::vector<ApiStatistics::ApiSummary> ApiStatistics::Summarize() const
+{
+    std::vector<ApiSummary> summaries;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    for (size_t slot = 0; slot < s_slotCount; slot++)
+    {
+        ApiSummary summary{};
+        summary.name = _names[slot].load(std::memory_order_relaxed);
+        summary.layer = gsl::narrow_cast<ULONG>(slot / s_apisPerLayer);
+        summary.api = gsl::narrow_cast<ULONG>(slot % s_apisPerLayer);
+
+        for (const auto& pThreadCounters : _threads)
+        {
+            const ApiCounters& counters = pThreadCounters->apis[slot];
+            summary.calls += counters.calls.load(std::memory_order_relaxed);
+            summary.bytesIn += counters.bytesIn.load(std::memory_order_relaxed);
+            summary.bytesOut += counters.bytesOut.load(std::memory_order_relaxed);
+            summary.totalMicroseconds += counters.totalMicroseconds.load(std::memory_order_relaxed);
+            summary.lockWaitMicroseconds += counters.lockWaitMicroseconds.load(std::memory_order_relaxed);
+            for (size_t bucket = 0; bucket < s_bucketCount; bucket++)
+            {
+                summary.histogram[bucket] += counters.histogram[bucket].load(std::memory_order_relaxed);
+            }
+        }
+
+        if (summary.calls != 0)
+        {
+            summaries.push_back(summary);
+        }
+    }
+
+    return summaries;
+}
+
+// Routine Description:
+// - Lays out the summaries as a table, one line per API, busiest first.
+// Arguments:
+// - <none>
+// Return Value:
+// - The report, as text.
+std::string ApiStatistics::FormatReport() const
+{
+    auto summaries = Summarize();
+    std::sort(summaries.begin(), summaries.end(), [](const ApiSummary& a, const ApiSummary& b) {
+        return a.totalMicroseconds > b.totalMicroseconds;
+    });
+
+    std::string report;
+    char line[256];
+
+    sprintf_s(line,
+              ARRAYSIZE(line),
+              "%-36s %10s %10s %8s %8s %8s %10s %12s %12s\r\n",
+              "API",
+              "calls",
+              "total ms",
+              "p50 us",
+              "p99 us",
+              "max us",
+              "lock ms",
+              "bytes in",
+              "bytes out");
+    report.append(line);
+
+    for (const auto& summary : summaries)
+    {
+        sprintf_s(line,
+                  ARRAYSIZE(line),
+                  "%-36s %10llu %10.1f %8llu %8llu %8llu %10.1f %12llu %12llu\r\n",
+                  summary.name != nullptr ? summary.name : "?",
+                  summary.calls,
+                  summary.totalMicroseconds / 1000.0,
+                  summary.Percentile(0.5),
+                  summary.Percentile(0.99),
+                  summary.Percentile(1.0),
+                  summary.lockWaitMicroseconds / 1000.0,
+                  summary.bytesIn,
+                  summary.bytesOut);
+        report.append(line);
+    }
+
+    return report;
+}
+
+// Routine Description:
+// - Writes the report to the file named by the CONHOST_API_STATISTICS
+//   environment variable. Does nothing if it isn't set.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ApiStatistics::WriteReportIfRequested() const noexcept
+{
+    try
+    {
+        wchar_t path[MAX_PATH];
+        const DWORD cchPath = GetEnvironmentVariableW(L"CONHOST_API_STATISTICS", path, ARRAYSIZE(path));
+        if (cchPath == 0 || cchPath >= ARRAYSIZE(path))
+        {
+            return;
+        }
+
+        const std::string report = FormatReport();
+
+        wil::unique_hfile file{ CreateFileW(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+
+        DWORD cbWritten = 0;
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), report.data(), gsl::narrow<DWORD>(report.size()), &cbWritten, nullptr));
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Finds the histogram bucket for a latency.
+// - Below four microseconds every value has a bucket of its own. Above that,
+//   every power of two is split into four buckets.
+// Arguments:
+// - microseconds - The latency.
+// Return Value:
+// - The bucket index. Latencies beyond the last bucket land in it.
+size_t ApiStatistics::s_GetBucket(const ULONGLONG microseconds) noexcept
+{
+    if (microseconds < s_subBucketCount)
+    {
+        return gsl::narrow_cast<size_t>(microseconds);
+    }
+
+    unsigned long msb;
+    _BitScanReverse64(&msb, microseconds);
+
+    const size_t subBucket = gsl::narrow_cast<size_t>(microseconds >> (msb - s_subBucketShift)) & (s_subBucketCount - 1);
+    const size_t bucket = (msb - s_subBucketShift + 1) * s_subBucketCount + subBucket;
+    return std::min(bucket, s_bucketCount - 1);
+}
+
+// Routine Description:
+// - Finds the largest latency that goes into a bucket.
+// Arguments:
+// - bucket - The bucket index.
+// Return Value:
+// - The largest latency in microseconds that s_GetBucket puts in the bucket.
+ULONGLONG ApiStatistics::s_GetBucketUpperBound(const size_t bucket) noexcept
+{
+    if (bucket < s_subBucketCount)
+    {
+        return bucket;
+    }
+
+    const size_t shift = bucket / s_subBucketCount - 1;
+    const ULONGLONG subBucket = bucket % s_subBucketCount;
+    return ((s_subBucketCount + subBucket + 1) << shift) - 1;
+}
+
+// Routine Description:
+// - Estimates a latency percentile from the histogram.
+// Arguments:
+// - fraction - The percentile as a fraction, like 0.99 for the 99th.
+// Return Value:
+// - The upper bound of the bucket the percentile falls in, in microseconds.
+ULONGLONG ApiStatistics::ApiSummary::Percentile(const double fraction) const noexcept
+{
+    const ULONGLONG wanted = std::max(1ull, static_cast<ULONGLONG>(ceil(calls * fraction)));
+
+    ULONGLONG seen = 0;
+    for (size_t bucket = 0; bucket < s_bucketCount; bucket++)
+    {
+        seen += histogram[bucket];
+        if (seen >= wanted)
+        {
+            return s_GetBucketUpperBound(bucket);
+        }
+    }
+
+    return s_GetBucketUpperBound(s_bucketCount - 1);
+}
+
+ApiStatistics::ThreadCounters* ApiStatistics::_GetThreadCounters() noexcept
+{
+    if (t_countersOwnerId == _id)
+    {
+        return static_cast<ThreadCounters*>(t_counters);
+    }
+
+    try
+    {
+        auto pThreadCounters = std::make_unique<ThreadCounters>();
+
+        std::lock_guard<std::mutex> guard(_lock);
+        _threads.push_back(std::move(pThreadCounters));
+
+        t_countersOwnerId = _id;
+        t_counters = _threads.back().get();
+        return _threads.back().get();
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return nullptr;
+    }
+}
+
+ULONGLONG ApiStatistics::_ToMicroseconds(const LONGLONG ticks) const noexcept
+{
+    return ticks <= 0 ? 0 : static_cast<ULONGLONG>(ticks) * 1000000 / _frequency;
+}
@@ -0,0 +1,113 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ApiStatistics.h
+
+Abstract:
+- Counts calls, bytes and time for every console API, so slow console
+  complaints can be looked into without ETW tooling.
+- Every thread that services APIs records into counters of its own, so
+  recording never contends with other threads. A report adds them all up.
+- Latencies go into histograms with four buckets per power of two
+  microseconds, which keeps percentiles within about 20% from a microsecond
+  up to minutes in a fixed amount of memory.
+- Time spent waiting for the console lock during a call is counted too, to
+  tell slow APIs apart from APIs stuck behind other callers.
+- The report can be read at any time with FormatReport (from a debugger, for
+  instance) and is written on exit to the file named by the
+  CONHOST_API_STATISTICS environment variable, if it's set.
+--*/
+
+#pragma once
+
+class ApiStatistics final
+{
+public:
+    // Implement this as a singleton class.
+    static ApiStatistics& Instance()
+    {
+        static ApiStatistics s_Instance;
+        return s_Instance;
+    }
+
+    // Tests make instances of their own to start from zero.
+    ApiStatistics();
+
+    ApiStatistics(const ApiStatistics&) = delete;
+    ApiStatistics& operator=(const ApiStatistics&) = delete;
+
+    static constexpr size_t s_layerCount = 3;
+    static constexpr size_t s_apisPerLayer = 64;
+    static constexpr size_t s_bucketCount = 112;
+
+    // Taken when a call starts and handed back to RecordCall when it's done.
+    struct CallStart
+    {
+        LONGLONG ticks;
+        LONGLONG lockWaitTicks;
+    };
+
+    static CallStart s_BeginCall() noexcept;
+    static void s_AddLockWait(const LONGLONG waitTicks) noexcept;
+
+    void RecordCall(const CallStart& start,
+                    const ULONG layer,
+                    const ULONG api,
+                    _In_ PCSTR name,
+                    const size_t bytesIn,
+                    const size_t bytesOut) noexcept;
+
+    struct ApiSummary
+    {
+        PCSTR name;
+        ULONG layer;
+        ULONG api;
+        ULONGLONG calls;
+        ULONGLONG bytesIn;
+        ULONGLONG bytesOut;
+        ULONGLONG totalMicroseconds;
+        ULONGLONG lockWaitMicroseconds;
+        std::array<ULONGLONG, s_bucketCount> histogram;
+
+        ULONGLONG Percentile(const double fraction) const noexcept;
+    };
+
+    std::vector<ApiSummary> Summarize() const;
+    std::string FormatReport() const;
+    void WriteReportIfRequested() const noexcept;
+
+    static size_t s_GetBucket(const ULONGLONG microseconds) noexcept;
+    static ULONGLONG s_GetBucketUpperBound(const size_t bucket) noexcept;
+
+private:
+    static constexpr size_t s_slotCount = s_layerCount * s_apisPerLayer;
+
+    // Only the owning thread writes these, so relaxed loads and stores are
+    //      enough and nothing ever bounces between cores while recording.
+    struct ApiCounters
+    {
+        std::atomic<ULONGLONG> calls;
+        std::atomic<ULONGLONG> bytesIn;
+        std::atomic<ULONGLONG> bytesOut;
+        std::atomic<ULONGLONG> totalMicroseconds;
+        std::atomic<ULONGLONG> lockWaitMicroseconds;
+        std::array<std::atomic<ULONG>, s_bucketCount> histogram;
+    };
+
+    struct ThreadCounters
+    {
+        std::array<ApiCounters, s_slotCount> apis{};
+    };
+
+    ThreadCounters* _GetThreadCounters() noexcept;
+    ULONGLONG _ToMicroseconds(const LONGLONG ticks) const noexcept;
+
+    const ULONGLONG _id;
+    LONGLONG _frequency;
+    std::array<std::atomic<PCSTR>, s_slotCount> _names{};
+
+    mutable std::mutex _lock;
+    std::vector<std::unique_ptr<ThreadCounters>> _threads;
+};
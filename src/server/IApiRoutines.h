@@ -70,29 +70,29 @@ public:
 
     [[nodiscard]]
     virtual HRESULT PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> buffer,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]]
     virtual HRESULT PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> buffer,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]]
     virtual HRESULT ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> buffer,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]]
     virtual HRESULT ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> buffer,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
@@ -0,0 +1,260 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "IoWorkerPool.h"
+
+// Routine Description:
+// - Starts the workers and sets aside the message buffers they'll share.
+// Arguments:
+// - workerCount - How many threads to service messages on.
+// - service - Called on a worker for every message, to service and complete it.
+// Return Value:
+// - An instance of an IoWorkerPool.
+// NOTE: CAN THROW IF MEMORY ALLOCATION OR THREAD CREATION FAILS.
+IoWorkerPool::IoWorkerPool(const size_t workerCount, ServiceRoutine service) :
+    _service{ std::move(service) }
+{
+    // A few messages per worker lets the reader stay ahead of them.
+    const size_t messageCount = workerCount * 4;
+    _messages.reserve(messageCount);
+    _freeMessages.reserve(messageCount);
+    for (size_t i = 0; i < messageCount; i++)
+    {
+        _messages.emplace_back(std::make_unique<CONSOLE_API_MSG>());
+        _freeMessages.push_back(_messages.back().get());
+    }
+
+    auto stopWorkers = wil::scope_exit([&]() {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _stopping = true;
+        }
+        _workAvailable.notify_all();
+        for (auto& worker : _workers)
+        {
+            worker.join();
+        }
+    });
+
+    _workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        _workers.emplace_back([this]() { _WorkerLoop(); });
+    }
+
+    stopWorkers.release();
+}
+
+// Routine Description:
+// - Lets the workers finish everything already dispatched, then stops them.
+IoWorkerPool::~IoWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+    _workAvailable.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+// Routine Description:
+// - Decides whether a message can be serviced alongside other clients' messages.
+// - Only requests that work on objects the client already has qualify.
+//   Anything that creates or destroys clients or handles must run alone.
+// Arguments:
+// - msg - The message as read from the driver.
+// Return Value:
+// - True if the message can go to a worker.
+bool IoWorkerPool::s_CanRunConcurrently(const CONSOLE_API_MSG& msg) noexcept
+{
+    switch (msg.Descriptor.Function)
+    {
+    case CONSOLE_IO_USER_DEFINED:
+    case CONSOLE_IO_RAW_WRITE:
+    case CONSOLE_IO_RAW_READ:
+    case CONSOLE_IO_RAW_FLUSH:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Routine Description:
+// - Gets a message buffer to read the next message into. Waits for one to be
+//   returned if they're all in use.
+// Arguments:
+// - <none>
+// Return Value:
+// - The message buffer. Hand it back with Dispatch or ReturnMessage.
+CONSOLE_API_MSG* IoWorkerPool::AcquireMessage() noexcept
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    _messageReturned.wait(lock, [&]() { return !_freeMessages.empty(); });
+
+    CONSOLE_API_MSG* const pMsg = _freeMessages.back();
+    _freeMessages.pop_back();
+    return pMsg;
+}
+
+// Routine Description:
+// - Hands a message that was just read to the workers, behind any others from
+//   the same client. Messages that can't run concurrently are serviced right
+//   here once everything else has finished.
+// Arguments:
+// - pMsg - A message buffer from AcquireMessage, filled in by the driver.
+// Return Value:
+// - <none>
+void IoWorkerPool::Dispatch(_In_ CONSOLE_API_MSG* const pMsg) noexcept
+{
+    if (s_CanRunConcurrently(*pMsg))
+    {
+        try
+        {
+            const ULONG_PTR client = pMsg->Descriptor.Process;
+
+            {
+                std::lock_guard<std::mutex> guard(_lock);
+
+                auto& queue = _clients[client];
+                queue.pending.push_back(pMsg);
+                _inFlight++;
+
+                if (queue.busy || queue.pending.size() > 1)
+                {
+                    // The worker that has this client picks it up when it's done.
+                    return;
+                }
+
+                auto undoQueue = wil::scope_exit([&]() {
+                    queue.pending.pop_back();
+                    _inFlight--;
+                });
+                _readyClients.push_back(client);
+                undoQueue.release();
+            }
+
+            _workAvailable.notify_one();
+            return;
+        }
+        CATCH_LOG();
+    }
+
+    _ServiceAlone(pMsg);
+}
+
+// Routine Description:
+// - Waits until every dispatched message has been serviced.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void IoWorkerPool::Drain() noexcept
+{
+    std::unique_lock<std::mutex> lock(_lock);
+    _messageReturned.wait(lock, [&]() { return _inFlight == 0; });
+}
+
+// Routine Description:
+// - Services a message on the calling thread once nothing else is in flight,
+//   then takes its buffer back.
+// Arguments:
+// - pMsg - A message buffer from AcquireMessage.
+// Return Value:
+// - <none>
+void IoWorkerPool::_ServiceAlone(_In_ CONSOLE_API_MSG* const pMsg) noexcept
+{
+    Drain();
+
+    try
+    {
+        _service(pMsg);
+    }
+    CATCH_LOG();
+
+    ReturnMessage(pMsg);
+}
+
+// Routine Description:
+// - Takes back a message buffer that won't be dispatched, like one the driver
+//   failed to read into.
+// Arguments:
+// - pMsg - A message buffer from AcquireMessage.
+// Return Value:
+// - <none>
+void IoWorkerPool::ReturnMessage(_In_ CONSOLE_API_MSG* const pMsg) noexcept
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _freeMessages.push_back(pMsg);
+    _messageReturned.notify_all();
+}
+
+// Routine Description:
+// - Takes the next ready client, services its oldest message and puts the
+//   client back in line if it has more. Runs until the pool is stopped and
+//   nothing is left to do.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void IoWorkerPool::_WorkerLoop() noexcept
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    while (true)
+    {
+        _workAvailable.wait(lock, [&]() { return _stopping || !_readyClients.empty(); });
+        if (_readyClients.empty())
+        {
+            return;
+        }
+
+        const ULONG_PTR client = _readyClients.front();
+        _readyClients.pop_front();
+
+        auto& queue = _clients.at(client);
+        CONSOLE_API_MSG* const pMsg = queue.pending.front();
+        queue.pending.pop_front();
+        queue.busy = true;
+
+        lock.unlock();
+        try
+        {
+            _service(pMsg);
+        }
+        CATCH_LOG();
+        lock.lock();
+
+        _FinishMessage(pMsg);
+
+        // Other dispatches may have rehashed the map while we were away.
+        auto& sameQueue = _clients.at(client);
+        sameQueue.busy = false;
+        if (sameQueue.pending.empty())
+        {
+            _clients.erase(client);
+        }
+        else
+        {
+            // If this can't be queued we fail fast rather than strand the
+            //      client's remaining messages.
+            _readyClients.push_back(client);
+            _workAvailable.notify_one();
+        }
+    }
+}
+
+// Routine Description:
+// - Puts a serviced message buffer back and wakes anyone waiting for one, or
+//   for the pool to drain. Must be called with the lock held.
+void IoWorkerPool::_FinishMessage(_In_ CONSOLE_API_MSG* const pMsg) noexcept
+{
+    _freeMessages.push_back(pMsg);
+    _inFlight--;
+    _messageReturned.notify_all();
+}
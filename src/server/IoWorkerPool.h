@@ -0,0 +1,70 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- IoWorkerPool.h
+
+Abstract:
+- Services IO messages from different clients side by side on a few worker
+  threads, so one busy client doesn't hold up the others.
+- Messages from the same client are serviced one at a time, in the order they
+  were read. Messages that change which clients or objects exist (connect,
+  disconnect, create and close) wait for everything in flight to finish and
+  are then serviced alone on the reading thread.
+- The pool owns a fixed number of message buffers. When they are all in use,
+  the reading thread waits for one to come back instead of allocating.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+#include "ApiMessage.h"
+
+class IoWorkerPool final
+{
+public:
+    // Services a message and completes it, or queues it on a wait.
+    using ServiceRoutine = std::function<void(CONSOLE_API_MSG* const)>;
+
+    IoWorkerPool(const size_t workerCount, ServiceRoutine service);
+    ~IoWorkerPool();
+
+    IoWorkerPool(const IoWorkerPool&) = delete;
+    IoWorkerPool& operator=(const IoWorkerPool&) = delete;
+
+    CONSOLE_API_MSG* AcquireMessage() noexcept;
+    void Dispatch(_In_ CONSOLE_API_MSG* const pMsg) noexcept;
+    void ReturnMessage(_In_ CONSOLE_API_MSG* const pMsg) noexcept;
+    void Drain() noexcept;
+
+    static bool s_CanRunConcurrently(const CONSOLE_API_MSG& msg) noexcept;
+
+private:
+    struct ClientQueue
+    {
+        std::deque<CONSOLE_API_MSG*> pending;
+        bool busy = false;
+    };
+
+    void _WorkerLoop() noexcept;
+    void _ServiceAlone(_In_ CONSOLE_API_MSG* const pMsg) noexcept;
+    void _FinishMessage(_In_ CONSOLE_API_MSG* const pMsg) noexcept;
+
+    ServiceRoutine _service;
+
+    std::mutex _lock;
+    std::condition_variable _workAvailable;
+    std::condition_variable _messageReturned;
+
+    std::vector<std::unique_ptr<CONSOLE_API_MSG>> _messages;
+    std::vector<CONSOLE_API_MSG*> _freeMessages;
+
+    std::unordered_map<ULONG_PTR, ClientQueue> _clients;
+    std::deque<ULONG_PTR> _readyClients; // have pending messages and no worker
+    size_t _inFlight = 0;
+    bool _stopping = false;
+
+    std::vector<std::thread> _workers;
+};
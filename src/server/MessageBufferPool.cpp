@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "MessageBufferPool.h"
+
+MessageBufferPool::~MessageBufferPool()
+{
+    for (size_t sizeClass = 0; sizeClass < s_classCount; sizeClass++)
+    {
+        for (size_t i = 0; i < _freeCount[sizeClass]; i++)
+        {
+            delete[] _free[sizeClass][i];
+        }
+    }
+}
+
+// Routine Description:
+// - Finds the size class a payload of the given size belongs to.
+// Arguments:
+// - cbSize - The size of the payload in bytes.
+// Return Value:
+// - The index of the smallest size class that fits the payload, or
+//   s_classCount if the payload is too big to be pooled.
+size_t MessageBufferPool::s_GetSizeClass(const ULONG cbSize) noexcept
+{
+    size_t sizeClass = 0;
+    while (sizeClass < s_classCount && cbSize > (1ul << (s_smallestClassShift + sizeClass)))
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+// Routine Description:
+// - Gets a buffer for a message payload of at least the given size.
+// - The buffer is not zeroed. Callers that may hand back more than they write
+//   must clear it themselves.
+// Arguments:
+// - cbSize - The size of the payload in bytes.
+// Return Value:
+// - The buffer, or nullptr if it couldn't be allocated.
+[[nodiscard]]
+BYTE* MessageBufferPool::Acquire(const ULONG cbSize) noexcept
+{
+    _acquired.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t sizeClass = s_GetSizeClass(cbSize);
+    size_t cbAllocate = cbSize;
+
+    if (sizeClass < s_classCount)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            if (_freeCount[sizeClass] > 0)
+            {
+                return _free[sizeClass][--_freeCount[sizeClass]];
+            }
+        }
+
+        cbAllocate = size_t{ 1 } << (s_smallestClassShift + sizeClass);
+    }
+
+    _allocated.fetch_add(1, std::memory_order_relaxed);
+    return new(std::nothrow) BYTE[cbAllocate];
+}
+
+// Routine Description:
+// - Gives a buffer from Acquire back to the pool, or frees it if the pool for
+//   its size class is already full.
+// Arguments:
+// - pBuffer - The buffer. Nothing happens if this is nullptr.
+// - cbSize - The same size that the buffer was acquired with.
+// Return Value:
+// - <none>
+void MessageBufferPool::Release(_In_opt_ BYTE* const pBuffer, const ULONG cbSize) noexcept
+{
+    if (pBuffer == nullptr)
+    {
+        return;
+    }
+
+    const size_t sizeClass = s_GetSizeClass(cbSize);
+    if (sizeClass < s_classCount)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_freeCount[sizeClass] < s_buffersPerClass)
+        {
+            _free[sizeClass][_freeCount[sizeClass]++] = pBuffer;
+            return;
+        }
+    }
+
+    delete[] pBuffer;
+}
+
+// Routine Description:
+// - Reports how many buffers have been handed out and how many of those had
+//   to be allocated, so the hit rate of the pool can be checked.
+// Arguments:
+// - <none>
+// Return Value:
+// - The counts since the pool was created.
+MessageBufferPool::Statistics MessageBufferPool::GetStatistics() const noexcept
+{
+    return { _acquired.load(std::memory_order_relaxed), _allocated.load(std::memory_order_relaxed) };
+}
@@ -0,0 +1,61 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- MessageBufferPool.h
+
+Abstract:
+- Keeps the payload buffers of API messages around for reuse, so that the
+  server doesn't go to the heap twice for every message it services.
+- Buffers are kept in power of two size classes. Payloads bigger than the
+  largest class are rare (huge writes or reads) and go straight to the heap.
+- Messages that have to wait are released on whichever thread completes the
+  wait, so the pool is shared by all threads and takes a lock of its own.
+--*/
+
+#pragma once
+
+class MessageBufferPool final
+{
+public:
+    // Implement this as a singleton class.
+    static MessageBufferPool& Instance()
+    {
+        static MessageBufferPool s_Instance;
+        return s_Instance;
+    }
+
+    ~MessageBufferPool();
+
+    MessageBufferPool(const MessageBufferPool&) = delete;
+    MessageBufferPool& operator=(const MessageBufferPool&) = delete;
+
+    [[nodiscard]]
+    BYTE* Acquire(const ULONG cbSize) noexcept;
+    void Release(_In_opt_ BYTE* const pBuffer, const ULONG cbSize) noexcept;
+
+    struct Statistics
+    {
+        size_t acquired; // Buffers handed out, from the pool or not.
+        size_t allocated; // Of those, how many had to come from the heap.
+    };
+
+    Statistics GetStatistics() const noexcept;
+
+private:
+    MessageBufferPool() = default;
+
+    static constexpr size_t s_smallestClassShift = 8; // 256 bytes
+    static constexpr size_t s_classCount = 9; // up to 64KiB
+    static constexpr size_t s_buffersPerClass = 8;
+
+    static size_t s_GetSizeClass(const ULONG cbSize) noexcept;
+
+    std::mutex _lock;
+    std::array<std::array<BYTE*, s_buffersPerClass>, s_classCount> _free{};
+    std::array<size_t, s_classCount> _freeCount{};
+
+    std::atomic<size_t> _acquired{ 0 };
+    std::atomic<size_t> _allocated{ 0 };
+};
@@ -219,7 +219,7 @@ HRESULT ConsoleHandleData::_CloseInputHandle()
 
     if (pReadHandleData->GetReadCount() != 0)
     {
-        pInputBuffer->WaitQueue.NotifyWaiters(true, WaitTerminationReason::HandleClosing);
+        pInputBuffer->WaitQueue.NotifyHandleWaiters(this, WaitTerminationReason::HandleClosing);
     }
 
     FAIL_FAST_IF(pReadHandleData->GetReadCount() > 0);
@@ -9,14 +9,22 @@
 #include "ApiSorter.h"
 
 #include "..\host\globals.h"
+#include "..\host\handle.h"
 #include "..\host\utils.hpp"
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
+// Released blocks are kept here for the next wait. A handful covers the usual
+//      pending reads and writes; a burst beyond that goes back to the heap.
+static constexpr size_t s_pooledBlockCount = 32;
+static std::mutex s_poolLock;
+static std::array<void*, s_pooledBlockCount> s_pooledBlocks{};
+static size_t s_pooledCount = 0;
+
 // Routine Description:
 // - Initializes a ConsoleWaitBlock
 // - ConsoleWaitBlocks will self-manage their position in their two queues.
-// - They will push themselves into the tail and store the iterator for constant deletion time later.
+// - They will link themselves in at the tail and unlink themselves in constant time later.
 // Arguments:
 // - pProcessQueue - The queue attached to the client process ID that requested this action
 // - pObjectQueue - The queue attached to the console object that will service the action when data arrives
@@ -27,11 +35,16 @@ ConsoleWaitBlock::ConsoleWaitBlock(_In_ ConsoleWaitQueue* const pProcessQueue,
                                    const CONSOLE_API_MSG* const pWaitReplyMessage,
                                    _In_ IWaitRoutine* const pWaiter) :
     _pProcessQueue(THROW_HR_IF_NULL(E_INVALIDARG, pProcessQueue)),
+    _processQueueLinks(),
     _pObjectQueue(THROW_HR_IF_NULL(E_INVALIDARG, pObjectQueue)),
+    _objectQueueLinks(),
+    _pHandle(pWaitReplyMessage->GetObjectHandle()),
     _pWaiter(THROW_HR_IF_NULL(E_INVALIDARG, pWaiter))
 {
-    _itProcessQueue = _pProcessQueue->_blocks.insert(_pProcessQueue->_blocks.end(), this);
-    _itObjectQueue = _pObjectQueue->_blocks.insert(_pObjectQueue->_blocks.end(), this);
+    _pProcessQueue->_AddBlock(this);
+    auto removeFromProcessQueue = wil::scope_exit([&]() { _pProcessQueue->_RemoveBlock(this); });
+    _pObjectQueue->_AddBlock(this);
+    removeFromProcessQueue.release();
 
     _WaitReplyMessage = *pWaitReplyMessage;
 
@@ -44,12 +57,12 @@ ConsoleWaitBlock::ConsoleWaitBlock(_In_ ConsoleWaitQueue* const pProcessQueue,
 
 // Routine Description:
 // - Destroys a ConsolewaitBlock
-// - On deletion, ConsoleWaitBlocks will erase themselves from the process and object queues in
-//   constant time with the iterator acquired on construction.
+// - On deletion, ConsoleWaitBlocks will unlink themselves from the process and object queues in
+//   constant time.
 ConsoleWaitBlock::~ConsoleWaitBlock()
 {
-    _pProcessQueue->_blocks.erase(_itProcessQueue);
-    _pObjectQueue->_blocks.erase(_itObjectQueue);
+    _pProcessQueue->_RemoveBlock(this);
+    _pObjectQueue->_RemoveBlock(this);
 
     if (_pWaiter != nullptr)
     {
@@ -57,9 +70,70 @@ ConsoleWaitBlock::~ConsoleWaitBlock()
     }
 }
 
+// Routine Description:
+// - Takes a released block for reuse if there is one, instead of going to the heap.
+// Arguments:
+// - cbSize - The size of the block.
+// Return Value:
+// - Memory for the block.
+// NOTE: CAN THROW IF MEMORY ALLOCATION FAILS.
+void* ConsoleWaitBlock::operator new(const size_t cbSize)
+{
+    if (cbSize == sizeof(ConsoleWaitBlock))
+    {
+        std::lock_guard<std::mutex> guard(s_poolLock);
+        if (s_pooledCount > 0)
+        {
+            return s_pooledBlocks[--s_pooledCount];
+        }
+    }
+
+    return ::operator new(cbSize);
+}
+
+// Routine Description:
+// - Keeps a destroyed block for the next wait, or frees it if enough are kept already.
+// Arguments:
+// - pv - Memory of the block.
+// Return Value:
+// - <none>
+void ConsoleWaitBlock::operator delete(void* const pv) noexcept
+{
+    if (pv == nullptr)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(s_poolLock);
+        if (s_pooledCount < s_pooledBlockCount)
+        {
+            s_pooledBlocks[s_pooledCount++] = pv;
+            return;
+        }
+    }
+
+    ::operator delete(pv);
+}
+
+// Routine Description:
+// - Finds the links this block uses in one of its two queues.
+// Arguments:
+// - pQueue - The process or the object queue of this block.
+// Return Value:
+// - The links for that queue.
+ConsoleWaitBlock::QueueLinks& ConsoleWaitBlock::_LinksFor(const ConsoleWaitQueue* const pQueue) noexcept
+{
+    return pQueue == _pProcessQueue ? _processQueueLinks : _objectQueueLinks;
+}
+
 // Routine Description:
 // - Creates and enqueues a new wait for later callback when a routine cannot be serviced at this time.
 // - Will extract the process ID and the target object, enqueuing in both to know when to callback
+// - The API routine that decided to wait has already released the console lock, and reads from
+//   several clients can be serviced on different IO threads at once. The queues have no lock of
+//   their own, so the block is linked into them under the console lock, like the notifications
+//   that walk them.
 // Arguments:
 // - pWaitReplyMessage - The original API message from the client asking for servicing
 // - pWaiter - The context/callback information to restore and dispatch the call later.
@@ -69,6 +143,9 @@ ConsoleWaitBlock::~ConsoleWaitBlock()
 HRESULT ConsoleWaitBlock::s_CreateWait(_Inout_ CONSOLE_API_MSG* const pWaitReplyMessage,
                                        _In_ IWaitRoutine* const pWaiter)
 {
+    LockConsole();
+    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
     ConsoleProcessHandle* const ProcessData = pWaitReplyMessage->GetProcessHandle();
     FAIL_FAST_IF_NULL(ProcessData);
 
@@ -114,7 +191,7 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
     DWORD dwControlKeyState;
     bool fIsUnicode = true;
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
+    gsl::span<INPUT_RECORD> outRecords;
     // TODO: MSFT 14104228 - get rid of this void* and get the data
     // out of the read wait object properly.
     void* pOutputData = nullptr;
@@ -127,7 +204,16 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
     {
         CONSOLE_GETCONSOLEINPUT_MSG* a = &(_WaitReplyMessage.u.consoleMsgL1.GetConsoleInput);
         fIsUnicode = !!a->Unicode;
-        pOutputData = &outEvents;
+
+        // The read stores the records straight into the reply's buffer.
+        void* buffer;
+        ULONG cbBuffer;
+        if (FAILED(_WaitReplyMessage.GetOutputBuffer(&buffer, &cbBuffer)))
+        {
+            return false;
+        }
+        outRecords = gsl::span<INPUT_RECORD>(static_cast<INPUT_RECORD*>(buffer), cbBuffer / sizeof(INPUT_RECORD));
+        pOutputData = &outRecords;
         break;
     }
     case API_NUMBER_READCONSOLE:
@@ -162,26 +248,7 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
             // information with the number of records, not number of
             // bytes.
             CONSOLE_GETCONSOLEINPUT_MSG* a = &(_WaitReplyMessage.u.consoleMsgL1.GetConsoleInput);
-
-            void* buffer;
-            ULONG cbBuffer;
-            if (FAILED(_WaitReplyMessage.GetOutputBuffer(&buffer, &cbBuffer)))
-            {
-                return false;
-            }
-
-            INPUT_RECORD* const pRecordBuffer = static_cast<INPUT_RECORD* const>(buffer);
-            a->NumRecords = static_cast<ULONG>(outEvents.size());
-            for (size_t i = 0; i < a->NumRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                pRecordBuffer[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
-
+            a->NumRecords = static_cast<ULONG>(NumBytes / sizeof(INPUT_RECORD));
         }
         else if (API_NUMBER_READCONSOLE == _WaitReplyMessage.msgHeader.ApiNumber)
         {
@@ -21,9 +21,17 @@ Revision History:
 #include "IWaitRoutine.h"
 #include "WaitTerminationReason.h"
 
-#include <list>
-
 class ConsoleWaitQueue;
+class ConsoleWaitBlock;
+class ConsoleHandleData;
+
+// Links a block into one of the lists of a wait queue. Blocks carry their own
+//      links so that waiting doesn't need to allocate list nodes.
+struct ConsoleWaitLink
+{
+    ConsoleWaitBlock* pPrev = nullptr;
+    ConsoleWaitBlock* pNext = nullptr;
+};
 
 class ConsoleWaitBlock
 {
@@ -31,6 +39,10 @@ public:
 
     ~ConsoleWaitBlock();
 
+    // Blocks come and go with every wait, so they're kept for reuse.
+    static void* operator new(const size_t cbSize);
+    static void operator delete(void* const pv) noexcept;
+
     bool Notify(const WaitTerminationReason TerminationReason);
 
     [[nodiscard]]
@@ -44,13 +56,28 @@ private:
                      const CONSOLE_API_MSG* const pWaitReplyMessage,
                      _In_ IWaitRoutine* const pWaiter);
 
+    // A block sits in two queues and in each of them it's linked into the
+    //      list of all waits and the list of waits on the same handle.
+    struct QueueLinks
+    {
+        ConsoleWaitLink inQueue;
+        ConsoleWaitLink onHandle;
+    };
+
+    QueueLinks& _LinksFor(const ConsoleWaitQueue* const pQueue) noexcept;
+
     ConsoleWaitQueue* const _pProcessQueue;
-    std::_List_const_iterator<std::_List_val<std::_List_simple_types<ConsoleWaitBlock*>>> _itProcessQueue;
+    QueueLinks _processQueueLinks;
 
     ConsoleWaitQueue* const _pObjectQueue;
-    std::_List_const_iterator<std::_List_val<std::_List_simple_types<ConsoleWaitBlock*>>> _itObjectQueue;
+    QueueLinks _objectQueueLinks;
+
+    const ConsoleHandleData* const _pHandle;
 
     CONSOLE_API_MSG _WaitReplyMessage;
 
     IWaitRoutine* const _pWaiter;
+
+    friend class ConsoleWaitQueue;
+    friend class WaitQueueTests;
 };
@@ -12,7 +12,9 @@
 // Routine Description:
 // - Instantiates a new ConsoleWaitQueue
 ConsoleWaitQueue::ConsoleWaitQueue() :
-    _blocks()
+    _blocks(),
+    _blocksByHandle(),
+    _count(0)
 {
 
 }
@@ -78,16 +80,10 @@ bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll,
 {
     bool fResult = false;
 
-    auto it = _blocks.cbegin();
-    while (!_blocks.empty() && it != _blocks.cend())
+    ConsoleWaitBlock* WaitBlock = _blocks.pHead;
+    while (WaitBlock != nullptr)
     {
-        ConsoleWaitBlock* const WaitBlock = (*it);
-        if (nullptr == WaitBlock)
-        {
-            break;
-        }
-
-        auto const nextIt = std::next(it); // we have to capture next before it is potentially erased
+        ConsoleWaitBlock* const NextBlock = _LinkOf(WaitBlock, false).pNext; // we have to capture next before it is potentially erased
 
         if (_NotifyBlock(WaitBlock, TerminationReason))
         {
@@ -99,12 +95,58 @@ bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll,
             break;
         }
 
-        it = nextIt;
+        WaitBlock = NextBlock;
     }
 
     return fResult;
 }
 
+// Routine Description:
+// - Instructs this queue to callback only the requests that wait through the given handle, oldest first
+// Arguments:
+// - pHandle - The handle whose waiters should be notified.
+// - TerminationReason - A reason/message to pass to each waiter signaling it should terminate appropriately.
+// Return Value:
+// - True if any block was successfully notified. False if no blocks were successful.
+bool ConsoleWaitQueue::NotifyHandleWaiters(const ConsoleHandleData* const pHandle,
+                                           const WaitTerminationReason TerminationReason)
+{
+    const auto found = _blocksByHandle.find(pHandle);
+    if (found == _blocksByHandle.end())
+    {
+        return false;
+    }
+
+    bool fResult = false;
+
+    // The list itself goes away with its last block, so only the links are followed from here.
+    ConsoleWaitBlock* WaitBlock = found->second.pHead;
+    while (WaitBlock != nullptr)
+    {
+        ConsoleWaitBlock* const NextBlock = _LinkOf(WaitBlock, true).pNext;
+
+        if (_NotifyBlock(WaitBlock, TerminationReason))
+        {
+            fResult = true;
+        }
+
+        WaitBlock = NextBlock;
+    }
+
+    return fResult;
+}
+
+// Routine Description:
+// - Gets the number of requests waiting in this queue.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of waiting requests.
+size_t ConsoleWaitQueue::GetWaitCount() const noexcept
+{
+    return _count;
+}
+
 // Routine Description:
 // - A helper to delete successfully notified callbacks
 // Arguments:
@@ -126,3 +168,90 @@ bool ConsoleWaitQueue::_NotifyBlock(_In_ ConsoleWaitBlock* pWaitBlock,
 
     return fResult;
 }
+
+// Routine Description:
+// - Links a new block in at the end of this queue and of the list for its handle.
+// Arguments:
+// - pWaitBlock - The block that started waiting.
+// Return Value:
+// - <none>
+// NOTE: CAN THROW IF THE HANDLE INDEX CAN'T GROW.
+void ConsoleWaitQueue::_AddBlock(_In_ ConsoleWaitBlock* const pWaitBlock)
+{
+    WaitList& handleList = _blocksByHandle[pWaitBlock->_pHandle];
+
+    _Append(_blocks, pWaitBlock, false);
+    _Append(handleList, pWaitBlock, true);
+    _count++;
+}
+
+// Routine Description:
+// - Unlinks a block from this queue and from the list for its handle.
+// Arguments:
+// - pWaitBlock - The block that's done waiting.
+// Return Value:
+// - <none>
+void ConsoleWaitQueue::_RemoveBlock(_In_ ConsoleWaitBlock* const pWaitBlock) noexcept
+{
+    _Unlink(_blocks, pWaitBlock, false);
+
+    const auto found = _blocksByHandle.find(pWaitBlock->_pHandle);
+    if (found != _blocksByHandle.end())
+    {
+        _Unlink(found->second, pWaitBlock, true);
+        if (found->second.pHead == nullptr)
+        {
+            _blocksByHandle.erase(found);
+        }
+    }
+
+    _count--;
+}
+
+void ConsoleWaitQueue::_Append(WaitList& list, _In_ ConsoleWaitBlock* const pWaitBlock, const bool fOnHandle) noexcept
+{
+    ConsoleWaitLink& link = _LinkOf(pWaitBlock, fOnHandle);
+    link.pPrev = list.pTail;
+    link.pNext = nullptr;
+
+    if (list.pTail != nullptr)
+    {
+        _LinkOf(list.pTail, fOnHandle).pNext = pWaitBlock;
+    }
+    else
+    {
+        list.pHead = pWaitBlock;
+    }
+    list.pTail = pWaitBlock;
+}
+
+void ConsoleWaitQueue::_Unlink(WaitList& list, _In_ ConsoleWaitBlock* const pWaitBlock, const bool fOnHandle) noexcept
+{
+    ConsoleWaitLink& link = _LinkOf(pWaitBlock, fOnHandle);
+
+    if (link.pPrev != nullptr)
+    {
+        _LinkOf(link.pPrev, fOnHandle).pNext = link.pNext;
+    }
+    else
+    {
+        list.pHead = link.pNext;
+    }
+
+    if (link.pNext != nullptr)
+    {
+        _LinkOf(link.pNext, fOnHandle).pPrev = link.pPrev;
+    }
+    else
+    {
+        list.pTail = link.pPrev;
+    }
+
+    link = {};
+}
+
+ConsoleWaitLink& ConsoleWaitQueue::_LinkOf(_In_ ConsoleWaitBlock* const pWaitBlock, const bool fOnHandle) const noexcept
+{
+    auto& links = pWaitBlock->_LinksFor(this);
+    return fOnHandle ? links.onHandle : links.inQueue;
+}
@@ -7,6 +7,9 @@ Module Name:
 
 Abstract:
 - This file manages a queue of wait blocks
+- Blocks are kept in the order they started waiting and are also indexed by
+  the handle they wait on, so that closing a handle only has to visit the
+  waits made through it.
 
 Author:
 - Michael Niksa (miniksa) 17-Oct-2016
@@ -17,14 +20,14 @@ Revision History:
 
 #pragma once
 
-#include <list>
-
 #include "..\host\conapi.h"
 
 #include "IWaitRoutine.h"
 #include "WaitBlock.h"
 #include "WaitTerminationReason.h"
 
+class ConsoleHandleData;
+
 class ConsoleWaitQueue
 {
 public:
@@ -37,15 +40,36 @@ public:
     bool NotifyWaiters(const bool fNotifyAll,
                        const WaitTerminationReason TerminationReason);
 
+    bool NotifyHandleWaiters(const ConsoleHandleData* const pHandle,
+                             const WaitTerminationReason TerminationReason);
+
+    size_t GetWaitCount() const noexcept;
+
     [[nodiscard]]
     static HRESULT s_CreateWait(_Inout_ CONSOLE_API_MSG* const pWaitReplyMessage,
                                 _In_ IWaitRoutine* const pWaiter);
 
 private:
+    struct WaitList
+    {
+        ConsoleWaitBlock* pHead = nullptr;
+        ConsoleWaitBlock* pTail = nullptr;
+    };
+
     bool _NotifyBlock(_In_ ConsoleWaitBlock* pWaitBlock,
                       const WaitTerminationReason TerminationReason);
 
-    std::list<ConsoleWaitBlock*> _blocks;
+    void _AddBlock(_In_ ConsoleWaitBlock* const pWaitBlock);
+    void _RemoveBlock(_In_ ConsoleWaitBlock* const pWaitBlock) noexcept;
+
+    void _Append(WaitList& list, _In_ ConsoleWaitBlock* const pWaitBlock, const bool fOnHandle) noexcept;
+    void _Unlink(WaitList& list, _In_ ConsoleWaitBlock* const pWaitBlock, const bool fOnHandle) noexcept;
+    ConsoleWaitLink& _LinkOf(_In_ ConsoleWaitBlock* const pWaitBlock, const bool fOnHandle) const noexcept;
+
+    WaitList _blocks;
+    std::unordered_map<const ConsoleHandleData*, WaitList> _blocksByHandle;
+    size_t _count;
 
     friend class ConsoleWaitBlock; // Blocks live in multiple queues so we let them manage the lifetime.
+    friend class WaitQueueTests;
 };
@@ -51,8 +51,9 @@ bool InteractDispatch::WriteCtrlC()
 }
 
 // Method Description:
-// - Writes a string of input to the host. The string is converted to keystrokes
-//      that will faithfully represent the input by CharToKeyEvents.
+// - Writes a string of input to the host. The host converts the whole string
+//      to keystrokes that will faithfully represent the input, as
+//      CharToKeyEvents would for each character.
 // Arguments:
 // - pws: a string to write to the console.
 // - cch: the number of chars in pws.
@@ -66,24 +67,8 @@ bool InteractDispatch::WriteString(_In_reads_(cch) const wchar_t* const pws,
         return true;
     }
 
-    unsigned int codepage = 0;
-    bool fSuccess = !!_pConApi->GetConsoleOutputCP(&codepage);
-    if (fSuccess)
-    {
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
-
-        for (size_t i = 0; i < cch; ++i)
-        {
-            std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(pws[i], codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
-        }
-
-        fSuccess = WriteInput(keyEvents);
-    }
-    return fSuccess;
+    size_t eventsWritten = 0;
+    return !!_pConApi->PrivateWriteConsoleInputText({ pws, cch }, eventsWritten);
 }
 
 //Method Description:
@@ -42,6 +42,18 @@ AdaptDispatch::AdaptDispatch(ConGetSet* const pConApi,
 
 }
 
+// Routine Description:
+// - Determines if printed characters are currently mapped to another
+//      character set (like DEC line drawing) before they reach the buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if characters are being translated. False if they print as is.
+bool AdaptDispatch::IsTranslatingCharacters() const
+{
+    return _TermOutput.NeedToTranslate();
+}
+
 void AdaptDispatch::Print(const wchar_t wchPrintable)
 {
     _pDefaults->Print(_TermOutput.TranslateKey(wchPrintable));
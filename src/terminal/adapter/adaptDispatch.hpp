@@ -41,6 +41,8 @@ namespace Microsoft::Console::VirtualTerminal
         virtual void PrintString(const wchar_t* const rgwch, const size_t cch);
         virtual void Print(const wchar_t wchPrintable);
 
+        bool IsTranslatingCharacters() const;
+
         virtual bool CursorUp(_In_ unsigned int const uiDistance); // CUU
         virtual bool CursorDown(_In_ unsigned int const uiDistance); // CUD
         virtual bool CursorForward(_In_ unsigned int const uiDistance); // CUF
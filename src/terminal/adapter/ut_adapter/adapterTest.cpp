@@ -365,6 +365,21 @@ public:
         return _fPrivateWriteConsoleInputWResult;
     }
 
+    BOOL PrivateWriteConsoleInputText(const std::wstring_view text,
+                                      _Out_ size_t& eventsWritten) override
+    {
+        Log::Comment(L"PrivateWriteConsoleInputText MOCK called...");
+
+        eventsWritten = 0;
+        if (_fPrivateWriteConsoleInputWResult)
+        {
+            Log::Comment(NoThrowString().Format(L"Typed %zu characters...", text.size()));
+            eventsWritten = text.size();
+        }
+
+        return _fPrivateWriteConsoleInputWResult;
+    }
+
     BOOL PrivatePrependConsoleInput(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
                                     _Out_ size_t& eventsWritten) override
     {
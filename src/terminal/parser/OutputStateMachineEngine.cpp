@@ -1667,6 +1667,27 @@ void OutputStateMachineEngine::SetTerminalConnection(ITerminalOutputConnection*
     this->_pfnFlushToTerminal = pfnFlushToTerminal;
 }
 
+// Method Description:
+// - Called when the host wrote plain text straight into the buffer without
+//      running it through the state machine. Updates the last printed
+//      character the same way ActionPrintString and ActionExecute would have,
+//      so a following REP still repeats the right thing.
+// Arguments:
+// - wchLast - The last character of the text that was written.
+// Return Value:
+// - <none>
+void OutputStateMachineEngine::NotePlainTextWritten(const wchar_t wchLast) noexcept
+{
+    if (wchLast >= AsciiChars::SPC)
+    {
+        _lastPrintedChar = wchLast;
+    }
+    else
+    {
+        _ClearLastChar();
+    }
+}
+
 
 // Routine Description:
 // - Retrieves a number of times to repeat the last graphical character
@@ -62,6 +62,8 @@ namespace Microsoft::Console::VirtualTerminal
         void SetTerminalConnection(Microsoft::Console::ITerminalOutputConnection* const pTtyConnection,
                                    std::function<bool()> pfnFlushToTerminal);
 
+        void NotePlainTextWritten(const wchar_t wchLast) noexcept;
+
         const ITermDispatch& Dispatch() const noexcept;
         ITermDispatch& Dispatch() noexcept;
 
@@ -1443,3 +1443,15 @@ void StateMachine::ResetState()
 {
     _EnterGround();
 }
+
+// Routine Description:
+// - Determines if the state machine is between sequences, so that text written
+//      now would be printed or executed rather than complete a sequence.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if we're in the ground state. False otherwise.
+bool StateMachine::IsInGroundState() const noexcept
+{
+    return _state == VTStates::Ground;
+}
@@ -36,6 +36,7 @@ namespace Microsoft::Console::VirtualTerminal
         void ProcessString(const std::wstring& wstr);
 
         void ResetState();
+        bool IsInGroundState() const noexcept;
 
         bool FlushToTerminal();
 
@@ -17,9 +17,366 @@
 static const WORD altScanCode = 0x38;
 static const WORD leftShiftScanCode = 0x2A;
 
+// The ASCII checks look at a whole 64-bit word of text at a time. A word is
+// all ASCII when none of its characters have a bit set outside the low seven.
+static constexpr uint64_t s_nonAsciiBytes = 0x8080808080808080;
+static constexpr uint64_t s_nonAsciiWchars = 0xFF80FF80FF80FF80;
+
+// The UTF-8 encoding of U+FFFD, written for text that can't be converted.
+static constexpr char s_utf8Replacement[] = { '\xEF', '\xBF', '\xBD' };
+
+// Routine Description:
+// - Copies ASCII from the start of the source into the target as UTF-16,
+//   stopping at the first non-ASCII byte. Eight bytes are checked and copied
+//   at a time.
+// Arguments:
+// - source - the text to copy from
+// - target - where to copy it to
+// Return Value:
+// - The number of characters copied.
+size_t WidenAscii(const std::string_view source, const gsl::span<wchar_t> target) noexcept
+{
+    const size_t count = std::min(source.size(), gsl::narrow_cast<size_t>(target.size()));
+    const char* const in = source.data();
+    wchar_t* const out = target.data();
+
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= count; i += sizeof(uint64_t))
+    {
+        uint64_t block;
+        memcpy(&block, in + i, sizeof(block));
+        if ((block & s_nonAsciiBytes) != 0)
+        {
+            break;
+        }
+        for (size_t j = 0; j < sizeof(uint64_t); j++)
+        {
+            out[i + j] = static_cast<wchar_t>(in[i + j]);
+        }
+    }
+
+    for (; i < count && (static_cast<unsigned char>(in[i]) & 0x80) == 0; i++)
+    {
+        out[i] = static_cast<wchar_t>(in[i]);
+    }
+    return i;
+}
+
+// Routine Description:
+// - Copies ASCII from the start of the source into the target as single
+//   bytes, stopping at the first non-ASCII character. Four characters are
+//   checked and copied at a time.
+// Arguments:
+// - source - the text to copy from
+// - target - where to copy it to
+// Return Value:
+// - The number of characters copied.
+size_t NarrowAscii(const std::wstring_view source, const gsl::span<char> target) noexcept
+{
+    const size_t count = std::min(source.size(), gsl::narrow_cast<size_t>(target.size()));
+    const wchar_t* const in = source.data();
+    char* const out = target.data();
+
+    const size_t charsPerBlock = sizeof(uint64_t) / sizeof(wchar_t);
+    size_t i = 0;
+    for (; i + charsPerBlock <= count; i += charsPerBlock)
+    {
+        uint64_t block;
+        memcpy(&block, in + i, sizeof(block));
+        if ((block & s_nonAsciiWchars) != 0)
+        {
+            break;
+        }
+        for (size_t j = 0; j < charsPerBlock; j++)
+        {
+            out[i + j] = static_cast<char>(in[i + j]);
+        }
+    }
+
+    for (; i < count && in[i] < 0x80; i++)
+    {
+        out[i] = static_cast<char>(in[i]);
+    }
+    return i;
+}
+
+// Routine Description:
+// - Converts UTF-8 to UTF-16 into the caller's buffer, for text that arrives
+//   in pieces. Conversion stops when the target is full, or at a sequence
+//   that's cut off by the end of the source, so the caller can carry the rest
+//   over to the next piece.
+// - Ill-formed sequences are replaced with U+FFFD, one for each maximal part
+//   of a sequence, as the Unicode standard recommends.
+// Arguments:
+// - source - the UTF-8 text to convert
+// - target - where to put the UTF-16 text. A target at least as long as the
+//   source always has room for all of it.
+// - consumed - on output, the number of bytes of source converted
+// - produced - on output, the number of wchar_ts written to target
+// Return Value:
+// - S_OK if the converted text was well-formed, or S_FALSE if any of it had to
+//   be replaced.
+[[nodiscard]]
+HRESULT Utf8ToUtf16(const std::string_view source,
+                    const gsl::span<wchar_t> target,
+                    _Out_ size_t& consumed,
+                    _Out_ size_t& produced) noexcept
+{
+    const unsigned char* const in = reinterpret_cast<const unsigned char*>(source.data());
+    const size_t inSize = source.size();
+    wchar_t* const out = target.data();
+    const size_t outSize = gsl::narrow_cast<size_t>(target.size());
+
+    size_t i = 0;
+    size_t o = 0;
+    bool replaced = false;
+    while (i < inSize && o < outSize)
+    {
+        if (in[i] < 0x80)
+        {
+            const size_t copied = WidenAscii({ source.data() + i, inSize - i }, { out + o, gsl::narrow_cast<ptrdiff_t>(outSize - o) });
+            i += copied;
+            o += copied;
+            continue;
+        }
+
+        // The lead byte decides the length of the sequence, and the range the
+        // second byte has to be in to rule out overlong forms, surrogates and
+        // anything past U+10FFFF.
+        const unsigned char lead = in[i];
+        size_t length = 0;
+        char32_t codepoint = 0;
+        unsigned char lower = 0x80;
+        unsigned char upper = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF)
+        {
+            length = 2;
+            codepoint = lead & 0x1F;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            length = 3;
+            codepoint = lead & 0x0F;
+            lower = lead == 0xE0 ? 0xA0 : lower;
+            upper = lead == 0xED ? 0x9F : upper;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            length = 4;
+            codepoint = lead & 0x07;
+            lower = lead == 0xF0 ? 0x90 : lower;
+            upper = lead == 0xF4 ? 0x8F : upper;
+        }
+
+        size_t valid = 1;
+        for (; valid < length && i + valid < inSize; valid++)
+        {
+            const unsigned char trail = in[i + valid];
+            if (trail < lower || trail > upper)
+            {
+                break;
+            }
+            codepoint = (codepoint << 6) | (trail & 0x3F);
+            lower = 0x80;
+            upper = 0xBF;
+        }
+
+        if (length != 0 && valid < length && i + valid == inSize)
+        {
+            // Every byte so far fits, but the rest are in the next piece.
+            break;
+        }
+
+        if (length == 0 || valid < length)
+        {
+            out[o++] = UNICODE_REPLACEMENT;
+            i += valid;
+            replaced = true;
+        }
+        else if (codepoint < 0x10000)
+        {
+            out[o++] = static_cast<wchar_t>(codepoint);
+            i += length;
+        }
+        else
+        {
+            if (outSize - o < 2)
+            {
+                break;
+            }
+            codepoint -= 0x10000;
+            out[o++] = static_cast<wchar_t>(0xD800 + (codepoint >> 10));
+            out[o++] = static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF));
+            i += length;
+        }
+    }
+
+    consumed = i;
+    produced = o;
+    return replaced ? S_FALSE : S_OK;
+}
+
+// Routine Description:
+// - Converts UTF-16 to UTF-8 into the caller's buffer, for text that arrives
+//   in pieces. Conversion stops when the next character doesn't fit in the
+//   target, or at a leading surrogate at the end of the source, so the caller
+//   can carry the rest over to the next piece.
+// - Unpaired surrogates are replaced with U+FFFD.
+// Arguments:
+// - source - the UTF-16 text to convert
+// - target - where to put the UTF-8 text. A target three times as long as the
+//   source always has room for all of it.
+// - consumed - on output, the number of wchar_ts of source converted
+// - produced - on output, the number of bytes written to target
+// Return Value:
+// - S_OK if the converted text was well-formed, or S_FALSE if any of it had to
+//   be replaced.
+[[nodiscard]]
+HRESULT Utf16ToUtf8(const std::wstring_view source,
+                    const gsl::span<char> target,
+                    _Out_ size_t& consumed,
+                    _Out_ size_t& produced) noexcept
+{
+    const wchar_t* const in = source.data();
+    const size_t inSize = source.size();
+    char* const out = target.data();
+    const size_t outSize = gsl::narrow_cast<size_t>(target.size());
+
+    size_t i = 0;
+    size_t o = 0;
+    bool replaced = false;
+    while (i < inSize && o < outSize)
+    {
+        if (in[i] < 0x80)
+        {
+            const size_t copied = NarrowAscii({ in + i, inSize - i }, { out + o, gsl::narrow_cast<ptrdiff_t>(outSize - o) });
+            i += copied;
+            o += copied;
+            continue;
+        }
+
+        char32_t codepoint = in[i];
+        size_t units = 1;
+        if (IS_HIGH_SURROGATE(in[i]))
+        {
+            if (i + 1 == inSize)
+            {
+                // The trailing surrogate is in the next piece.
+                break;
+            }
+            if (IS_LOW_SURROGATE(in[i + 1]))
+            {
+                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (in[i + 1] - 0xDC00);
+                units = 2;
+            }
+            else
+            {
+                codepoint = UNICODE_REPLACEMENT;
+                replaced = true;
+            }
+        }
+        else if (IS_LOW_SURROGATE(in[i]))
+        {
+            codepoint = UNICODE_REPLACEMENT;
+            replaced = true;
+        }
+
+        const size_t length = codepoint < 0x800 ? 2 : codepoint < 0x10000 ? 3 : 4;
+        if (outSize - o < length)
+        {
+            break;
+        }
+
+        switch (length)
+        {
+        case 2:
+            out[o++] = static_cast<char>(0xC0 | (codepoint >> 6));
+            break;
+        case 3:
+            out[o++] = static_cast<char>(0xE0 | (codepoint >> 12));
+            out[o++] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            break;
+        default:
+            out[o++] = static_cast<char>(0xF0 | (codepoint >> 18));
+            out[o++] = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out[o++] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            break;
+        }
+        out[o++] = static_cast<char>(0x80 | (codepoint & 0x3F));
+        i += units;
+    }
+
+    consumed = i;
+    produced = o;
+    return replaced ? S_FALSE : S_OK;
+}
+
+// Routine Description:
+// - Converts all of a UTF-16 string to UTF-8, appending it to the target.
+//   The target's storage is reused, so a caller that keeps the string around
+//   between calls only allocates when its text grows.
+// - A leading surrogate at the very end is replaced with U+FFFD, like the rest
+//   of the unpaired surrogates.
+// Arguments:
+// - source - the UTF-16 text to convert
+// - target - the string to append the UTF-8 text to
+// Return Value:
+// - <none>
+// - NOTE: Throws if the target can't grow.
+void AppendUtf16AsUtf8(const std::wstring_view source, std::string& target)
+{
+    const size_t start = target.size();
+    target.resize(start + source.size() * 3);
+
+    size_t consumed;
+    size_t produced;
+    (void)Utf16ToUtf8(source, { target.data() + start, gsl::narrow<ptrdiff_t>(source.size() * 3) }, consumed, produced);
+    target.resize(start + produced);
+
+    if (consumed < source.size())
+    {
+        target.append(std::begin(s_utf8Replacement), std::end(s_utf8Replacement));
+    }
+}
+
+// Routine Description:
+// - Counts the bytes the UTF-8 encoding of a UTF-16 string takes, without
+//   converting it. Unpaired surrogates count as the U+FFFD they're converted to.
+// Arguments:
+// - source - the UTF-16 text to measure
+// Return Value:
+// - The length of the UTF-8 text in bytes.
+static size_t _GetUtf8Length(const std::wstring_view source) noexcept
+{
+    size_t length = 0;
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        const wchar_t wch = source[i];
+        if (wch < 0x80)
+        {
+            length += 1;
+        }
+        else if (wch < 0x800)
+        {
+            length += 2;
+        }
+        else if (IS_HIGH_SURROGATE(wch) && i + 1 < source.size() && IS_LOW_SURROGATE(source[i + 1]))
+        {
+            length += 4;
+            i++;
+        }
+        else
+        {
+            length += 3;
+        }
+    }
+    return length;
+}
+
 // Routine Description:
 // - Takes a multibyte string, allocates the appropriate amount of memory for the conversion, performs the conversion,
 //   and returns the Unicode UTF-16 result in the smart pointer (and the length).
+// - UTF-8 is converted in a single pass by Utf8ToUtf16, instead of measuring it first.
 // Arguments:
 // - codepage - Windows Code Page representing the multibyte source text
 // - source - View of multibyte characters of source text
@@ -35,6 +392,23 @@ std::wstring ConvertToW(const UINT codePage, const std::string_view source)
         return {};
     }
 
+    if (codePage == CP_UTF8)
+    {
+        // Each byte becomes at most one wchar_t.
+        std::wstring out(source.size(), UNICODE_NULL);
+        size_t consumed;
+        size_t produced;
+        (void)Utf8ToUtf16(source, { out.data(), gsl::narrow<ptrdiff_t>(out.size()) }, consumed, produced);
+
+        // A sequence cut off by the end of the text is ill-formed, too.
+        if (consumed < source.size())
+        {
+            out[produced++] = UNICODE_REPLACEMENT;
+        }
+        out.resize(produced);
+        return out;
+    }
+
     int iSource; // convert to int because Mb2Wc requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -59,6 +433,7 @@ std::wstring ConvertToW(const UINT codePage, const std::string_view source)
 // Routine Description:
 // - Takes a wide string, allocates the appropriate amount of memory for the conversion, performs the conversion,
 //   and returns the Multibyte result
+// - UTF-8 is converted in a single pass by Utf16ToUtf8, instead of measuring it first.
 // Arguments:
 // - codepage - Windows Code Page representing the multibyte destination text
 // - source - Unicode (UTF-16) characters of source text
@@ -73,7 +448,14 @@ std::string ConvertToA(const UINT codepage, const std::wstring_view source)
     {
         return {};
     }
-    
+
+    if (codepage == CP_UTF8)
+    {
+        std::string out;
+        AppendUtf16AsUtf8(source, out);
+        return out;
+    }
+
     int iSource; // convert to int because Wc2Mb requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -114,6 +496,11 @@ size_t GetALengthFromW(const UINT codepage, const std::wstring_view source)
         return 0;
     }
 
+    if (codepage == CP_UTF8)
+    {
+        return _GetUtf8Length(source);
+    }
+
     int iSource; // convert to int because Wc2Mb requires it
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -129,8 +516,16 @@ size_t GetALengthFromW(const UINT codepage, const std::wstring_view source)
     return cchTarget;
 }
 
-std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
-                                                      const unsigned int codepage)
+// Routine Description:
+// - Looks up how the character is typed on the current keyboard layout, like
+//   VkKeyScanW does. DBCS characters that VkKeyScanW doesn't know are treated
+//   as typeable without any modifiers.
+// Arguments:
+// - wch - the wchar_t to look up
+// Return Value:
+// - the virtual key in the low byte and the VkKeyScanModState in the high byte,
+//   or -1 if the character can only be entered with Alt + numpad
+static short _GetKeyState(const wchar_t wch)
 {
     const short invalidKey = -1;
     short keyState = VkKeyScanW(wch);
@@ -149,131 +544,97 @@ std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
         }
     }
 
-    std::deque<std::unique_ptr<KeyEvent>> convertedEvents;
-    if (keyState == invalidKey)
-    {
-        // if VkKeyScanW fails (char is not in kbd layout), we must
-        // emulate the key being input through the numpad
-        convertedEvents = SynthesizeNumpadEvents(wch, codepage);
-    }
-    else
-    {
-        convertedEvents = SynthesizeKeyboardEvents(wch, keyState);
-    }
+    return keyState;
+}
 
-    return convertedEvents;
+// Routine Description:
+// - Finds the scan code SynthesizeKeyboardEvents gives the character.
+static WORD _GetScanCode(const wchar_t wch)
+{
+    return gsl::narrow<WORD>(MapVirtualKeyW(wch, MAPVK_VK_TO_VSC));
 }
 
+static void _AppendKeyRecord(std::vector<INPUT_RECORD>& records,
+                             const bool keyDown,
+                             const WORD virtualKeyCode,
+                             const WORD virtualScanCode,
+                             const wchar_t wch,
+                             const DWORD controlKeyState)
+{
+    INPUT_RECORD record;
+    record.EventType = KEY_EVENT;
+    record.Event.KeyEvent.bKeyDown = keyDown;
+    record.Event.KeyEvent.wRepeatCount = 1;
+    record.Event.KeyEvent.wVirtualKeyCode = virtualKeyCode;
+    record.Event.KeyEvent.wVirtualScanCode = virtualScanCode;
+    record.Event.KeyEvent.uChar.UnicodeChar = wch;
+    record.Event.KeyEvent.dwControlKeyState = controlKeyState;
+    records.push_back(record);
+}
 
 // Routine Description:
-// - converts a wchar_t into a series of KeyEvents as if it was typed
-// using the keyboard
-// Arguments:
-// - wch - the wchar_t to convert
-// Return Value:
-// - deque of KeyEvents that represent the wchar_t being typed
-// Note:
-// - will throw exception on error
-std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+// - Appends the key events of typing the character on the keyboard. See
+//   SynthesizeKeyboardEvents.
+static void _AppendKeyboardRecords(const wchar_t wch,
+                                     const short keyState,
+                                     const WORD virtualScanCode,
+                                     std::vector<INPUT_RECORD>& records)
 {
     const byte modifierState = HIBYTE(keyState);
-
-    bool altGrSet = false;
-    bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    const bool altGrSet = WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed);
+    const bool shiftSet = !altGrSet && WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed);
 
     // add modifier key event if necessary
-    if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
+    if (altGrSet)
     {
-        altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        _AppendKeyRecord(records, true, VK_MENU, altScanCode, UNICODE_NULL, ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED);
     }
-    else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
+    else if (shiftSet)
     {
-        shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        _AppendKeyRecord(records, true, VK_SHIFT, leftShiftScanCode, UNICODE_NULL, SHIFT_PRESSED);
     }
 
-    const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(wch, MAPVK_VK_TO_VSC));
-    KeyEvent keyEvent{ true, 1, LOBYTE(keyState), virtualScanCode, wch, 0 };
-
     // add modifier flags if necessary
+    DWORD controlKeyState = 0;
     if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::Shift);
+        WI_SetFlag(controlKeyState, SHIFT_PRESSED);
     }
     if (WI_IsFlagSet(modifierState, VkKeyScanModState::CtrlPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::LeftCtrl);
+        WI_SetFlag(controlKeyState, LEFT_CTRL_PRESSED);
     }
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::RightAlt);
+        WI_SetFlag(controlKeyState, RIGHT_ALT_PRESSED);
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
-    keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    _AppendKeyRecord(records, true, LOBYTE(keyState), virtualScanCode, wch, controlKeyState);
+    _AppendKeyRecord(records, false, LOBYTE(keyState), virtualScanCode, wch, controlKeyState);
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        _AppendKeyRecord(records, false, VK_MENU, altScanCode, UNICODE_NULL, ENHANCED_KEY);
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        _AppendKeyRecord(records, false, VK_SHIFT, leftShiftScanCode, UNICODE_NULL, 0);
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
-// - converts a wchar_t into a series of KeyEvents as if it was typed
-// using Alt + numpad
-// Arguments:
-// - wch - the wchar_t to convert
-// Return Value:
-// - deque of KeyEvents that represent the wchar_t being typed using
-// alt + numpad
-// Note:
-// - will throw exception on error
-std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
+// - Appends the key events of typing the character with Alt + numpad. See
+//   SynthesizeNumpadEvents.
+static void _AppendNumpadRecords(const wchar_t wch,
+                                 const unsigned int codepage,
+                                 std::vector<INPUT_RECORD>& records)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
-
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
-
-    const int radix = 10;
-    std::wstring wstr{ wch };
-    const auto convertedChars = ConvertToA(codepage, wstr);
+    _AppendKeyRecord(records, true, VK_MENU, altScanCode, UNICODE_NULL, LEFT_ALT_PRESSED);
+
+    const auto convertedChars = ConvertToA(codepage, { &wch, 1 });
     if (convertedChars.size() == 1)
     {
         // It is OK if the char is "signed -1", we want to interpret that as "unsigned 255" for the
@@ -297,31 +658,142 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch,
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            _AppendKeyRecord(records, true, virtualKey, virtualScanCode, UNICODE_NULL, LEFT_ALT_PRESSED);
+            _AppendKeyRecord(records, false, virtualKey, virtualScanCode, UNICODE_NULL, LEFT_ALT_PRESSED);
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
+    _AppendKeyRecord(records, false, VK_MENU, altScanCode, wch, 0);
+}
+
+static std::deque<std::unique_ptr<KeyEvent>> _ToKeyEvents(const std::vector<INPUT_RECORD>& records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
     return keyEvents;
 }
 
+std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
+                                                      const unsigned int codepage)
+{
+    const short invalidKey = -1;
+    const short keyState = _GetKeyState(wch);
+
+    std::deque<std::unique_ptr<KeyEvent>> convertedEvents;
+    if (keyState == invalidKey)
+    {
+        // if VkKeyScanW fails (char is not in kbd layout), we must
+        // emulate the key being input through the numpad
+        convertedEvents = SynthesizeNumpadEvents(wch, codepage);
+    }
+    else
+    {
+        convertedEvents = SynthesizeKeyboardEvents(wch, keyState);
+    }
+
+    return convertedEvents;
+}
+
+// Routine Description:
+// - converts a string into the key events of typing it, as CharToKeyEvents
+// would for each of its characters, and appends them to records.
+// - The keyboard layout lookups for the most common characters are kept in a
+// table while the string is converted, so a long string doesn't ask the layout
+// about the same characters over and over again. The layout can change between
+// calls, so the table doesn't outlive one.
+// Arguments:
+// - chars - the string to convert
+// - codepage - the codepage for characters that have to be typed with Alt + numpad
+// - records - where to append the key events
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void CharsToInputRecords(const std::wstring_view chars,
+                         const unsigned int codepage,
+                         std::vector<INPUT_RECORD>& records)
+{
+    struct KeyLookup
+    {
+        short keyState;
+        WORD virtualScanCode;
+        bool cached;
+    };
+    std::array<KeyLookup, 0x100> table{};
+
+    const short invalidKey = -1;
+
+    // Most characters take one key press and one release.
+    records.reserve(records.size() + chars.size() * 2);
+
+    for (const wchar_t wch : chars)
+    {
+        KeyLookup lookup;
+        if (wch < table.size() && table.at(wch).cached)
+        {
+            lookup = table.at(wch);
+        }
+        else
+        {
+            lookup.keyState = _GetKeyState(wch);
+            lookup.virtualScanCode = lookup.keyState == invalidKey ? 0 : _GetScanCode(wch);
+            lookup.cached = true;
+            if (wch < table.size())
+            {
+                table.at(wch) = lookup;
+            }
+        }
+
+        if (lookup.keyState == invalidKey)
+        {
+            // if VkKeyScanW fails (char is not in kbd layout), we must
+            // emulate the key being input through the numpad
+            _AppendNumpadRecords(wch, codepage, records);
+        }
+        else
+        {
+            _AppendKeyboardRecords(wch, lookup.keyState, lookup.virtualScanCode, records);
+        }
+    }
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of KeyEvents as if it was typed
+// using the keyboard
+// Arguments:
+// - wch - the wchar_t to convert
+// Return Value:
+// - deque of KeyEvents that represent the wchar_t being typed
+// Note:
+// - will throw exception on error
+std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    _AppendKeyboardRecords(wch, keyState, _GetScanCode(wch), records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of KeyEvents as if it was typed
+// using Alt + numpad
+// Arguments:
+// - wch - the wchar_t to convert
+// Return Value:
+// - deque of KeyEvents that represent the wchar_t being typed using
+// alt + numpad
+// Note:
+// - will throw exception on error
+std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    _AppendNumpadRecords(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
+
 // Routine Description:
 // - naively determines the width of a UCS2 encoded wchar
 // Arguments:
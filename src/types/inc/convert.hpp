@@ -16,6 +16,7 @@ Author:
 #pragma once
 #include <deque>
 #include <memory>
+#include <vector>
 #include "IInputEvent.hpp"
 
 enum class CodepointWidth : BYTE
@@ -38,8 +39,29 @@ std::string ConvertToA(const UINT codepage,
 size_t GetALengthFromW(const UINT codepage,
                        const std::wstring_view source);
 
+size_t WidenAscii(const std::string_view source, const gsl::span<wchar_t> target) noexcept;
+size_t NarrowAscii(const std::wstring_view source, const gsl::span<char> target) noexcept;
+
+[[nodiscard]]
+HRESULT Utf8ToUtf16(const std::string_view source,
+                    const gsl::span<wchar_t> target,
+                    _Out_ size_t& consumed,
+                    _Out_ size_t& produced) noexcept;
+
+[[nodiscard]]
+HRESULT Utf16ToUtf8(const std::wstring_view source,
+                    const gsl::span<char> target,
+                    _Out_ size_t& consumed,
+                    _Out_ size_t& produced) noexcept;
+
+void AppendUtf16AsUtf8(const std::wstring_view source, std::string& target);
+
 std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch, const unsigned int codepage);
 
+void CharsToInputRecords(const std::wstring_view chars,
+                         const unsigned int codepage,
+                         std::vector<INPUT_RECORD>& records);
+
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch,
                                                                const short keyState);
 